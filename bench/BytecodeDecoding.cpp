@@ -0,0 +1,94 @@
+///
+/// Measures decoding throughput of the large synthetic methods. Compares
+/// two pass 'parseInstructions' with the one by one decoding loop.
+///
+
+#include "Bytecode/Bytecode.h"
+#include "Bytecode/Instructions.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Bytecode;
+
+namespace {
+
+// Generates method body where roughly 'OneBytePercent' of instructions are
+// single byte ones. Rest are evenly split between the wider instructions.
+Container generateMethod(std::size_t Size, int OneBytePercent) {
+  static const uint8_t OneByte[] = {
+      iload_0::OpCode, iload_1::OpCode, iadd::OpCode, dup::OpCode,
+      istore_2::OpCode, aload_0::OpCode, iconst_1::OpCode, ireturn::OpCode};
+  static const uint8_t Wide[] = {
+      bipush::OpCode, iload::OpCode, getstatic::OpCode, invokestatic::OpCode,
+      iinc::OpCode, java_goto::OpCode, ldc_w::OpCode};
+
+  std::mt19937 Rng(42);
+  std::uniform_int_distribution<int> Percent(0, 99);
+  std::uniform_int_distribution<int> Byte(0, 255);
+
+  Container Res;
+  Res.reserve(Size + 3);
+  while (Res.size() < Size) {
+    if (Percent(Rng) < OneBytePercent) {
+      Res.push_back(OneByte[Rng() % std::size(OneByte)]);
+      continue;
+    }
+
+    const uint8_t Op = Wide[Rng() % std::size(Wide)];
+    Res.push_back(Op);
+    for (int Idx = 1; Idx < getOpcodeInfo(Op).Length; ++Idx)
+      Res.push_back(static_cast<uint8_t>(Byte(Rng)));
+  }
+
+  return Res;
+}
+
+// Decoding loop which was used before the two pass decoder
+std::vector<Instruction> decodeOneByOne(const Container &Bytes) {
+  std::vector<Instruction> Ret;
+  auto It = Bytes.begin();
+  while (It != Bytes.end())
+    Ret.push_back(parseInstruction(Bytes, It));
+  return Ret;
+}
+
+template<class F>
+double measure(const Container &Bytes, int Reps, F Decode) {
+  std::size_t Total = 0;
+
+  const auto Start = std::chrono::steady_clock::now();
+  for (int Rep = 0; Rep < Reps; ++Rep)
+    Total += Decode(Bytes).size();
+  const std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+
+  if (Total == 0)
+    std::cerr << "Nothing was decoded\n";
+  return Elapsed.count();
+}
+
+}
+
+int main(int argc, char **argv) {
+  // Size of the single method in bytes
+  const std::size_t Size = argc > 1 ? std::stoul(argv[1]) : 1 << 20;
+  const int Reps = argc > 2 ? std::stoi(argv[2]) : 50;
+
+  for (int OneBytePercent: {50, 80, 95}) {
+    const auto Bytes = generateMethod(Size, OneBytePercent);
+    const double MBytes = static_cast<double>(Bytes.size()) * Reps / 1e6;
+
+    const double Old = measure(Bytes, Reps, decodeOneByOne);
+    const double New = measure(Bytes, Reps, parseInstructions);
+
+    std::cout << OneBytePercent << "% one byte instructions\n"
+              << "  one by one: " << MBytes / Old << " MB/s\n"
+              << "  two pass:   " << MBytes / New << " MB/s\n";
+  }
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+///
+/// Measures CD parsing throughput on the large synthetic class with many
+/// methods. Class is written into the temporary file and parsed from it
+/// several times.
+///
+
+#include "CD/Parser.h"
+#include "JavaTypes/JavaClass.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Every method has branches, labels, constant pool references and a stack
+// map, so that all parts of the parser are exercised.
+std::string generateClass(std::size_t NumMethods) {
+  std::string Res =
+      "class {\n"
+      "  constant_pool {\n"
+      "    1: ClassInfo \"Generated\"\n"
+      "    2: ClassInfo \"java/lang/Object\"\n"
+      "    3: NameAndType \"field\" \"I\"\n"
+      "    4: FieldRef #1 #3 // field\n"
+      "    auto: \"(I)I\"\n";
+  for (std::size_t Idx = 0; Idx < NumMethods; ++Idx)
+    Res += "    auto: \"method_" + std::to_string(Idx) + "\"\n";
+  Res +=
+      "  }\n"
+      "\n"
+      "  Name: #1\n"
+      "  Super: #2\n"
+      "\n"
+      "  fields {\n"
+      "    public static \"I\": \"field\"\n"
+      "  }\n";
+
+  for (std::size_t Idx = 0; Idx < NumMethods; ++Idx) {
+    Res +=
+        "\n"
+        "  method \"method_" + std::to_string(Idx) + "\" \"(I)I\" {\n"
+        "    Flags: public, static\n"
+        "    MaxStack: 10\n"
+        "    MaxLocals: 10\n"
+        "\n"
+        "    bytecode {\n"
+        "      getstatic #4 // Field field:I\n"
+        "      iload_0\n"
+        "      if_icmpeq @equal\n"
+        "        iconst_0\n"
+        "        istore_1\n"
+        "        goto @done\n"
+        "      :equal\n"
+        "        iconst_1\n"
+        "        istore_1\n"
+        "      :done\n"
+        "        iload_1\n"
+        "        bipush #100\n"
+        "        iadd\n"
+        "        ireturn\n"
+        "\n"
+        "      stackmap {\n"
+        "        equal: same\n"
+        "        done: same\n"
+        "      }\n"
+        "    }\n"
+        "  }\n";
+  }
+
+  Res += "}\n";
+  return Res;
+}
+
+}
+
+int main(int argc, char **argv) {
+  const std::size_t NumMethods = argc > 1 ? std::stoul(argv[1]) : 20000;
+  const int Reps = argc > 2 ? std::stoi(argv[2]) : 5;
+
+  const std::string Source = generateClass(NumMethods);
+  const std::string FileName = "icp_bench_cd_parsing.cd";
+  {
+    std::ofstream Out(FileName, std::ios_base::binary | std::ios_base::trunc);
+    Out << Source;
+  }
+
+  std::size_t Total = 0;
+  const auto Start = std::chrono::steady_clock::now();
+  for (int Rep = 0; Rep < Reps; ++Rep)
+    Total += CD::parseFromFile(FileName)->methods().size();
+  const std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+
+  std::remove(FileName.c_str());
+
+  if (Total == 0)
+    std::cerr << "Nothing was parsed\n";
+
+  const double MBytes = static_cast<double>(Source.size()) * Reps / 1e6;
+  std::cout << "Parsed " << Source.size() / 1000 << " KB class "
+            << Reps << " times\n"
+            << "  " << MBytes / Elapsed.count() << " MB/s\n";
+
+  return 0;
+}
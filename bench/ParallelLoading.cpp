@@ -0,0 +1,102 @@
+///
+/// Measures batch class loading. Generates given number of the CD classes in
+/// the temporary directory and loads them with the different number of
+/// worker threads.
+///
+
+#include "Runtime/ClassManager.h"
+#include "Utils/ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Runtime;
+
+static void writeClass(const std::string &Name) {
+  std::ofstream Out(Name + ".cd");
+  Out << "class {\n"
+         "  constant_pool {\n"
+         "    1: ClassInfo \"" << Name << "\"\n"
+         "    2: ClassInfo \"java/lang/Object\"\n"
+         "    3: NameAndType \"F\" \"I\"\n"
+         "    4: FieldRef #1 #3\n"
+         "    auto: \"run\"\n"
+         "    auto: \"(I)I\"\n"
+         "  }\n"
+         "  Name: #1\n"
+         "  Super: #2\n"
+         "  fields {\n"
+         "    public static \"I\": \"F\"\n"
+         "  }\n"
+         "  method \"run\" \"(I)I\" {\n"
+         "    Flags: public, static\n"
+         "    MaxStack: 2\n"
+         "    MaxLocals: 1\n"
+         "    bytecode {\n"
+         "      iload_0\n"
+         "      getstatic #4\n"
+         "      iadd\n"
+         "      ireturn\n"
+         "    }\n"
+         "  }\n"
+         "}\n";
+}
+
+int main(int argc, char **argv) {
+  const int NumClasses = argc > 1 ? std::atoi(argv[1]) : 10000;
+
+  char Dir[] = "/tmp/icp_bench_XXXXXX";
+  if (!mkdtemp(Dir) || chdir(Dir) != 0) {
+    std::cerr << "Unable to create temporary directory\n";
+    return 1;
+  }
+  mkdir("gen", 0700);
+
+  std::vector<Utf8String> Names;
+  for (int Idx = 0; Idx < NumClasses; ++Idx) {
+    Names.push_back("gen/C" + std::to_string(Idx));
+    writeClass(Names.back());
+  }
+
+  auto Measure = [&](auto &&Load) {
+    const auto Start = std::chrono::steady_clock::now();
+    Load();
+    const std::chrono::duration<double> Elapsed =
+        std::chrono::steady_clock::now() - Start;
+    return Elapsed.count();
+  };
+
+  const double Sequential = Measure([&]() {
+    ClassManager CM;
+    for (const auto &Name: Names)
+      CM.getClass(Name, getTestLoader());
+  });
+  std::cout << "sequential: " << Sequential << "s\n";
+
+  const unsigned MaxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned NumThreads = 1; NumThreads <= MaxThreads; NumThreads *= 2) {
+    Utils::ThreadPool Pool(NumThreads);
+    const double Batch = Measure([&]() {
+      ClassManager CM;
+      CM.loadClasses(Names, getTestLoader(), Pool);
+    });
+    std::cout << NumThreads << " threads: " << Batch << "s, speedup "
+              << Sequential / Batch << "\n";
+  }
+
+  for (const auto &Name: Names)
+    unlink((Name + ".cd").c_str());
+  rmdir("gen");
+  if (chdir("/") == 0)
+    rmdir(Dir);
+  return 0;
+}
@@ -0,0 +1,119 @@
+///
+/// Compares modified UTF-8 validation with the byte by byte loop which was
+/// used by the class file reader before. Strings are taken from the constant
+/// pools of the class files given on the command line.
+///
+
+#include "Utils/BinaryFiles.h"
+#include "Utils/ModifiedUtf8.h"
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace Utils;
+
+namespace {
+
+struct StringRef {
+  const uint8_t *Data;
+  std::size_t Size;
+};
+
+// Collects all Utf8 constants from the class file without parsing it.
+void collectStrings(const MappedFile &File, std::vector<StringRef> &Out) {
+  BigEndianReader Input(File.data(), File.size());
+  Input.skip(8); // magic and version
+
+  const uint16_t Count = Input.readHalf();
+  for (uint16_t Idx = 1; Idx < Count; ++Idx) {
+    switch (Input.readByte()) {
+    case 1: {
+      const uint16_t Length = Input.readHalf();
+      Out.push_back({Input.readBytes(Length), Length});
+      break;
+    }
+    case 7: case 8: case 16: Input.skip(2); break;
+    case 15: Input.skip(3); break;
+    case 3: case 4: case 9: case 10: case 11: case 12: case 18:
+      Input.skip(4); break;
+    case 5: case 6: Input.skip(8); ++Idx; break;
+    default: throw ReadError();
+    }
+  }
+}
+
+// Loop from the original class file reader
+bool legacyDecode(const StringRef &Str, std::string &Out) {
+  Out.clear();
+  for (std::size_t Idx = 0; Idx < Str.Size; ++Idx) {
+    const uint8_t Byte = Str.Data[Idx];
+    if (Byte == 0 || Byte >= 0xf0)
+      return false;
+    Out += static_cast<char>(Byte);
+  }
+  return true;
+}
+
+bool newDecode(const StringRef &Str, std::string &Out) {
+  if (!ModifiedUtf8::isValid(Str.Data, Str.Size))
+    return false;
+  Out.assign(reinterpret_cast<const char*>(Str.Data), Str.Size);
+  return true;
+}
+
+template<class F>
+double measure(const std::vector<StringRef> &Strings, int Reps, F Decode) {
+  std::string Buf;
+  std::size_t Valid = 0;
+
+  const auto Start = std::chrono::steady_clock::now();
+  for (int Rep = 0; Rep < Reps; ++Rep)
+    for (const auto &Str: Strings)
+      Valid += Decode(Str, Buf);
+  const std::chrono::duration<double> Elapsed =
+      std::chrono::steady_clock::now() - Start;
+
+  if (Valid != Strings.size() * static_cast<std::size_t>(Reps))
+    std::cerr << "Some strings were rejected\n";
+  return Elapsed.count();
+}
+
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <class files...>\n";
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<MappedFile>> Files;
+  std::vector<StringRef> Strings;
+  std::size_t TotalBytes = 0;
+  for (int Idx = 1; Idx < argc; ++Idx) {
+    try {
+      Files.push_back(std::make_unique<MappedFile>(argv[Idx]));
+      collectStrings(*Files.back(), Strings);
+    } catch (ReadError &) {
+      std::cerr << "Skipping " << argv[Idx] << "\n";
+    }
+  }
+  for (const auto &Str: Strings)
+    TotalBytes += Str.Size;
+  if (TotalBytes == 0)
+    return 1;
+
+  // Aim for roughly 100MB of processed strings
+  const int Reps = static_cast<int>(100'000'000 / TotalBytes) + 1;
+
+  const double Legacy = measure(Strings, Reps, legacyDecode);
+  const double New = measure(Strings, Reps, newDecode);
+
+  const double MBytes = static_cast<double>(TotalBytes) * Reps / 1e6;
+  std::cout << Strings.size() << " strings, " << TotalBytes << " bytes\n"
+            << "legacy: " << MBytes / Legacy << " MB/s\n"
+            << "new:    " << MBytes / New << " MB/s\n";
+  return 0;
+}
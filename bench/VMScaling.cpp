@@ -0,0 +1,57 @@
+///
+/// Measures how well independent VM instances scale with the number of
+/// threads. Each thread creates it's own VM, all of them share parsed classes.
+/// Should be run from the assets directory.
+///
+
+#include "Runtime/VM.h"
+#include "Runtime/SharedClassCache.h"
+#include "JavaTypes/JavaClass.h"
+#include "SlowInterpreter/SlowInterpreter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Runtime;
+
+static void runOne(std::shared_ptr<SharedClassCache> Cache, int NumIters) {
+  VM Instance(std::move(Cache));
+  auto &CM = Instance.getClassManager();
+
+  const auto &Class =
+      CM.getClass("tests/Runtime/threads", Instance.getTestLoader());
+  SlowInterpreter::interpret(
+      *Class.getMethod("run"), {Value::create<JavaInt>(NumIters)}, CM);
+}
+
+int main(int argc, char **argv) {
+  const int NumIters = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  const unsigned MaxThreads =
+      std::max(1u, std::thread::hardware_concurrency());
+
+  auto Cache = std::make_shared<SharedClassCache>();
+
+  for (unsigned NumThreads = 1; NumThreads <= MaxThreads; ++NumThreads) {
+    const auto Start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> Threads;
+    for (unsigned i = 0; i < NumThreads; ++i)
+      Threads.emplace_back(runOne, Cache, NumIters);
+    for (auto &T: Threads)
+      T.join();
+
+    const std::chrono::duration<double> Elapsed =
+        std::chrono::steady_clock::now() - Start;
+    const double Throughput = NumThreads * NumIters / Elapsed.count();
+
+    std::cout << NumThreads << " VMs: " << Elapsed.count() << "s, "
+              << static_cast<long long>(Throughput) << " calls/s\n";
+  }
+
+  return 0;
+}
@@ -5,56 +5,209 @@
 #include "Bytecode.h"
 #include "Instructions.h"
 
+#include <array>
+
+#if defined(__x86_64__)
+  #include <immintrin.h>
+  #define ICP_HAS_SSSE3_PATH 1
+#else
+  #define ICP_HAS_SSSE3_PATH 0
+#endif
+
 using namespace Bytecode;
 
-std::unique_ptr<Instruction> Bytecode::parseInstruction(
+// Lengths of all instructions indexed by opcode. Zero for unknown opcodes.
+static constexpr auto LengthTable = [] {
+  std::array<uint8_t, 256> Res{};
+  for (unsigned Op = 0; Op < Res.size(); ++Op)
+    Res[Op] = OpcodeTable[Op].Length;
+  return Res;
+}();
+
+Instruction Bytecode::parseInstruction(
   const Container &Bytecodes, ContainerIterator &It) {
 
   // There should be at least one byte so that we can read OpCode
-  // Rest of the checks will happen inside 'create' function.
   if (It == Bytecodes.end())
     throw BytecodeParsingError();
 
-#define PARSE_OP(OpType) \
-    case OpType::OpCode: \
-      return Instruction::create<OpType>(Bytecodes, It);
+  const auto &Info = getOpcodeInfo(*It);
+  if (!Info.isValid())
+    throw UnknownBytecode(std::to_string(*It));
+  if (std::distance(It, Bytecodes.end()) < Info.Length)
+    throw BytecodeParsingError();
 
-  switch (*It) {
-#define HANDLE_INSTR_ALL(ClassName) PARSE_OP(ClassName)
-#include "Instructions.inc"
+  auto Res = Instruction::decode(Info, &*It);
+  It += Info.Length;
+  return Res;
+}
 
-    default:
-      throw UnknownBytecode(std::to_string(*It));
+// Validates single instruction at 'Idx' and returns it's length.
+static uint8_t scanOne(
+    const uint8_t *Data, std::size_t Size, std::size_t Idx) {
+  const uint8_t Length = LengthTable[Data[Idx]];
+  if (Length == 0)
+    throw UnknownBytecode(std::to_string(Data[Idx]));
+  if (Size - Idx < Length)
+    throw BytecodeParsingError();
+  return Length;
+}
+
+static std::size_t scanScalar(
+    const uint8_t *Data, std::size_t Size,
+    std::size_t Idx, std::size_t &Count) {
+  for (; Idx < Size; ++Count)
+    Idx += scanOne(Data, Size, Idx);
+  return Idx;
+}
+
+#if ICP_HAS_SSSE3_PATH
+
+// Set of the one byte opcodes as a 256 bit bitmap
+static constexpr auto OneByteSet = [] {
+  std::array<uint8_t, 32> Res{};
+  for (unsigned Op = 0; Op < 256; ++Op) {
+    if (LengthTable[Op] == 1)
+      Res[Op >> 3] |= static_cast<uint8_t>(1 << (Op & 7));
+  }
+  return Res;
+}();
+
+// Most of the code consists of the runs of one byte instructions. This looks
+// up each of the 16 bytes in the 'OneByteSet' bitmap with two shuffles and
+// skips over such runs without touching the length table. Bytes which are
+// actually operands get their bit as well but they are never looked at.
+__attribute__((target("ssse3")))
+static std::size_t scanSsse3(
+    const uint8_t *Data, std::size_t Size, std::size_t &Count) {
+  const __m128i SetLo = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(OneByteSet.data()));
+  const __m128i SetHi = _mm_loadu_si128(
+      reinterpret_cast<const __m128i*>(OneByteSet.data() + 16));
+  const __m128i BitOf = _mm_setr_epi8(
+      1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+
+  std::size_t Idx = 0;
+  while (Size - Idx >= 16) {
+    const __m128i Chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + Idx));
+
+    // Byte of the bitmap is 'Op >> 3', it's bit is 'Op & 7'
+    const __m128i SetIdx =
+        _mm_and_si128(_mm_srli_epi16(Chunk, 3), _mm_set1_epi8(0x1f));
+    const __m128i InHi = _mm_cmpgt_epi8(SetIdx, _mm_set1_epi8(0x0f));
+    const __m128i SetByte = _mm_or_si128(
+        _mm_andnot_si128(InHi, _mm_shuffle_epi8(SetLo, SetIdx)),
+        _mm_and_si128(InHi, _mm_shuffle_epi8(SetHi, SetIdx)));
+    const __m128i Bit =
+        _mm_shuffle_epi8(BitOf, _mm_and_si128(Chunk, _mm_set1_epi8(7)));
+    const auto OneByte = static_cast<uint32_t>(_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_and_si128(SetByte, Bit), Bit)));
+
+    // Walk this window. Instruction may end past it, next window starts
+    // right after such instruction.
+    std::size_t Pos = 0;
+    while (Pos < 16) {
+      const auto Run = static_cast<std::size_t>(
+          __builtin_ctz(~(OneByte >> Pos)));
+      Count += Run;
+      Pos += Run;
+      if (Pos >= 16)
+        break;
+
+      ++Count;
+      Pos += scanOne(Data, Size, Idx + Pos);
+    }
+
+    Idx += Pos;
   }
 
-#undef PARSE_OP
+  return Idx;
 }
 
-std::vector<std::unique_ptr<Instruction>> Bytecode::parseInstructions(
+#endif
+
+// First decoding pass. Checks that all instructions are known and fit into
+// the container.
+// \returns Number of instructions.
+static std::size_t countInstructions(const uint8_t *Data, std::size_t Size) {
+  std::size_t Count = 0, Idx = 0;
+
+#if ICP_HAS_SSSE3_PATH
+  // Decide once, cpu doesn't change while we are running
+  static const bool HasSsse3 = __builtin_cpu_supports("ssse3");
+  if (HasSsse3)
+    Idx = scanSsse3(Data, Size, Count);
+#endif
+
+  Idx = scanScalar(Data, Size, Idx, Count);
+  assert(Idx == Size);
+  return Count;
+}
+
+std::vector<Instruction> Bytecode::parseInstructions(
     const Container &Bytecodes) {
 
-  std::vector<std::unique_ptr<Instruction>> Ret;
+  const uint8_t *Data = Bytecodes.data();
+  const std::size_t Size = Bytecodes.size();
+
+  std::vector<Instruction> Ret;
+  Ret.reserve(countInstructions(Data, Size));
+
+  // Everything is validated, second pass doesn't need any checks. Operands
+  // are extracted without branching on the instruction length while there
+  // are at least three bytes left.
+  std::size_t Idx = 0;
+  while (Size - Idx >= 3) {
+    const uint8_t Length = LengthTable[Data[Idx]];
+    const uint32_t Wide =
+        (static_cast<uint32_t>(Data[Idx + 1]) << 8) | Data[Idx + 2];
+    Ret.push_back(Instruction(
+        Data[Idx], static_cast<uint16_t>(Wide >> (8 * (3 - Length)))));
+    Idx += Length;
+  }
 
-  auto It = Bytecodes.begin();
-  while (It != Bytecodes.end()) {
-    Ret.push_back(parseInstruction(Bytecodes, It));
+  while (Idx < Size) {
+    const auto &Info = getOpcodeInfo(Data[Idx]);
+    Ret.push_back(Instruction::decode(Info, Data + Idx));
+    Idx += Info.Length;
   }
 
+  assert(Ret.size() == Ret.capacity());
   return Ret;
 }
 
-std::unique_ptr<Instruction> Bytecode::parseFromString(
+Instruction Bytecode::parseFromString(
     std::string_view OpCodeStr, IdxType Idx /*= 0*/) {
 
-#define PARSE_OP(OpType) \
-  if (OpCodeStr == OpType::Name) \
-    return Instruction::create<OpType>(Idx);
+  const auto Op = lookupOpcode(OpCodeStr);
+
+  // Unable to find correct instruction for string
+  if (!Op)
+    throw UnknownBytecode(std::string(OpCodeStr));
+
+  return Instruction(
+      *Op, Instruction::encodeOperand(getOpcodeInfo(*Op).Length, Idx));
+}
 
-#define HANDLE_INSTR_ALL(ClassName) PARSE_OP(ClassName)
+void Instruction::accept(InstructionVisitor &V) const {
+  switch (getOpCode()) {
+#define HANDLE_INSTR_ALL(ClassName, ...) \
+  case ClassName::OpCode: V.visit(ClassName(*this)); return;
 #include "Instructions.inc"
 
-#undef PARSE_OP
+  default:
+    assert(false); // instructions are only created for the known opcodes
+  }
+}
 
-  // Unable to find correct instruction for string
-  throw UnknownBytecode(OpCodeStr.data());
+void Instruction::print(std::ostream &Out) const {
+  switch (getOpCode()) {
+#define HANDLE_INSTR_ALL(ClassName, ...) \
+  case ClassName::OpCode: ClassName(*this).print(Out); return;
+#include "Instructions.inc"
+
+  default:
+    assert(false); // instructions are only created for the known opcodes
+  }
 }
@@ -10,8 +10,12 @@
 #include <memory>
 #include <cassert>
 #include <vector>
+#include <optional>
+#include <string_view>
+#include <type_traits>
 
 #include "Bytecode/BytecodeFwd.h"
+#include "Bytecode/Opcodes.h"
 #include "Bytecode/InstructionVisitor.h"
 
 namespace Bytecode {
@@ -23,12 +27,17 @@ class UnknownBytecode: public std::runtime_error {
   using runtime_error::runtime_error;
 };
 
-// Represents single bytecode instruction. Supposed to be created from the
-// byte array using 'Instruction::create' or 'parseInstruction' functions.
+// Represents single bytecode instruction. This is a small value type which
+// only stores the opcode and the raw operand bits. Typed instruction classes
+// (see Instructions.h) are views of the same data with the convenient
+// accessors, they are obtained using 'getAs' and friends. Static properties
+// of the instruction are stored in the OpcodeTable.
+// Supposed to be created from the byte array using 'Instruction::create' or
+// 'parseInstruction' functions.
 class Instruction {
 public:
   // These constants are used in 'create' function and are expected to be
-  // found in each subclass.
+  // found in each typed instruction.
 
   // Instruction bytecode
   static constexpr uint8_t OpCode = 0x00;
@@ -41,45 +50,57 @@ public:
   static constexpr const char *Name = "";
 
 public:
-  virtual ~Instruction() = default;
+  // Support visitor pattern. Dispatches on the opcode.
+  void accept(InstructionVisitor &V) const;
 
-  // No copies
-  Instruction(const Instruction&) = delete;
-  Instruction &operator=(const Instruction &) = delete;
+  uint8_t getOpCode() const { return Op; }
 
-  // Support visitor pattern
-  virtual void accept(InstructionVisitor &V) const = 0;
+  // Static properties of this instruction.
+  const OpcodeInfo &getInfo() const { return getOpcodeInfo(Op); }
 
   // Return true if this instruction has type 'RetType'
   template<class RetType>
   bool isA() const {
-    return dynamic_cast<const RetType*>(this) != nullptr;
+    return Op == RetType::OpCode;
   }
 
   // Cast instruction to the type 'RetType' or throw an exception.
   // \throws UnexpectedBytecodeOperation If this instruction is of the wrong type.
   template<class RetType>
-  const RetType &getAs() const {
-    const auto *Res = dynamic_cast<const RetType*>(this);
-    if (Res == nullptr)
+  RetType getAs() const {
+    if (!isA<RetType>())
       throw UnexpectedBytecodeOperation();
-    return *Res;
+    return RetType(*this);
   }
 
-  // Cast instruction to the type 'RetType' or return null if it is impossible.
+  // Cast instruction to the type 'RetType' or return nothing if it is
+  // impossible.
   template<class RetType>
-  const RetType *getAsOrNull() const {
-    return dynamic_cast<const RetType*>(this);
+  std::optional<RetType> getAsOrNull() const {
+    if (!isA<RetType>())
+      return std::nullopt;
+    return RetType(*this);
   }
 
-  // Get length of this inistruction. So far this is the only common field for
-  // the all instructions.
-  virtual uint8_t getLength() const = 0;
+  // Get length of this instruction in bytes.
+  uint8_t getLength() const { return getInfo().Length; }
+
+  // Appends bytes of this instruction exactly as they are encoded in the
+  // class file. Inverse of the 'parseInstruction'.
+  void encode(Container &Out) const {
+    Out.push_back(Op);
+    if (getLength() == 2) {
+      Out.push_back(static_cast<uint8_t>(Operand));
+    } else if (getLength() == 3) {
+      Out.push_back(static_cast<uint8_t>(Operand >> 8));
+      Out.push_back(static_cast<uint8_t>(Operand & 0xff));
+    }
+  }
 
   // Print information about this instruction.
   // This is intended as a debug output and should not be relied on for
   // correctness.
-  virtual void print(std::ostream &Out) const = 0;
+  void print(std::ostream &Out) const;
 
   // Creates instruction and advances the iterator.
   // \param It Iterator pointing to the beginning of the instruction
@@ -87,45 +108,69 @@ public:
   // \throws BytecodeParsingError if length of the container was less than
   // instruction length.
   template<class InstructionType>
-  static std::unique_ptr<Instruction> create(
-      const Container &Bytecodes, ContainerIterator &It);
+  static Instruction create(const Container &Bytecodes, ContainerIterator &It);
 
   // Directly create an instruction. Arg1 is unused for single index
   // instructions.
   template<class InstructionType>
-  static std::unique_ptr<Instruction> create(IdxType Arg1 = 0);
+  static Instruction create(IdxType Arg1 = 0) {
+    return Instruction(
+        InstructionType::OpCode,
+        encodeOperand(InstructionType::Length, Arg1));
+  }
 
 protected:
-  Instruction() = default;
-};
+  // Operand bits exactly as they are encoded in the bytecode, i.e two byte
+  // operands are big endian and 'iinc' keeps local index in the high byte.
+  uint16_t getRawOperand() const { return Operand; }
 
-// This class is used as a base in CRTP to simplify visitor implementation
-template<class ConcreteType>
-class VisitableInstruction: public Instruction {
-public:
-  // Support instruction visitor
-  void accept(InstructionVisitor &V) const override {
-    V.visit(static_cast<const ConcreteType&>(*this));
+private:
+  Instruction(uint8_t Op, uint16_t Operand): Op(Op), Operand(Operand) {
+    ;
   }
 
-  // Also implement getLength. It might not be a perfect place for this
-  // but adding another inheritance level seems to be redundant.
-  uint8_t getLength() const override { return ConcreteType::Length; }
+  // Decodes instruction with the given opcode. Expects all bytes of the
+  // instruction to be available.
+  static Instruction decode(const OpcodeInfo &Info, const uint8_t *Bytes) {
+    if (Info.Length == 1)
+      return Instruction(Bytes[0], 0);
+    if (Info.Length == 2)
+      return Instruction(Bytes[0], Bytes[1]);
+    assert(Info.Length == 3);
+    return Instruction(
+        Bytes[0], static_cast<uint16_t>((Bytes[1] << 8) | Bytes[2]));
+  }
 
-protected:
-  VisitableInstruction() = default;
+  static uint16_t encodeOperand(uint8_t Length, IdxType Arg) {
+    if (Length == 1)
+      return 0;
+    if (Length == 2)
+      return Arg & 0x00FF;
+    assert(Length == 3); // Unhandled instruction length
+    return Arg;
+  }
+
+  friend Instruction parseInstruction(const Container &, ContainerIterator &);
+  friend std::vector<Instruction> parseInstructions(const Container &);
+  friend Instruction parseFromString(std::string_view, IdxType);
+
+private:
+  uint8_t Op;
+  uint16_t Operand;
 };
 
+static_assert(std::is_trivially_copyable_v<Instruction>);
+static_assert(sizeof(Instruction) == 4);
+
 template<class InstructionType>
-std::unique_ptr<Instruction>
+Instruction
 Instruction::create(const Container &Bytecodes, ContainerIterator &It) {
   // Check that we can parse this instruction
   if (std::distance(It, Bytecodes.end()) < InstructionType::Length)
     throw BytecodeParsingError();
   assert(*It == InstructionType::OpCode);
 
-  // Create instruction
-  auto Res = std::unique_ptr<InstructionType>(new InstructionType(It));
+  auto Res = decode(getOpcodeInfo(InstructionType::OpCode), &*It);
 
   // Advance iterator
   It += InstructionType::Length;
@@ -133,47 +178,27 @@ Instruction::create(const Container &Bytecodes, ContainerIterator &It) {
   return Res;
 }
 
-template<class InstructionType>
-std::unique_ptr<Instruction> Instruction::create(IdxType Arg1/* = 0*/) {
-  Container Bytecode;
-
-  if constexpr (InstructionType::Length == 1) {
-    Bytecode = {InstructionType::OpCode};
-  } else if constexpr (InstructionType::Length == 2) {
-    Bytecode = {Instruction::OpCode, static_cast<uint8_t>(Arg1 & 0x00FF)};
-  } else if constexpr (InstructionType::Length == 3) {
-    Bytecode = {InstructionType::OpCode,
-                static_cast<uint8_t>((Arg1 & 0xFF00) >> 8),
-                static_cast<uint8_t>(Arg1 & 0x00FF)};
-  } else {
-    assert(false); // Unhandled instruction length
-  }
-
-  return
-      std::unique_ptr<InstructionType>(new InstructionType(Bytecode.cbegin()));
-}
-
-// Parses all instructions from the specified container.
+// Parses all instructions from the specified container. First pass finds
+// instruction boundaries and validates the whole method, second pass decodes
+// into the exactly sized vector.
 // \throws UndefinedBytecode if opcode was not recognized.
 // \throws BytecodeParsingError if length of the container was less than
 // instruction length.
-std::vector<std::unique_ptr<Instruction>> parseInstructions(
-    const Container &Bytecodes);
+std::vector<Instruction> parseInstructions(const Container &Bytecodes);
 
 // Creates instruction and advances the iterator.
 // \returns New instruction.
 // \throws UndefinedBytecode if opcode was not recognized.
 // \throws BytecodeParsingError if length of the container was less than
 // instruction length.
-std::unique_ptr<Instruction> parseInstruction(
-    const Container &Bytecodes, ContainerIterator &It);
+Instruction parseInstruction(const Container &Bytecodes, ContainerIterator &It);
 
 // Parses single instruction from it's string representation.
-// Receives string which names the opcode and it's indexes.
+// Receives string which names the opcode and it's indexes. Opcode is found
+// using perfect hash over the instruction mnemonics.
 // \returns New bytecode
 // \throws UndefinedBytecode if opcode was not recognized.
-std::unique_ptr<Instruction> parseFromString(
-    std::string_view OpCodeStr, IdxType Idx = 0);
+Instruction parseFromString(std::string_view OpCodeStr, IdxType Idx = 0);
 
 }
 
@@ -24,10 +24,10 @@ class BciMap;
 
 class Instruction;
 
-template<class T> class NoIndex;
-template<class T, class U> class SingleIndex;
+template<class T, uint8_t Op> class NoIndex;
+template<class T, uint8_t Op, class U> class SingleIndex;
 
-#define HANDLE_INSTR_ALL(ClassName) class ClassName;
+#define HANDLE_INSTR_ALL(ClassName, ...) class ClassName;
 #define HANDLE_WRAPPER(ClassName) class ClassName;
 #include "Instructions.inc"
 
@@ -9,73 +9,76 @@
 
 namespace Bytecode {
 
+// Common base for all typed instructions. Typed instruction is a view of the
+// plain instruction with the accessors specific to the opcode. It has exactly
+// the same layout and is cheap to copy.
+template<class ConcreteType, uint8_t OpCodeVal>
+class TypedInstruction: public Instruction {
+public:
+  static constexpr uint8_t OpCode = OpCodeVal;
+  static constexpr uint8_t Length = getOpcodeInfo(OpCodeVal).Length;
+  static constexpr const char *Name = getOpcodeInfo(OpCodeVal).Name;
+  static_assert(Length != 0, "opcode is missing from the Instructions.inc");
+
+protected:
+  explicit TypedInstruction(const Instruction &Inst): Instruction(Inst) {
+    assert(Inst.getOpCode() == OpCodeVal);
+  }
+};
+
 // Utility class for instruction consisting of a single byte.
-template<class ConcreteType>
-class NoIndex : public VisitableInstruction<ConcreteType> {
+template<class ConcreteType, uint8_t OpCodeVal>
+class NoIndex : public TypedInstruction<ConcreteType, OpCodeVal> {
 public:
-  static constexpr uint8_t Length = 1;
+  static_assert(getOpcodeInfo(OpCodeVal).Length == 1);
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << ConcreteType::Name << "\n";
   }
 
 private:
-  // Adhere to the common interface used in the create functions.
-  explicit NoIndex(ContainerIterator It) {
-    (void) It;
+  explicit NoIndex(const Instruction &Inst):
+      TypedInstruction<ConcreteType, OpCodeVal>(Inst) {
+    ;
   }
 
-  // Allow calling constructor from the create functions.
+  // Allow calling constructor from the Instruction::getAs functions.
   friend class Instruction;
 };
 
-// Utility class for three byte instructions. First byte is opcode,
-// second two represent constant pool index.
-template<class ConcreteType, class T = IdxType>
-class SingleIndex : public VisitableInstruction<ConcreteType> {
+// Utility class for instructions with a single operand. Operand type decides
+// whether it is one byte index, wide index or signed offset.
+template<class ConcreteType, uint8_t OpCodeVal, class T = IdxType>
+class SingleIndex : public TypedInstruction<ConcreteType, OpCodeVal> {
 public:
-  static constexpr uint8_t Length = 1 + sizeof(T);
-  static_assert(Length == 2 || Length == 3);
+  static_assert(getOpcodeInfo(OpCodeVal).Length == 1 + sizeof(T));
 
 public:
   T getIdx() const {
-    return Idx;
+    return static_cast<T>(this->getRawOperand());
   }
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << ConcreteType::Name << " #" << getIdx() << "\n";
   }
 
 private:
-  static T parseIdx(ContainerIterator It) {
-    if (Length == 2) {
-      return *(It + 1);
-    } else if (Length == 3) {
-      return (*(It + 1) << 8) | *(It + 2);
-    } else {
-      assert(false); // unhandled length
-    }
-  }
-
-  explicit SingleIndex(ContainerIterator It) :
-      Idx(parseIdx(It)) {
-    ; // Empty
+  explicit SingleIndex(const Instruction &Inst):
+      TypedInstruction<ConcreteType, OpCodeVal>(Inst) {
+    ;
   }
 
-  // Allow calling constructor from the Instruction::create functions
+  // Allow calling constructor from the Instruction::getAs functions
   friend class Instruction;
-
-private:
-  const T Idx;
 };
 
 // Same as SingleIndex but has signed index type.
-template<class ConcreteType>
-using OffsetIndex = SingleIndex<ConcreteType, BciOffsetType>;
+template<class ConcreteType, uint8_t OpCodeVal>
+using OffsetIndex = SingleIndex<ConcreteType, OpCodeVal, BciOffsetType>;
 
 // Same as SingleIndex but has one byte index instead.
-template<class ConcreteType>
-using ByteIndex = SingleIndex<ConcreteType, ByteIdxType>;
+template<class ConcreteType, uint8_t OpCodeVal>
+using ByteIndex = SingleIndex<ConcreteType, OpCodeVal, ByteIdxType>;
 
 
 // Determine index type of the given instruction. We can have different index
@@ -146,7 +149,7 @@ public:
   constexpr const Instruction &getInst() const { return Inst; }
 
 protected:
-  const Instruction &Inst;
+  const Instruction Inst;
   const ThisValType Val = 0;
 };
 
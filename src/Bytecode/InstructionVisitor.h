@@ -15,7 +15,7 @@ public:
     assert(false && "unimplemented"); \
   }
 
-#define HANDLE_INSTR(ClassName) DEF_VISIT(ClassName)
+#define HANDLE_INSTR(ClassName, ...) DEF_VISIT(ClassName)
 #define HANDLE_WRAPPER(ClassName) DEF_VISIT(ClassName)
 #include "Instructions.inc"
 
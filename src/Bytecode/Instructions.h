@@ -9,39 +9,36 @@
 
 namespace Bytecode {
 
-class invokespecial final: public SingleIndex<invokespecial> {
+class invokespecial final:
+    public SingleIndex<invokespecial, OpCodes::invokespecial> {
   using SingleIndex::SingleIndex;
+};
 
-public:
-  static constexpr uint8_t OpCode = 0xb7;
-  static constexpr const char *Name = "invokespecial";
+class invokestatic final:
+    public SingleIndex<invokestatic, OpCodes::invokestatic> {
+  using SingleIndex::SingleIndex;
 };
 
-class java_return final: public NoIndex<java_return> {
+class java_return final: public NoIndex<java_return, OpCodes::java_return> {
   using NoIndex::NoIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0xb1;
-  static constexpr const char *Name = "return";
 };
 
-#define DEF_ICONST(Num, Value, OpCodeVal) \
-class iconst_##Num final: public NoIndex<iconst_##Num> { \
+#define DEF_ICONST(Num, Value) \
+class iconst_##Num final: \
+    public NoIndex<iconst_##Num, OpCodes::iconst_##Num> { \
   using NoIndex::NoIndex; \
 \
 public:\
-  static constexpr uint8_t OpCode = OpCodeVal;\
-  static constexpr const char *Name = "iconst_"#Num;\
   static constexpr int8_t Val = Value;\
 }
 
-DEF_ICONST(m1, -1, 0x02);
-DEF_ICONST(0, 0, 0x03);
-DEF_ICONST(1, 1, 0x04);
-DEF_ICONST(2, 2, 0x05);
-DEF_ICONST(3, 3, 0x06);
-DEF_ICONST(4, 4, 0x07);
-DEF_ICONST(5, 5, 0x08);
+DEF_ICONST(m1, -1);
+DEF_ICONST(0, 0);
+DEF_ICONST(1, 1);
+DEF_ICONST(2, 2);
+DEF_ICONST(3, 3);
+DEF_ICONST(4, 4);
+DEF_ICONST(5, 5);
 
 #undef DEF_ICONST
 
@@ -52,21 +49,17 @@ class iconst_val final:
   using ValueInstWrapper::ValueInstWrapper;
 };
 
-class dconst_0 final: public NoIndex<dconst_0> {
+class dconst_0 final: public NoIndex<dconst_0, OpCodes::dconst_0> {
   using NoIndex::NoIndex;
 
 public:
-  static constexpr uint8_t OpCode = 0x0e;
-  static constexpr const char *Name = "dconst_0";
   static constexpr const uint8_t Val = 0;
 };
 
-class dconst_1 final: public NoIndex<dconst_1> {
+class dconst_1 final: public NoIndex<dconst_1, OpCodes::dconst_1> {
   using NoIndex::NoIndex;
 
 public:
-  static constexpr uint8_t OpCode = 0x0f;
-  static constexpr const char *Name = "dconst_1";
   static constexpr const uint8_t Val = 1;
 };
 
@@ -74,36 +67,28 @@ class dconst_val final: public ValueInstWrapper<dconst_0, dconst_1> {
   using ValueInstWrapper::ValueInstWrapper;
 };
 
-class ireturn final: public NoIndex<ireturn> {
+class ireturn final: public NoIndex<ireturn, OpCodes::ireturn> {
   using NoIndex::NoIndex;
+};
 
-public:
-  static constexpr uint8_t OpCode = 0xac;
-  static constexpr const char *Name = "ireturn";
+class lreturn final: public NoIndex<lreturn, OpCodes::lreturn> {
+  using NoIndex::NoIndex;
 };
 
-class dreturn final: public NoIndex<dreturn> {
+class freturn final: public NoIndex<freturn, OpCodes::freturn> {
   using NoIndex::NoIndex;
+};
 
-public:
-  static constexpr uint8_t OpCode = 0xaf;
-  static constexpr const char *Name = "dreturn";
+class dreturn final: public NoIndex<dreturn, OpCodes::dreturn> {
+  using NoIndex::NoIndex;
 };
 
-class getstatic final: public SingleIndex<getstatic> {
+class getstatic final: public SingleIndex<getstatic, OpCodes::getstatic> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0xb2;
-  static constexpr const char *Name = "getstatic";
 };
 
-class putstatic final: public SingleIndex<putstatic> {
+class putstatic final: public SingleIndex<putstatic, OpCodes::putstatic> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0xb3;
-  static constexpr const char *Name = "putstatic";
 };
 
 ///
@@ -118,22 +103,21 @@ enum ComparisonOp: uint8_t {
   COMP_LE
 };
 
-#define IF_ICMP(Suffix, OpCodeNum, OpCodeName) \
-class if_icmp##Suffix: public OffsetIndex<if_icmp##Suffix> { \
+#define IF_ICMP(Suffix, OpCodeName) \
+class if_icmp##Suffix: \
+    public OffsetIndex<if_icmp##Suffix, OpCodes::if_icmp##Suffix> { \
   using SingleIndex::SingleIndex; \
 \
 public:\
-  static constexpr uint8_t OpCode = OpCodeNum;\
-  static constexpr const char *Name = "if_icmp"#Suffix;\
   static constexpr uint8_t Val = OpCodeName;\
 }
 
-IF_ICMP(eq, 0x9f, COMP_EQ);
-IF_ICMP(ne, 0xa0, COMP_NE);
-IF_ICMP(lt, 0xa1, COMP_LT);
-IF_ICMP(ge, 0xa2, COMP_GE);
-IF_ICMP(gt, 0xa3, COMP_GT);
-IF_ICMP(le, 0xa4, COMP_LE);
+IF_ICMP(eq, COMP_EQ);
+IF_ICMP(ne, COMP_NE);
+IF_ICMP(lt, COMP_LT);
+IF_ICMP(ge, COMP_GE);
+IF_ICMP(gt, COMP_GT);
+IF_ICMP(le, COMP_LE);
 
 #undef IF_ICMP
 
@@ -144,60 +128,46 @@ class if_icmp_op:
   using ValueIdxWrapper::ValueIdxWrapper;
 };
 
-class java_goto final: public OffsetIndex<java_goto> {
+class java_goto final: public OffsetIndex<java_goto, OpCodes::java_goto> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0xa7;
-  static constexpr const char *Name = "goto";
 };
 
 ///
 /// Locals load/store
 ///
 
-#define DEF_ILOAD(Value, OpCodeVal) \
-class iload_##Value final: public NoIndex<iload_##Value> { \
+#define DEF_ILOAD(Value) \
+class iload_##Value final: \
+    public NoIndex<iload_##Value, OpCodes::iload_##Value> { \
   using NoIndex::NoIndex; \
 \
 public:\
-  static constexpr uint8_t OpCode = OpCodeVal;\
-  static constexpr const char *Name = "iload_"#Value;\
   static constexpr ByteIdxType Val = Value;\
 }
 
-#define DEF_ISTORE(Value, OpCodeVal) \
-class istore_##Value final: public NoIndex<istore_##Value> { \
+#define DEF_ISTORE(Value) \
+class istore_##Value final: \
+    public NoIndex<istore_##Value, OpCodes::istore_##Value> { \
   using NoIndex::NoIndex; \
 \
 public:\
-  static constexpr uint8_t OpCode = OpCodeVal;\
-  static constexpr const char *Name = "istore_"#Value;\
   static constexpr ByteIdxType Val = Value;\
 }
 
-DEF_ILOAD(0, 0x1a); DEF_ISTORE(0, 0x3b);
-DEF_ILOAD(1, 0x1b); DEF_ISTORE(1, 0x3c);
-DEF_ILOAD(2, 0x1c); DEF_ISTORE(2, 0x3d);
-DEF_ILOAD(3, 0x1d); DEF_ISTORE(3, 0x3e);
+DEF_ILOAD(0); DEF_ISTORE(0);
+DEF_ILOAD(1); DEF_ISTORE(1);
+DEF_ILOAD(2); DEF_ISTORE(2);
+DEF_ILOAD(3); DEF_ISTORE(3);
 
 #undef DEF_ILOAD
 #undef DEF_ISTORE
 
-class iload: public ByteIndex<iload> {
+class iload: public ByteIndex<iload, OpCodes::iload> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0x15;
-  static constexpr const char *Name = "iload";
 };
 
-class istore: public ByteIndex<istore> {
+class istore: public ByteIndex<istore, OpCodes::istore> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0x36;
-  static constexpr const char *Name = "istore";
 };
 
 class iload_val final:
@@ -214,66 +184,44 @@ public:
   istore_val(const istore &Inst): ValueInstWrapper(from_idx, Inst) {}
 };
 
-class iinc final: public VisitableInstruction<iinc> {
-public:
-  static constexpr uint8_t Length = 3;
-  static constexpr uint8_t OpCode = 0x84;
-  static constexpr const char *Name = "iinc";
-
+class iinc final: public TypedInstruction<iinc, OpCodes::iinc> {
 public:
-  uint8_t getIdx() const { return Idx; }
-  int8_t getConst() const { return Const; }
+  // Local index is encoded in the first operand byte, constant in the second.
+  uint8_t getIdx() const {
+    return static_cast<uint8_t>(getRawOperand() >> 8);
+  }
+  int8_t getConst() const {
+    return static_cast<int8_t>(getRawOperand() & 0x00FF);
+  }
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << iinc::Name << " #" << std::to_string(getIdx()) <<  " #" <<
         std::to_string(getConst()) << "\n";
   }
 
 private:
-  explicit iinc(ContainerIterator It):
-      Idx(*(It + 1)),
-      Const(*(It + 2)) {
+  explicit iinc(const Instruction &Inst): TypedInstruction(Inst) {
     ;
   }
 
-  // Allow calling constructor from the Instruction::create functions
+  // Allow calling constructor from the Instruction::getAs functions
   friend class Instruction;
-
-private:
-  const uint8_t Idx;
-  const int8_t Const;
 };
 
-class iadd final: public NoIndex<iadd> {
+class iadd final: public NoIndex<iadd, OpCodes::iadd> {
   using NoIndex::NoIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0x60;
-  static constexpr const char *Name = "iadd";
 };
 
-class java_new final: public SingleIndex<java_new> {
+class java_new final: public SingleIndex<java_new, OpCodes::java_new> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0xbb;
-  static constexpr const char *Name = "new";
 };
 
-class getfield final: public SingleIndex<getfield> {
+class getfield final: public SingleIndex<getfield, OpCodes::getfield> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0xb4;
-  static constexpr const char *Name = "getfield";
 };
 
-class putfield final: public SingleIndex<putfield> {
+class putfield final: public SingleIndex<putfield, OpCodes::putfield> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0xb5;
-  static constexpr const char *Name = "putfield";
 };
 
 ///
@@ -281,48 +229,38 @@ public:
 ///
 /// TODO: aload has single-byte index
 
-#define DEF_aload(Value, OpCodeVal) \
-class aload_##Value final: public NoIndex<aload_##Value> { \
+#define DEF_aload(Value) \
+class aload_##Value final: \
+    public NoIndex<aload_##Value, OpCodes::aload_##Value> { \
   using NoIndex::NoIndex; \
 \
 public:\
-  static constexpr uint8_t OpCode = OpCodeVal;\
-  static constexpr const char *Name = "aload_"#Value;\
   static constexpr ByteIdxType Val = Value;\
 }
 
-#define DEF_astore(Value, OpCodeVal) \
-class astore_##Value final: public NoIndex<astore_##Value> { \
+#define DEF_astore(Value) \
+class astore_##Value final: \
+    public NoIndex<astore_##Value, OpCodes::astore_##Value> { \
   using NoIndex::NoIndex; \
 \
 public:\
-  static constexpr uint8_t OpCode = OpCodeVal;\
-  static constexpr const char *Name = "astore_"#Value;\
   static constexpr ByteIdxType Val = Value;\
 }
 
-DEF_aload(0, 0x2a); DEF_astore(0, 0x4b);
-DEF_aload(1, 0x2b); DEF_astore(1, 0x4c);
-DEF_aload(2, 0x2c); DEF_astore(2, 0x4d);
-DEF_aload(3, 0x2d); DEF_astore(3, 0x4e);
+DEF_aload(0); DEF_astore(0);
+DEF_aload(1); DEF_astore(1);
+DEF_aload(2); DEF_astore(2);
+DEF_aload(3); DEF_astore(3);
 
 #undef DEF_aload
 #undef DEF_astore
 
-class aload final: public ByteIndex<aload> {
+class aload final: public ByteIndex<aload, OpCodes::aload> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0x19;
-  static constexpr const char *Name = "aload";
 };
 
-class astore final: public ByteIndex<astore> {
+class astore final: public ByteIndex<astore, OpCodes::astore> {
   using SingleIndex::SingleIndex;
-
-public:
-  static constexpr uint8_t OpCode = 0x3a;
-  static constexpr const char *Name = "astore";
 };
 
 class aload_val final:
@@ -339,22 +277,45 @@ public:
   astore_val(const astore &Inst): ValueInstWrapper(from_idx, Inst) {}
 };
 
-class dup final: public NoIndex<dup> {
+class dup final: public NoIndex<dup, OpCodes::dup> {
   using NoIndex::NoIndex;
+};
 
-public:
-  static constexpr uint8_t OpCode = 0x59;
-  static constexpr const char *Name = "dup";
+class bipush final: public ByteIndex<bipush, OpCodes::bipush> {
+  using SingleIndex::SingleIndex;
 };
 
-class bipush final: public ByteIndex<bipush> {
+///
+/// Constant loading
+///
+
+// Loads int or float constant from the constant pool.
+class ldc final: public ByteIndex<ldc, OpCodes::ldc> {
   using SingleIndex::SingleIndex;
+};
 
-public:
-  static constexpr uint8_t OpCode = 0x10;
-  static constexpr const char *Name = "bipush";
+// Same as 'ldc' but with wide index. Also used as a replacement for the
+// getstatic of the int and float constant fields.
+class ldc_w final: public SingleIndex<ldc_w, OpCodes::ldc_w> {
+  using SingleIndex::SingleIndex;
+};
+
+// Loads long or double constant from the constant pool.
+class ldc2_w final: public SingleIndex<ldc2_w, OpCodes::ldc2_w> {
+  using SingleIndex::SingleIndex;
+};
+
+///
+/// Synchronization
+///
+
+class monitorenter final: public NoIndex<monitorenter, OpCodes::monitorenter> {
+  using NoIndex::NoIndex;
 };
 
+class monitorexit final: public NoIndex<monitorexit, OpCodes::monitorexit> {
+  using NoIndex::NoIndex;
+};
 
 }
 
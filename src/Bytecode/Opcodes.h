@@ -0,0 +1,177 @@
+///
+/// Static per-opcode metadata. All tables are generated from the
+/// Instructions.inc at compile time and are indexed by the opcode byte.
+///
+
+#ifndef ICP_OPCODES_H
+#define ICP_OPCODES_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace Bytecode {
+
+// How instruction operand is encoded in the bytecode.
+enum class OperandKind: uint8_t {
+  None,         // no operand
+  CPIndex,      // two byte constant pool index
+  ByteCPIndex,  // one byte constant pool index
+  Local,        // one byte local variable index
+  Byte,         // one byte immediate value
+  BranchOffset, // two byte signed offset from the current bci
+  LocalAndConst // one byte local variable index and one byte signed constant
+};
+
+enum OpcodeFlags: uint8_t {
+  FLAG_NONE = 0,
+  FLAG_BRANCH = 1 << 0,      // transfers control to the offset target
+  FLAG_CONDITIONAL = 1 << 1, // may fall through to the next instruction
+  FLAG_RETURN = 1 << 2,      // leaves the method
+
+  FLAG_COND_BRANCH = FLAG_BRANCH | FLAG_CONDITIONAL
+};
+
+// Stack effect which can only be computed using the constant pool.
+inline constexpr int8_t VarStack = -1;
+
+struct OpcodeInfo {
+  // Mnemonic used in the CD files and debug output
+  const char *Name = nullptr;
+  // Number of bytes including the opcode. Zero for unknown opcodes.
+  uint8_t Length = 0;
+  OperandKind Operand = OperandKind::None;
+  // Stack slots consumed and produced, or VarStack
+  int8_t Pops = 0;
+  int8_t Pushes = 0;
+  uint8_t Flags = FLAG_NONE;
+
+  constexpr bool isValid() const { return Length != 0; }
+  constexpr bool isBranch() const { return Flags & FLAG_BRANCH; }
+  constexpr bool isConditional() const { return Flags & FLAG_CONDITIONAL; }
+  constexpr bool isReturn() const { return Flags & FLAG_RETURN; }
+  // True if execution can't continue to the next instruction
+  constexpr bool endsBlock() const {
+    return isReturn() || (isBranch() && !isConditional());
+  }
+};
+
+// Opcode values by the instruction class name, i.e 'OpCodes::java_goto'.
+namespace OpCodes {
+enum: uint8_t {
+#define HANDLE_INSTR_ALL(ClassName, Mnemonic, OpCode, ...) ClassName = OpCode,
+#include "Instructions.inc"
+};
+}
+
+namespace _detail {
+
+constexpr uint8_t operandLength(OperandKind Kind) {
+  switch (Kind) {
+  case OperandKind::None:
+    return 0;
+  case OperandKind::ByteCPIndex:
+  case OperandKind::Local:
+  case OperandKind::Byte:
+    return 1;
+  case OperandKind::CPIndex:
+  case OperandKind::BranchOffset:
+  case OperandKind::LocalAndConst:
+    return 2;
+  }
+  return 0;
+}
+
+constexpr std::array<OpcodeInfo, 256> buildOpcodeTable() {
+  std::array<OpcodeInfo, 256> Res{};
+
+#define HANDLE_INSTR_ALL(ClassName, Mnemonic, OpCode, Kind, Pops, Pushes, Fl) \
+  Res[OpCode] = OpcodeInfo{                                                   \
+      Mnemonic,                                                               \
+      static_cast<uint8_t>(1 + operandLength(OperandKind::Kind)),             \
+      OperandKind::Kind, Pops, Pushes, static_cast<uint8_t>(Fl)};
+#include "Instructions.inc"
+
+  return Res;
+}
+
+}
+
+inline constexpr std::array<OpcodeInfo, 256> OpcodeTable =
+    _detail::buildOpcodeTable();
+
+constexpr const OpcodeInfo &getOpcodeInfo(uint8_t OpCode) {
+  return OpcodeTable[OpCode];
+}
+
+namespace _detail {
+
+// Mnemonics are mapped to opcodes using perfect hash. Seeded FNV-1a is
+// evaluated with increasing seeds at compile time until it places every
+// mnemonic into a separate slot.
+constexpr std::size_t MnemonicTableSize = 512;
+
+constexpr uint32_t hashMnemonic(std::string_view Str, uint32_t Seed) {
+  uint32_t Hash = 2166136261u ^ Seed;
+  for (char C: Str) {
+    Hash ^= static_cast<uint8_t>(C);
+    Hash *= 16777619u;
+  }
+  return (Hash ^ (Hash >> 15)) % MnemonicTableSize;
+}
+
+constexpr uint32_t findMnemonicSeed() {
+  for (uint32_t Seed = 0; Seed < 4096; ++Seed) {
+    bool Used[MnemonicTableSize] = {};
+    bool Collision = false;
+
+    for (unsigned Op = 0; Op < OpcodeTable.size() && !Collision; ++Op) {
+      if (!OpcodeTable[Op].isValid())
+        continue;
+      const auto Slot = hashMnemonic(OpcodeTable[Op].Name, Seed);
+      Collision = Used[Slot];
+      Used[Slot] = true;
+    }
+
+    if (!Collision)
+      return Seed;
+  }
+  return UINT32_MAX;
+}
+
+inline constexpr uint32_t MnemonicSeed = findMnemonicSeed();
+static_assert(MnemonicSeed != UINT32_MAX, "no perfect hash for mnemonics");
+
+// Unused slots point to the opcode zero which is never a valid instruction.
+constexpr std::array<uint8_t, MnemonicTableSize> buildMnemonicTable() {
+  static_assert(!OpcodeTable[0].isValid());
+
+  std::array<uint8_t, MnemonicTableSize> Res{};
+  for (unsigned Op = 0; Op < OpcodeTable.size(); ++Op) {
+    if (OpcodeTable[Op].isValid())
+      Res[hashMnemonic(OpcodeTable[Op].Name, MnemonicSeed)] =
+          static_cast<uint8_t>(Op);
+  }
+  return Res;
+}
+
+inline constexpr std::array<uint8_t, MnemonicTableSize> MnemonicTable =
+    buildMnemonicTable();
+
+}
+
+// Finds opcode by it's mnemonic.
+// \returns Opcode or nullopt if there is no such instruction.
+constexpr std::optional<uint8_t> lookupOpcode(std::string_view Mnemonic) {
+  const uint8_t Op = _detail::MnemonicTable[
+      _detail::hashMnemonic(Mnemonic, _detail::MnemonicSeed)];
+  const auto &Info = getOpcodeInfo(Op);
+  if (!Info.isValid() || Mnemonic != Info.Name)
+    return std::nullopt;
+  return Op;
+}
+
+}
+
+#endif //ICP_OPCODES_H
@@ -1,178 +1,224 @@
 ///
-/// Implementation of the CD lexer.
+/// Implementation of the CD lexer. Whole input is split into tokens in a
+/// single pass over the characters, tokens refer into the input.
 ///
 
 #include "Lexer.h"
 
-#include <regex>
-#include <iostream>
+#include <array>
+#include <cstdint>
 
 using namespace CD;
-using namespace std::string_literals;
-
-const Token Token::LBrace{L_BRACE};
-const Token Token::RBrace{R_BRACE};
-const Token Token::LSBrace{L_SBRACE};
-const Token Token::RSBrace{R_SBRACE};
-const Token Token::Comma{COMMA};
-const Token Token::Colon{COLON};
-const Token Token::Sharp{SHARP};
-const Token Token::Dog{DOG};
-
-Token Token::String() {
-  static Token Ret(STRING);
-  return Ret;
-}
-Token Token::String(std::string Data) {
-  return Token(STRING, std::move(Data));
-}
 
-Token Token::Keyword() {
-  static Token Ret(KEYWORD);
-  return Ret;
-}
-Token Token::Keyword(std::string Data) {
-  return Token(KEYWORD, std::move(Data));
+namespace {
+
+enum CharKind: uint8_t {
+  INVALID = 0,
+  BLANK,
+  WORD,      // [a-zA-Z0-9_]
+  DIGIT,     // [0-9], also a word character
+  QUOTE,
+  SLASH,
+  NEW_LINE,
+  CARRIAGE_RETURN,
+  PUNCT      // single character tokens
+};
+
+constexpr std::array<uint8_t, 256> CharKinds = [] {
+  std::array<uint8_t, 256> Res{};
+  for (int C = 'a'; C <= 'z'; ++C)
+    Res[C] = WORD;
+  for (int C = 'A'; C <= 'Z'; ++C)
+    Res[C] = WORD;
+  for (int C = '0'; C <= '9'; ++C)
+    Res[C] = DIGIT;
+  Res['_'] = WORD;
+
+  Res[' '] = BLANK;
+  Res['\t'] = BLANK;
+  Res['"'] = QUOTE;
+  Res['/'] = SLASH;
+  Res['\n'] = NEW_LINE;
+  Res['\r'] = CARRIAGE_RETURN;
+
+  for (char C: std::string_view("{}[],:#@="))
+    Res[static_cast<uint8_t>(C)] = PUNCT;
+  return Res;
+}();
+
+constexpr CharKind kindOf(char C) {
+  return static_cast<CharKind>(CharKinds[static_cast<uint8_t>(C)]);
 }
 
-Token Token::Num() {
-  static Token Ret(NUM);
-  return Ret;
-}
-Token Token::Num(std::string Data) {
-  return Token(NUM, std::move(Data));
+constexpr bool isWordChar(char C) {
+  const auto Kind = kindOf(C);
+  return Kind == WORD || Kind == DIGIT;
 }
 
-Token Token::Id() {
-  static Token Ret(ID);
-  return Ret;
-}
-Token Token::Id(std::string Data) {
-  return Token(ID, std::move(Data));
+// Characters allowed inside of the string literals
+constexpr std::array<bool, 256> StringChars = [] {
+  std::array<bool, 256> Res{};
+  for (int C = 0; C < 256; ++C)
+    Res[C] = CharKinds[C] == WORD || CharKinds[C] == DIGIT;
+  for (char C: std::string_view("<>/()[];.+-"))
+    Res[static_cast<uint8_t>(C)] = true;
+  return Res;
+}();
+
+constexpr bool isStringChar(char C) {
+  return StringChars[static_cast<uint8_t>(C)];
 }
 
-// Trims spaces and comments from the beginning of the string. Stops at the next
-// character after the first new line. Hand rolled solution is much faster than
-// the regexp based one.
-static std::string trimSpacesAndComments(const std::string &Input) {
-  std::size_t new_start = 0;
-  bool in_comment = false;
-
-  while (new_start < Input.size()) {
-    // Check new line
-    if (Input.substr(new_start, 2) == "\r\n") {
-      new_start += 2;
-      break;
-    }
-    if (Input[new_start] == '\n' || Input[new_start] == '\r') {
-      ++new_start;
-      break;
-    }
+// Keywords are recognized using perfect hash over their first and last
+// characters and length. Seed is found at compile time same as for the
+// instruction mnemonics.
+constexpr std::string_view Keywords[] = {
+    "class", "constant_pool", "method", "bytecode", "auto", "fields",
+    "stackmap"};
 
-    // Skip comments
-    if (in_comment) {
-      ++new_start;
-      continue;
-    }
-    if (Input.substr(new_start, 2) == "//") {
-      in_comment = true;
-      new_start += 2;
-      continue;
-    }
+constexpr std::size_t KeywordTableSize = 16;
 
-    // Skip whitespaces
-    if (std::isblank(Input[new_start])) {
-      ++new_start;
-      continue;
-    }
-
-    // Nothing to skip
-    break;
-  }
-  return Input.substr(new_start, std::string::npos);
+constexpr uint32_t hashKeyword(std::string_view Word, uint32_t Seed) {
+  const auto First = static_cast<uint8_t>(Word.front());
+  const auto Last = static_cast<uint8_t>(Word.back());
+  return (First * Seed + Last * 7 + static_cast<uint32_t>(Word.size())) %
+         KeywordTableSize;
 }
 
-Lexer::Lexer(std::string &&Input) {
-  // Merge all patterns into single regular expression in the form of
-  // "^(token1)|(token2)|..."
-  std::string PatternStr = "^";
-  for (int TokT = Token::FIRST; TokT != Token::LAST; ++TokT) {
-    PatternStr += "("s +
-        Token::getPattern(static_cast<Token::Type>(TokT)) + ")|";
-  }
-  PatternStr.pop_back();
-
-  std::regex Pattern(PatternStr);
-
-  // Match tokens until the end of string.
-  // TODO: This whole process creates fresh std::string each time it needs a
-  // substring. Although this doesn't show as a performance problem but
-  // allocation rate be improved using string_view or similar instrument.
-  std::size_t cur_line = 1;
-  while (!Input.empty()) {
-    std::smatch Matches;
-
-    // Skip spaces while counting new lines
-    auto old_len = Input.length();
-    Input = trimSpacesAndComments(Input);
-    if (old_len != Input.length()) {
-      cur_line++;
-      continue;
-    }
+constexpr uint32_t findKeywordSeed() {
+  for (uint32_t Seed = 1; Seed < 4096; ++Seed) {
+    bool Used[KeywordTableSize] = {};
+    bool Collision = false;
 
-    // Parse token
-    std::regex_search(Input, Matches, Pattern,
-        std::regex_constants::match_continuous);
-    if (Matches.empty())
-      break; // no token found
-    // Should have single sub-match for each token type
-    assert(Matches.size() == Token::LAST + 1);
-
-    // Create and record the new token
-    bool FoundToken = false;
-    for (int TokT = Token::FIRST; TokT != Token::LAST; ++TokT) {
-      // Plus one because zero sub match represents the whole match
-      if (Matches[TokT + 1].matched) {
-        Tokens.push_back(Token::create(
-            static_cast<Token::Type>(TokT), Matches[TokT + 1].str()));
-        FoundToken = true;
-        break;
-      }
+    for (const auto &Kw: Keywords) {
+      const auto Slot = hashKeyword(Kw, Seed);
+      Collision |= Used[Slot];
+      Used[Slot] = true;
     }
-    assert(FoundToken); // Should be able to find token
 
-    // Consume this token
-    Input = Matches.suffix().str();
+    if (!Collision)
+      return Seed;
   }
+  return UINT32_MAX;
+}
 
-  if (!Input.empty())
-    throw LexerError(
-        "Unable to lex the whole string: " + std::to_string(cur_line));
+constexpr uint32_t KeywordSeed = findKeywordSeed();
+static_assert(KeywordSeed != UINT32_MAX, "no perfect hash for keywords");
+
+constexpr std::array<std::string_view, KeywordTableSize> KeywordTable = [] {
+  std::array<std::string_view, KeywordTableSize> Res{};
+  for (const auto &Kw: Keywords)
+    Res[hashKeyword(Kw, KeywordSeed)] = Kw;
+  return Res;
+}();
 
-  // Reverse the list to simplify common operations
-  std::reverse(Tokens.begin(), Tokens.end());
-  NumTokens = Tokens.size();
+bool isKeyword(std::string_view Word) {
+  return KeywordTable[hashKeyword(Word, KeywordSeed)] == Word;
 }
 
-bool Lexer::hasNext() const {
-  return NumTokens >= 1;
 }
 
-const Token &Lexer::consume() {
-  assert(hasNext());
-  --NumTokens;
-  return tokens()[numTokens()];
+Lexer::Lexer(std::string_view Input) {
+  lex(Input);
 }
 
-bool Lexer::isNext(const Token &Tok) const {
-  if (!hasNext())
-    return false;
-  return tokens()[numTokens() - 1] == Tok;
+Lexer::Lexer(std::string &&Input):
+    OwnedInput(std::move(Input)) {
+  lex(OwnedInput);
 }
 
-const Token *Lexer::consume(const Token &Tok) {
-  if (!hasNext() || !isNext(Tok))
-    return nullptr;
+void Lexer::lex(std::string_view Input) {
+  // Rough estimate, avoids most of the reallocations
+  Tokens.reserve(Input.size() / 4);
+
+  const char *Cur = Input.data();
+  const char *const End = Cur + Input.size();
+  std::size_t CurLine = 1;
+
+  auto Fail = [&]() {
+    throw LexerError(
+        "Unable to lex the whole string: " + std::to_string(CurLine));
+  };
 
-  return &consume();
+  while (Cur != End) {
+    switch (kindOf(*Cur)) {
+    case BLANK:
+      ++Cur;
+      break;
+
+    case NEW_LINE:
+      ++CurLine;
+      ++Cur;
+      break;
+
+    case CARRIAGE_RETURN:
+      ++CurLine;
+      ++Cur;
+      if (Cur != End && *Cur == '\n')
+        ++Cur;
+      break;
+
+    case SLASH:
+      // Only comments start with the slash, skip until the end of line
+      if (End - Cur < 2 || Cur[1] != '/')
+        Fail();
+      while (Cur != End && *Cur != '\n' && *Cur != '\r')
+        ++Cur;
+      break;
+
+    case PUNCT: {
+      switch (*Cur) {
+      case '{': Tokens.push_back(Token::LBrace); break;
+      case '}': Tokens.push_back(Token::RBrace); break;
+      case '[': Tokens.push_back(Token::LSBrace); break;
+      case ']': Tokens.push_back(Token::RSBrace); break;
+      case ',': Tokens.push_back(Token::Comma); break;
+      case ':': Tokens.push_back(Token::Colon); break;
+      case '#': Tokens.push_back(Token::Sharp); break;
+      case '@': Tokens.push_back(Token::Dog); break;
+      case '=': Tokens.push_back(Token::Eq); break;
+      default: assert(false); // all punctuation should be handled
+      }
+      ++Cur;
+      break;
+    }
+
+    case QUOTE: {
+      // Quotes are not part of the token. Empty strings are not allowed.
+      const char *Begin = ++Cur;
+      while (Cur != End && isStringChar(*Cur))
+        ++Cur;
+      if (Cur == End || *Cur != '"' || Cur == Begin)
+        Fail();
+
+      Tokens.push_back(Token::String(
+          std::string_view(Begin, static_cast<std::size_t>(Cur - Begin))));
+      ++Cur;
+      break;
+    }
+
+    case WORD:
+    case DIGIT: {
+      const char *Begin = Cur;
+      bool AllDigits = true;
+      while (Cur != End && isWordChar(*Cur)) {
+        AllDigits &= kindOf(*Cur) == DIGIT;
+        ++Cur;
+      }
+
+      const std::string_view Word(
+          Begin, static_cast<std::size_t>(Cur - Begin));
+      if (isKeyword(Word))
+        Tokens.push_back(Token::Keyword(Word));
+      else if (AllDigits)
+        Tokens.push_back(Token::Num(Word));
+      else
+        Tokens.push_back(Token::Id(Word));
+      break;
+    }
+
+    case INVALID:
+      Fail();
+    }
+  }
 }
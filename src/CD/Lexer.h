@@ -7,11 +7,17 @@
 
 #include <optional>
 #include <cassert>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 #include <ostream>
 
 namespace CD {
 
+// Tokens don't own their data, it points either into the lexer input or into
+// the string literals. Tokens are cheap to create and compare, so all of the
+// factory functions below are constexpr.
 class Token final {
 public:
   static const Token LBrace;
@@ -22,28 +28,37 @@ public:
   static const Token Colon;
   static const Token Sharp;
   static const Token Dog;
+  static const Token Eq;
 
   // Token which matches all strings independent from their 'Data'.
   // Same for similar functions defined below.
-  static Token String();
-  static Token String(std::string Data);
+  static constexpr Token String() { return Token(STRING); }
+  static constexpr Token String(std::string_view Data) {
+    return Token(STRING, Data);
+  }
 
-  static Token Keyword();
-  static Token Keyword(std::string Data);
+  static constexpr Token Keyword() { return Token(KEYWORD); }
+  static constexpr Token Keyword(std::string_view Data) {
+    return Token(KEYWORD, Data);
+  }
 
-  static Token Num();
-  static Token Num(std::string Data);
+  static constexpr Token Num() { return Token(NUM); }
+  static constexpr Token Num(std::string_view Data) {
+    return Token(NUM, Data);
+  }
 
-  static Token Id();
-  static Token Id(std::string Data);
+  static constexpr Token Id() { return Token(ID); }
+  static constexpr Token Id(std::string_view Data) {
+    return Token(ID, Data);
+  }
 
 public:
-  bool operator==(const Token &Rhs) const noexcept {
+  constexpr bool operator==(const Token &Rhs) const noexcept {
     if (T != Rhs.T)
       return false;
 
     // Wildcard matching
-    if (!Data || !Rhs.Data)
+    if (Data.empty() || Rhs.Data.empty())
       return true;
 
     return Data == Rhs.Data;
@@ -57,21 +72,21 @@ public:
   friend std::string to_string(const Token &Tok) {
     std::string Res = std::to_string(Tok.T) + " (";
 
-    if (Tok.Data)
-      Res += *Tok.Data;
+    if (!Tok.Data.empty())
+      Res += Tok.Data;
     else
       Res += "none";
     Res += ")";
     return Res;
   }
 
-  bool operator!=(const Token &Rhs) const noexcept {
+  constexpr bool operator!=(const Token &Rhs) const noexcept {
     return !(*this == Rhs);
   }
 
-  const std::string &getData() const {
-    assert(Data);
-    return *Data;
+  std::string_view getData() const {
+    assert(!Data.empty());
+    return Data;
   }
 
   void swap(Token &Other) {
@@ -90,84 +105,45 @@ private:
     COLON,
     SHARP,
     DOG,
+    EQ,
     STRING,
     KEYWORD,
     NUM,
-    ID,
-
-    FIRST = L_BRACE,
-    LAST = ID + 1
+    ID
   };
 
-  static constexpr const char *getPattern(Type T) {
-    switch (T) {
-      case L_BRACE: return "\\{";
-      case R_BRACE: return "\\}";
-      case L_SBRACE: return "\\[";
-      case R_SBRACE: return "\\]";
-      case COMMA: return ",";
-      case COLON: return ":";
-      case SHARP: return "#";
-      case DOG: return "@";
-      case STRING: return "\"[a-zA-Z0-9_<>/()\\[\\];]+\"";
-      case KEYWORD: return "class|constant_pool|method|bytecode|auto|fields|stackmap";
-      case NUM: return "\\d+\\b";
-      case ID: return "[a-zA-Z0-9_]+\\b";
-
-      default: assert(false);
-    }
-
-    return "error";
-  }
-
-  // This is intended to be used only from the Lexer constructor
-  static Token create(Type T, const std::string &Data) {
-    switch (T) {
-      case L_BRACE: return LBrace;
-      case R_BRACE: return RBrace;
-      case L_SBRACE: return LSBrace;
-      case R_SBRACE: return RSBrace;
-      case COMMA: return Comma;
-      case COLON: return Colon;
-      case SHARP: return Sharp;
-      case DOG: return Dog;
-      case STRING:
-        // Cut quotes from the match
-        return String(Data.substr(1, Data.length() - 2));
-      case KEYWORD: return Keyword(Data);
-      case NUM: return Num(Data);
-      case ID: return Id(Data);
-      case LAST: assert(false);
-    }
-
-    assert(false);
-    return Token(LAST);
-  }
-
 private:
   explicit constexpr Token(Type T) noexcept:
       T(T) {
     ;
   }
 
-  Token(Type T, std::string Data) noexcept:
-      T(T) {
-
-    // Treat empty string as an absence of data
-    if (!Data.empty())
-      this->Data = std::move(Data);
+  // Empty string is treated as an absence of data
+  constexpr Token(Type T, std::string_view Data) noexcept:
+      T(T), Data(Data) {
+    ;
   }
 
 private:
   Type T;
-  std::optional<std::string> Data;
+  std::string_view Data;
 
   friend class Lexer;
 };
 
-// Lexer returns references to tokens and owns them. This means that user
-// should ensure that lifetime of the Lexer is greater than the lifetime of it's
-// tokens.
+inline constexpr Token Token::LBrace{Token::L_BRACE};
+inline constexpr Token Token::RBrace{Token::R_BRACE};
+inline constexpr Token Token::LSBrace{Token::L_SBRACE};
+inline constexpr Token Token::RSBrace{Token::R_SBRACE};
+inline constexpr Token Token::Comma{Token::COMMA};
+inline constexpr Token Token::Colon{Token::COLON};
+inline constexpr Token Token::Sharp{Token::SHARP};
+inline constexpr Token Token::Dog{Token::DOG};
+inline constexpr Token Token::Eq{Token::EQ};
+
+// Lexer returns references to tokens and owns them. Tokens point into the
+// input, so user should ensure that lifetime of the Lexer and of it's input
+// is greater than the lifetime of the tokens.
 class Lexer final {
 public:
   class LexerError: public std::runtime_error {
@@ -175,36 +151,57 @@ public:
   };
 
 public:
-  // \throws LexerError if unable to lex the output
-  // \throws std::regex_error If token patterns are invalid
+  // Lexes the buffer without copying it, i.e mapped file. Buffer should
+  // outlive the lexer.
+  // \throws LexerError if unable to lex the input
+  explicit Lexer(std::string_view Input);
+  explicit Lexer(const char *Input):
+      Lexer(std::string_view(Input)) {
+    ;
+  }
+
+  // Same as above but the lexer takes ownership of the input.
   explicit Lexer(std::string &&Input);
 
   Lexer(const Lexer &) = delete;
   Lexer &operator=(const Lexer &) = delete;
 
   // Return true if there are any tokens left in the stream.
-  bool hasNext() const;
+  bool hasNext() const {
+    return Pos < Tokens.size();
+  }
 
   // Checks if next token in the stream matches 'Tok'.
   // Doesn't extract it.
-  bool isNext(const Token &Tok) const;
+  bool isNext(const Token &Tok) const {
+    return hasNext() && Tokens[Pos] == Tok;
+  }
 
   // Extracts next token from the stream.
-  const Token &consume();
+  const Token &consume() {
+    assert(hasNext());
+    return Tokens[Pos++];
+  }
 
   // If next token is equal to Tok - extracts it and returns.
   // Otherwise return null.
-  const Token *consume(const Token &Tok);
+  const Token *consume(const Token &Tok) {
+    if (!isNext(Tok))
+      return nullptr;
+    return &consume();
+  }
 
 private:
-  const auto &tokens() const { return Tokens; }
-  auto &tokens() { return Tokens; }
-
-  auto numTokens() const { return NumTokens; }
+  // Splits whole input into tokens.
+  // \throws LexerError
+  void lex(std::string_view Input);
 
 private:
+  // Input if it's owned by the lexer
+  const std::string OwnedInput;
+
   std::vector<Token> Tokens;
-  std::size_t NumTokens = 0;
+  std::size_t Pos = 0;
 };
 
 }
@@ -13,11 +13,14 @@
 #include "JavaTypes/ConstantPoolRecords.h"
 #include "JavaTypes/JavaField.h"
 #include "Utils/BinaryFiles.h"
+#include "Utils/Symbol.h"
 
+#include <charconv>
 #include <fstream>
 #include <sstream>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <variant>
 
 using namespace std::string_view_literals;
@@ -26,6 +29,24 @@ using namespace std::string_literals;
 using namespace CD;
 using namespace JavaTypes;
 
+// Tokens with the fixed data which parser looks for
+namespace {
+constexpr Token KwClass = Token::Keyword("class");
+constexpr Token KwConstantPool = Token::Keyword("constant_pool");
+constexpr Token KwMethod = Token::Keyword("method");
+constexpr Token KwBytecode = Token::Keyword("bytecode");
+constexpr Token KwAuto = Token::Keyword("auto");
+constexpr Token KwFields = Token::Keyword("fields");
+constexpr Token KwStackMap = Token::Keyword("stackmap");
+
+constexpr Token IdSame = Token::Id("same");
+constexpr Token IdFlags = Token::Id("Flags");
+constexpr Token IdMaxStack = Token::Id("MaxStack");
+constexpr Token IdMaxLocals = Token::Id("MaxLocals");
+constexpr Token IdName = Token::Id("Name");
+constexpr Token IdSuper = Token::Id("Super");
+}
+
 // Helper function to avoid repeating patters:
 //  if (!Lex.consume(Tok)) throw ...
 static const Token &consumeOrThrow(const Token &Tok, Lexer &Lex) {
@@ -36,6 +57,17 @@ static const Token &consumeOrThrow(const Token &Tok, Lexer &Lex) {
   return *Res;
 }
 
+// Helper function. Converts data of the numeric token.
+// \throws ParserError If number doesn't fit into unsigned long.
+static unsigned long parseNumber(const Token &Tok) {
+  const auto Str = Tok.getData();
+  unsigned long Ret = 0;
+  const auto Res = std::from_chars(Str.data(), Str.data() + Str.size(), Ret);
+  if (Res.ec != std::errc() || Res.ptr != Str.data() + Str.size())
+    throw ParserError("Unable to parse number " + std::string(Str));
+  return Ret;
+}
+
 // Helper function. Index can be in a form of either #<number>
 // or #[first_byte second_byte]. Returns nothing on error.
 static std::optional<ConstantPool::IndexType> tryParseCPIndex(Lexer &Lex) {
@@ -51,8 +83,8 @@ static std::optional<ConstantPool::IndexType> tryParseCPIndex(Lexer &Lex) {
     const auto &second_byte_tok = consumeOrThrow(Token::Num(), Lex);
     consumeOrThrow(Token::RSBrace, Lex);
 
-    auto first_byte = std::stoul(first_byte_tok.getData());
-    auto second_byte = std::stoul(second_byte_tok.getData());
+    auto first_byte = parseNumber(first_byte_tok);
+    auto second_byte = parseNumber(second_byte_tok);
 
     if (!Utils::isUint8(first_byte) || !Utils::isUint8(second_byte))
       throw ParserError("Compound indexes should fit into single byte");
@@ -63,7 +95,7 @@ static std::optional<ConstantPool::IndexType> tryParseCPIndex(Lexer &Lex) {
 
   // It's #<number> form
   const auto &res_tok = consumeOrThrow(Token::Num(), Lex);
-  auto res = std::stoul(res_tok.getData());
+  auto res = parseNumber(res_tok);
 
   if (!Utils::isUint16(res))
     throw ParserError("Index must fir into 16 bits");
@@ -79,24 +111,68 @@ static ConstantPool::IndexType parseCPIndex(Lexer &Lex) {
   return *Ret;
 }
 
+// Maps constant pool strings to their records. Built once per class, so that
+// method and field lookups don't scan whole constant pool.
+using CPStrings =
+    std::unordered_map<Utils::Symbol, const ConstantPoolRecords::Utf8*>;
+
+static CPStrings collectCPStrings(const ConstantPool &CP) {
+  CPStrings Ret;
+  for (ConstantPool::IndexType Idx = 1; Idx <= CP.numRecords(); ++Idx) {
+    if (const auto *Rec = CP.getAsOrNull<ConstantPoolRecords::Utf8>(Idx))
+      Ret.emplace(Rec->getValue(), Rec); // first record wins
+  }
+  return Ret;
+}
+
 // Helper function. Looks for the specified string in the constant pool.
-// This is inefficient and should be replaced with the proper symbol table.
 // \returns Pointer to the cp record or null if nothing found.
 static const ConstantPoolRecords::Utf8 *findStringInCP(
-    const std::string &Target, const ConstantPool &CP) {
+    std::string_view Target, const CPStrings &Strings) {
 
-  for (ConstantPool::IndexType Idx = 1; Idx <= CP.numRecords(); ++Idx) {
-    if (const auto *Rec = CP.getAsOrNull<ConstantPoolRecords::Utf8>(Idx)) {
-      if (Rec->getValue() == Target)
-        return Rec;
-    }
-  }
+  // Constant pool strings are interned, so we can compare symbols
+  const auto Sym = Utils::Symbol::lookup(Target);
+  if (Sym.isNull())
+    return nullptr;
 
-  return nullptr;
+  const auto It = Strings.find(Sym);
+  return It == Strings.end() ? nullptr : It->second;
+}
+
+// Helper function. Numeric constant records have single string argument
+// which holds their value, i.e 'Integer "-5"' or 'Double "1.5"'.
+// \throws ParserError if unable to parse the value.
+template<class ValueT, class ArgT>
+static ValueT parseNumericArg(
+    const std::vector<ArgT> &Args, std::string_view RecType) {
+  if (Args.size() != 1 || !std::holds_alternative<std::string_view>(Args[0]))
+    throw ParserError(std::string(RecType) +
+                      " record should have exactly one string argument");
+  const std::string Str(std::get<std::string_view>(Args[0]));
+
+  try {
+    std::size_t Pos = 0;
+    ValueT Ret = 0;
+    if constexpr (std::is_same_v<ValueT, Runtime::JavaInt>)
+      Ret = std::stoi(Str, &Pos);
+    else if constexpr (std::is_same_v<ValueT, Runtime::JavaLong>)
+      Ret = std::stoll(Str, &Pos);
+    else if constexpr (std::is_same_v<ValueT, Runtime::JavaFloat>)
+      Ret = std::stof(Str, &Pos);
+    else if constexpr (std::is_same_v<ValueT, Runtime::JavaDouble>)
+      Ret = std::stod(Str, &Pos);
+
+    if (Pos != Str.size())
+      throw ParserError("Unexpected characters in the numeric constant " + Str);
+    return Ret;
+  } catch (const std::logic_error &) {
+    // Covers both invalid_argument and out_of_range
+    throw ParserError("Unable to parse numeric constant " + Str);
+  }
 }
 
 static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
-  if (!Lex.consume(Token::Keyword("constant_pool")))
+  if (!Lex.consume(KwConstantPool))
     throw ParserError("Expected constant_pool as a first member of the class");
   if (!Lex.consume(Token::LBrace))
     throw ParserError("Expected LBrace");
@@ -108,18 +184,19 @@ static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
   // 3. Create constant pool
 
 
-  // Temporary data structures to store pre-parsed constant pool
+  // Temporary data structures to store pre-parsed constant pool. Strings
+  // point into the lexer input.
   struct Record {
-    std::string Type = "";
+    std::string_view Type = "";
 
     using ArgType =
-      std::variant<ConstantPool::IndexType, std::string>;
+      std::variant<ConstantPool::IndexType, std::string_view>;
     std::vector<ArgType> Args;
   };
   std::map<ConstantPool::IndexType, Record> ParsedRecords;
   ConstantPool::IndexType MaxCPIdx = 0;
   // Collect free standing strings with no indexes assigned
-  std::map<std::string, ConstantPool::IndexType> StringToIdx;
+  std::map<std::string_view, ConstantPool::IndexType> StringToIdx;
 
   // Parse constant pool into the structures defined above
   // Compute maximal pre defined index along the way
@@ -130,7 +207,7 @@ static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
       // Parse "<number>: <id> <args>"
 
       auto Idx = static_cast<ConstantPool::IndexType>(
-          std::stoi(Lex.consume().getData()));
+          parseNumber(Lex.consume()));
       if (Idx <= 0)
         throw ParserError("Constant pool index should be greater than zero");
       if (ParsedRecords.count(Idx) > 0)
@@ -143,13 +220,21 @@ static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
       Record NewRec;
       NewRec.Type = consumeOrThrow(Token::Id(), Lex).getData();
 
+      // Numeric constants hold their values as strings, these strings should
+      // not be placed into the constant pool.
+      const bool IsNumeric =
+          NewRec.Type == "Integer" || NewRec.Type == "Float" ||
+          NewRec.Type == "Long" || NewRec.Type == "Double";
+      const bool IsWide = NewRec.Type == "Long" || NewRec.Type == "Double";
+
       bool hasArgs = true;
       while (hasArgs) {
         if (const auto &ArgIdx = tryParseCPIndex(Lex)) {
           NewRec.Args.emplace_back(*ArgIdx);
         } else if (const auto &Tok = Lex.consume(Token::String())) {
           NewRec.Args.emplace_back(Tok->getData());
-          StringToIdx[Tok->getData()] = 0;
+          if (!IsNumeric)
+            StringToIdx[Tok->getData()] = 0;
         } else {
           hasArgs = false;
         }
@@ -157,11 +242,23 @@ static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
 
       ParsedRecords[Idx] = std::move(NewRec);
 
-    } else if (Lex.consume(Token::Keyword("auto"))) {
+      // Long and double constants take two constant pool entries
+      if (IsWide) {
+        const auto NextIdx = static_cast<ConstantPool::IndexType>(Idx + 1);
+        if (NextIdx == 0 || ParsedRecords.count(NextIdx) > 0)
+          throw ParserError(
+              "Unable to reserve second index for the wide constant " +
+              std::to_string(Idx));
+
+        MaxCPIdx = std::max(MaxCPIdx, NextIdx);
+        ParsedRecords[NextIdx].Type = "Unusable";
+      }
+
+    } else if (Lex.consume(KwAuto)) {
       // Parse "auto: <string>"
 
       consumeOrThrow(Token::Colon, Lex);
-      const auto &Str = consumeOrThrow(Token::String(), Lex).getData();
+      const auto Str = consumeOrThrow(Token::String(), Lex).getData();
       StringToIdx[Str] = 0;
     } else {
       throw ParserError("Expected RBrace at the end of constant pool");
@@ -189,9 +286,9 @@ static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
     if (std::holds_alternative<ConstantPool::IndexType>(Arg))
       return std::get<ConstantPool::IndexType>(Arg);
 
-    assert(std::holds_alternative<std::string>(Arg));
+    assert(std::holds_alternative<std::string_view>(Arg));
 
-    const auto &RetIdx = StringToIdx[std::get<std::string>(Arg)];
+    const auto &RetIdx = StringToIdx[std::get<std::string_view>(Arg)];
     assert(RetIdx != 0); // should have assigned indexes for all strings
     return RetIdx;
   };
@@ -243,8 +340,23 @@ static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
                 GetIdxForArg(Rec.Args[0])),
             Builder.getCellReference<ConstantPoolRecords::NameAndType>(
                 GetIdxForArg(Rec.Args[1])));
+      } else if (Rec.Type == "Integer") {
+        Builder.create<ConstantPoolRecords::Integer>(
+            Idx, parseNumericArg<Runtime::JavaInt>(Rec.Args, Rec.Type));
+      } else if (Rec.Type == "Float") {
+        Builder.create<ConstantPoolRecords::Float>(
+            Idx, parseNumericArg<Runtime::JavaFloat>(Rec.Args, Rec.Type));
+      } else if (Rec.Type == "Long") {
+        Builder.create<ConstantPoolRecords::Long>(
+            Idx, parseNumericArg<Runtime::JavaLong>(Rec.Args, Rec.Type));
+      } else if (Rec.Type == "Double") {
+        Builder.create<ConstantPoolRecords::Double>(
+            Idx, parseNumericArg<Runtime::JavaDouble>(Rec.Args, Rec.Type));
+      } else if (Rec.Type == "Unusable") {
+        Builder.create<ConstantPoolRecords::Unusable>(Idx);
       } else {
-        throw ParserError("Unrecognized record type: " + Rec.Type);
+        throw ParserError(
+            "Unrecognized record type: " + std::string(Rec.Type));
       }
     }
   } catch (const ConstantPoolBuilder::IncompatibleCellType &e) {
@@ -255,7 +367,8 @@ static std::unique_ptr<ConstantPool> parseConstantPool(Lexer &Lex) {
   try {
     for (const auto &[Str, Idx]: StringToIdx) {
       assert(Idx > 0); // all indexes should have been assigned
-      Builder.set(Idx, std::make_unique<ConstantPoolRecords::Utf8>(Str));
+      Builder.create<ConstantPoolRecords::Utf8>(
+          Idx, Utils::Symbol::intern(Str));
     }
   } catch (const ConstantPoolBuilder::IncompatibleCellType &e) {
     // Indexes for string are assigned automatically so no type collision
@@ -273,7 +386,7 @@ static StackMapTableBuilder parseStackMap(
     std::map<std::string_view, Bytecode::BciType> Label2Bci,
     Lexer &Lex) {
 
-  if (!Lex.consume(Token::Keyword("stackmap")))
+  if (!Lex.consume(KwStackMap))
     return {};
   consumeOrThrow(Token::LBrace, Lex);
 
@@ -287,7 +400,7 @@ static StackMapTableBuilder parseStackMap(
     consumeOrThrow(Token::Colon, Lex);
 
     // Current frame is same as previous frame.
-    if (Lex.consume(Token::Id("same"))) {
+    if (Lex.consume(IdSame)) {
       Ret.addSame(bci);
       continue;
     }
@@ -297,7 +410,8 @@ static StackMapTableBuilder parseStackMap(
       std::vector<Type> ret;
       consumeOrThrow(Token::LSBrace, Lex);
       while (const auto *str_type = Lex.consume(Token::String()))
-        ret.push_back(Type::parseFieldDescriptor(str_type->getData()));
+        ret.push_back(
+            Type::parseFieldDescriptor(std::string(str_type->getData())));
       consumeOrThrow(Token::RSBrace, Lex);
       return ret;
     };
@@ -315,17 +429,18 @@ static StackMapTableBuilder parseStackMap(
 static void parseBytecode(
     JavaMethod::MethodConstructorParameters &Params, Lexer &Lex) {
 
-  consumeOrThrow(Token::Keyword("bytecode"), Lex);
+  consumeOrThrow(KwBytecode, Lex);
   consumeOrThrow(Token::LBrace, Lex);
 
   // Since we need to support forward declared labels we will need two passes
   // over the bytecode. First - to gather all instructions and calculate
   // offsets. Second is to actually create bytecode with correct labels.
 
+  // Names point into the lexer input. Empty label means there is no label.
   struct ParsedInst {
-    const char *Name = "";
+    std::string_view Name;
     const ConstantPool::IndexType Idx = 0;
-    const char *Label = nullptr;
+    std::string_view Label;
   };
   std::vector<ParsedInst> Instrs;
   std::map<std::string_view, Bytecode::BciType> Label2Bci;
@@ -340,7 +455,7 @@ static void parseBytecode(
   TryEatLabel();
   while (const auto *NameTok = Lex.consume(Token::Id())) {
     // Name
-    const char *Name = NameTok->getData().c_str();
+    const auto Name = NameTok->getData();
 
     // Index
     // Only single indexed instructions for now.
@@ -350,19 +465,22 @@ static void parseBytecode(
         IdxOpt ? static_cast<Bytecode::IdxType>(*IdxOpt) : 0;
 
     // Label use
-    const char *Label = nullptr;
+    std::string_view Label;
     if (Lex.consume(Token::Dog))
-      Label = consumeOrThrow(Token::Id(), Lex).getData().c_str();
+      Label = consumeOrThrow(Token::Id(), Lex).getData();
 
     Instrs.push_back({Name, Idx, Label});
 
     // Can't have both index and label
-    bool hasIdx = IdxOpt.has_value();
-    bool hasLabel = (Label != nullptr);
-    assert(hasLabel != hasIdx || (!hasLabel && !hasIdx));
+    assert(!(IdxOpt.has_value() && !Label.empty()));
 
-    // Slightly hacky way to compute current bci
-    cur_bci += 1 + ((hasLabel || hasIdx) ? 2 : 0);
+    // Instructions have different lengths, so in order to compute bci we
+    // need to know the actual instruction. Index value doesn't matter here.
+    const auto OpCode = Bytecode::lookupOpcode(Name);
+    if (!OpCode)
+      throw ParserError(
+          "Unable to parse method bytecode for " + std::string(Name));
+    cur_bci += Bytecode::getOpcodeInfo(*OpCode).Length;
 
     // Label definition for the next bytecode
     TryEatLabel();
@@ -377,10 +495,10 @@ static void parseBytecode(
 
   for (const auto &InstInfo: Instrs) {
     Bytecode::IdxType Idx = InstInfo.Idx;
-    if (InstInfo.Label) {
+    if (!InstInfo.Label.empty()) {
       assert(Idx == 0); // can't have both label and idx
       if (Label2Bci.count(InstInfo.Label) == 0)
-        throw ParserError("Undefined label "s + InstInfo.Label);
+        throw ParserError("Undefined label " + std::string(InstInfo.Label));
 
       // Index is an offset from the current bci
       int64_t offset = static_cast<int64_t>(Label2Bci[InstInfo.Label]) - cur_bci;
@@ -397,9 +515,7 @@ static void parseBytecode(
       throw ParserError(
           "Unable to parse method bytecode for " + std::string(InstInfo.Name));
     }
-    assert(Ret.back() != nullptr);
-
-    cur_bci += Ret.back()->getLength();
+    cur_bci += Ret.back().getLength();
   }
 
   Params.Code = std::move(Ret);
@@ -414,52 +530,62 @@ static void parseBytecode(
 
 static std::unique_ptr<JavaMethod> parseMethod(
     Lexer &Lex,
-    const ConstantPool &CP) {
+    const CPStrings &Strings) {
 
   JavaMethod::MethodConstructorParameters Params;
 
-  consumeOrThrow(Token::Keyword("method"), Lex);
+  consumeOrThrow(KwMethod, Lex);
 
   // Parse name and descriptor
-  const std::string &Name = consumeOrThrow(Token::String(), Lex).getData();
-  Params.Name = findStringInCP(Name, CP);
+  const auto Name = consumeOrThrow(Token::String(), Lex).getData();
+  Params.Name = findStringInCP(Name, Strings);
   if (Params.Name == nullptr)
     throw ParserError("Method name was not found in constant pool");
 
-  const std::string &Descr = consumeOrThrow(Token::String(), Lex).getData();
-  Params.Descriptor = findStringInCP(Descr, CP);
+  const auto Descr = consumeOrThrow(Token::String(), Lex).getData();
+  Params.Descriptor = findStringInCP(Descr, Strings);
   if (Params.Descriptor == nullptr)
     throw ParserError("Method descriptor was not found in constant pool");
 
   consumeOrThrow(Token::LBrace, Lex);
 
   // Parse flags
-  consumeOrThrow(Token::Id("Flags"), Lex);
+  consumeOrThrow(IdFlags, Lex);
   consumeOrThrow(Token::Colon, Lex);
 
   Params.Flags = JavaMethod::AccessFlags::ACC_NONE;
   do {
-    const std::string &FlagName = consumeOrThrow(Token::Id(), Lex).getData();
+    const auto FlagName = consumeOrThrow(Token::Id(), Lex).getData();
 
     if (FlagName == "public")
       Params.Flags = Params.Flags | JavaMethod::AccessFlags::ACC_PUBLIC;
     else if (FlagName == "static")
       Params.Flags = Params.Flags | JavaMethod::AccessFlags::ACC_STATIC;
+    else if (FlagName == "native")
+      Params.Flags = Params.Flags | JavaMethod::AccessFlags::ACC_NATIVE;
+    else if (FlagName == "synchronized")
+      Params.Flags = Params.Flags | JavaMethod::AccessFlags::ACC_SYNCHRONIZED;
     else
       throw ParserError("Unrecognized method access flag");
 
   } while (Lex.consume(Token::Comma));
 
+  // Native methods have only flags
+  if (Params.Flags & JavaMethod::AccessFlags::ACC_NATIVE) {
+    consumeOrThrow(Token::RBrace, Lex);
+    return std::make_unique<JavaMethod>(std::move(Params));
+  }
+
   // Parse MaxStack and MaxLocals
-  consumeOrThrow(Token::Id("MaxStack"), Lex);
+  consumeOrThrow(IdMaxStack, Lex);
   consumeOrThrow(Token::Colon, Lex);
   Params.MaxStack = static_cast<uint16_t>(
-      std::stoi(consumeOrThrow(Token::Num(), Lex).getData()));
+      parseNumber(consumeOrThrow(Token::Num(), Lex)));
 
-  consumeOrThrow(Token::Id("MaxLocals"), Lex);
+  consumeOrThrow(IdMaxLocals, Lex);
   consumeOrThrow(Token::Colon, Lex);
   Params.MaxLocals = static_cast<uint16_t>(
-      std::stoi(consumeOrThrow(Token::Num(), Lex).getData()));
+      parseNumber(consumeOrThrow(Token::Num(), Lex)));
 
   // Parse bytecode
   parseBytecode(Params, Lex);
@@ -470,9 +596,9 @@ static std::unique_ptr<JavaMethod> parseMethod(
 }
 
 static std::vector<JavaField> parseClassFields(
-    Lexer &Lex, const ConstantPool &CP) {
+    Lexer &Lex, const ConstantPool &CP, const CPStrings &Strings) {
 
-  consumeOrThrow(Token::Keyword("fields"), Lex);
+  consumeOrThrow(KwFields, Lex);
   consumeOrThrow(Token::LBrace, Lex);
 
   std::vector<JavaField> Ret;
@@ -480,7 +606,7 @@ static std::vector<JavaField> parseClassFields(
   while (!Lex.isNext(Token::RBrace)) {
     JavaField::AccessFlags Flags = JavaField::ACC_NONE;
     do {
-      const std::string &FlagName = consumeOrThrow(Token::Id(), Lex).getData();
+      const auto FlagName = consumeOrThrow(Token::Id(), Lex).getData();
 
       if (FlagName == "public")
         Flags = Flags | JavaField::ACC_PUBLIC;
@@ -494,19 +620,34 @@ static std::vector<JavaField> parseClassFields(
         throw ParserError("Unknown field flag is specified");
     } while (Lex.isNext(Token::Id()));
 
-    const std::string &Descr = consumeOrThrow(Token::String(), Lex).getData();
+    const auto Descr = consumeOrThrow(Token::String(), Lex).getData();
     consumeOrThrow(Token::Colon, Lex);
-    const std::string &Name = consumeOrThrow(Token::String(), Lex).getData();
+    const auto Name = consumeOrThrow(Token::String(), Lex).getData();
 
-    const auto *DescrCI = findStringInCP(Descr, CP);
+    const auto *DescrCI = findStringInCP(Descr, Strings);
     if (!DescrCI)
       throw ParserError("Unable to find field descriptor in the constant pool");
 
-    const auto *NameCI = findStringInCP(Name, CP);
+    const auto *NameCI = findStringInCP(Name, Strings);
     if (!NameCI)
       throw ParserError("Unable to find field name in the constant pool");
 
-    Ret.emplace_back(*DescrCI, *NameCI, Flags);
+    // Optional constant value in the form of '= #<idx>'
+    const ConstantPoolRecords::NumericConstant *ConstantValue = nullptr;
+    if (Lex.consume(Token::Eq)) {
+      ConstantValue = CP.getAsOrNull<ConstantPoolRecords::NumericConstant>(
+          parseCPIndex(Lex));
+      if (!ConstantValue)
+        throw ParserError("Field constant value should be a numeric constant");
+      if (!(Flags & JavaField::ACC_STATIC))
+        throw ParserError("Only static fields can have constant value");
+    }
+
+    try {
+      Ret.emplace_back(*DescrCI, *NameCI, Flags, ConstantValue);
+    } catch (const Type::ParsingError &e) {
+      throw ParserError("Invalid field: "s + e.what());
+    }
   }
 
   consumeOrThrow(Token::RBrace, Lex);
@@ -514,14 +655,14 @@ static std::vector<JavaField> parseClassFields(
 }
 
 static void parseClass(JavaClass::ClassParameters &Params, Lexer &Lex) {
-  consumeOrThrow(Token::Keyword("class"), Lex);
+  consumeOrThrow(KwClass, Lex);
   consumeOrThrow(Token::LBrace, Lex);
 
   // Parse constant pool
   Params.CP = parseConstantPool(Lex);
 
   // Parse class name
-  consumeOrThrow(Token::Id("Name"), Lex);
+  consumeOrThrow(IdName, Lex);
   consumeOrThrow(Token::Colon, Lex);
   const auto &ClassNameIdx = parseCPIndex(Lex);
   if (!Params.CP->isA<ConstantPoolRecords::ClassInfo>(ClassNameIdx))
@@ -530,7 +671,7 @@ static void parseClass(JavaClass::ClassParameters &Params, Lexer &Lex) {
       &Params.CP->getAs<ConstantPoolRecords::ClassInfo>(ClassNameIdx);
 
   // Parse super class name
-  consumeOrThrow(Token::Id("Super"), Lex);
+  consumeOrThrow(IdSuper, Lex);
   consumeOrThrow(Token::Colon, Lex);
   const auto &SuperIdx = parseCPIndex(Lex);
   if (!Params.CP->isA<ConstantPoolRecords::ClassInfo>(SuperIdx))
@@ -542,30 +683,26 @@ static void parseClass(JavaClass::ClassParameters &Params, Lexer &Lex) {
   Params.Flags =
       JavaClass::AccessFlags::ACC_PUBLIC | JavaClass::AccessFlags::ACC_SUPER;
 
+  const auto Strings = collectCPStrings(*Params.CP);
+
   // Parse fields if avaliable
-  if (Lex.isNext(Token::Keyword("fields"))) {
-    Params.Fields = parseClassFields(Lex, *Params.CP);
+  if (Lex.isNext(KwFields)) {
+    Params.Fields = parseClassFields(Lex, *Params.CP, Strings);
   }
 
   // Parse methods
-  while (Lex.isNext(Token::Keyword("method"))) {
-    Params.Methods.push_back(parseMethod(Lex, *Params.CP));
+  while (Lex.isNext(KwMethod)) {
+    Params.Methods.push_back(parseMethod(Lex, Strings));
   }
 
   consumeOrThrow(Token::RBrace, Lex);
 }
 
-std::unique_ptr<JavaTypes::JavaClass> CD::parseFromStream(
-    std::istream &InputStream) {
-
-  // Lex
-  Lexer Lex{std::string(
-      std::istreambuf_iterator<char>(InputStream),
-      std::istreambuf_iterator<char>())};
+// Parses class from the already lexed input.
+static std::unique_ptr<JavaClass> parseFromLexer(Lexer &Lex) {
   if (!Lex.hasNext())
     throw ParserError("Unexpected empty input");
 
-  // Parse
   JavaClass::ClassParameters Params;
 
   parseClass(Params, Lex);
@@ -573,21 +710,34 @@ std::unique_ptr<JavaTypes::JavaClass> CD::parseFromStream(
   return std::make_unique<JavaClass>(std::move(Params));
 }
 
+std::unique_ptr<JavaTypes::JavaClass> CD::parseFromStream(
+    std::istream &InputStream) {
+
+  Lexer Lex{std::string(
+      std::istreambuf_iterator<char>(InputStream),
+      std::istreambuf_iterator<char>())};
+  return parseFromLexer(Lex);
+}
+
 std::unique_ptr<JavaTypes::JavaClass> CD::parseFromFile(
     const std::string &FileName) {
 
-  std::ifstream File(FileName, std::ios_base::in);
-  if (!File)
+  // Lex directly from the mapped file
+  std::unique_ptr<Utils::MappedFile> File;
+  try {
+    File = std::make_unique<Utils::MappedFile>(FileName);
+  } catch (Utils::ReadError &) {
     throw FileNotFound();
+  }
 
-  return parseFromStream(File);
+  Lexer Lex(std::string_view(
+      reinterpret_cast<const char*>(File->data()), File->size()));
+  return parseFromLexer(Lex);
 }
 
 std::unique_ptr<JavaTypes::JavaClass> CD::parseFromString(
-    const std::string &Input) {
-
-  std::istringstream InputStream(Input);
-  assert(InputStream); // What can go wrong?
+    std::string_view Input) {
 
-  return parseFromStream(InputStream);
+  Lexer Lex{Input};
+  return parseFromLexer(Lex);
 }
@@ -13,6 +13,7 @@
 #include <stdexcept>
 #include <istream>
 #include <memory>
+#include <string_view>
 
 namespace CD {
 
@@ -33,7 +34,7 @@ std::unique_ptr<JavaTypes::JavaClass> parseFromFile(
     const std::string &FileName);
 
 std::unique_ptr<JavaTypes::JavaClass> parseFromString(
-    const std::string &Input);
+    std::string_view Input);
 
 std::unique_ptr<JavaTypes::JavaClass> parseFromStream(
     std::istream &InputStream);
@@ -5,6 +5,7 @@
 #include "ClassFileReader.h"
 
 #include "Utils/BinaryFiles.h"
+#include "Utils/ModifiedUtf8.h"
 #include "JavaTypes/ConstantPool.h"
 #include "JavaTypes/ConstantPoolRecords.h"
 #include "JavaTypes/JavaMethod.h"
@@ -12,7 +13,8 @@
 
 #include <istream>
 #include <iostream>
-#include <fstream>
+#include <cstring>
+#include <iterator>
 
 using namespace std::string_literals;
 
@@ -66,17 +68,27 @@ static const RecordType &readConstantPoolRecord(
 // Same as above but reads 2 byte index from the input stream.
 template<class RecordType>
 static const RecordType &readConstantPoolRecord(
-    std::istream &Input, const ConstantPool &CP, const std::string &FieldName) {
-  uint16_t Idx = BigEndianReading::readHalf(Input);
+    BigEndianReader &Input, const ConstantPool &CP, const std::string &FieldName) {
+  uint16_t Idx = Input.readHalf();
 
   return readConstantPoolRecord<RecordType>(Idx, CP, FieldName);
 }
 
+// Reinterprets bits read from the class file as a floating point value.
+template<class FloatT, class BitsT>
+static FloatT bitsToFloat(BitsT Bits) {
+  static_assert(sizeof(FloatT) == sizeof(BitsT));
+  FloatT Ret;
+  std::memcpy(&Ret, &Bits, sizeof(Ret));
+  return Ret;
+}
+
 // Parses single constant pool record and adds it to the Builder.
+// \returns Number of the constant pool entries taken by this record.
 // \throws ConstantPoolBuilder::IncompatibleCellType
-static void parseConstantPoolRecord(
+static ConstantPool::IndexType parseConstantPoolRecord(
     ConstantPoolBuilder &Builder, ConstantPool::IndexType CurIdx,
-    std::istream& Input) {
+    BigEndianReader &Input) {
 
   auto CheckIndex =
       [&](ConstantPool::IndexType ToCheck) {
@@ -86,11 +98,11 @@ static void parseConstantPoolRecord(
               " found at " + std::to_string(CurIdx));
       };
 
-  uint8_t tag = BigEndianReading::readByte(Input);
+  uint8_t tag = Input.readByte();
 
   switch (static_cast<ConstantPoolTags>(tag)) {
     case ConstantPoolTags::CONSTANT_Class: {
-      uint16_t name_index = BigEndianReading::readHalf(Input);
+      uint16_t name_index = Input.readHalf();
       CheckIndex(name_index);
 
       const auto &NameRef = Builder.getCellReference<Utf8>(name_index);
@@ -99,10 +111,10 @@ static void parseConstantPoolRecord(
     }
 
     case ConstantPoolTags::CONSTANT_Methodref: {
-      uint16_t class_index = BigEndianReading::readHalf(Input);
+      uint16_t class_index = Input.readHalf();
       CheckIndex(class_index);
 
-      uint16_t name_and_type_index = BigEndianReading::readHalf(Input);
+      uint16_t name_and_type_index = Input.readHalf();
       CheckIndex(name_and_type_index);
 
       const auto &ClassRef =
@@ -115,10 +127,10 @@ static void parseConstantPoolRecord(
     }
 
     case ConstantPoolTags::CONSTANT_Fieldref: {
-      uint16_t class_index = BigEndianReading::readHalf(Input);
+      uint16_t class_index = Input.readHalf();
       CheckIndex(class_index);
 
-      uint16_t name_and_type_index = BigEndianReading::readHalf(Input);
+      uint16_t name_and_type_index = Input.readHalf();
       CheckIndex(name_and_type_index);
 
       const auto &ClassRef =
@@ -131,33 +143,23 @@ static void parseConstantPoolRecord(
     }
 
     case ConstantPoolTags::CONSTANT_Utf8: {
-      uint16_t length = BigEndianReading::readHalf(Input);
-      std::string name;
-
-      for (uint16_t byte_idx = 0; byte_idx < length; ++byte_idx) {
-        uint8_t byte = BigEndianReading::readByte(Input);
+      const uint16_t length = Input.readHalf();
+      const uint8_t *bytes = Input.readBytes(length);
 
-        // Specification requirements
-        if (byte == 0 || byte >= 0xf0)
-          throw FormatError("Unexpected string byte at " + std::to_string(CurIdx));
+      if (!ModifiedUtf8::isValid(bytes, length))
+        throw FormatError("Malformed string at " + std::to_string(CurIdx));
 
-        // For now support only regular ASCII codes
-        if (byte > 0x7f)
-          throw FormatError("Unicode is not fully supported at " +
-                                std::to_string(CurIdx));
-
-        name += static_cast<char>(byte);
-      }
-
-      Builder.create<ConstantPoolRecords::Utf8>(CurIdx, name);
+      // Copy whole string at once straight from the input buffer
+      Builder.create<ConstantPoolRecords::Utf8>(
+          CurIdx, Utf8String(reinterpret_cast<const char*>(bytes), length));
       break;
     }
 
     case ConstantPoolTags::CONSTANT_NameAndType: {
-      uint16_t name_index = BigEndianReading::readHalf(Input);
+      uint16_t name_index = Input.readHalf();
       CheckIndex(name_index);
 
-      uint16_t descriptor_index = BigEndianReading::readHalf(Input);
+      uint16_t descriptor_index = Input.readHalf();
       CheckIndex(descriptor_index);
 
       const auto &NameRef =
@@ -169,18 +171,51 @@ static void parseConstantPoolRecord(
       break;
     }
 
+    case ConstantPoolTags::CONSTANT_Integer: {
+      const uint32_t bytes = Input.readWord();
+      Builder.create<ConstantPoolRecords::Integer>(
+          CurIdx, static_cast<Runtime::JavaInt>(bytes));
+      break;
+    }
+
+    case ConstantPoolTags::CONSTANT_Float: {
+      const uint32_t bytes = Input.readWord();
+      Builder.create<ConstantPoolRecords::Float>(
+          CurIdx, bitsToFloat<Runtime::JavaFloat>(bytes));
+      break;
+    }
+
+    case ConstantPoolTags::CONSTANT_Long:
+    case ConstantPoolTags::CONSTANT_Double: {
+      // Eight byte constants take two entries, the second one is unusable.
+      CheckIndex(CurIdx + 1);
+
+      const uint64_t bytes = Input.readDoubleWord();
+      if (static_cast<ConstantPoolTags>(tag) == ConstantPoolTags::CONSTANT_Long)
+        Builder.create<ConstantPoolRecords::Long>(
+            CurIdx, static_cast<Runtime::JavaLong>(bytes));
+      else
+        Builder.create<ConstantPoolRecords::Double>(
+            CurIdx, bitsToFloat<Runtime::JavaDouble>(bytes));
+
+      Builder.create<ConstantPoolRecords::Unusable>(CurIdx + 1);
+      return 2;
+    }
+
     default:
       throw FormatError("Unsupported constant pool tag " +
                             std::to_string(tag));
   }
+
+  return 1;
 }
 
 // Creates and parses constant pool from the class file.
 // \returns Unique pointer to the valid constant pool.
 // \throws FormatError or ReadError is case of any input problems.
 static std::unique_ptr<ConstantPool>
-parseConstantPool(std::istream& Input) {
-  const uint16_t constant_pool_count = BigEndianReading::readHalf(Input);
+parseConstantPool(BigEndianReader &Input) {
+  const uint16_t constant_pool_count = Input.readHalf();
   // I guess extra one is added to account for the weird representation of
   // the long numbers.
   const uint16_t ConstantPoolSize =
@@ -189,8 +224,8 @@ parseConstantPool(std::istream& Input) {
   ConstantPoolBuilder Builder(ConstantPoolSize);
 
   try {
-    for (ConstantPool::IndexType i = 1; i <= ConstantPoolSize; ++i)
-      parseConstantPoolRecord(Builder, i, Input);
+    for (ConstantPool::IndexType i = 1; i <= ConstantPoolSize;)
+      i += parseConstantPoolRecord(Builder, i, Input);
   } catch (const ConstantPoolBuilder::IncompatibleCellType &e) {
     throw FormatError("Constant pool parsing error: "s + e.what());
   }
@@ -203,9 +238,9 @@ namespace {
 // Reads class file attributes. Throws ReadError on errors.
 class AttributeIterator {
 public:
-  explicit AttributeIterator(const ConstantPool &CP, std::istream &Input):
+  explicit AttributeIterator(const ConstantPool &CP, BigEndianReader &Input):
       CP(CP), Input(Input) {
-    NumAttrs = BigEndianReading::readHalf(Input);
+    NumAttrs = Input.readHalf();
 
     // Read first attribute if possible
     if (!empty())
@@ -216,7 +251,10 @@ public:
   bool empty() const { return NumAttrs == 0; }
 
   // Get name of the current attribute
-  const Utf8String &getName() const { assert(CurName); return *CurName; };
+  Utils::Symbol getName() const { assert(!CurName.isNull()); return CurName; };
+
+  // Get size of the current attribute
+  uint32_t getSize() const { return CurSize; }
 
   // Assuming current input position is at the beginning of the attribute,
   // read information about this attribute. Fails assertion if no attributes
@@ -233,7 +271,7 @@ public:
   // if he want's to visit next attribute.
   void skip() {
     assert(!empty());
-    Input.seekg(CurSize, std::ios_base::cur);
+    Input.skip(CurSize);
   }
 
 private:
@@ -244,23 +282,24 @@ private:
     const auto &NameRec =
         readConstantPoolRecord<ConstantPoolRecords::Utf8>(
             Input, CP, "attribute_name");
-    CurName = &NameRec.getValue();
-    CurSize = BigEndianReading::readWord(Input);
+    CurName = NameRec.getValue();
+    CurSize = Input.readWord();
   }
 
 private:
   const ConstantPool &CP;
-  std::istream &Input;
+  BigEndianReader &Input;
   uint16_t NumAttrs = 0;
 
-  const Utf8String *CurName = nullptr;
+  Utils::Symbol CurName;
   uint32_t CurSize = 0;
 };
 
 }
 
-static Type parseVerificationTypeInfo(std::istream &Input) {
-  const uint8_t tag = BigEndianReading::readByte(Input);
+static Type parseVerificationTypeInfo(
+    BigEndianReader &Input, const ConstantPool &CP) {
+  const uint8_t tag = Input.readByte();
 
   switch (tag) {
   case 0: return Types::Top;
@@ -269,11 +308,14 @@ static Type parseVerificationTypeInfo(std::istream &Input) {
   case 5: return Types::Null;
   case 6: return Types::UninitializedThis;
   case 7: {
-    (void)BigEndianReading::readHalf(Input);
-    return Types::Class;
+    // Verifier types don't track class names, but arrays are distinct
+    const auto &Class = readConstantPoolRecord<ConstantPoolRecords::ClassInfo>(
+        Input, CP, "cpool_index");
+    const Utf8String &Name = Class.getName();
+    return !Name.empty() && Name[0] == '[' ? Types::Array : Types::Class;
   }
   case 8: {
-    const uint16_t offset = BigEndianReading::readHalf(Input);
+    const uint16_t offset = Input.readHalf();
     return Types::UninitializedOffset(offset);
   }
   case 4: return Types::Long;
@@ -287,32 +329,86 @@ static Type parseVerificationTypeInfo(std::istream &Input) {
 
 // Parses stack map table and saves it into the 'Params' structure.
 // \throws ReadError or FormatError.
-static StackMapTableBuilder parseStackMapTable(std::istream &Input) {
-  const uint16_t number_of_entries = BigEndianReading::readHalf(Input);
+static StackMapTableBuilder parseStackMapTable(
+    BigEndianReader &Input, const ConstantPool &CP) {
+  const uint16_t number_of_entries = Input.readHalf();
 
   StackMapTableBuilder Ret;
   // Specification is terribly thoughtful
   auto cur_bci = static_cast<Bytecode::BciType>(-1);
 
+  // Same frames of the specification have empty stack, while the builder
+  // keeps stack of the previous frame. Empty append is used to clear it.
+  bool prev_has_stack = false;
+  auto AddSame = [&]() {
+    if (prev_has_stack)
+      Ret.addAppend(cur_bci, {});
+    else
+      Ret.addSame(cur_bci);
+    prev_has_stack = false;
+  };
+
+  auto ReadTypes = [&](std::size_t Count) {
+    std::vector<Type> Res;
+    Res.reserve(Count);
+    for (std::size_t Idx = 0; Idx < Count; ++Idx)
+      Res.push_back(parseVerificationTypeInfo(Input, CP));
+    return Res;
+  };
+
   for (int i = 0; i < number_of_entries; ++i) {
-    const uint8_t frame_type = BigEndianReading::readByte(Input);
+    const uint8_t frame_type = Input.readByte();
 
     if (frame_type <= 63) {
       cur_bci += frame_type + 1;
-      Ret.addSame(cur_bci);
+      AddSame();
+
+    } else if (frame_type <= 127) {
+      const Type stack_item = parseVerificationTypeInfo(Input, CP);
+
+      cur_bci += frame_type - 64 + 1;
+      Ret.addSameLocalsOneStack(cur_bci, stack_item);
+      prev_has_stack = true;
+
+    } else if (frame_type == 247) {
+      const uint16_t offset_delta = Input.readHalf();
+      const Type stack_item = parseVerificationTypeInfo(Input, CP);
+
+      cur_bci += offset_delta + 1;
+      Ret.addSameLocalsOneStack(cur_bci, stack_item);
+      prev_has_stack = true;
+
+    } else if (frame_type >= 248 && frame_type <= 250) {
+      const uint16_t offset_delta = Input.readHalf();
+
+      cur_bci += offset_delta + 1;
+      Ret.addChop(cur_bci, 251u - frame_type);
+      prev_has_stack = false;
+
+    } else if (frame_type == 251) {
+      const uint16_t offset_delta = Input.readHalf();
+
+      cur_bci += offset_delta + 1;
+      AddSame();
 
     } else if (frame_type >= 252 && frame_type <= 254) {
-      const uint16_t offset_delta = BigEndianReading::readHalf(Input);
+      const uint16_t offset_delta = Input.readHalf();
       const uint8_t k = frame_type - 251;
 
-      std::vector<Type> new_locals;
-      new_locals.reserve(k);
-      for (uint8_t local_idx = 0; local_idx < k; ++local_idx) {
-        new_locals.push_back(parseVerificationTypeInfo(Input));
-      }
+      auto new_locals = ReadTypes(k);
 
       cur_bci += offset_delta + 1;
       Ret.addAppend(cur_bci, std::move(new_locals));
+      prev_has_stack = false;
+
+    } else if (frame_type == 255) {
+      const uint16_t offset_delta = Input.readHalf();
+      auto locals = ReadTypes(Input.readHalf());
+      auto stack = ReadTypes(Input.readHalf());
+
+      cur_bci += offset_delta + 1;
+      prev_has_stack = !stack.empty();
+      Ret.addFull(cur_bci, std::move(locals), std::move(stack));
 
     } else {
       throw FormatError("Unrecognized stack map frame type");
@@ -322,36 +418,32 @@ static StackMapTableBuilder parseStackMapTable(std::istream &Input) {
   return Ret;
 }
 
-// Expects current input position to be set up right after 'Code' attribute
-// tag. Saves result in the 'Params' structure.
+// Decodes instructions, skips exception table and parses stack map table of
+// the 'Code' attribute. Expects input to be positioned right after the
+// max_locals field.
 // \throws ReadError or FormatError.
-static void parseMethodCode(
-    JavaMethod::MethodConstructorParameters &Params,
-    const ConstantPool &CP, std::istream &Input) {
+static JavaMethod::MethodBody parseMethodBody(
+    const ConstantPool &CP, BigEndianReader &Input) {
+  JavaMethod::MethodBody Body;
 
-  Params.MaxStack = BigEndianReading::readHalf(Input);
-  Params.MaxLocals = BigEndianReading::readHalf(Input);
-
-  std::vector<uint8_t> Bytecode;
-  const uint32_t code_length = BigEndianReading::readWord(Input);
-  Bytecode.resize(code_length);
-  Input.read(reinterpret_cast<char*>(Bytecode.data()), code_length);
-  if (Input.fail())
+  const uint32_t code_length = Input.readWord();
+  if (code_length > Input.remaining())
     throw FormatError("Failed to read method code");
-  Params.Code = Bytecode::parseInstructions(Bytecode);
+  const uint8_t *code = Input.readBytes(code_length);
+  Body.Code = Bytecode::parseInstructions(
+      std::vector<uint8_t>(code, code + code_length));
 
   // Skip exception table for now
-  const uint16_t exception_table_length = BigEndianReading::readHalf(Input);
-  const uint16_t exception_table_entry_size = 8;
-  Input.seekg(exception_table_length * exception_table_entry_size,
-              std::ios_base::cur);
-  if (Input.fail())
+  const uint16_t exception_table_length = Input.readHalf();
+  const std::size_t exception_table_entry_size = 8;
+  if (exception_table_length * exception_table_entry_size > Input.remaining())
     throw FormatError("Failed to read exception table from code attribute");
+  Input.skip(exception_table_length * exception_table_entry_size);
 
   AttributeIterator AttrIt(CP, Input);
   for (; !AttrIt.empty(); AttrIt.next()) {
     if (AttrIt.getName() == "StackMapTable") {
-      Params.StackMapBuilder = parseStackMapTable(Input);
+      Body.StackMapBuilder = parseStackMapTable(Input, CP);
     } else {
       AttrIt.skip();
     }
@@ -359,6 +451,43 @@ static void parseMethodCode(
 
   // TODO: Check that attribute_length is consistent with the actual
   // amount of data.
+  return Body;
+}
+
+// Expects current input position to be set up right after 'Code' attribute
+// tag. Reads stack and locals sizes and keeps the rest of the attribute
+// undecoded until the method is used. Most methods are never executed.
+// Saves result in the 'Params' structure.
+// \throws ReadError or FormatError.
+static void parseMethodCode(
+    JavaMethod::MethodConstructorParameters &Params,
+    const ConstantPool &CP, BigEndianReader &Input, uint32_t AttrSize) {
+
+  Params.MaxStack = Input.readHalf();
+  Params.MaxLocals = Input.readHalf();
+
+  const uint32_t RestSize = AttrSize - 4;
+  if (AttrSize < 4 || RestSize > Input.remaining())
+    throw FormatError("Failed to read method code");
+
+  // Class doesn't refer to the input buffer, so keep a copy of the
+  // undecoded part
+  const uint8_t *Rest = Input.readBytes(RestSize);
+  auto Bytes = std::make_shared<const std::vector<uint8_t>>(Rest, Rest + RestSize);
+
+  // Constant pool is owned by the class and outlives the method
+  Params.LazyBody = [Bytes, CPtr = &CP]() {
+    try {
+      BigEndianReader BodyInput(Bytes->data(), Bytes->size());
+      return parseMethodBody(*CPtr, BodyInput);
+    } catch (ReadError &) {
+      throw FormatError("Unable to read method code");
+    } catch (Bytecode::BytecodeParsingError &e) {
+      throw FormatError("Unable to parse method's bytecode: "s + e.what());
+    } catch (Bytecode::UnknownBytecode &e) {
+      throw FormatError("Encountered unknown bytecode: "s + e.what());
+    }
+  };
 }
 
 // Parse single field description.
@@ -366,8 +495,8 @@ static void parseMethodCode(
 // the fields vector.
 // \throws FormatError or ReadError accordingly.
 static JavaField parseField(
-    std::istream &Input, const ConstantPool &CP) {
-  const uint16_t access_flags = BigEndianReading::readHalf(Input);
+    BigEndianReader &Input, const ConstantPool &CP) {
+  const uint16_t access_flags = Input.readHalf();
   auto Flags = static_cast<JavaField::AccessFlags>(access_flags);
   // This doesn't follow JVM specification but this is what javac
   // generates on practice.
@@ -381,12 +510,21 @@ static JavaField parseField(
       readConstantPoolRecord<ConstantPoolRecords::Utf8>(
           Input, CP, "field_descriptor_index");
 
-  // Skip all the attributes for now
+  const NumericConstant *ConstantValue = nullptr;
+
   AttributeIterator AttrIt(CP, Input);
-  for (; !AttrIt.empty(); AttrIt.next())
-    AttrIt.skip();
+  for (; !AttrIt.empty(); AttrIt.next()) {
+    // Non static fields should silently ignore this attribute (jvms 4.7.2)
+    if (AttrIt.getName() == "ConstantValue" &&
+        (Flags & JavaField::ACC_STATIC)) {
+      ConstantValue = &readConstantPoolRecord<NumericConstant>(
+          Input, CP, "constantvalue_index");
+    } else {
+      AttrIt.skip();
+    }
+  }
 
-  return JavaField(Descriptor, Name, Flags);
+  return JavaField(Descriptor, Name, Flags, ConstantValue);
 }
 
 // Helper function for the class file parser. Parses single method.
@@ -395,10 +533,10 @@ static JavaField parseField(
 // to call constructor himself.
 // \throws FormatError or ReadError accordingly.
 static std::unique_ptr<JavaMethod> parseMethod(
-    std::istream &Input, const ConstantPool &CP) {
+    BigEndianReader &Input, const ConstantPool &CP) {
   JavaMethod::MethodConstructorParameters Params;
 
-  const uint16_t access_flags = BigEndianReading::readHalf(Input);
+  const uint16_t access_flags = Input.readHalf();
   Params.Flags = static_cast<JavaMethod::AccessFlags>(access_flags);
 
   const auto &Name =
@@ -416,14 +554,18 @@ static std::unique_ptr<JavaMethod> parseMethod(
   AttributeIterator AttrIt(CP, Input);
   for (; !AttrIt.empty(); AttrIt.next()) {
     if (AttrIt.getName() == "Code") {
-      parseMethodCode(Params, CP, Input);
+      parseMethodCode(Params, CP, Input, AttrIt.getSize());
       seen_code = true;
     } else {
       AttrIt.skip();
     }
   }
 
-  if (!seen_code)
+  // Native methods are the only ones without the code
+  const bool is_native = Params.Flags & JavaMethod::AccessFlags::ACC_NATIVE;
+  if (is_native && seen_code)
+    throw FormatError("Native method can't have code attribute");
+  if (!is_native && !seen_code)
     throw FormatError("Couldn't find method code attribute");
 
   return std::make_unique<JavaMethod>(std::move(Params));
@@ -432,21 +574,36 @@ static std::unique_ptr<JavaMethod> parseMethod(
 std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromFile(
     const std::string &FileName) {
 
-  std::ifstream file(FileName, std::ios_base::in | std::ios_base::binary);
-  if (!file)
+  std::unique_ptr<MappedFile> File;
+  try {
+    File = std::make_unique<MappedFile>(FileName);
+  } catch (ReadError &) {
     throw FileNotFound();
+  }
 
-  return loadClassFromStream(file);
+  return loadClassFromBuffer(File->data(), File->size());
 }
 
 std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromStream(
     std::istream &Input) {
+
+  const std::vector<char> Contents(
+      (std::istreambuf_iterator<char>(Input)),
+      std::istreambuf_iterator<char>());
+
+  return loadClassFromBuffer(
+      reinterpret_cast<const uint8_t*>(Contents.data()), Contents.size());
+}
+
+std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromBuffer(
+    const uint8_t *Data, std::size_t Size) {
   JavaClass::ClassParameters ClassParams;
+  BigEndianReader Input(Data, Size);
 
   // Read basic constants
   //
   try {
-    const uint32_t magic = BigEndianReading::readWord(Input);
+    const uint32_t magic = Input.readWord();
     if (magic != 0xCAFEBABE)
       throw FormatError("Magic word in a wrong format");
   } catch (ReadError &) {
@@ -454,8 +611,8 @@ std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromStream(
   }
 
   try {
-    const uint16_t minor_version = BigEndianReading::readHalf(Input);
-    const uint16_t major_version = BigEndianReading::readHalf(Input);
+    const uint16_t minor_version = Input.readHalf();
+    const uint16_t major_version = Input.readHalf();
     if (major_version != 52 || minor_version != 0)
       throw FormatError("Unsupported class file version");
   } catch (ReadError &) {
@@ -474,7 +631,7 @@ std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromStream(
   // Access flags
   //
   try {
-    const uint16_t access_flags = BigEndianReading::readHalf(Input);
+    const uint16_t access_flags = Input.readHalf();
     ClassParams.Flags = static_cast<JavaClass::AccessFlags>(access_flags);
   } catch (ReadError &) {
     throw FormatError("Unable to read access flags");
@@ -488,7 +645,7 @@ std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromStream(
             Input, *ClassParams.CP, "this_class");
     ClassParams.ClassName = &ThisClass;
 
-    const uint16_t super_class = BigEndianReading::readHalf(Input);
+    const uint16_t super_class = Input.readHalf();
     if (super_class != 0) {
       const auto &SuperClass =
           readConstantPoolRecord<ConstantPoolRecords::ClassInfo>(
@@ -502,7 +659,7 @@ std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromStream(
   // Interfaces
   //
   try {
-    const uint16_t interfaces_count = BigEndianReading::readHalf(Input);
+    const uint16_t interfaces_count = Input.readHalf();
     if (interfaces_count != 0)
       throw FormatError("Interface inheritance is not supported yet");
   } catch (ReadError &) {
@@ -512,7 +669,7 @@ std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromStream(
   // Fields
   //
   try {
-    const uint16_t fields_count = BigEndianReading::readHalf(Input);
+    const uint16_t fields_count = Input.readHalf();
 
     ClassParams.Fields.reserve(fields_count);
     for (uint16_t idx = 0; idx < fields_count; ++idx) {
@@ -525,7 +682,7 @@ std::unique_ptr<JavaTypes::JavaClass> ClassFileReader::loadClassFromStream(
   // Methods
   //
   try {
-    const uint16_t methods_count = BigEndianReading::readHalf(Input);
+    const uint16_t methods_count = Input.readHalf();
 
     ClassParams.Methods.reserve(methods_count);
     for (uint16_t method_idx = 0; method_idx < methods_count; ++method_idx)
@@ -7,6 +7,8 @@
 
 #include "JavaTypes/JavaClass.h"
 
+#include <cstdint>
+#include <istream>
 #include <memory>
 #include <string>
 
@@ -26,10 +28,18 @@ std::unique_ptr<JavaTypes::JavaClass> loadClassFromFile(
     const std::string &FileName);
 
 // Same as loadClassFromFile, but gathers information from the input stream.
+// Reads whole stream into memory and parses it from there.
 // \returns Unique pointer for the parsed class file.
 // \throws FormatError In case of any parsing problems.
 std::unique_ptr<JavaTypes::JavaClass> loadClassFromStream(std::istream &Input);
 
+// Parses class from the memory buffer. Resulting class doesn't refer to the
+// buffer, so it can be freed afterwards.
+// \returns Unique pointer for the parsed class file.
+// \throws FormatError In case of any parsing problems.
+std::unique_ptr<JavaTypes::JavaClass> loadClassFromBuffer(
+    const uint8_t *Data, std::size_t Size);
+
 }
 
 #endif //ICP_CLASSFILEREADER_H
@@ -0,0 +1,503 @@
+///
+/// Implementation of the class file writer.
+///
+
+#include "ClassFileWriter.h"
+
+#include "Utils/BinaryFiles.h"
+#include "JavaTypes/ConstantPool.h"
+#include "JavaTypes/ConstantPoolRecords.h"
+#include "JavaTypes/JavaMethod.h"
+#include "JavaTypes/StackMapTable.h"
+#include "Bytecode/Bytecode.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+
+using namespace ClassFileWriter;
+using Utils::BigEndianWriter;
+using Utils::Symbol;
+using namespace JavaTypes;
+
+namespace {
+
+// Same as in the reader
+enum class ConstantPoolTags: uint8_t {
+  CONSTANT_Class = 7,
+  CONSTANT_Fieldref = 9,
+  CONSTANT_Methodref = 10,
+  CONSTANT_Integer = 3,
+  CONSTANT_Float = 4,
+  CONSTANT_Long = 5,
+  CONSTANT_Double = 6,
+  CONSTANT_NameAndType = 12,
+  CONSTANT_Utf8 = 1
+};
+
+// Verifier types don't track class names, these are written instead. Reader
+// only distinguishes arrays from the other classes.
+constexpr const char *AnyClassName = "java/lang/Object";
+constexpr const char *AnyArrayName = "[Ljava/lang/Object;";
+
+template<class FloatT, class BitsT>
+BitsT floatToBits(FloatT Val) {
+  static_assert(sizeof(FloatT) == sizeof(BitsT));
+  BitsT Ret;
+  std::memcpy(&Ret, &Val, sizeof(Ret));
+  return Ret;
+}
+
+// Constant pool of the written class. Starts as the constant pool of the
+// class, records which are missing are appended after it.
+class ConstantPoolWriter final {
+public:
+  using IndexType = ConstantPool::IndexType;
+
+public:
+  explicit ConstantPoolWriter(const ConstantPool &CP):
+      CP(CP), NextIdx(CP.numRecords() + 1) {
+    // First record wins, same as the string lookups in the CD parser
+    for (IndexType Idx = 1; Idx <= CP.numRecords(); ++Idx) {
+      if (const auto *Str = CP.getAsOrNull<ConstantPoolRecords::Utf8>(Idx))
+        Strings.emplace(Str->getValue(), Idx);
+      else if (const auto *C = CP.getAsOrNull<ConstantPoolRecords::ClassInfo>(Idx))
+        Classes.emplace(C->getName(), Idx);
+    }
+  }
+
+  // \returns Index of the Utf8 record with the given value.
+  // \throws WriteError If constant pool overflows.
+  IndexType getUtf8(Symbol Value) {
+    if (const auto It = Strings.find(Value); It != Strings.end())
+      return It->second;
+
+    const auto Idx = allocate();
+    Strings.emplace(Value, Idx);
+    Appended.push_back({ConstantPoolTags::CONSTANT_Utf8, Value, 0});
+    return Idx;
+  }
+
+  // \returns Index of the ClassInfo record with the given name.
+  // \throws WriteError If constant pool overflows.
+  IndexType getClass(Symbol Name) {
+    if (const auto It = Classes.find(Name); It != Classes.end())
+      return It->second;
+
+    const auto NameIdx = getUtf8(Name);
+    const auto Idx = allocate();
+    Classes.emplace(Name, Idx);
+    Appended.push_back({ConstantPoolTags::CONSTANT_Class, Name, NameIdx});
+    return Idx;
+  }
+
+  // Writes 'constant_pool_count' followed by all records.
+  // \throws WriteError If some record can't be written.
+  void write(BigEndianWriter &Out) {
+    // Strings for the class infos are allocated before the records are
+    // written, so that the record count doesn't change from now on.
+    for (IndexType Idx = 1; Idx <= CP.numRecords(); ++Idx) {
+      if (const auto *C = CP.getAsOrNull<ConstantPoolRecords::ClassInfo>(Idx))
+        getUtf8(C->getName());
+      else if (const auto *NT =
+                   CP.getAsOrNull<ConstantPoolRecords::NameAndType>(Idx)) {
+        getUtf8(NT->getName());
+        getUtf8(NT->getDescriptor());
+      }
+    }
+
+    Out.writeHalf(NextIdx);
+
+    for (IndexType Idx = 1; Idx <= CP.numRecords(); ++Idx)
+      Idx += writeRecord(Idx, Out);
+
+    for (const auto &Rec: Appended) {
+      Out.writeByte(static_cast<uint8_t>(Rec.Tag));
+      if (Rec.Tag == ConstantPoolTags::CONSTANT_Utf8)
+        writeUtf8(Rec.Value, Out);
+      else
+        Out.writeHalf(Rec.NameIdx);
+    }
+  }
+
+private:
+  IndexType allocate() {
+    if (NextIdx == std::numeric_limits<IndexType>::max())
+      throw WriteError("Constant pool is too large");
+    return NextIdx++;
+  }
+
+  static void writeUtf8(Symbol Value, BigEndianWriter &Out) {
+    const auto &Str = Value.str();
+    if (Str.size() > std::numeric_limits<uint16_t>::max())
+      throw WriteError("String is too long for the constant pool");
+
+    Out.writeHalf(static_cast<uint16_t>(Str.size()));
+    Out.writeBytes(Str);
+  }
+
+  // Writes record at 'Idx'.
+  // \returns Number of the following records which were written together
+  // with this one, i.e unusable record after the long.
+  IndexType writeRecord(IndexType Idx, BigEndianWriter &Out) {
+    using namespace ConstantPoolRecords;
+    using Tag = ConstantPool::Tag;
+
+    const auto WriteTag = [&](ConstantPoolTags T) {
+      Out.writeByte(static_cast<uint8_t>(T));
+    };
+    const auto WriteRef = [&](ConstantPoolTags T, const auto &Rec) {
+      WriteTag(T);
+      Out.writeHalf(CP.indexOf(Rec.getClass()));
+      Out.writeHalf(CP.indexOf(Rec.getNameAndType()));
+    };
+
+    switch (CP.getTag(Idx)) {
+    case Tag::Utf8:
+      WriteTag(ConstantPoolTags::CONSTANT_Utf8);
+      writeUtf8(CP.getAs<Utf8>(Idx).getValue(), Out);
+      return 0;
+
+    case Tag::NameAndType: {
+      const auto &NT = CP.getAs<NameAndType>(Idx);
+      WriteTag(ConstantPoolTags::CONSTANT_NameAndType);
+      Out.writeHalf(Strings.at(NT.getName()));
+      Out.writeHalf(Strings.at(NT.getDescriptor()));
+      return 0;
+    }
+
+    case Tag::ClassInfo:
+      WriteTag(ConstantPoolTags::CONSTANT_Class);
+      Out.writeHalf(Strings.at(CP.getAs<ClassInfo>(Idx).getName()));
+      return 0;
+
+    case Tag::MethodRef:
+      WriteRef(ConstantPoolTags::CONSTANT_Methodref, CP.getAs<MethodRef>(Idx));
+      return 0;
+
+    case Tag::FieldRef:
+      WriteRef(ConstantPoolTags::CONSTANT_Fieldref, CP.getAs<FieldRef>(Idx));
+      return 0;
+
+    case Tag::Integer:
+      WriteTag(ConstantPoolTags::CONSTANT_Integer);
+      Out.writeWord(static_cast<uint32_t>(
+          CP.getAs<Integer>(Idx).getValue().getAs<Runtime::JavaInt>()));
+      return 0;
+
+    case Tag::Float:
+      WriteTag(ConstantPoolTags::CONSTANT_Float);
+      Out.writeWord(floatToBits<Runtime::JavaFloat, uint32_t>(
+          CP.getAs<Float>(Idx).getValue().getAs<Runtime::JavaFloat>()));
+      return 0;
+
+    case Tag::Long:
+    case Tag::Double:
+      // Class file implicitly reserves the next entry
+      if (!CP.isA<Unusable>(Idx + 1))
+        throw WriteError("Long or double constant at " + std::to_string(Idx) +
+                         " should be followed by the unusable record");
+
+      if (CP.getTag(Idx) == Tag::Long) {
+        WriteTag(ConstantPoolTags::CONSTANT_Long);
+        Out.writeDoubleWord(static_cast<uint64_t>(
+            CP.getAs<Long>(Idx).getValue().getAs<Runtime::JavaLong>()));
+      } else {
+        WriteTag(ConstantPoolTags::CONSTANT_Double);
+        Out.writeDoubleWord(floatToBits<Runtime::JavaDouble, uint64_t>(
+            CP.getAs<Double>(Idx).getValue().getAs<Runtime::JavaDouble>()));
+      }
+      return 1;
+
+    case Tag::Unusable:
+      throw WriteError("Unusable record at " + std::to_string(Idx) +
+                       " doesn't follow long or double constant");
+
+    case Tag::Empty:
+      break;
+    }
+
+    assert(false); // constant pool is always fully populated
+    return 0;
+  }
+
+private:
+  struct AppendedRecord {
+    ConstantPoolTags Tag;
+    Symbol Value;      // string value or class name
+    IndexType NameIdx; // only for the classes
+  };
+
+  const ConstantPool &CP;
+
+  std::unordered_map<Symbol, IndexType> Strings;
+  std::unordered_map<Symbol, IndexType> Classes;
+
+  std::vector<AppendedRecord> Appended;
+  IndexType NextIdx;
+};
+
+// Writes 'attribute_name_index' and placeholder for the 'attribute_length'.
+// \returns Position which should be passed to the 'endAttribute'.
+std::size_t beginAttribute(
+    const char *Name, ConstantPoolWriter &CP, BigEndianWriter &Out) {
+  Out.writeHalf(CP.getUtf8(Symbol::intern(Name)));
+  const auto Pos = Out.size();
+  Out.writeWord(0);
+  return Pos;
+}
+
+void endAttribute(std::size_t Pos, BigEndianWriter &Out) {
+  const auto Length = Out.size() - Pos - 4;
+  if (Length > std::numeric_limits<uint32_t>::max())
+    throw WriteError("Attribute is too large");
+  Out.patchWord(Pos, static_cast<uint32_t>(Length));
+}
+
+void writeVerificationType(
+    const Type &T, ConstantPoolWriter &CP, BigEndianWriter &Out) {
+  if (T == Types::Top) {
+    Out.writeByte(0);
+  } else if (Types::isAssignable(T, Types::Int)) {
+    // Byte, char, short and boolean are integers for the verifier
+    Out.writeByte(1);
+  } else if (T == Types::Float) {
+    Out.writeByte(2);
+  } else if (T == Types::Double) {
+    Out.writeByte(3);
+  } else if (T == Types::Long) {
+    Out.writeByte(4);
+  } else if (T == Types::Null) {
+    Out.writeByte(5);
+  } else if (T == Types::UninitializedThis) {
+    Out.writeByte(6);
+  } else if (T == Types::Class || T == Types::Array) {
+    Out.writeByte(7);
+    Out.writeHalf(CP.getClass(Symbol::intern(
+        T == Types::Class ? AnyClassName : AnyArrayName)));
+  } else if (T.getBits() != Types::UninitializedOffset().getBits() &&
+             T == Types::UninitializedOffset()) {
+    Out.writeByte(8);
+    Out.writeHalf(static_cast<uint16_t>(Types::getUninitializedOffset(T)));
+  } else {
+    throw WriteError("Type can't be represented in the stack map");
+  }
+}
+
+void writeVerificationTypes(
+    const std::vector<Type> &Types, ConstantPoolWriter &CP,
+    BigEndianWriter &Out) {
+  for (const auto &T: Types)
+    writeVerificationType(T, CP, Out);
+}
+
+// Writes frames of the builder one to one. The only exception are builder's
+// same frames after the frames with the stack: class file same frame has
+// an empty stack, so the frame with the stack is repeated instead.
+void writeStackMapTable(
+    const StackMapTableBuilder &Builder, ConstantPoolWriter &CP,
+    BigEndianWriter &Out) {
+  using Action = StackMapTableBuilder::Action;
+
+  const auto &Actions = Builder.actions();
+  if (Actions.size() > std::numeric_limits<uint16_t>::max())
+    throw WriteError("Too many stack map frames");
+  Out.writeHalf(static_cast<uint16_t>(Actions.size()));
+
+  const Action *LastWithStack = nullptr;
+  Bytecode::BciType PrevBci = 0;
+  bool IsFirst = true;
+
+  for (const auto &Act: Actions) {
+    const auto Delta = IsFirst ? Act.Bci : Act.Bci - PrevBci - 1;
+    if (Delta > std::numeric_limits<uint16_t>::max())
+      throw WriteError("Stack map frame offset is too large");
+    const auto OffsetDelta = static_cast<uint16_t>(Delta);
+    IsFirst = false;
+    PrevBci = Act.Bci;
+
+    // Same frame takes whatever previous frame was
+    const Action &Frame =
+        Act.FrameType == Action::SAME && LastWithStack ? *LastWithStack : Act;
+
+    switch (Frame.FrameType) {
+    case Action::SAME:
+      if (OffsetDelta <= 63) {
+        Out.writeByte(static_cast<uint8_t>(OffsetDelta));
+      } else {
+        Out.writeByte(251);
+        Out.writeHalf(OffsetDelta);
+      }
+      break;
+
+    case Action::SAME_LOCALS_ONE_STACK:
+      assert(Frame.Stack.size() == 1);
+      if (OffsetDelta <= 63) {
+        Out.writeByte(static_cast<uint8_t>(64 + OffsetDelta));
+      } else {
+        Out.writeByte(247);
+        Out.writeHalf(OffsetDelta);
+      }
+      writeVerificationType(Frame.Stack.front(), CP, Out);
+      LastWithStack = &Frame;
+      break;
+
+    case Action::CHOP:
+      if (Frame.Locals.empty() || Frame.Locals.size() > 3)
+        throw WriteError("Chop frame should remove from one to three locals");
+      Out.writeByte(static_cast<uint8_t>(251 - Frame.Locals.size()));
+      Out.writeHalf(OffsetDelta);
+      LastWithStack = nullptr;
+      break;
+
+    case Action::APPEND:
+      if (Frame.Locals.size() > 3)
+        throw WriteError("Append frame should add at most three locals");
+      // Empty append only clears the stack
+      if (Frame.Locals.empty()) {
+        Out.writeByte(251);
+      } else {
+        Out.writeByte(static_cast<uint8_t>(251 + Frame.Locals.size()));
+      }
+      Out.writeHalf(OffsetDelta);
+      writeVerificationTypes(Frame.Locals, CP, Out);
+      LastWithStack = nullptr;
+      break;
+
+    case Action::FULL:
+      if (Frame.Locals.size() > std::numeric_limits<uint16_t>::max() ||
+          Frame.Stack.size() > std::numeric_limits<uint16_t>::max())
+        throw WriteError("Full frame is too large");
+      Out.writeByte(255);
+      Out.writeHalf(OffsetDelta);
+      Out.writeHalf(static_cast<uint16_t>(Frame.Locals.size()));
+      writeVerificationTypes(Frame.Locals, CP, Out);
+      Out.writeHalf(static_cast<uint16_t>(Frame.Stack.size()));
+      writeVerificationTypes(Frame.Stack, CP, Out);
+      LastWithStack = Frame.Stack.empty() ? nullptr : &Frame;
+      break;
+    }
+  }
+}
+
+void writeCode(
+    const JavaMethod &Method, ConstantPoolWriter &CP, BigEndianWriter &Out) {
+  const auto AttrPos = beginAttribute("Code", CP, Out);
+
+  Out.writeHalf(Method.getMaxStack());
+  Out.writeHalf(Method.getMaxLocals());
+
+  Bytecode::Container Code;
+  for (const Bytecode::Instruction *Inst: Method)
+    Inst->encode(Code);
+  if (Code.size() > std::numeric_limits<uint16_t>::max())
+    throw WriteError("Method " + Method.getName().str() + " is too large");
+
+  Out.writeWord(static_cast<uint32_t>(Code.size()));
+  Out.writeBytes(std::string_view(
+      reinterpret_cast<const char*>(Code.data()), Code.size()));
+
+  // Exception tables are not supported
+  Out.writeHalf(0);
+
+  const auto &StackMap = Method.getStackMapBuilder();
+  if (StackMap.actions().empty()) {
+    Out.writeHalf(0);
+  } else {
+    Out.writeHalf(1);
+    const auto StackMapPos = beginAttribute("StackMapTable", CP, Out);
+    writeStackMapTable(StackMap, CP, Out);
+    endAttribute(StackMapPos, Out);
+  }
+
+  endAttribute(AttrPos, Out);
+}
+
+void writeMethod(
+    const JavaMethod &Method, ConstantPoolWriter &CP, BigEndianWriter &Out) {
+  Out.writeHalf(static_cast<uint16_t>(Method.getAccessFlags()));
+  Out.writeHalf(CP.getUtf8(Method.getName()));
+  Out.writeHalf(CP.getUtf8(Method.getDescriptor()));
+
+  // Native methods have no code
+  if (Method.isNative()) {
+    Out.writeHalf(0);
+    return;
+  }
+
+  Out.writeHalf(1);
+  writeCode(Method, CP, Out);
+}
+
+void writeField(
+    const JavaField &Field, const ConstantPool &ClassCP,
+    ConstantPoolWriter &CP, BigEndianWriter &Out) {
+  Out.writeHalf(static_cast<uint16_t>(Field.getFlags()));
+  Out.writeHalf(CP.getUtf8(Field.getName()));
+  Out.writeHalf(CP.getUtf8(Field.getDescriptor()));
+
+  if (!Field.hasConstantValue()) {
+    Out.writeHalf(0);
+    return;
+  }
+
+  Out.writeHalf(1);
+  const auto AttrPos = beginAttribute("ConstantValue", CP, Out);
+  Out.writeHalf(ClassCP.indexOf(Field.getConstantValue()));
+  endAttribute(AttrPos, Out);
+}
+
+}
+
+std::string ClassFileWriter::writeClassToBuffer(const JavaClass &Class) {
+  const auto &ClassCP = Class.getConstantPool();
+  ConstantPoolWriter CP(ClassCP);
+
+  // Constant pool goes first, but it's complete only after everything else
+  // is written.
+  BigEndianWriter Body;
+
+  Body.writeHalf(static_cast<uint16_t>(Class.getAccessFlags()));
+  Body.writeHalf(CP.getClass(Class.getClassName()));
+  Body.writeHalf(Class.hasSuper() ? CP.getClass(Class.getSuperClassName()) : 0);
+
+  // Interfaces are not supported
+  Body.writeHalf(0);
+
+  if (Class.fields().size() > std::numeric_limits<uint16_t>::max() ||
+      Class.methods().size() > std::numeric_limits<uint16_t>::max())
+    throw WriteError("Too many fields or methods");
+
+  Body.writeHalf(static_cast<uint16_t>(Class.fields().size()));
+  for (const auto &Field: Class.fields())
+    writeField(Field, ClassCP, CP, Body);
+
+  Body.writeHalf(static_cast<uint16_t>(Class.methods().size()));
+  for (const auto &Method: Class.methods())
+    writeMethod(*Method, CP, Body);
+
+  // No class attributes
+  Body.writeHalf(0);
+
+  BigEndianWriter Out;
+  Out.writeWord(0xCAFEBABE);
+  // Same version as the reader expects
+  Out.writeHalf(0);
+  Out.writeHalf(52);
+  CP.write(Out);
+  Out.writeBytes(Body.str());
+
+  return Out.take();
+}
+
+void ClassFileWriter::writeClassToFile(
+    const JavaClass &Class, const std::string &FileName) {
+  const auto Bytes = writeClassToBuffer(Class);
+
+  std::ofstream File(FileName, std::ios_base::binary | std::ios_base::trunc);
+  File << Bytes;
+  File.close();
+  if (!File)
+    throw WriteError("Unable to write " + FileName);
+}
@@ -0,0 +1,36 @@
+///
+/// Serializes classes into the class file format. Counterpart of the
+/// ClassFileReader, i.e classes written here are loaded back into the
+/// equivalent JavaClass.
+///
+
+#ifndef ICP_CLASSFILEWRITER_H
+#define ICP_CLASSFILEWRITER_H
+
+#include "JavaTypes/JavaClass.h"
+
+#include <stdexcept>
+#include <string>
+
+namespace ClassFileWriter {
+
+class WriteError: public std::runtime_error {
+  using std::runtime_error::runtime_error;
+};
+
+// Constant pool of the class is written as is, records which are needed only
+// in the class file (attribute names, classes of the stack map types) are
+// appended after it. Methods are written with their current code, i.e
+// with the constant fields already folded.
+// \returns Bytes of the class file.
+// \throws WriteError If class can't be represented in the class file format.
+std::string writeClassToBuffer(const JavaTypes::JavaClass &Class);
+
+// Same as above but writes result into the file.
+// \throws WriteError Also if file can't be written.
+void writeClassToFile(
+    const JavaTypes::JavaClass &Class, const std::string &FileName);
+
+}
+
+#endif //ICP_CLASSFILEWRITER_H
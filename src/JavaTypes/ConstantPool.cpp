@@ -3,12 +3,31 @@
 ///
 
 #include "ConstantPool.h"
+#include "ConstantPoolRecords.h"
 
 using namespace JavaTypes;
+using namespace JavaTypes::ConstantPoolRecords;
 
 void ConstantPool::print(std::ostream &Out) const {
   for (IndexType Idx = 1; Idx <= numRecords(); ++Idx) {
     Out << "#" << Idx << " = ";
-    get(Idx).print(Out);
+
+    switch (getTag(Idx)) {
+#define PRINT_RECORD(Name) \
+    case Tag::Name: getAs<Name>(Idx).print(Out); break;
+    PRINT_RECORD(Utf8)
+    PRINT_RECORD(NameAndType)
+    PRINT_RECORD(ClassInfo)
+    PRINT_RECORD(MethodRef)
+    PRINT_RECORD(FieldRef)
+    PRINT_RECORD(Integer)
+    PRINT_RECORD(Float)
+    PRINT_RECORD(Long)
+    PRINT_RECORD(Double)
+    PRINT_RECORD(Unusable)
+#undef PRINT_RECORD
+    case Tag::Empty:
+      assert(false); // constant pool is fully populated
+    }
   }
 }
@@ -3,6 +3,11 @@
 /// It is immutable and only way to construct it is by using the
 /// ConstantPoolBuilder class.
 ///
+/// Records are stored flat: one tag byte per cell and a fixed width payload
+/// slot per cell into which record is constructed in place. Type checks are
+/// simple tag comparisons and building a constant pool takes a constant
+/// number of allocations regardless of the number of records.
+///
 
 #ifndef ICP_CONSTANTPOOL_H
 #define ICP_CONSTANTPOOL_H
@@ -10,8 +15,12 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <new>
 #include <ostream>
-#include <typeinfo>
+#include <cassert>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
 
 namespace JavaTypes {
 
@@ -19,18 +28,34 @@ class ConstantPool;
 
 namespace ConstantPoolRecords {
 
-// Base abstract class for all constant pool records
+// Kind of the record stored in the constant pool cell.
+enum class Tag: uint8_t {
+  Empty = 0,
+  Utf8,
+  NameAndType,
+  ClassInfo,
+  MethodRef,
+  FieldRef,
+  Integer,
+  Float,
+  Long,
+  Double,
+  Unusable
+};
+
+// Base class for all constant pool records. Records live directly inside the
+// constant pool payload array and must be trivially destructible. Each record
+// type provides 'classof(Tag)' which is used for the type checks. Concrete
+// records additionally provide 'Kind' - tag which they are stored under.
 class Record {
 public:
-  virtual ~Record() = default;
-
   Record() = default;
 
   // No copying
   Record(const Record &) = delete;
   Record &operator=(const Record &) = delete;
 
-  virtual void print(std::ostream &) const = 0;
+  static constexpr bool classof(Tag T) { return T != Tag::Empty; }
 };
 
 }
@@ -40,10 +65,17 @@ public:
   typedef uint16_t IndexType;
   typedef uint16_t SizeType;
 
-  template<class T> using CellType = std::unique_ptr<T>;
-  template<class T> using CellReference = const CellType<T>&;
+  using Tag = ConstantPoolRecords::Tag;
+
+  // Records are referenced by plain pointers into the payload array. It is
+  // allocated once and never moves so it's safe to create such references
+  // before the record is constructed.
+  template<class T> using CellReference = const T*;
 
-  typedef std::vector<CellType<ConstantPoolRecords::Record>> RecordTable;
+  // Storage for one record. All records should fit into it.
+  struct alignas(8) PayloadSlot {
+    unsigned char Bytes[16];
+  };
 
 public:
   // Get record at the index 'Idx'.
@@ -51,9 +83,14 @@ public:
   //          exist.
   const ConstantPoolRecords::Record &get(IndexType Idx) const {
     assert(isValidIndex(Idx));
-    Idx = ConstantPool::toZeroBasedIndex(Idx);
-    assert(getRecordTable()[Idx] != nullptr);
-    return *getRecordTable()[Idx];
+    assert(getTag(Idx) != Tag::Empty);
+    return *recordAt<ConstantPoolRecords::Record>(toZeroBasedIndex(Idx));
+  }
+
+  // Get tag of the record at the index 'Idx'.
+  Tag getTag(IndexType Idx) const {
+    assert(isValidIndex(Idx));
+    return Tags[toZeroBasedIndex(Idx)];
   }
 
   // Get record at the index 'Idx' with a type 'RecordType'.
@@ -61,10 +98,8 @@ public:
   //          exist or has unexpected type.
   template<class RecordType>
   const RecordType &getAs(IndexType Idx) const {
-    const ConstantPoolRecords::Record &Res = get(Idx);
-    auto *TypedRes = dynamic_cast<const RecordType*>(&Res);
-    assert(TypedRes != nullptr);
-    return *TypedRes;
+    assert(isA<RecordType>(Idx));
+    return *recordAt<RecordType>(toZeroBasedIndex(Idx));
   }
 
   // Get record at the index 'Idx' with a type 'RecordType'.
@@ -73,11 +108,9 @@ public:
   // \returns Null pointer if record has unexpected type.
   template<class RecordType>
   const RecordType *getAsOrNull(IndexType Idx) const {
-    if (!isValidIndex(Idx))
+    if (!isA<RecordType>(Idx))
       return nullptr;
-
-    const ConstantPoolRecords::Record &Res = get(Idx);
-    return dynamic_cast<const RecordType*>(&Res);
+    return recordAt<RecordType>(toZeroBasedIndex(Idx));
   }
 
   // Checks if the record has given type.
@@ -87,13 +120,19 @@ public:
   bool isA(IndexType Idx) const {
     if (!isValidIndex(Idx))
       return false;
-    const auto &Res = get(Idx);
-    return dynamic_cast<const RecordType*>(&Res) != nullptr;
+    return RecordType::classof(Tags[toZeroBasedIndex(Idx)]);
+  }
+
+  // Finds index of the record which belongs to this constant pool.
+  IndexType indexOf(const ConstantPoolRecords::Record &Rec) const {
+    const auto *Slot = reinterpret_cast<const PayloadSlot*>(&Rec);
+    assert(Slot >= Payload.get() && Slot < Payload.get() + numRecords());
+    return static_cast<IndexType>(Slot - Payload.get() + 1);
   }
 
   // Get number of records (including dummy empty ones).
   SizeType numRecords() const {
-    return static_cast<SizeType>(getRecordTable().size());
+    return static_cast<SizeType>(Tags.size());
   }
 
   // Checks if index is valid index into this constant pool. Expects 1 based
@@ -111,12 +150,15 @@ public:
 
 private:
   // Only possible to construct through the ConstantPoolBuilder.
-  explicit ConstantPool(SizeType NumRecords): Records(NumRecords) {
+  explicit ConstantPool(SizeType NumRecords):
+      Tags(NumRecords, Tag::Empty),
+      Payload(new PayloadSlot[NumRecords]) {
     ;
   }
 
-  const RecordTable &getRecordTable() const {
-    return Records;
+  template<class T>
+  const T *recordAt(IndexType ZeroBasedIdx) const {
+    return std::launder(reinterpret_cast<const T*>(&Payload[ZeroBasedIdx]));
   }
 
   // Indexes used in the class file are 1 based, but internally we use
@@ -126,7 +168,8 @@ private:
   }
 
 private:
-  RecordTable Records;
+  std::vector<Tag> Tags;
+  std::unique_ptr<PayloadSlot[]> Payload;
 
   friend class ConstantPoolBuilder;
 };
@@ -141,20 +184,20 @@ public:
 public:
   using IndexType = ConstantPool::IndexType;
   using SizeType = ConstantPool::SizeType;
+  using Tag = ConstantPool::Tag;
 
-  template<class T> using CellType = ConstantPool::CellType<T>;
   template<class T> using CellReference = ConstantPool::CellReference<T>;
-  using RecordTable = ConstantPool::RecordTable;
 
-  // Check that type is a subtype of the Record, but not Record itself.
+  // Check that type is a concrete record which fits into the payload slot.
   template<class T> static constexpr bool IsCPRecord =
       std::is_base_of_v<ConstantPoolRecords::Record, T> &&
       !std::is_same_v<ConstantPoolRecords::Record, T>;
 
 public:
-  explicit ConstantPoolBuilder(SizeType NumRecords) {
-    TypeSpeculations.resize(NumRecords);
-    ConstantPoolUnderConstruction.reset(new ConstantPool(NumRecords));
+  explicit ConstantPoolBuilder(SizeType NumRecords):
+      ConstantPoolUnderConstruction(new ConstantPool(NumRecords)),
+      Assigned(NumRecords, false) {
+    ;
   }
 
   // Each invocation to this function registers a speculation on the data type
@@ -165,34 +208,32 @@ public:
     speculateCellType<T>(Idx);
 
     assert(isValid());
-    assert(isValidIndex(Idx));
-    Idx = ConstantPool::toZeroBasedIndex(Idx);
-
-    return reinterpret_cast<CellReference<T>>(getRecordTable()[Idx]);
+    return reinterpret_cast<CellReference<T>>(
+        &ConstantPoolUnderConstruction->Payload[
+            ConstantPool::toZeroBasedIndex(Idx)]);
   }
 
-  // If type of the cell is known this will check that we are assigning correct
-  // type.
+  // Constructs record of type 'T' in place. If type of the cell is known this
+  // will check that we are assigning correct type.
   // \throws IncompatibleCellType on error.
-  template<class T, class X = std::enable_if_t<IsCPRecord<T>>>
-  void set(IndexType Idx, CellType<T> &&NewRecord) {
-    speculateCellType<T>(Idx);
-
-    assert(isValid());
-    assert(isValidIndex(Idx));
-    Idx = ConstantPool::toZeroBasedIndex(Idx);
-
-    assert(getRecordTable()[Idx] == nullptr); // only assign once
-    getRecordTable()[Idx] = std::move(NewRecord);
-  }
-
-  // Helper wrapper to avoid typing redundant 'make_unique'
   template<
       class T,
       class... Ts,
       class X = std::enable_if_t<IsCPRecord<T>>>
   void create(IndexType Idx, Ts&&... Args) {
-    set(Idx, std::make_unique<T>(std::forward<Ts>(Args)...));
+    static_assert(sizeof(T) <= sizeof(ConstantPool::PayloadSlot));
+    static_assert(alignof(T) <= alignof(ConstantPool::PayloadSlot));
+    static_assert(std::is_trivially_destructible_v<T>);
+
+    speculateCellType<T>(Idx);
+
+    assert(isValid());
+    Idx = ConstantPool::toZeroBasedIndex(Idx);
+
+    assert(!Assigned[Idx]); // only assign once
+    new (&ConstantPoolUnderConstruction->Payload[Idx])
+        T(std::forward<Ts>(Args)...);
+    Assigned[Idx] = true;
   }
 
   // Check that constant pool is fully populated and creates it.
@@ -201,10 +242,8 @@ public:
     assert(isValid());
 
     // Check that we created all the records.
-    if (std::any_of(getRecordTable().begin(), getRecordTable().end(),
-          [] (const auto &Cell) { return Cell == nullptr; })) {
+    if (std::find(Assigned.begin(), Assigned.end(), false) != Assigned.end())
       assert(false);
-    }
 
     return std::move(ConstantPoolUnderConstruction);
   }
@@ -220,31 +259,27 @@ public:
   }
 
 private:
-  // Helper function intended to save some key typing.
-  RecordTable &getRecordTable() const {
-    return ConstantPoolUnderConstruction->Records;
-  }
-
   // Either records type speculation for the record at Idx or check that
-  // speculation is valid.
+  // speculation is valid. Speculations are stored directly in the tag array.
   // \throws IncompatibleCellType in case if speculation is not possible.
   template<class T>
   void speculateCellType(IndexType Idx) {
     assert(isValidIndex(Idx));
-    Idx = ConstantPool::toZeroBasedIndex(Idx);
+    Tag &Cur = ConstantPoolUnderConstruction->Tags[
+        ConstantPool::toZeroBasedIndex(Idx)];
 
-    if (TypeSpeculations[Idx] == nullptr) {
-      TypeSpeculations[Idx] = &typeid(T);
-    } else if (*TypeSpeculations[Idx] != typeid(T)) {
+    if (Cur == Tag::Empty) {
+      Cur = T::Kind;
+    } else if (Cur != T::Kind) {
       throw IncompatibleCellType(
-          "Wrong cell type at index " + std::to_string(Idx+1));
+          "Wrong cell type at index " + std::to_string(Idx));
     }
   }
 
 private:
   std::unique_ptr<ConstantPool> ConstantPoolUnderConstruction;
 
-  std::vector<const std::type_info*> TypeSpeculations;
+  std::vector<bool> Assigned;
 };
 
 }
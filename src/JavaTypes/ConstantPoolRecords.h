@@ -8,65 +8,83 @@
 #include "ConstantPool.h"
 
 #include "Utils/Utf8String.h"
+#include "Utils/Symbol.h"
+#include "JavaTypes/Type.h"
+#include "Runtime/Value.h"
 
 namespace JavaTypes {
 namespace ConstantPoolRecords {
 
 class Utf8 final: public Record {
 public:
-  explicit Utf8(Utf8String NewValue):
-      Value(std::move(NewValue)) {
+  static constexpr Tag Kind = Tag::Utf8;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
+  explicit Utf8(const Utf8String &NewValue):
+      Value(Utils::Symbol::intern(NewValue)) {
     ;
   }
 
-  const Utf8String &getValue() const {
+  explicit Utf8(Utils::Symbol NewValue):
+      Value(NewValue) {
+    assert(!Value.isNull());
+  }
+
+  Utils::Symbol getValue() const {
     return Value;
   }
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << "Utf8\t" << getValue() << "\n";
   }
 
 private:
-  const Utf8String Value;
+  const Utils::Symbol Value;
 };
 
 class NameAndType final: public Record {
 public:
+  static constexpr Tag Kind = Tag::NameAndType;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
   NameAndType(ConstantPool::CellReference<Utf8> NewNameRef,
               ConstantPool::CellReference<Utf8> NewDescriptorRef):
       NameRef(NewNameRef), DescriptorRef(NewDescriptorRef) {
     ;
   }
 
-  const Utf8String &getName() const {
+  Utils::Symbol getName() const {
     return NameRef->getValue();
   }
 
-  const Utf8String &getDescriptor() const {
+  Utils::Symbol getDescriptor() const {
     return DescriptorRef->getValue();
   }
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << "NameAndType\t" << getName() << " " << getDescriptor() << "\n";
   }
 
 private:
-  ConstantPool::CellReference<Utf8> NameRef, DescriptorRef;
+  ConstantPool::CellReference<Utf8> NameRef;
+  ConstantPool::CellReference<Utf8> DescriptorRef;
 };
 
 class ClassInfo final: public Record {
 public:
+  static constexpr Tag Kind = Tag::ClassInfo;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
   explicit ClassInfo(ConstantPool::CellReference<Utf8> NewName):
       Name(NewName) {
     ;
   }
 
-  const Utf8String &getName() const {
+  Utils::Symbol getName() const {
     return Name->getValue();
   }
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << "ClassInfo\t" << getName() << "\n";
   }
 
@@ -92,15 +110,15 @@ public:
     return *NameAndTypeRef;
   }
 
-  const Utf8String &getClassName() const {
+  Utils::Symbol getClassName() const {
     return getClass().getName();
   }
 
-  const Utf8String &getName() const {
+  Utils::Symbol getName() const {
     return getNameAndType().getName();
   }
 
-  const Utf8String &getDescriptor() const {
+  Utils::Symbol getDescriptor() const {
     return getNameAndType().getDescriptor();
   }
 
@@ -112,13 +130,16 @@ private:
 
 class MethodRef final: public _detail::RefRecord {
 public:
+  static constexpr Tag Kind = Tag::MethodRef;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
   MethodRef(ConstantPool::CellReference<ClassInfo> ClassRef,
             ConstantPool::CellReference<NameAndType> NameAndTypeRef) :
       RefRecord(ClassRef, NameAndTypeRef) {
     ;
   }
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << "MethodRef\t" << getClass().getName() << " " <<
         getNameAndType().getName() << " " << getNameAndType().getDescriptor()
         << "\n";
@@ -129,13 +150,16 @@ public:
 
 class FieldRef final: public _detail::RefRecord {
 public:
+  static constexpr Tag Kind = Tag::FieldRef;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
   FieldRef(ConstantPool::CellReference<ClassInfo> ClassRef,
            ConstantPool::CellReference<NameAndType> NameAndTypeRef) :
       RefRecord(ClassRef, NameAndTypeRef) {
     ;
   }
 
-  void print(std::ostream &Out) const override {
+  void print(std::ostream &Out) const {
     Out << "FieldRef\t" << getClass().getName() << " " <<
         getNameAndType().getName() << " " << getNameAndType().getDescriptor()
         << "\n";
@@ -144,6 +168,111 @@ public:
   // TODO: Add descriptor verification
 };
 
+// Common implementation of the numeric constants. Their runtime values are
+// materialized once when the constant pool is built, so that 'ldc' and
+// 'ConstantValue' users can use them directly.
+class NumericConstant: public Record {
+public:
+  static constexpr bool classof(Tag T) {
+    return T == Tag::Integer || T == Tag::Float ||
+           T == Tag::Long || T == Tag::Double;
+  }
+
+  const Runtime::Value &getValue() const { return Val; }
+
+  // Verification type of this constant.
+  Type getType() const {
+    if (Val.isA<Runtime::JavaInt>())
+      return Types::Int;
+    if (Val.isA<Runtime::JavaFloat>())
+      return Types::Float;
+    if (Val.isA<Runtime::JavaLong>())
+      return Types::Long;
+    assert(Val.isA<Runtime::JavaDouble>());
+    return Types::Double;
+  }
+
+protected:
+  explicit NumericConstant(Runtime::Value NewVal): Val(NewVal) {
+    ;
+  }
+
+private:
+  const Runtime::Value Val;
+};
+
+class Integer final: public NumericConstant {
+public:
+  static constexpr Tag Kind = Tag::Integer;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
+  explicit Integer(Runtime::JavaInt Val):
+      NumericConstant(Runtime::Value::create<Runtime::JavaInt>(Val)) {
+    ;
+  }
+
+  void print(std::ostream &Out) const {
+    Out << "Integer\t" << getValue() << "\n";
+  }
+};
+
+class Float final: public NumericConstant {
+public:
+  static constexpr Tag Kind = Tag::Float;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
+  explicit Float(Runtime::JavaFloat Val):
+      NumericConstant(Runtime::Value::create<Runtime::JavaFloat>(Val)) {
+    ;
+  }
+
+  void print(std::ostream &Out) const {
+    Out << "Float\t" << getValue() << "\n";
+  }
+};
+
+class Long final: public NumericConstant {
+public:
+  static constexpr Tag Kind = Tag::Long;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
+  explicit Long(Runtime::JavaLong Val):
+      NumericConstant(Runtime::Value::create<Runtime::JavaLong>(Val)) {
+    ;
+  }
+
+  void print(std::ostream &Out) const {
+    Out << "Long\t" << getValue() << "\n";
+  }
+};
+
+class Double final: public NumericConstant {
+public:
+  static constexpr Tag Kind = Tag::Double;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
+  explicit Double(Runtime::JavaDouble Val):
+      NumericConstant(Runtime::Value::create<Runtime::JavaDouble>(Val)) {
+    ;
+  }
+
+  void print(std::ostream &Out) const {
+    Out << "Double\t" << getValue() << "\n";
+  }
+};
+
+// Long and double constants take two constant pool entries. Second one is
+// valid but unusable, this record fills it in.
+class Unusable final: public Record {
+public:
+  static constexpr Tag Kind = Tag::Unusable;
+  static constexpr bool classof(Tag T) { return T == Kind; }
+
+  void print(std::ostream &Out) const {
+    Out << "Unusable\n";
+  }
+};
+
 }
 }
 
@@ -40,7 +40,7 @@ void JavaClass::print(std::ostream &Out) const {
     Method->print(Out);
 }
 
-const JavaMethod *JavaClass::getMethod(const std::string &Name) const {
+const JavaMethod *JavaClass::getMethod(Utils::Symbol Name) const {
   for (const auto &Method: methods()) {
     if (Method->getName() == Name)
       return Method.get();
@@ -48,3 +48,22 @@ const JavaMethod *JavaClass::getMethod(const std::string &Name) const {
 
   return nullptr;
 }
+
+const JavaMethod *JavaClass::getMethod(
+    Utils::Symbol Name, Utils::Symbol Descriptor) const {
+  for (const auto &Method: methods()) {
+    if (Method->getName() == Name && Method->getDescriptor() == Descriptor)
+      return Method.get();
+  }
+
+  return nullptr;
+}
+
+const JavaField *JavaClass::getField(Utils::Symbol Name) const {
+  for (const auto &Field: fields()) {
+    if (Field.getName() == Name)
+      return &Field;
+  }
+
+  return nullptr;
+}
@@ -3,7 +3,9 @@
 /// This class is intended to contain all information about single java class:
 /// i.e constant pool, methods, fields and so on. Essentially it represents
 /// parsed class file. Note that it's immutable and stores no runtime information
-/// like defining laoder and static field values.
+/// like defining laoder and static field values. The only exception is a link
+/// to such information of the class manager which defined it. Classes may be
+/// shared between class managers, but only one of them is linked at a time.
 ///
 
 #ifndef ICP_JAVACLASS_H
@@ -13,6 +15,9 @@
 #include "ConstantPoolRecords.h"
 #include "JavaMethod.h"
 #include "JavaField.h"
+#include "Runtime/RuntimeFwd.h"
+
+#include <atomic>
 
 namespace JavaTypes {
 
@@ -69,7 +74,7 @@ public:
     return *CP;
   }
 
-  const Utf8String &getClassName() const {
+  Utils::Symbol getClassName() const {
     assert(ClassName != nullptr);
     return ClassName->getName();
   }
@@ -88,16 +93,71 @@ public:
   // Finds method by name or return null if nothing found
   // It's a trivial getter. Fll resolutin logic is located inside ClassObject
   // and InstanceObject.
-  const JavaMethod *getMethod(const Utf8String &Name) const;
+  const JavaMethod *getMethod(Utils::Symbol Name) const;
+
+  // Same as above but also matches method descriptor.
+  const JavaMethod *getMethod(
+      Utils::Symbol Name, Utils::Symbol Descriptor) const;
+
+  // Finds field by name or returns null if nothing found.
+  const JavaField *getField(Utils::Symbol Name) const;
+
+  // Convenience overloads for the plain strings. Names which were never
+  // interned can't match anything.
+  const JavaMethod *getMethod(const Utf8String &Name) const {
+    return getMethod(Utils::Symbol::lookup(Name));
+  }
+  const JavaMethod *getMethod(
+      const Utf8String &Name, const Utf8String &Descriptor) const {
+    return getMethod(
+        Utils::Symbol::lookup(Name), Utils::Symbol::lookup(Descriptor));
+  }
+  const JavaField *getField(const Utf8String &Name) const {
+    return getField(Utils::Symbol::lookup(Name));
+  }
+  const JavaMethod *getMethod(const char *Name) const {
+    return getMethod(Utils::Symbol::lookup(Name));
+  }
+  const JavaField *getField(const char *Name) const {
+    return getField(Utils::Symbol::lookup(Name));
+  }
 
   // Only valid to call when there is super class
-  const Utf8String &getSuperClassName() const {
+  Utils::Symbol getSuperClassName() const {
     assert(hasSuper());
     return SuperClass->getName();
   }
 
   void print(std::ostream &Out) const;
 
+  // Runtime information of this class. Allows class manager to find it
+  // without any lookups. Never dereferences data of the other managers.
+  // \returns null if class is not linked to the given class manager.
+  Runtime::ClassMetaInfo *getMetaInfo(const Runtime::ClassManager &CM) const {
+    if (MetaOwner.load(std::memory_order_acquire) != &CM)
+      return nullptr;
+    return MetaInfo.load(std::memory_order_relaxed);
+  }
+
+  // Links runtime information of the given manager to this class.
+  // \returns false if class is already linked to some other manager.
+  bool tryLinkMetaInfo(
+      const Runtime::ClassManager &CM, Runtime::ClassMetaInfo &Info) const {
+    const Runtime::ClassManager *Expected = nullptr;
+    if (!MetaOwner.compare_exchange_strong(Expected, &CM))
+      return false;
+    MetaInfo.store(&Info, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Should be called before the linked manager is destroyed.
+  void unlinkMetaInfo(const Runtime::ClassManager &CM) const {
+    if (MetaOwner.load(std::memory_order_relaxed) != &CM)
+      return;
+    MetaInfo.store(nullptr, std::memory_order_relaxed);
+    MetaOwner.store(nullptr, std::memory_order_release);
+  }
+
 private:
   const ConstantPoolRecords::ClassInfo *const ClassName;
   // Null when no super class is present
@@ -110,6 +170,10 @@ private:
   const std::vector<std::unique_ptr<JavaMethod>> Methods;
 
   std::vector<JavaField> Fields;
+
+  // Runtime information is only valid for the manager stored in MetaOwner
+  mutable std::atomic<const Runtime::ClassManager*> MetaOwner = nullptr;
+  mutable std::atomic<Runtime::ClassMetaInfo*> MetaInfo = nullptr;
 };
 
 }
@@ -9,21 +9,30 @@ using namespace JavaTypes;
 JavaField::JavaField(
     const ConstantPoolRecords::Utf8 &Descr,
     const ConstantPoolRecords::Utf8 &Name,
-    JavaField::AccessFlags Flags):
+    JavaField::AccessFlags Flags,
+    const ConstantPoolRecords::NumericConstant *ConstantValue):
   Name(Name),
   Descr(Descr),
-  Flags(Flags)
+  Flags(Flags),
+  ConstantValue(ConstantValue)
 {
   assert(Flags != AccessFlags::ACC_NONE); // Flags should be specified
 
   T = Type::parseFieldDescriptor(Descr.getValue());
+
+  // Constant should be assignable to the field, i.e integer constant can
+  // initialize byte field but not the double one.
+  if (hasConstantValue() &&
+      Types::toStackType(T) != getConstantValue().getType())
+    throw Type::ParsingError(
+        "ConstantValue has incompatible type for field " + Name.getValue());
 }
 
-const std::string &JavaField::getName() const {
+Utils::Symbol JavaField::getName() const {
   return Name.getValue();
 }
 
-const std::string &JavaField::getDescriptor() const {
+Utils::Symbol JavaField::getDescriptor() const {
   return Descr.getValue();
 }
 
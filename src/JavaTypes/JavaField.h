@@ -11,6 +11,7 @@
 #include "ConstantPool.h"
 #include "ConstantPoolRecords.h"
 #include "Utils/Utf8String.h"
+#include "Utils/Symbol.h"
 
 namespace JavaTypes {
 
@@ -38,11 +39,14 @@ public:
   }
 
 public:
+  // \param ConstantValue Value of the 'ConstantValue' attribute or null if
+  // field doesn't have one.
   // \throws Type::ParsingError if unable to parse field descriptor
   JavaField(
       const ConstantPoolRecords::Utf8 &Descr,
       const ConstantPoolRecords::Utf8 &Name,
-      AccessFlags Flags);
+      AccessFlags Flags,
+      const ConstantPoolRecords::NumericConstant *ConstantValue = nullptr);
 
   // No copies
   JavaField(const JavaField &) = delete;
@@ -51,13 +55,22 @@ public:
   JavaField(JavaField &&) = default;
   JavaField &operator=(JavaField &&) = default;
 
-  const Utf8String &getName() const;
-  const Utf8String &getDescriptor() const;
+  Utils::Symbol getName() const;
+  Utils::Symbol getDescriptor() const;
   AccessFlags getFlags() const { return Flags; }
 
   Type getType() const;
 
   bool isStatic() const { return Flags & ACC_STATIC; }
+  bool isFinal() const { return Flags & ACC_FINAL; }
+
+  // Static final fields with the 'ConstantValue' attribute are initialized
+  // during preparation and never change afterwards.
+  bool hasConstantValue() const { return ConstantValue != nullptr; }
+  const ConstantPoolRecords::NumericConstant &getConstantValue() const {
+    assert(hasConstantValue());
+    return *ConstantValue;
+  }
 
   // Return size of this fields in bytes
   std::size_t getSize() const;
@@ -66,6 +79,7 @@ private:
   const ConstantPoolRecords::Utf8 &Name;
   const ConstantPoolRecords::Utf8 &Descr;
   AccessFlags Flags;
+  const ConstantPoolRecords::NumericConstant *ConstantValue;
 
   Type T = Types::Void;
 };
@@ -3,6 +3,10 @@
 ///
 
 #include "JavaMethod.h"
+#include "JavaClass.h"
+#include "Bytecode/Instructions.h"
+
+#include <thread>
 
 using namespace JavaTypes;
 using namespace Bytecode;
@@ -21,22 +25,123 @@ JavaMethod::JavaMethod(JavaMethod::MethodConstructorParameters &&Params) :
     Descriptor(checkRecord(Params.Descriptor)),
     MaxStack(Params.MaxStack),
     MaxLocals(Params.MaxLocals),
+    LazyBody(std::move(Params.LazyBody)),
     CodeOwner(std::move(Params.Code)),
     StackMapBuilder(std::move(Params.StackMapBuilder))
 {
-  // Fill code viewer
+  // Lazy methods get their code later
+  assert(!LazyBody || CodeOwner.empty());
+
+  // Other flags are not supported currently
+  const auto VisibilityFlags = static_cast<AccessFlags>(
+      static_cast<uint16_t>(getAccessFlags()) &
+      ~static_cast<uint16_t>(
+          AccessFlags::ACC_NATIVE | AccessFlags::ACC_SYNCHRONIZED));
+  assert(
+      VisibilityFlags == AccessFlags::ACC_PUBLIC ||
+      VisibilityFlags == AccessFlags::ACC_STATIC ||
+      VisibilityFlags == AccessFlags::ACC_PUBLIC_STATIC);
+  (void)VisibilityFlags;
+
+  // Native methods have no code
+  assert(!isNative() || (CodeOwner.empty() && !LazyBody));
+}
+
+void JavaMethod::buildCodeViewer() const {
   BciType cur_bci = 0;
   for (auto &Inst: CodeOwner) {
-    assert(Inst != nullptr);
-    this->Code.insert_back(cur_bci, Inst.get());
-    cur_bci += Inst->getLength();
+    this->Code.insert_back(cur_bci, &Inst);
+    cur_bci += Inst.getLength();
   }
+}
 
-  // Other flags are not supported currently
-  assert(
-      getAccessFlags() == AccessFlags::ACC_PUBLIC ||
-      getAccessFlags() == AccessFlags::ACC_STATIC ||
-      getAccessFlags() == AccessFlags::ACC_PUBLIC_STATIC);
+void JavaMethod::materializeSlow() const {
+  // If loader throws, flag is not set and next caller will try again
+  std::call_once(MaterializeOnce, [this]() {
+    if (LazyBody) {
+      auto Body = LazyBody();
+      CodeOwner = std::move(Body.Code);
+      StackMapBuilder = std::move(Body.StackMapBuilder);
+      // Release everything captured by the loader
+      LazyBody = nullptr;
+    }
+
+    buildCodeViewer();
+    // Standalone methods (i.e in tests) have nothing to fold
+    if (Owner != nullptr)
+      foldConstantFields();
+
+    Materialized.store(true, std::memory_order_release);
+  });
+}
+
+void JavaMethod::verifyOnceSlow(void (*Verify)(const JavaMethod &)) const {
+  auto State = Verification.load(std::memory_order_acquire);
+  while (true) {
+    switch (State) {
+    case VerificationState::VERIFIED:
+      return;
+
+    case VerificationState::FAILED:
+      std::rethrow_exception(VerificationFailure);
+
+    case VerificationState::IN_PROGRESS:
+      // Single method is verified quickly, no need for anything smarter
+      std::this_thread::yield();
+      State = Verification.load(std::memory_order_acquire);
+      break;
+
+    case VerificationState::UNVERIFIED:
+      // On failure 'State' receives the current value
+      if (!Verification.compare_exchange_weak(
+              State, VerificationState::IN_PROGRESS,
+              std::memory_order_acquire))
+        break;
+
+      try {
+        Verify(*this);
+      } catch (...) {
+        VerificationFailure = std::current_exception();
+        Verification.store(
+            VerificationState::FAILED, std::memory_order_release);
+        throw;
+      }
+
+      Verification.store(
+          VerificationState::VERIFIED, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+void JavaMethod::foldConstantFields() const {
+  const auto &Class = getOwner();
+  const auto &CP = Class.getConstantPool();
+
+  // Instructions are replaced in place so code viewer stays valid.
+  for (auto &Inst: CodeOwner) {
+    // Only fields of the current class are folded. This is always safe since
+    // they are either initialized or being initialized by this thread.
+    const auto GetStatic = Inst.getAsOrNull<getstatic>();
+    const auto *FRef = GetStatic ?
+        CP.getAsOrNull<ConstantPoolRecords::FieldRef>(GetStatic->getIdx()) :
+        nullptr;
+    const auto *Field = (FRef && FRef->getClassName() == Class.getClassName()) ?
+        Class.getField(FRef->getName()) : nullptr;
+
+    if (Field && Field->isFinal() && Field->hasConstantValue() &&
+        Field->getDescriptor() == FRef->getDescriptor()) {
+      const auto &Const = Field->getConstantValue();
+      const auto ConstIdx = CP.indexOf(Const);
+
+      if (Types::sizeOf(Const.getType()) == 2)
+        Inst = Instruction::create<ldc2_w>(ConstIdx);
+      else
+        Inst = Instruction::create<ldc_w>(ConstIdx);
+      static_assert(getstatic::Length == ldc_w::Length);
+      static_assert(getstatic::Length == ldc2_w::Length);
+    }
+  }
 }
 
 void JavaMethod::print(std::ostream &Out) const {
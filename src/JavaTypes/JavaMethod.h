@@ -13,21 +13,23 @@
 #include "StackMapTable.h"
 #include "Bytecode/BciMap.h"
 
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+
 namespace JavaTypes {
 
 class JavaClass;
 
 class JavaMethod final {
 public:
-  using CodeOwnerType =
-    std::vector<std::unique_ptr<Bytecode::Instruction>>;
-
-  // We want to expose BciMap iterator to the user.
-  // However we also want to store instructions as a unique pointers which
-  // shouldn't be exposed to the user. In order to achieve this we use separate
-  // "code viewer" which mirrors code owner but doesn't store unique pointers.
-  // So far it's the simplest solution without introducing hard to understand
-  // iterator nesting.
+  using CodeOwnerType = std::vector<Bytecode::Instruction>;
+
+  // We want to expose BciMap iterator to the user. Instructions are stored
+  // by value in the code owner and the "code viewer" maps bci's to them.
+  // Code owner is never resized after the viewer is built, so the pointers
+  // stay valid.
   using CodeViewerType = Bytecode::BciMap<Bytecode::Instruction*>;
   using CodeIterator = CodeViewerType::const_iterator;
 
@@ -61,6 +63,13 @@ public:
   }
 
 
+  // Decoded method code. Might be produced lazily on the first use.
+  struct MethodBody {
+    CodeOwnerType Code;
+    StackMapTableBuilder StackMapBuilder;
+  };
+  using BodyLoaderType = std::function<MethodBody()>;
+
   // This is only to simplify constructor parameter list. No additional
   // semantic meaning is implied.
   struct MethodConstructorParameters {
@@ -75,6 +84,10 @@ public:
     CodeOwnerType Code; // This is plain unparsed bytecode
 
     StackMapTableBuilder StackMapBuilder;
+
+    // If specified Code and StackMapBuilder should be empty. Body will be
+    // loaded when it's first needed.
+    BodyLoaderType LazyBody;
   };
 
 public:
@@ -87,10 +100,10 @@ public:
   JavaMethod(JavaMethod&&) = delete;
   JavaMethod &operator=(JavaMethod &&) = delete;
 
-  const Utf8String &getName() const {
+  Utils::Symbol getName() const {
     return Name.getValue();
   }
-  const Utf8String &getDescriptor() const {
+  Utils::Symbol getDescriptor() const {
     return Descriptor.getValue();
   }
 
@@ -109,7 +122,14 @@ public:
     Owner = &NewOwner;
   }
 
-  const StackMapTableBuilder &getStackMapBuilder() const { return StackMapBuilder; }
+  // All code accessors below materialize the method body if it's lazy.
+  // This is thread safe and happens only once.
+  // \throws Whatever body loader throws, i.e ClassFileReader::FormatError.
+
+  const StackMapTableBuilder &getStackMapBuilder() const {
+    materialize();
+    return StackMapBuilder;
+  }
 
   CodeIterator getInstrAtOffset(
       CodeIterator It, Bytecode::BciOffsetType Off) const {
@@ -117,17 +137,72 @@ public:
   }
 
   // Support ranged-for iteration over instructions.
-  CodeIterator begin() const { return CodeIterator(Code.cbegin()); }
-  CodeIterator end() const { return CodeIterator(Code.cend()); }
+  CodeIterator begin() const {
+    materialize();
+    return CodeIterator(Code.cbegin());
+  }
+  CodeIterator end() const {
+    materialize();
+    return CodeIterator(Code.cend());
+  }
 
   Bytecode::BciType numInstructions() const {
+    materialize();
     return static_cast<Bytecode::BciType>(Code.size());
   }
 
+  // Checks if method body was already decoded
+  bool isMaterialized() const {
+    return Materialized.load(std::memory_order_acquire);
+  }
+
+  // Checks if method was verified by the 'verifyOnce'
+  bool isVerified() const {
+    return Verification.load(std::memory_order_acquire) ==
+           VerificationState::VERIFIED;
+  }
+
+  // Runs 'Verify' on this method unless it was already done. Only one of the
+  // concurrent callers runs it, others wait for the result. Failure is
+  // remembered and the same error is rethrown to every caller.
+  // \throws Whatever 'Verify' throws.
+  void verifyOnce(void (*Verify)(const JavaMethod &)) const {
+    if (!isVerified())
+      verifyOnceSlow(Verify);
+  }
+
   bool isStatic() const { return Flags & AccessFlags::ACC_STATIC; }
+  // Native methods have no code, their implementation is bound at link time.
+  bool isNative() const { return Flags & AccessFlags::ACC_NATIVE; }
+  bool isSynchronized() const {
+    return Flags & AccessFlags::ACC_SYNCHRONIZED;
+  }
 
   void print(std::ostream &Out) const;
 
+private:
+  // Decodes method body if it wasn't done yet. Owner should be set before
+  // that, otherwise constants are not folded.
+  void materialize() const {
+    if (!isMaterialized())
+      materializeSlow();
+  }
+  void materializeSlow() const;
+
+  void verifyOnceSlow(void (*Verify)(const JavaMethod &)) const;
+
+  // Fills code viewer from the code owner
+  void buildCodeViewer() const;
+
+  // Replaces 'getstatic' of the owner's static final fields which have
+  // constant value with the direct load of that constant. Expects owner to be
+  // already set. Replacement has the same length so bci's are not affected.
+  void foldConstantFields() const;
+
+  enum class VerificationState: uint8_t {
+    UNVERIFIED, IN_PROGRESS, VERIFIED, FAILED
+  };
+
 private:
   const JavaClass *Owner;
 
@@ -139,10 +214,20 @@ private:
   const uint16_t MaxStack;
   const uint16_t MaxLocals;
 
-  CodeOwnerType CodeOwner;
-  CodeViewerType Code;
+  // Body is logically const, it's just computed on demand
+  mutable BodyLoaderType LazyBody;
+  mutable std::once_flag MaterializeOnce;
+  mutable std::atomic<bool> Materialized{false};
+
+  mutable CodeOwnerType CodeOwner;
+  mutable CodeViewerType Code;
+
+  mutable StackMapTableBuilder StackMapBuilder;
 
-  StackMapTableBuilder StackMapBuilder;
+  mutable std::atomic<VerificationState> Verification{
+      VerificationState::UNVERIFIED};
+  // Written before the state becomes FAILED
+  mutable std::exception_ptr VerificationFailure;
 };
 
 }
@@ -4,8 +4,53 @@
 
 #include "StackFrame.h"
 
+#if defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
 using namespace JavaTypes;
 
+// Finds first index starting from 'Idx' at which encodings of the types differ.
+// Most of the frames match slot by slot, so this is the fast path for all
+// frame comparisons. Differing slots might still be equal or assignable,
+// callers check them one by one.
+// \returns Index of the mismatch or 'Size' if there is none.
+static std::size_t findMismatch(
+    const Type *A, const Type *B, std::size_t Idx, std::size_t Size) {
+
+#if defined(__SSE2__)
+  static_assert(sizeof(Type) == 4);
+  for (; Size - Idx >= 4; Idx += 4) {
+    const __m128i VA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(A + Idx));
+    const __m128i VB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(B + Idx));
+    // One bit per byte, 0xffff if all four types are the same
+    const auto Mask = static_cast<unsigned>(
+        _mm_movemask_epi8(_mm_cmpeq_epi32(VA, VB)));
+    if (Mask != 0xffff)
+      return Idx + static_cast<std::size_t>(__builtin_ctz(~Mask)) / 4;
+  }
+#endif
+
+  for (; Idx < Size; ++Idx) {
+    if (A[Idx].getBits() != B[Idx].getBits())
+      return Idx;
+  }
+  return Size;
+}
+
+// Checks that each of the 'From' types is assignable to the corresponding
+// 'To' type. Both ranges have 'Size' elements.
+template<class Pred>
+static bool allSlots(
+    const Type *From, const Type *To, std::size_t Size, Pred Check) {
+  for (auto Idx = findMismatch(From, To, 0, Size); Idx < Size;
+       Idx = findMismatch(From, To, Idx + 1, Size)) {
+    if (!Check(From[Idx], To[Idx]))
+      return false;
+  }
+  return true;
+}
+
 void StackFrame::computeFlags() {
   // Look for uninitializedThis in locals
   Flags = std::any_of(
@@ -16,27 +61,37 @@ void StackFrame::computeFlags() {
 }
 
 // Helper method which correctly pushes single expanded type
-static void pushExpanded(std::vector<Type> &Ret, const Type &T) {
+static void pushExpanded(StackFrame::Storage &Ret, const Type &T) {
   Ret.push_back(T);
   if (Types::sizeOf(T) == 2)
     Ret.push_back(Types::Top);
 }
 
+void StackFrame::chopLocals(std::size_t Count) {
+  for (; Count != 0 && !locals().empty(); --Count) {
+    const auto Last = locals().size() - 1;
+    const bool TwoWord = Last > 0 && locals()[Last] == Types::Top &&
+                         Types::sizeOf(locals()[Last - 1]) == 2;
+
+    locals().pop_back();
+    if (TwoWord)
+      locals().pop_back();
+  }
+
+  computeFlags();
+}
+
 bool StackFrame::isTwoWordType(std::size_t Idx) const {
   return Idx >= 1 &&
          stack()[Idx] == Types::Top &&
          Types::sizeOf(stack()[Idx - 1]) == 2;
 }
 
-std::vector<Type> StackFrame::expandTypes(const std::vector<Type> &Src) {
-  std::vector<Type> Ret;
-
-  Ret.reserve(Src.size());
+void StackFrame::expandTypes(TypeList Src, Storage &Dst) {
+  Dst.reserve(Dst.size() + Src.size());
   for (const auto &T: Src) {
-    pushExpanded(Ret, T);
+    pushExpanded(Dst, T);
   }
-
-  return Ret;
 }
 
 void StackFrame::pop() {
@@ -78,7 +133,7 @@ std::optional<Type> StackFrame::popMatchingType(const JavaTypes::Type &T) {
   return actual_type;
 }
 
-bool StackFrame::popMatchingList(const std::vector<Type> &Types) {
+bool StackFrame::popMatchingList(TypeList Types) {
   if (stack().empty())
     return Types.empty();
 
@@ -121,16 +176,13 @@ bool StackFrame::verifyTypeEncoding() {
   return CheckVector(locals()) && CheckVector(stack());
 }
 
-void StackFrame::pushList(const std::vector<Type> &Types) {
-  const auto ExpandedTypes = expandTypes(Types);
-
-  stack().insert(stack().end(), ExpandedTypes.begin(), ExpandedTypes.end());
+void StackFrame::pushList(TypeList Types) {
+  expandTypes(Types, stack());
 
   assert(verifyTypeEncoding());
 }
 
-bool StackFrame::doTypeTransition(
-    const std::vector<Type> &ToPop, Type ToPush) {
+bool StackFrame::doTypeTransition(TypeList ToPop, Type ToPush) {
 
   // Pop operands
   if (!popMatchingList(ToPop))
@@ -161,39 +213,42 @@ void StackFrame::setLocal(std::size_t Idx, Type T) {
   assert(verifyTypeEncoding());
 }
 
-bool StackFrame::isAssignable(const StackFrame &From, const StackFrame &To) {
-  // Early return on trivial case.
-  if (From == To)
-    return true;
+bool StackFrame::operator==(const StackFrame &Other) const {
+  if (numStack() != Other.numStack() || numLocals() != Other.numLocals())
+    return false;
+
+  auto Equal = [](const Type &A, const Type &B) { return A == B; };
+  return allSlots(
+             stack().data(), Other.stack().data(), numStack(), Equal) &&
+         allSlots(
+             locals().data(), Other.locals().data(), numLocals(), Equal);
+}
 
+bool StackFrame::isAssignable(const StackFrame &From, const StackFrame &To) {
   // Stack sized should match.
   if (From.numStack() != To.numStack())
     return false;
 
-  // Stacks should be assignable.
-  auto to_stack = To.stack().begin();
-  for (const auto &from_stack: From.stack()) {
-    if (!Types::isAssignable(from_stack, *to_stack))
-      return false;
-    ++to_stack;
-  }
+  // Stacks should be assignable. Equal slots are skipped with the vector
+  // compare, only the remaining ones go through the subtyping check.
+  if (!allSlots(From.stack().data(), To.stack().data(), From.numStack(),
+                Types::isAssignable))
+    return false;
 
   // Locals should be assignable but can have different lengths.
   // Unexistent elements are considered as Top type according with the spec.
-  auto to_locals = To.locals().begin();
-  auto to_locals_end = To.locals().end();
-  auto from_locals = From.locals().begin();
-  auto from_locals_end = From.locals().end();
-
-  while (to_locals != to_locals_end || from_locals != from_locals_end) {
-    Type to_type = to_locals == to_locals_end ? Types::Top : *to_locals;
-    Type from_type = from_locals == from_locals_end ? Types::Top : *from_locals;
+  const auto Common = std::min(From.numLocals(), To.numLocals());
+  if (!allSlots(From.locals().data(), To.locals().data(), Common,
+                Types::isAssignable))
+    return false;
 
-    if (!Types::isAssignable(from_type, to_type))
+  for (auto Idx = Common; Idx < From.numLocals(); ++Idx) {
+    if (!Types::isAssignable(From.locals()[Idx], Types::Top))
+      return false;
+  }
+  for (auto Idx = Common; Idx < To.numLocals(); ++Idx) {
+    if (!Types::isAssignable(Types::Top, To.locals()[Idx]))
       return false;
-
-    if (to_locals != to_locals_end) ++to_locals;
-    if (from_locals != from_locals_end) ++from_locals;
   }
 
   // All checks have passed.
@@ -208,7 +263,7 @@ bool StackFrame::transformInto(const StackFrame &NextFrame) {
   if (!StackFrame::isAssignable(*this, NextFrame))
     return false;
 
-  // Frames are assignable, do the transformation.
+  // Frames are assignable, do the transformation. Storage is reused.
   locals() = NextFrame.locals();
   stack() = NextFrame.stack();
   computeFlags();
@@ -8,10 +8,12 @@
 #define ICP_STACKFRAME_H
 
 #include "JavaTypes/Type.h"
+#include "Utils/SmallVector.h"
 
 #include <vector>
 #include <stack>
 #include <algorithm>
+#include <optional>
 
 namespace JavaTypes {
 
@@ -20,14 +22,18 @@ namespace JavaTypes {
 // Internally two word types are encoded as pairs of (Actual type, Types::Top)
 // This is strictly internal format and all input data is expected to be in a
 // regular form (i.e two-word types are stored as a single element)
+// Locals and stack are kept in the inline buffers. Verifier reserves them
+// according to the method limits, so that no allocations happen afterwards.
 class StackFrame final {
 public:
-  StackFrame(
-      const std::vector<JavaTypes::Type> &Locals,
-      const std::vector<JavaTypes::Type> &Stack)
-  {
-    this->Locals = expandTypes(Locals);
-    this->Stack = expandTypes(Stack);
+  // Most methods have only a few locals and stack slots
+  static constexpr std::size_t InlineSlots = 8;
+  using Storage = Utils::SmallVector<Type, InlineSlots>;
+
+public:
+  StackFrame(TypeList Locals, TypeList Stack) {
+    expandTypes(Locals, this->Locals);
+    expandTypes(Stack, this->Stack);
     computeFlags();
     assert(verifyTypeEncoding());
   }
@@ -37,16 +43,50 @@ public:
   StackFrame(StackFrame &&) = default;
   StackFrame &operator=(StackFrame &&)  = default;
 
+  // Preallocates storage, so that the frame can grow up to the given limits
+  // without allocations. Expects limits in slots.
+  void reserve(std::size_t MaxLocals, std::size_t MaxStack) {
+    Locals.reserve(MaxLocals);
+    Stack.reserve(MaxStack);
+  }
+
+  // Removes all locals and stack slots, keeps the storage.
+  void clear() {
+    Locals.clear();
+    Stack.clear();
+    Flags = false;
+  }
+
+  // Replaces contents of this frame with the new types. Storage is reused.
+  void assign(TypeList NewLocals, TypeList NewStack) {
+    clear();
+    expandTypes(NewLocals, Locals);
+    expandTypes(NewStack, Stack);
+    computeFlags();
+    assert(verifyTypeEncoding());
+  }
+
+  // Adds new locals after the existing ones.
+  void appendLocals(TypeList NewLocals) {
+    expandTypes(NewLocals, Locals);
+    computeFlags();
+    assert(verifyTypeEncoding());
+  }
+
+  // Removes 'Count' last locals, two word locals are removed as a whole.
+  // Stops early if there are no locals left.
+  void chopLocals(std::size_t Count);
+
+  void clearStack() { Stack.clear(); }
+
   void resizeLocals(std::size_t NewSize) {
     if (NewSize <= locals().size())
       return;
 
-    locals().insert(locals().end(), NewSize - locals().size(), Types::Top);
+    locals().resize(NewSize, Types::Top);
   }
 
-  bool operator==(const StackFrame &Other) const {
-    return stack() == Other.stack() && locals() == Other.locals();
-  }
+  bool operator==(const StackFrame &Other) const;
   bool operator!=(const StackFrame &Other) const { return !(*this == Other); }
 
   // Returns true if locals have uninitialized this flag
@@ -92,18 +132,17 @@ public:
   // First type in the list is popped first. No special encoding of two-word
   // types is expected (i.e they are stored as a single element).
   // \returns true if all types were popped, false otherwise.
-  bool popMatchingList(const std::vector<JavaTypes::Type> &Types);
+  bool popMatchingList(TypeList Types);
 
   // Push types onto the frame stack.
-  void pushList(const std::vector<JavaTypes::Type> &Types);
+  void pushList(TypeList Types);
 
   // Pops 'ToPop' types then pushes 'ToPush' type.
   // This is primitive for modeling instruction behaviour which takes some
   // operands from stack and pushes the result back.
   // If some types are incompatible whole function is a no-op.
   // \returns true if type transition was successfull, false otherwise.
-  bool doTypeTransition(
-      const std::vector<JavaTypes::Type> &ToPop, JavaTypes::Type ToPush);
+  bool doTypeTransition(TypeList ToPop, JavaTypes::Type ToPush);
 
   // Checks if we can assign this stack from into the 'NextFrame'.
   static bool isAssignable(const StackFrame &From, const StackFrame &To);
@@ -120,17 +159,16 @@ private:
 
   // Expands each TwoWord type into the two consequential slots:
   //   (Actual type, Types::Top)
-  // \returns New vector with expanded types.
-  static std::vector<JavaTypes::Type> expandTypes(
-      const std::vector<JavaTypes::Type> &Src);
+  // and appends them to the 'Dst'.
+  static void expandTypes(TypeList Src, Storage &Dst);
 
   // Private accessors for the locals and stack.
   // This class internally maintains "expanded type" encoding so the user should
   // not be exposed to this plain containers.
-  const std::vector<Type> &locals() const { return Locals; }
-  std::vector<Type> &locals() { return Locals; }
-  const std::vector<Type> &stack() const { return Stack; }
-  std::vector<Type> &stack() { return Stack; }
+  const Storage &locals() const { return Locals; }
+  Storage &locals() { return Locals; }
+  const Storage &stack() const { return Stack; }
+  Storage &stack() { return Stack; }
 
   // Unconditionally pop from the stack. Preserves type encoding (i.e pops two
   // elements for the two word type).
@@ -146,9 +184,9 @@ private:
   bool isTwoWordType(std::size_t Idx) const;
 
 private:
-  std::vector<Type> Locals;
-  std::vector<Type> Stack;
-  bool Flags; // true if any of the locals is uninitializedThis
+  Storage Locals;
+  Storage Stack;
+  bool Flags = false; // true if any of the locals is uninitializedThis
 };
 
 }
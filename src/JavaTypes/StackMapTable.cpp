@@ -4,6 +4,8 @@
 
 #include "StackMapTable.h"
 
+#include <algorithm>
+
 using namespace JavaTypes;
 
 void StackMapTableBuilder::addAppend(
@@ -29,6 +31,24 @@ void StackMapTableBuilder::addFull(
       Action::FULL, std::move(Locals), std::move(Stack));
 }
 
+void StackMapTableBuilder::addChop(
+    Bytecode::BciType Idx, std::size_t NumLocals) {
+
+  assert(checkBciMonotonic(Idx));
+  actions().emplace_back(Idx,
+      Action::CHOP, std::vector<Type>(NumLocals, Types::Top),
+      std::vector<Type>());
+}
+
+void StackMapTableBuilder::addSameLocalsOneStack(
+    Bytecode::BciType Idx, Type StackItem) {
+
+  assert(checkBciMonotonic(Idx));
+  actions().emplace_back(Idx,
+      Action::SAME_LOCALS_ONE_STACK, std::vector<Type>(),
+      std::vector<Type>{StackItem});
+}
+
 bool StackMapTableBuilder::checkBciMonotonic(Bytecode::BciType Idx) {
   if (actions().empty())
     return true;
@@ -37,37 +57,141 @@ bool StackMapTableBuilder::checkBciMonotonic(Bytecode::BciType Idx) {
   return Idx > last_index;
 }
 
-void StackMapTableBuilder::transformFrame(RawFrame &Frame, const Action &Act) {
+void StackMapTableBuilder::transformFrame(
+    StackFrame &Frame, const Action &Act) {
   switch (Act.FrameType) {
   case Action::SAME:
     // Noting to be done.
     return;
   case Action::FULL:
-    Frame.first = Act.Locals;
-    Frame.second = Act.Stack;
+    Frame.assign(Act.Locals, Act.Stack);
     return;
   case Action::APPEND:
-    Frame.first.insert(Frame.first.end(), Act.Locals.begin(), Act.Locals.end());
-    Frame.second.clear();
+    Frame.appendLocals(Act.Locals);
+    Frame.clearStack();
+    return;
+  case Action::CHOP:
+    Frame.chopLocals(Act.Locals.size());
+    Frame.clearStack();
+    return;
+  case Action::SAME_LOCALS_ONE_STACK:
+    Frame.clearStack();
+    Frame.pushList(Act.Stack);
     return;
   }
 
   assert(false); // all actions should be implemented
 }
 
-StackMapTable StackMapTableBuilder::createTable(
-    const std::vector<Type> &InitialLocals) const {
-
+StackMapTable StackMapTableBuilder::createTable(TypeList InitialLocals) const {
   StackMapTable::Container materialized_frames;
 
-  // Use raw frames to avoid type expansion.
-  RawFrame cur_frame_raw{InitialLocals, {}};
-
-  for (const auto &act: actions()) {
-    transformFrame(cur_frame_raw, act);
-    materialized_frames.emplace_back(
-        act.Bci, StackFrame(cur_frame_raw.first, cur_frame_raw.second));
+  for (StackMapCursor Cursor(*this, InitialLocals);
+       !Cursor.atEnd(); Cursor.advance()) {
+    materialized_frames.emplace_back(Cursor.getBci(), Cursor.getFrame());
   }
 
   return StackMapTable(std::move(materialized_frames));
 }
+
+StackMapCursor::StackMapCursor(
+    const StackMapTableBuilder &Builder, TypeList InitialLocals) :
+    Actions(&Builder.actions()),
+    Initial(InitialLocals, {}) {
+
+  if (atEnd())
+    return;
+
+  Current = Initial;
+  StackMapTableBuilder::transformFrame(Current, (*Actions)[Pos]);
+}
+
+void StackMapCursor::reserve(std::size_t MaxLocals, std::size_t MaxStack) {
+  Current.reserve(MaxLocals, MaxStack);
+  Scratch.reserve(MaxLocals, MaxStack);
+  for (auto &CP: Checkpoints)
+    CP.Frame.reserve(MaxLocals, MaxStack);
+}
+
+void StackMapCursor::advance() {
+  assert(!atEnd());
+
+  ++Pos;
+  if (!atEnd())
+    StackMapTableBuilder::transformFrame(Current, (*Actions)[Pos]);
+}
+
+void StackMapCursor::recordCheckpoint(
+    std::size_t Idx, const StackFrame &Frame) {
+  if (Idx % CheckpointInterval != 0)
+    return;
+  for (const auto &CP: Checkpoints) {
+    if (CP.Pos == Idx)
+      return;
+  }
+
+  // Oldest one is replaced, copy reuses the storage
+  auto &CP = Checkpoints[NextCheckpoint];
+  CP.Pos = Idx;
+  CP.Frame = Frame;
+  NextCheckpoint = (NextCheckpoint + 1) % NumCheckpoints;
+}
+
+const StackFrame *StackMapCursor::findAtBci(Bytecode::BciType Bci) {
+  if (Actions == nullptr)
+    return nullptr;
+
+  // Actions are sorted by bci
+  const auto It = std::lower_bound(
+      Actions->begin(), Actions->end(), Bci,
+      [](const Action &Act, Bytecode::BciType Val) { return Act.Bci < Val; });
+  if (It == Actions->end() || It->Bci != Bci)
+    return nullptr;
+
+  const auto Target = static_cast<std::size_t>(It - Actions->begin());
+  if (Target == Pos)
+    return &Current;
+  if (ScratchPos == Target)
+    return &Scratch;
+
+  // Find the closest known frame before the target. Null means initial one.
+  const StackFrame *Start = nullptr;
+  std::size_t From = 0;
+  auto Consider = [&](std::size_t Idx, const StackFrame &Frame) {
+    if (Idx < Target && (Start == nullptr || Idx + 1 > From)) {
+      Start = &Frame;
+      From = Idx + 1;
+    }
+  };
+
+  for (const auto &CP: Checkpoints) {
+    if (CP.Pos)
+      Consider(*CP.Pos, CP.Frame);
+  }
+  if (!atEnd())
+    Consider(Pos, Current);
+  if (ScratchPos)
+    Consider(*ScratchPos, Scratch);
+
+  // Full frame doesn't depend on the previous ones
+  for (auto Idx = Target + 1; Idx > From; --Idx) {
+    if ((*Actions)[Idx - 1].FrameType == Action::FULL) {
+      Start = &Scratch;
+      From = Idx - 1;
+      break;
+    }
+  }
+
+  if (Start == nullptr)
+    Scratch = Initial;
+  else if (Start != &Scratch)
+    Scratch = *Start;
+
+  for (auto Idx = From; Idx <= Target; ++Idx) {
+    StackMapTableBuilder::transformFrame(Scratch, (*Actions)[Idx]);
+    recordCheckpoint(Idx, Scratch);
+  }
+  ScratchPos = Target;
+
+  return &Scratch;
+}
@@ -1,9 +1,10 @@
 ///
 /// Representation of the stack map table for the method.
 /// User should first create "StackMapTableBuilder", populate it with the
-/// desired building instructions and then create new "StackMapTable" based
-/// on the set of method's initial arguments. This is designed in order to
-/// better fit the JVM view of the stack maps.
+/// desired building instructions and then either walk the frames with the
+/// "StackMapCursor" or create new "StackMapTable" based on the set of
+/// method's initial arguments. This is designed in order to better fit the
+/// JVM view of the stack maps.
 ///
 
 #ifndef ICP_STACKMAPTABLE_H
@@ -13,8 +14,13 @@
 #include "JavaTypes/StackFrame.h"
 #include "Bytecode/BciMap.h"
 
+#include <array>
+#include <optional>
+
 namespace JavaTypes {
 
+// All frames of the stack map table materialized at once. Convenient for
+// the inspection, verifier uses the StackMapCursor instead.
 class StackMapTable {
 public:
   using Container = Bytecode::BciMap<StackFrame>;
@@ -61,7 +67,7 @@ public:
   // Creates stack map table based on the current content of the builder and on
   // the supplied initial locals array. Usually initial locals are generated
   // from the method descriptor.
-  StackMapTable createTable(const std::vector<Type> &InitialLocals) const;
+  StackMapTable createTable(TypeList InitialLocals) const;
 
   // Constructs next frame by appending some locals into previous one.
   void addAppend(Bytecode::BciType Idx, std::vector<Type> &&Locals);
@@ -73,14 +79,25 @@ public:
   void addFull(Bytecode::BciType Idx,
       std::vector<Type> &&Locals, std::vector<Type> &&Stack);
 
-private:
+  // Next frame has the same locals as the previous one minus 'NumLocals'
+  // last ones and an empty stack.
+  void addChop(Bytecode::BciType Idx, std::size_t NumLocals);
+
+  // Next frame has the same locals as the previous one and a single element
+  // on the stack.
+  void addSameLocalsOneStack(Bytecode::BciType Idx, Type StackItem);
+
+public:
+  // Actions are exposed for the users which need to reproduce them, i.e
+  // class file writer. Each action is a single stack map frame.
   struct Action {
     enum FrameTypeEnum {
-      APPEND, SAME, FULL
+      APPEND, SAME, FULL, CHOP, SAME_LOCALS_ONE_STACK
     };
 
     Bytecode::BciType Bci;
     FrameTypeEnum FrameType;
+    // For the CHOP frames holds 'Top' for every removed local
     std::vector<Type> Locals, Stack;
 
     Action(Bytecode::BciType Bci, FrameTypeEnum FrameType,
@@ -93,11 +110,9 @@ private:
 
   using Container = std::vector<Action>;
 
-  // Store frame with non-expanded types.
-  using RawFrame = std::pair<std::vector<Type>, std::vector<Type>>;
+  const Container &actions() const { return FrameActions; }
 
 private:
-  const Container &actions() const { return FrameActions; }
   Container &actions() { return FrameActions; }
 
   // Checks that 'Idx' is monotonically increasing in relation to the previous
@@ -106,10 +121,86 @@ private:
 
   // Transforms given frame accoding with the given action. Transformation is
   // performed in-place.
-  static void transformFrame(RawFrame &Frame, const Action &Act);
+  static void transformFrame(StackFrame &Frame, const Action &Act);
 
 private:
   Container FrameActions;
+
+  friend class StackMapCursor;
+};
+
+// Walks frames of the stack map table in the bci order applying builder
+// actions one by one. Only the current frame is kept, so memory doesn't
+// depend on the number of frames. Builder itself serves as a log of deltas
+// between the frames and should outlive the cursor.
+class StackMapCursor {
+public:
+  // Cursor without any frames
+  StackMapCursor() = default;
+
+  // Positions cursor at the first frame.
+  StackMapCursor(
+      const StackMapTableBuilder &Builder, TypeList InitialLocals);
+
+  StackMapCursor(const StackMapCursor &) = delete;
+  StackMapCursor &operator=(const StackMapCursor &) = delete;
+  StackMapCursor(StackMapCursor &&) = default;
+  StackMapCursor &operator=(StackMapCursor &&) = default;
+
+  // Preallocates frame storage, expects limits in slots.
+  void reserve(std::size_t MaxLocals, std::size_t MaxStack);
+
+  bool atEnd() const { return Actions == nullptr || Pos >= Actions->size(); }
+
+  Bytecode::BciType getBci() const {
+    assert(!atEnd());
+    return (*Actions)[Pos].Bci;
+  }
+
+  const StackFrame &getFrame() const {
+    assert(!atEnd());
+    return Current;
+  }
+
+  // Moves to the next frame.
+  void advance();
+
+  // Finds frame at the given bci. It's reconstructed by replaying actions
+  // from the closest known frame: the current one, the last found one, a
+  // checkpoint or the last full frame before 'Bci'. Replay remembers frames
+  // at every 'CheckpointInterval' action, only the last 'NumCheckpoints' of
+  // them are kept.
+  // \returns Frame or null if there is no frame at this bci. Reference is
+  // valid until the next call to any of the cursor methods.
+  const StackFrame *findAtBci(Bytecode::BciType Bci);
+
+  static constexpr std::size_t CheckpointInterval = 64;
+  static constexpr std::size_t NumCheckpoints = 8;
+
+private:
+  using Action = StackMapTableBuilder::Action;
+
+  // Remembers frame at the action 'Idx' if it's a checkpoint.
+  void recordCheckpoint(std::size_t Idx, const StackFrame &Frame);
+
+private:
+  const std::vector<Action> *Actions = nullptr;
+  std::size_t Pos = 0;
+
+  StackFrame Initial{{}, {}};
+  StackFrame Current{{}, {}};
+
+  // Used for the random access. Holds frame at the 'ScratchPos' action.
+  StackFrame Scratch{{}, {}};
+  std::optional<std::size_t> ScratchPos;
+
+  // Fixed size ring of the frames, storage is preallocated by 'reserve'.
+  struct Checkpoint {
+    std::optional<std::size_t> Pos;
+    StackFrame Frame{{}, {}};
+  };
+  std::array<Checkpoint, NumCheckpoints> Checkpoints;
+  std::size_t NextCheckpoint = 0;
 };
 
 }
@@ -11,11 +11,18 @@ using namespace JavaTypes;
 Type Type::parseFieldDescriptor(
     const std::string &Desc, std::size_t *LastPos) {
 
+  std::size_t Pos = 0;
+  auto Ret = parseFieldType(Desc, Pos);
+  if (LastPos != nullptr)
+    *LastPos = Pos;
+  return Ret;
+}
+
+Type Type::parseFieldType(std::string_view Desc, std::size_t &LastPos) {
   if (Desc.empty())
     throw ParsingError("Field descriptor is empty");
 
-  if (LastPos != nullptr)
-    *LastPos = 1;
+  LastPos = 1;
 
   switch (Desc[0]) {
     case 'B': return Types::Byte;
@@ -29,21 +36,18 @@ Type Type::parseFieldDescriptor(
 
     case 'L': {
       auto End = Desc.find(';');
-      if (End == std::string::npos)
+      if (End == std::string_view::npos)
         throw ParsingError("Reference type in a wrong format");
 
-      if (LastPos != nullptr)
-        *LastPos = End + 1;
+      LastPos = End + 1;
       return Types::Class;
     }
 
     case '[': {
       try {
-        (void)parseFieldDescriptor(Desc.substr(1), LastPos);
-        if (LastPos != nullptr)
-          *LastPos += 1;
-      } catch (std::exception &) {
-        // This will also catch cases when substr(1) had throw and exception
+        (void)parseFieldType(Desc.substr(1), LastPos);
+        LastPos += 1;
+      } catch (ParsingError &) {
         throw ParsingError("Array type in a wrong format");
       }
       return Types::Array;
@@ -54,8 +58,7 @@ Type Type::parseFieldDescriptor(
   }
 }
 
-std::pair<Type, std::vector<Type>>
-Type::parseMethodDescriptor(const std::string &Desc) {
+Type Type::parseMethodDescriptor(const std::string &Desc, ArgumentTypes &Args) {
   if (Desc.empty())
     throw ParsingError("Empty descriptor");
 
@@ -68,29 +71,36 @@ Type::parseMethodDescriptor(const std::string &Desc) {
   if (RBracePos == Desc.size() - 1)
     throw ParsingError("Expected to find return type descriptor");
 
-  std::string ArgsDesc = Desc.substr(1, RBracePos - 1);
-  std::string RetDesc = Desc.substr(RBracePos + 1);
+  const std::string_view DescView(Desc);
+  const auto ArgsDesc = DescView.substr(1, RBracePos - 1);
+  const auto RetDesc = DescView.substr(RBracePos + 1);
   assert(!RetDesc.empty());
 
   // Parse argument types
-  std::vector<Type> ArgTypes;
   std::size_t ArgsPos = 0;
   while (ArgsPos < ArgsDesc.length()) {
     std::size_t ArgEnd;
-    auto NewType = parseFieldDescriptor(ArgsDesc.substr(ArgsPos), &ArgEnd);
+    auto NewType = parseFieldType(ArgsDesc.substr(ArgsPos), ArgEnd);
 
-    ArgTypes.push_back(NewType);
+    Args.push_back(NewType);
     ArgsPos += ArgEnd;
   }
 
   // Parse return type
-  auto RetType = Types::Void;
-  if (RetDesc != "V") {
-    std::size_t RetEnd;
-    RetType = parseFieldDescriptor(RetDesc, &RetEnd);
-    if (RetEnd != RetDesc.length())
-      throw ParsingError("Can't parse tail of the descriptor");
-  }
+  if (RetDesc == "V")
+    return Types::Void;
+
+  std::size_t RetEnd;
+  auto RetType = parseFieldType(RetDesc, RetEnd);
+  if (RetEnd != RetDesc.length())
+    throw ParsingError("Can't parse tail of the descriptor");
+
+  return RetType;
+}
 
-  return std::pair(RetType, ArgTypes);
+std::pair<Type, std::vector<Type>>
+Type::parseMethodDescriptor(const std::string &Desc) {
+  ArgumentTypes Args;
+  auto RetType = parseMethodDescriptor(Desc, Args);
+  return std::pair(RetType, std::vector<Type>(Args.begin(), Args.end()));
 }
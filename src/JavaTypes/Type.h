@@ -6,19 +6,103 @@
 #ifndef ICP_TYPE_H
 #define ICP_TYPE_H
 
-#include <optional>
+#include "Utils/SmallVector.h"
+
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <initializer_list>
 #include <stack>
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace JavaTypes {
 
+namespace _detail {
+
+enum class TypeTag: uint8_t {
+  TOP = 0,
+  ONE_WORD,
+  TWO_WORD,
+  INT,
+  BYTE,
+  CHAR,
+  SHORT,
+  BOOLEAN,
+  FLOAT,
+  LONG,
+  DOUBLE,
+  REFERENCE,
+  UNINITIALIZED,
+  UNINITIALIZED_THIS,
+  UNINITIALIZED_OFFSET,
+  ARRAY,
+  CLASS,
+  NULL_TAG,
+  VOID,
+
+  NUM_TAGS
+};
+
+constexpr uint32_t tagBit(TypeTag Tag) {
+  return 1u << static_cast<unsigned>(Tag);
+}
+
+// Set of the strict supertypes for the given tag as a bitmask of tags. This
+// mirrors subtyping relation from the jvms 4.10.1.2.
+constexpr uint32_t supertypesOf(TypeTag Tag) {
+  using T = TypeTag;
+  switch (Tag) {
+  case T::TOP:
+  case T::VOID:
+    return 0;
+  case T::ONE_WORD:
+  case T::TWO_WORD:
+    return tagBit(T::TOP);
+  case T::INT:
+  case T::FLOAT:
+  case T::REFERENCE:
+    return tagBit(T::ONE_WORD) | supertypesOf(T::ONE_WORD);
+  case T::LONG:
+  case T::DOUBLE:
+    return tagBit(T::TWO_WORD) | supertypesOf(T::TWO_WORD);
+  case T::UNINITIALIZED:
+  case T::CLASS:
+  case T::ARRAY:
+    return tagBit(T::REFERENCE) | supertypesOf(T::REFERENCE);
+  case T::UNINITIALIZED_THIS:
+  case T::UNINITIALIZED_OFFSET:
+    return tagBit(T::UNINITIALIZED) | supertypesOf(T::UNINITIALIZED);
+  case T::BYTE:
+  case T::CHAR:
+  case T::SHORT:
+  case T::BOOLEAN:
+    return tagBit(T::INT) | supertypesOf(T::INT);
+  case T::NULL_TAG:
+    return tagBit(T::CLASS) | supertypesOf(T::CLASS) |
+           tagBit(T::ARRAY) | supertypesOf(T::ARRAY);
+  case T::NUM_TAGS:
+    break;
+  }
+  return 0;
+}
+
+inline constexpr auto SupertypeTable = [] {
+  std::array<uint32_t, static_cast<std::size_t>(TypeTag::NUM_TAGS)> Res{};
+  for (std::size_t Tag = 0; Tag < Res.size(); ++Tag)
+    Res[Tag] = supertypesOf(static_cast<TypeTag>(Tag));
+  return Res;
+}();
+
+}
+
 // Class representing java data type.
 // Direct construction is forbidden. In order to refer to the specific types
 // user is supposed to use static variables from the 'Types' struct.
-// This is intended to be a small immutable value-like class.
+// This is intended to be a small immutable value-like class which fits into a
+// single 32 bit word.
 class Type final {
 public:
   // Indicates parsing error in parseFieldDescriptor and
@@ -29,20 +113,24 @@ public:
 
 public:
   constexpr bool operator==(const Type &Rhs) const noexcept {
-    if (Tag != Rhs.Tag)
+    // Identical encodings is the common case
+    if (Bits == Rhs.Bits)
+      return true;
+    if (getTag() != Rhs.getTag())
       return false;
 
     // This is to support wildcard matching of parametrized types
-    if (!Data || !Rhs.Data)
-      return true;
-
-    return Data == Rhs.Data;
+    return !hasData() || !Rhs.hasData();
   }
 
   constexpr bool operator!=(const Type &Rhs) const noexcept {
     return !(*this == Rhs);
   }
 
+  // Packed representation of this type. Types with equal encodings are always
+  // equal, but wildcards are equal to the types with different encodings.
+  constexpr uint32_t getBits() const noexcept { return Bits; }
+
   // Explicitly state that moves and copies are allowed.
   Type(const Type&) = default;
   Type &operator=(const Type &) = default;
@@ -71,49 +159,53 @@ public:
   static std::pair<Type, std::vector<Type>>
   parseMethodDescriptor(const std::string &Desc);
 
+  // JVMS 4.3.3 limits method arguments to 255 slots, so they always fit
+  // into this buffer without any heap allocations.
+  static constexpr std::size_t MaxArgumentSlots = 255;
+  using ArgumentTypes = Utils::SmallVector<Type, MaxArgumentSlots>;
+
+  // Same as above but appends argument types into the 'Args' instead of
+  // allocating new vector. Intended for the verifier.
+  // \returns Return type, Types::Void for void functions.
+  // \throws ParsingError In case of any errors.
+  static Type parseMethodDescriptor(
+      const std::string &Desc, ArgumentTypes &Args);
+
 private:
-  enum class TagType {
-    TOP = 0,
-    ONE_WORD,
-    TWO_WORD,
-    INT,
-    BYTE,
-    CHAR,
-    SHORT,
-    BOOLEAN,
-    FLOAT,
-    LONG,
-    DOUBLE,
-    REFERENCE,
-    UNINITIALIZED,
-    UNINITIALIZED_THIS,
-    UNINITIALIZED_OFFSET,
-    ARRAY,
-    CLASS,
-    NULL_TAG,
-    VOID
-  };
+  using TagType = _detail::TypeTag;
 
-  TagType Tag;
+  // Whole type is packed into a single word:
+  //   bits 0-7   - tag
+  //   bit 8      - type has parameter
+  //   bits 16-31 - parameter (i.e offset for the UninitializedOffset)
+  static constexpr uint32_t TagMask = 0xff;
+  static constexpr uint32_t HasDataBit = 1u << 8;
+  static constexpr unsigned DataShift = 16;
 
-  // Once array, class and null type are implemented this will be replaced
-  // with std::variant.
   using DataType = uint32_t;
 
-  std::optional<DataType> Data;
+  uint32_t Bits;
 
 private:
   explicit constexpr Type(TagType Tag) noexcept:
-      Tag(Tag),
-      Data() {
+      Bits(static_cast<uint32_t>(Tag)) {
     ;
   }
 
   constexpr Type(TagType Tag, DataType Data) noexcept:
-      Tag(Tag),
-      Data(Data) {
-    ;
+      Bits(static_cast<uint32_t>(Tag) | HasDataBit | (Data << DataShift)) {
+    // Offsets are bci's which never exceed 16 bits
+    assert(Data <= 0xffff);
+  }
+
+  constexpr TagType getTag() const noexcept {
+    return static_cast<TagType>(Bits & TagMask);
   }
+  constexpr bool hasData() const noexcept { return Bits & HasDataBit; }
+
+  // Implementation of the field descriptor parsing. 'LastPos' receives
+  // index of the first not parsed character.
+  static Type parseFieldType(std::string_view Desc, std::size_t &LastPos);
 
   friend struct Types;
 };
@@ -167,6 +259,13 @@ struct Types final {
     return Type(Type::TagType::UNINITIALIZED_OFFSET, Offset);
   }
 
+  // Extracts offset from the UninitializedOffset(Offset). Wildcard has no
+  // offset and is not accepted.
+  static constexpr uint32_t getUninitializedOffset(const Type &T) noexcept {
+    assert(T.getTag() == Type::TagType::UNINITIALIZED_OFFSET && T.hasData());
+    return T.Bits >> Type::DataShift;
+  }
+
   static constexpr Type Class{Type::TagType::CLASS};
   static constexpr Type Array{Type::TagType::ARRAY};
   static constexpr Type Null{Type::TagType::NULL_TAG};
@@ -192,6 +291,37 @@ struct Types final {
   Types() = delete;
 };
 
+// Non-owning view of the consecutive types. Allows to pass braced lists,
+// vectors and small vectors to the same function without copying them.
+class TypeList final {
+public:
+  TypeList() = default;
+
+  // Braced list lives until the end of the full expression, so it's fine to
+  // pass it directly into the function call.
+  TypeList(std::initializer_list<Type> List) {
+    Begin = List.begin();
+    End = List.end();
+  }
+
+  template<class Container, class = decltype(std::declval<Container>().data())>
+  TypeList(const Container &C): Begin(C.data()), End(C.data() + C.size()) {
+    ;
+  }
+
+  const Type *begin() const { return Begin; }
+  const Type *end() const { return End; }
+  std::size_t size() const { return static_cast<std::size_t>(End - Begin); }
+  bool empty() const { return Begin == End; }
+
+private:
+  const Type *Begin = nullptr;
+  const Type *End = nullptr;
+};
+
+static_assert(sizeof(Type) == sizeof(uint32_t));
+static_assert(std::is_trivially_copyable_v<Type>);
+
 //
 // Implementation of the utility functions.
 //
@@ -201,44 +331,12 @@ constexpr bool Types::isAssignable(const Type &From, const Type &To) noexcept {
   if (From == To)
     return true;
 
-  // Top can only be assigned to itself
-  if (From == Types::Top)
-    return false;
-
-  // Everything can be assigned to top
-  if (To == Types::Top)
-    return true;
-
-  if (From == Types::OneWord || From == Types::TwoWord)
-    return To == Types::Top;
-
-  // Recursion here is not necessary, however it provides more clear
-  // implementation. If performance would ever become an issue this should be
-  // optimized.
-  if (From == Types::Int || From == Types::Float || From == Types::Reference)
-    return isAssignable(Types::OneWord, To);
-
-  if (From == Types::Long || From == Types::Double)
-    return isAssignable(Types::TwoWord, To);
-
-  if (From == Types::Uninitialized)
-    return isAssignable(Types::Reference, To);
-
-  if (From == Types::UninitializedThis || From == Types::UninitializedOffset())
-    return isAssignable(Types::Uninitialized, To);
-
-  if (From == Types::Class || From == Types::Array)
-    return isAssignable(Types::Reference, To);
-
-  if (From == Types::Char || From == Types::Short ||
-      From == Types::Byte || From == Types::Boolean)
-    return isAssignable(Types::Int, To);
-
-  if (From == Types::Null)
-    return isAssignable(Types::Class, To) || isAssignable(Types::Array, To);
+  assert(From != Types::Void); // All types should be covered
 
-  assert(false); // All types should be covered
-  return false;
+  // Otherwise 'To' should be one of the supertypes. Parametrized types are
+  // never supertypes, so parameters don't matter here.
+  return _detail::SupertypeTable[static_cast<std::size_t>(From.getTag())] &
+         _detail::tagBit(To.getTag());
 }
 
 constexpr std::size_t Types::sizeOf(const Type &T) noexcept {
@@ -5,37 +5,66 @@
 #include "ClassManager.h"
 
 #include "JavaTypes/JavaClass.h"
+#include "JavaTypes/JavaMethod.h"
 #include "Verifier/Verifier.h"
 #include "SlowInterpreter/SlowInterpreter.h"
 #include "ClassFileReader/ClassFileReader.h"
 #include "CD/Parser.h"
+#include "Bytecode/Instructions.h"
+#include "Utils/ThreadPool.h"
+#include "Runtime/SharedClassCache.h"
+#include "Utils/BinaryFiles.h"
 
+#include <atomic>
 #include <fstream>
+#include <future>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace Runtime;
 using namespace JavaTypes;
 
+// Set while the thread initializes classes on behalf of 'initializeClasses'
+static thread_local const ClassManager *ParallelInitOwner = nullptr;
+
 // Overall loading scheme:
 // CM.loadClass -> Loader.loadClass -> (create stream, CM.defineClass(*this)) -> (Loader.deriveClass(), record init and deref class)
 
+ClassManager::ClassManager(std::shared_ptr<SharedClassCache> Cache):
+  Cache(std::move(Cache)) {
+  ;
+}
+
+ClassManager::~ClassManager() = default;
+
 const JavaTypes::JavaClass &ClassManager::getClass(
-    const Utf8String &Name, const ClassLoader &ILoader) {
+    Utils::Symbol Name, const ClassLoader &ILoader) {
 
   // If we already loaded such class - just return it.
   if (const auto *meta_info = getMetaInfoForInitLoader(Name, ILoader))
     return *meta_info->Class;
 
+  // Loading is serialized. Lock is recursive so loader can call back into
+  // defineClass.
+  std::lock_guard<std::recursive_mutex> Guard(Lock);
+
+  // Some other thread might have loaded it while we were waiting
+  if (const auto *meta_info = getMetaInfoForInitLoader(Name, ILoader))
+    return *meta_info->Class;
+
   // Otherwise call a class loader to find and define this class
   // It will callback into class manager in order to properly register this class.
   const auto &Class = ILoader.loadClass(Name, *this);
 
   // Register this class as it's initiating loader
-  ClassesInitLoaders[std::make_pair(Class.getClassName(), &ILoader)] =
-      &getMetaInfoForClass(Class);
+  ClassesInitLoaders.insert(
+      std::make_pair(Class.getClassName(), &ILoader), &getMetaInfoForClass(Class));
 
   // TODO: This is temporary measure due to the fact that sometimes class name
   // might not be the same as the file from which it was loaded.
-  ClassesInitLoaders[std::make_pair(Name, &ILoader)] = &getMetaInfoForClass(Class);
+  ClassesInitLoaders.insert(
+      std::make_pair(Name, &ILoader), &getMetaInfoForClass(Class));
   return Class;
 }
 
@@ -44,29 +73,339 @@ Runtime::ClassObject &ClassManager::getClassObject(
 
   auto &meta_info = getMetaInfoForClass(Class);
 
-  // If we already have this object - just return it. Also prevent recursive
-  // initialization.
-  if (meta_info.State == ClassMetaInfo::INITIALIZED ||
-      meta_info.State == ClassMetaInfo::INIT_IN_PROGRESS) {
-    assert(meta_info.Object); // should have this object
+  // Fast path for the already initialized classes
+  if (meta_info.State.load(std::memory_order_acquire) ==
+      ClassMetaInfo::INITIALIZED)
     return *meta_info.Object;
+
+  std::unique_lock<std::recursive_mutex> Guard(Lock);
+
+  // Wait until some other thread finishes initialization. Parallel
+  // initialization may start classes in the order in which their threads
+  // wait for each other. Such request is handled as a recursive one, the
+  // same as if all of those classes were initialized by this thread.
+  const auto ThisThread = std::this_thread::get_id();
+  while (meta_info.State == ClassMetaInfo::INIT_IN_PROGRESS &&
+         meta_info.InitThread != ThisThread) {
+    if (ParallelInitOwner == this && isInitBlockedOn(meta_info, ThisThread))
+      break;
+
+    InitWaits[ThisThread] = &meta_info;
+    InitDone.wait(Guard);
+    InitWaits.erase(ThisThread);
   }
 
-  // Verify class (throws VerificationError)
-  Verifier::verify(Class);
+  switch (meta_info.State.load(std::memory_order_relaxed)) {
+  case ClassMetaInfo::INITIALIZED:
+    assert(meta_info.Object); // should have this object
+    return *meta_info.Object;
+
+  case ClassMetaInfo::INIT_IN_PROGRESS:
+    // Recursive request from the initializing thread or the thread it waits
+    // for. Waiting threads are always inside of some <clinit>.
+    assert(meta_info.Object); // should have this object
+    return *meta_info.Object;
 
-  // Prepare. Happens automatically in the ClassObject constructor
-  meta_info.Object = std::make_unique<ClassObject>(Class);
+  case ClassMetaInfo::ERRONEOUS:
+    throw NoClassDefFoundError(
+        "Class " + Class.getClassName() + " is in erroneous state");
 
-  // Initialize the object
-  meta_info.State = ClassMetaInfo::INIT_IN_PROGRESS;
-  if (const auto *method = meta_info.Object->getMethod("<clinit>"))
-    SlowInterpreter::interpret(*method, {}, *this);
-  meta_info.State = ClassMetaInfo::INITIALIZED;
+  case ClassMetaInfo::LOADED:
+    break;
+  }
+
+  // This thread is responsible for the initialization
+  meta_info.State.store(ClassMetaInfo::INIT_IN_PROGRESS);
+  meta_info.InitThread = std::this_thread::get_id();
+
+  try {
+    // Verify class (throws VerificationError). In the lazy mode methods are
+    // verified before their first invocation instead.
+    // Classes from the verification cache were verified by an earlier run.
+    Guard.unlock();
+    auto *VCache = VerifyCache.load();
+    const auto &Key = meta_info.CacheKey;
+    const bool KnownVerified = VCache && Key && VCache->contains(*Key);
+
+    if (!KnownVerified) {
+      if (LazyVerification.load()) {
+        meta_info.VerifyLazily.store(true);
+      } else {
+        if (auto *Pool = VerificationPool.load())
+          Verifier::verify(Class, *Pool);
+        else
+          Verifier::verify(Class);
+
+        // Only the whole class verification is recorded
+        if (VCache && Key)
+          VCache->insert(*Key);
+      }
+    }
+
+    // Calls of the verified methods only check their state. Native methods
+    // are marked as well so that they take the same path.
+    if (!meta_info.VerifyLazily.load()) {
+      for (const auto &Method: Class.methods())
+        Method->verifyOnce([](const JavaTypes::JavaMethod &) {});
+    }
+
+    // Prepare. Happens automatically in the ClassObject constructor
+    auto NewObject = std::make_unique<ClassObject>(Class);
+
+    // Bind native methods. Do this eagerly so that missing symbols are
+    // reported at link time and calls don't need to perform any lookups.
+    Guard.lock();
+    for (const auto &Method: Class.methods()) {
+      if (Method->isNative())
+        NewObject->bindNative(*Method, Natives.bind(
+            Class.getClassName(), Method->getName(), Method->getDescriptor()));
+    }
+
+    // Publish the object for the recursive requests
+    meta_info.Object = std::move(NewObject);
+    const auto *clinit = meta_info.Object->getMethod(Utils::Symbols::clinit());
+    Guard.unlock();
+
+    // Initialize the object without holding the lock
+    if (clinit)
+      SlowInterpreter::interpret(*clinit, {}, *this);
+
+    Guard.lock();
+  } catch (...) {
+    if (!Guard.owns_lock())
+      Guard.lock();
+    meta_info.State.store(ClassMetaInfo::ERRONEOUS);
+    InitDone.notify_all();
+    throw;
+  }
+
+  meta_info.State.store(ClassMetaInfo::INITIALIZED, std::memory_order_release);
+  InitDone.notify_all();
 
   return *meta_info.Object;
 }
 
+bool ClassManager::isInitBlockedOn(
+    const ClassMetaInfo &Meta, std::thread::id Thread) const {
+
+  // Each thread waits for at most one class, so any chain which is longer
+  // than the number of waiting threads is a cycle without 'Thread'.
+  const ClassMetaInfo *Cur = &Meta;
+  for (std::size_t Steps = 0; Steps <= InitWaits.size(); ++Steps) {
+    if (Cur->State != ClassMetaInfo::INIT_IN_PROGRESS)
+      return false;
+    if (Cur->InitThread == Thread)
+      return true;
+
+    auto It = InitWaits.find(Cur->InitThread);
+    if (It == InitWaits.end())
+      return false;
+    Cur = It->second;
+  }
+
+  return false;
+}
+
+// Collects names of the classes which might be initialized by the <clinit>
+// of the given class, including the methods of the same class it calls.
+// Code of the other classes is not inspected, getClassObject deals with the
+// dependencies hidden there. Methods are not verified yet, so ignore
+// malformed references, verifier will report them later.
+static std::vector<Utf8String> getInitDependencies(const JavaClass &Class) {
+  using namespace Bytecode;
+  using namespace ConstantPoolRecords;
+
+  std::vector<Utf8String> Ret;
+
+  const auto *clinit = Class.getMethod(Utils::Symbols::clinit());
+  if (!clinit)
+    return Ret;
+  const auto &CP = Class.getConstantPool();
+
+  std::vector<const JavaMethod*> ToVisit{clinit};
+  std::unordered_set<const JavaMethod*> Visited{clinit};
+
+  auto AddRef = [&](auto *Rec) {
+    if (Rec)
+      Ret.push_back(Rec->getClassName());
+  };
+  auto AddCall = [&](const MethodRef *Rec) {
+    AddRef(Rec);
+    if (!Rec || Rec->getClassName() != Class.getClassName())
+      return;
+    const auto *Callee = Class.getMethod(Rec->getName(), Rec->getDescriptor());
+    if (Callee && !Callee->isNative() && Visited.insert(Callee).second)
+      ToVisit.push_back(Callee);
+  };
+
+  while (!ToVisit.empty()) {
+    const auto *Method = ToVisit.back();
+    ToVisit.pop_back();
+
+    for (const auto *Inst: *Method) {
+      switch (Inst->getOpCode()) {
+      case getstatic::OpCode:
+        AddRef(CP.getAsOrNull<FieldRef>(Inst->getAs<getstatic>().getIdx()));
+        break;
+      case putstatic::OpCode:
+        AddRef(CP.getAsOrNull<FieldRef>(Inst->getAs<putstatic>().getIdx()));
+        break;
+      case invokestatic::OpCode:
+        AddCall(CP.getAsOrNull<MethodRef>(
+            Inst->getAs<invokestatic>().getIdx()));
+        break;
+      case invokespecial::OpCode:
+        AddCall(CP.getAsOrNull<MethodRef>(
+            Inst->getAs<invokespecial>().getIdx()));
+        break;
+      case java_new::OpCode:
+        if (const auto *CI =
+                CP.getAsOrNull<ClassInfo>(Inst->getAs<java_new>().getIdx()))
+          Ret.push_back(CI->getName());
+        break;
+      default:
+        break;
+      }
+    }
+  }
+
+  return Ret;
+}
+
+void ClassManager::initializeClasses(
+    const std::vector<const JavaTypes::JavaClass*> &ToInit,
+    Utils::ThreadPool &Pool) {
+
+  const auto NumClasses = ToInit.size();
+
+  std::unordered_map<Utf8String, std::size_t> NameToIdx;
+  for (std::size_t Idx = 0; Idx < NumClasses; ++Idx)
+    NameToIdx.emplace(ToInit[Idx]->getClassName(), Idx);
+
+  // Build the dependency graph. Only classes from the list are considered,
+  // all others are initialized lazily as usual.
+  std::vector<std::vector<std::size_t>> Dependents(NumClasses);
+  std::vector<std::size_t> NumDeps(NumClasses, 0);
+  for (std::size_t Idx = 0; Idx < NumClasses; ++Idx) {
+    std::unordered_set<std::size_t> Seen;
+    for (const auto &DepName: getInitDependencies(*ToInit[Idx])) {
+      auto It = NameToIdx.find(DepName);
+      if (It == NameToIdx.end() || It->second == Idx)
+        continue;
+      if (!Seen.insert(It->second).second)
+        continue;
+
+      Dependents[It->second].push_back(Idx);
+      ++NumDeps[Idx];
+    }
+  }
+
+  // Find the acyclic part of the graph using topological sort. Everything
+  // which was not reached is either in the cycle or depends on one.
+  std::vector<bool> Acyclic(NumClasses, false);
+  std::size_t NumAcyclic = 0;
+  {
+    auto Left = NumDeps;
+    std::vector<std::size_t> Ready;
+    for (std::size_t Idx = 0; Idx < NumClasses; ++Idx)
+      if (Left[Idx] == 0)
+        Ready.push_back(Idx);
+
+    while (!Ready.empty()) {
+      const auto Idx = Ready.back();
+      Ready.pop_back();
+      Acyclic[Idx] = true;
+      ++NumAcyclic;
+
+      for (auto Dep: Dependents[Idx])
+        if (--Left[Dep] == 0)
+          Ready.push_back(Dep);
+    }
+  }
+
+  // Schedule each class once all of it's dependencies are initialized
+  std::vector<std::atomic<std::size_t>> Pending(NumClasses);
+  for (std::size_t Idx = 0; Idx < NumClasses; ++Idx)
+    Pending[Idx].store(NumDeps[Idx], std::memory_order_relaxed);
+
+  std::mutex DoneLock;
+  std::condition_variable AllDone;
+  std::size_t NumLeft = NumAcyclic;
+  // Reported error doesn't depend on the scheduling, each class records it's
+  // own and the first one in the order of the list wins.
+  std::vector<std::exception_ptr> Errors(NumClasses);
+
+  std::function<void(std::size_t)> Schedule = [&](std::size_t Idx) {
+    Pool.submit([&, Idx]() {
+      ParallelInitOwner = this;
+      try {
+        getClassObject(*ToInit[Idx]);
+      } catch (...) {
+        Errors[Idx] = std::current_exception();
+      }
+      ParallelInitOwner = nullptr;
+
+      // Dependents are scheduled even if this class failed, they will
+      // observe erroneous state if they really need it.
+      for (auto Dep: Dependents[Idx]) {
+        if (Acyclic[Dep] &&
+            Pending[Dep].fetch_sub(1, std::memory_order_acq_rel) == 1)
+          Schedule(Dep);
+      }
+
+      std::lock_guard<std::mutex> Guard(DoneLock);
+      if (--NumLeft == 0)
+        AllDone.notify_all();
+    });
+  };
+
+  for (std::size_t Idx = 0; Idx < NumClasses; ++Idx)
+    if (Acyclic[Idx] && NumDeps[Idx] == 0)
+      Schedule(Idx);
+
+  {
+    std::unique_lock<std::mutex> Guard(DoneLock);
+    AllDone.wait(Guard, [&]() { return NumLeft == 0; });
+  }
+
+  // Cycles are initialized in the same order as they would be without this
+  // method. Recursive initialization requests are handled by getClassObject.
+  for (std::size_t Idx = 0; Idx < NumClasses; ++Idx) {
+    if (Acyclic[Idx])
+      continue;
+
+    try {
+      getClassObject(*ToInit[Idx]);
+    } catch (...) {
+      Errors[Idx] = std::current_exception();
+    }
+  }
+
+  for (const auto &Error: Errors)
+    if (Error)
+      std::rethrow_exception(Error);
+}
+
+void ClassManager::verifyBeforeInvoke(
+    const JavaTypes::JavaMethod &Method) const {
+
+  // Methods of the eagerly verified classes are marked as verified, so this
+  // is a single load for them.
+  if (Method.isVerified() || Method.isNative())
+    return;
+
+  // Standalone classes (i.e in tests) are not known to the manager
+  const auto &Owner = Method.getOwner();
+  const ClassMetaInfo *Meta = Owner.getMetaInfo(*this);
+  if (Meta == nullptr) {
+    const auto *Foreign = ForeignClasses.find(&Owner);
+    Meta = Foreign ? *Foreign : nullptr;
+  }
+
+  if (Meta != nullptr && Meta->VerifyLazily.load())
+    Method.verifyOnce(Verifier::verifyMethod);
+}
+
 const ClassLoader *ClassManager::getDefLoader(
     const JavaTypes::JavaClass &Class) const {
 
@@ -76,91 +415,242 @@ const ClassLoader *ClassManager::getDefLoader(
 JavaTypes::JavaClass &ClassManager::defineClass(
     const Utf8String &Name, std::istream &Bytes, const ClassLoader &DefLoader) {
 
+  const std::string Contents(
+      std::istreambuf_iterator<char>(Bytes), std::istreambuf_iterator<char>{});
+  return defineClass(Name, std::string_view(Contents), DefLoader);
+}
+
+JavaTypes::JavaClass &ClassManager::defineClass(
+    const Utf8String &Name, std::string_view Bytes,
+    const ClassLoader &DefLoader) {
+
+  std::lock_guard<std::recursive_mutex> Guard(Lock);
+
   // This should always be a new class
-  if (getMetaInfoForInitLoader(Name, DefLoader))
+  if (getMetaInfoForInitLoader(Utils::Symbol::intern(Name), DefLoader))
     throw LinkageError("Class " + Name + " already loaded");
 
   // Parse the class (throws in case of an error)
-  auto Class = DefLoader.deriveClass(Bytes);
-  auto RealName = Class->getClassName();
+  std::optional<VerificationCache::Key> CacheKey;
+  auto Class = parseClass(Bytes, DefLoader, CacheKey);
   // TODO: Check class name
   //assert(RealName == Name);
 
-  // Record the new class
-  ClassMetaInfo meta_info{
-      DefLoader, std::move(Class), nullptr, ClassMetaInfo::LOADED};
+  return *recordClass(std::move(Class), DefLoader, CacheKey).Class;
+}
 
-  auto It = Classes.insert(std::make_pair(RealName, std::move(meta_info)));
-  ClassesInitLoaders[std::make_pair(RealName, &DefLoader)] = &It->second;
+std::shared_ptr<JavaClass> ClassManager::parseClass(
+    std::string_view Bytes, const ClassLoader &DefLoader,
+    std::optional<VerificationCache::Key> &CacheKey) {
 
-  return *It->second.Class;
+  // Hashing is much cheaper than the verification it allows to skip
+  if (VerifyCache.load())
+    CacheKey = VerificationCache::computeKey(Bytes);
+
+  if (!Cache)
+    return DefLoader.deriveClass(Bytes);
+
+  return Cache->getOrParse(Bytes, [&](std::string_view Input) {
+    return DefLoader.deriveClass(Input);
+  });
 }
 
-const ClassManager::ClassMetaInfo *ClassManager::getMetaInfoForInitLoader(
-    const Utf8String &Name, const ClassLoader &ILoader) const {
+ClassMetaInfo &ClassManager::recordClass(
+    std::shared_ptr<JavaClass> Class, const ClassLoader &DefLoader,
+    const std::optional<VerificationCache::Key> &CacheKey) {
+
+  const auto RealName = Class->getClassName();
+  if (getMetaInfoForInitLoader(RealName, DefLoader))
+    throw LinkageError("Class " + RealName + " already defined");
+
+  Classes.push_back(
+      std::make_unique<ClassMetaInfo>(*this, DefLoader, std::move(Class)));
+  auto &meta_info = *Classes.back();
+  meta_info.CacheKey = CacheKey;
+
+  // Shared class might be linked to some other manager already
+  if (!meta_info.Class->tryLinkMetaInfo(*this, meta_info))
+    ForeignClasses.insert(meta_info.Class.get(), &meta_info);
 
-  auto It = ClassesInitLoaders.find(std::make_pair(Name, &ILoader));
-  if (It == ClassesInitLoaders.end())
-    return nullptr;
-  return It->second;
+  ClassesInitLoaders.insert(std::make_pair(RealName, &DefLoader), &meta_info);
+
+  return meta_info;
 }
 
-const ClassManager::ClassMetaInfo &ClassManager::getMetaInfoForClass(
-    const JavaTypes::JavaClass &Class) const {
+std::vector<const JavaClass*> ClassManager::loadClasses(
+    const std::vector<Utf8String> &Names,
+    const ClassLoader &ILoader,
+    Utils::ThreadPool &Pool) {
+
+  std::vector<Utils::Symbol> Symbols;
+  Symbols.reserve(Names.size());
+  for (const auto &Name: Names)
+    Symbols.push_back(Utils::Symbol::intern(Name));
+
+  // Read and parse everything which is not loaded yet. Each task goes
+  // through the whole pipeline, different tasks are at different stages.
+  using ParseResult = std::pair<
+      std::shared_ptr<JavaClass>, std::optional<VerificationCache::Key>>;
+  std::vector<std::future<ParseResult>> Parsed(Names.size());
+  std::unordered_set<Utils::Symbol> Scheduled;
+  for (std::size_t Idx = 0; Idx < Names.size(); ++Idx) {
+    if (getMetaInfoForInitLoader(Symbols[Idx], ILoader) ||
+        !Scheduled.insert(Symbols[Idx]).second)
+      continue;
+
+    Parsed[Idx] = Pool.submit([this, &Name = Names[Idx], &ILoader]() {
+      const auto Bytes = ILoader.readClass(Name);
+      ParseResult Res;
+      Res.first = parseClass(Bytes, ILoader, Res.second);
+      return Res;
+    });
+  }
 
-  auto [beg, end] = Classes.equal_range(Class.getClassName());
+  // Wait for all of the tasks, they refer to our arguments
+  std::vector<ParseResult> Results(Names.size());
+  std::exception_ptr Error;
+  for (std::size_t Idx = 0; Idx < Names.size(); ++Idx) {
+    if (!Parsed[Idx].valid())
+      continue;
+    try {
+      Results[Idx] = Parsed[Idx].get();
+    } catch (...) {
+      if (!Error)
+        Error = std::current_exception();
+    }
+  }
+  if (Error)
+    std::rethrow_exception(Error);
+
+  // Publish in the order of the list
+  std::lock_guard<std::recursive_mutex> Guard(Lock);
+
+  // Check all classes first so that we don't leave half of them defined
+  std::unordered_set<Utils::Symbol> NewNames;
+  for (std::size_t Idx = 0; Idx < Names.size(); ++Idx) {
+    if (!Results[Idx].first || getMetaInfoForInitLoader(Symbols[Idx], ILoader))
+      continue;
+
+    const auto RealName = Results[Idx].first->getClassName();
+    if (getMetaInfoForInitLoader(RealName, ILoader) ||
+        !NewNames.insert(RealName).second)
+      throw LinkageError("Class " + RealName + " already defined");
+  }
 
-  for (auto it = beg; it != end; ++it) {
-    if (it->second.Class.get() == &Class)
-      return it->second;
+  std::vector<const JavaClass*> Ret(Names.size());
+  for (std::size_t Idx = 0; Idx < Names.size(); ++Idx) {
+    // Might have been loaded by someone else while we were parsing
+    if (const auto *meta_info = getMetaInfoForInitLoader(Symbols[Idx], ILoader)) {
+      Ret[Idx] = meta_info->Class.get();
+      continue;
+    }
+
+    auto &meta_info = recordClass(
+        std::move(Results[Idx].first), ILoader, Results[Idx].second);
+    // Same as in getClass, file name might differ from the class name
+    ClassesInitLoaders.insert(std::make_pair(Symbols[Idx], &ILoader), &meta_info);
+    Ret[Idx] = meta_info.Class.get();
   }
 
-  assert(false); // class should be loaded
-  return beg->second;
+  return Ret;
 }
 
-ClassManager::ClassMetaInfo &ClassManager::getMetaInfoForClass(
-    const JavaTypes::JavaClass &Class) {
-  return const_cast<ClassManager::ClassMetaInfo&>(
-      const_cast<const ClassManager*>(this)->getMetaInfoForClass(Class));
+ClassMetaInfo *ClassManager::getMetaInfoForInitLoader(
+    Utils::Symbol Name, const ClassLoader &ILoader) const {
+
+  const auto *Res = ClassesInitLoaders.find(std::make_pair(Name, &ILoader));
+  return Res ? *Res : nullptr;
 }
 
-namespace {
-class BootstrapLoader: public ClassLoader {
-  virtual JavaTypes::JavaClass &loadClass(
-      const Utf8String &Name, ClassManager &CM) const override {
+ClassMetaInfo &ClassManager::getMetaInfoForClass(
+    const JavaTypes::JavaClass &Class) const {
 
-    // Hope that class is on cwd.
-    // This is not conformant with the spec but who cares.
-    std::ifstream file(Name + ".class");
-    if (!file)
-      throw ClassNotFoundException("Can't find class " + Name);
+  if (auto *Res = Class.getMetaInfo(*this))
+    return *Res;
 
-    return CM.defineClass(Name, file, *this);
-  }
+  const auto *Res = ForeignClasses.find(&Class);
+  assert(Res != nullptr); // class should be loaded
+  return **Res;
+}
 
-  virtual std::unique_ptr<JavaTypes::JavaClass> deriveClass(
-      std::istream &Bytes) const override {
-    return ClassFileReader::loadClassFromStream(Bytes);
-  }
-};
+ClassMetaInfo::ClassMetaInfo(
+    const ClassManager &Owner,
+    const ClassLoader &DefLoader,
+    std::shared_ptr<JavaTypes::JavaClass> Class):
+  Owner(Owner),
+  DefLoader(DefLoader),
+  Class(std::move(Class)),
+  Object(nullptr),
+  State(LOADED) {
+  ;
+}
 
-class TestLoader: public BootstrapLoader {
-  virtual JavaTypes::JavaClass &loadClass(
-      const Utf8String &Name, ClassManager &CM) const override {
+ClassMetaInfo::~ClassMetaInfo() {
+  // Class might outlive us in the shared cache
+  Class->unlinkMetaInfo(Owner);
+}
 
-    std::ifstream file(Name + ".cd");
-    if (!file)
-      throw ClassNotFoundException("Can't find class " + Name);
+JavaTypes::JavaClass &BootstrapLoader::loadClass(
+    const Utf8String &Name, ClassManager &CM) const {
 
-    return CM.defineClass(Name, file, *this);
+  // Hope that class is on cwd.
+  // This is not conformant with the spec but who cares.
+  std::unique_ptr<Utils::MappedFile> File;
+  try {
+    File = std::make_unique<Utils::MappedFile>(getFileName(Name));
+  } catch (Utils::ReadError &) {
+    throw ClassNotFoundException("Can't find class " + Name);
   }
 
-  virtual std::unique_ptr<JavaTypes::JavaClass> deriveClass(
-      std::istream &Bytes) const override {
-    return CD::parseFromStream(Bytes);
-  }
-};
+  return CM.defineClass(Name, std::string_view(
+      reinterpret_cast<const char*>(File->data()), File->size()), *this);
+}
+
+std::string BootstrapLoader::readClass(const Utf8String &Name) const {
+  std::ifstream file(getFileName(Name), std::ios_base::binary);
+  if (!file)
+    throw ClassNotFoundException("Can't find class " + Name);
+
+  return std::string(
+      std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+std::string BootstrapLoader::getFileName(const Utf8String &Name) const {
+  return Name + ".class";
+}
+
+std::unique_ptr<JavaTypes::JavaClass> BootstrapLoader::deriveClass(
+    std::string_view Bytes) const {
+  return ClassFileReader::loadClassFromBuffer(
+      reinterpret_cast<const uint8_t*>(Bytes.data()), Bytes.size());
+}
+
+std::string TestLoader::getFileName(const Utf8String &Name) const {
+  return Name + ".cd";
+}
+
+ClassPathLoader::ClassPathLoader(const std::string &Spec):
+  Path(Spec) {
+  ;
+}
+
+JavaTypes::JavaClass &ClassPathLoader::loadClass(
+    const Utf8String &Name, ClassManager &CM) const {
+
+  const auto Bytes = readClass(Name);
+  return CM.defineClass(Name, std::string_view(Bytes), *this);
+}
+
+std::string ClassPathLoader::readClass(const Utf8String &Name) const {
+  auto Bytes = Path.read(Name);
+  if (!Bytes)
+    throw ClassNotFoundException("Can't find class " + Name);
+  return std::move(*Bytes);
+}
+
+std::unique_ptr<JavaTypes::JavaClass> TestLoader::deriveClass(
+    std::string_view Bytes) const {
+  return CD::parseFromString(Bytes);
 }
 
 const ClassLoader &Runtime::getBootstrapLoader() {
@@ -7,9 +7,26 @@
 #define ICP_CLASSMANAGER_H
 
 #include "Runtime/Objects.h"
+#include "Runtime/NativeMethods.h"
+#include "Runtime/Heap.h"
+#include "Runtime/ClassPath.h"
+#include "Runtime/VerificationCache.h"
 #include "JavaTypes/JavaTypesFwd.h"
+#include "Utils/ConcurrentHashMap.h"
 
-#include <map>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace Utils {
+class ThreadPool;
+}
 
 namespace Runtime {
 
@@ -19,6 +36,9 @@ class ClassNotFoundException: public std::runtime_error {
 class LinkageError: public std::runtime_error {
   using runtime_error::runtime_error;
 };
+class NoClassDefFoundError: public LinkageError {
+  using LinkageError::LinkageError;
+};
 
 class ClassManager;
 
@@ -30,19 +50,111 @@ public:
   virtual JavaTypes::JavaClass &loadClass(
       const Utf8String &Name, ClassManager &CM) const = 0;
 
+  // Parses class from the raw bytes. Resulting class doesn't refer to them.
   virtual std::unique_ptr<JavaTypes::JavaClass> deriveClass(
-      std::istream &Bytes) const = 0;
+      std::string_view Bytes) const = 0;
+
+  // Reads raw bytes of the class without defining it. Used by the batch
+  // loading which parses classes outside of the class manager.
+  // \throws ClassNotFoundException
+  virtual std::string readClass(const Utf8String &Name) const = 0;
+};
+
+// Loads classes from the class files in the current directory.
+class BootstrapLoader: public ClassLoader {
+public:
+  JavaTypes::JavaClass &loadClass(
+      const Utf8String &Name, ClassManager &CM) const override;
+
+  std::unique_ptr<JavaTypes::JavaClass> deriveClass(
+      std::string_view Bytes) const override;
+
+  std::string readClass(const Utf8String &Name) const override;
+
+protected:
+  // \returns File name for the given class name
+  virtual std::string getFileName(const Utf8String &Name) const;
+};
+
+// Loads classes from the CD files in the current directory.
+class TestLoader: public BootstrapLoader {
+public:
+  std::unique_ptr<JavaTypes::JavaClass> deriveClass(
+      std::string_view Bytes) const override;
+
+protected:
+  std::string getFileName(const Utf8String &Name) const override;
 };
 
+// Loads class files from the class path.
+class ClassPathLoader: public BootstrapLoader {
+public:
+  // \param Spec List of directories and archives separated by ':'.
+  // \throws ClassPathError If some of the entries can't be opened.
+  explicit ClassPathLoader(const std::string &Spec);
+
+  JavaTypes::JavaClass &loadClass(
+      const Utf8String &Name, ClassManager &CM) const override;
+
+  std::string readClass(const Utf8String &Name) const override;
+
+  const ClassPath &getClassPath() const { return Path; }
+
+private:
+  ClassPath Path;
+};
+
+// Process wide loader instances. Loaders are stateless, so it's fine to use
+// them from different class managers. However each VM instance has it's own
+// loaders as well.
 const ClassLoader &getBootstrapLoader();
 const ClassLoader &getTestLoader();
 
+class SharedClassCache;
+
+// Runtime information about the loaded class. Owned by the class manager
+// which defined the class. Class itself might be shared with other class
+// managers, in that case only one of them is linked from the JavaClass.
+struct ClassMetaInfo final {
+  enum StateType {
+    LOADED, INIT_IN_PROGRESS, INITIALIZED, ERRONEOUS
+  };
+
+  ClassMetaInfo(
+      const ClassManager &Owner,
+      const ClassLoader &DefLoader,
+      std::shared_ptr<JavaTypes::JavaClass> Class);
+  ~ClassMetaInfo();
+
+  const ClassManager &Owner;
+  const ClassLoader &DefLoader;
+  const std::shared_ptr<JavaTypes::JavaClass> Class;
+
+  // Set before the state becomes INITIALIZED
+  std::unique_ptr<ClassObject> Object;
+  // Modified under the class manager lock. Once class is initialized it may
+  // be read without any locking.
+  std::atomic<StateType> State;
+  // Valid only in the INIT_IN_PROGRESS state
+  std::thread::id InitThread = {};
+  // Methods are verified on their first invocation instead of the class
+  // initialization.
+  std::atomic<bool> VerifyLazily = false;
+  // Key of the class bytes in the verification cache. Only computed when
+  // the cache was used at the time of loading.
+  std::optional<VerificationCache::Key> CacheKey;
+};
+
 
-// TODO: This should be thread safe and it's not
+// All methods are thread safe. Class initialization follows JVMS 5.5:
+// concurrent requests wait until the initializing thread is done, while
+// recursive requests from the initializing thread itself return immediately.
 class ClassManager final {
 public:
-  // Creates empty class manager
-  ClassManager() = default;
+  // Creates empty class manager.
+  // \param Cache If specified parsed classes are taken from this cache.
+  explicit ClassManager(std::shared_ptr<SharedClassCache> Cache = nullptr);
+  ~ClassManager();
 
   // No copies
   ClassManager(const ClassManager&) = delete;
@@ -55,52 +167,177 @@ public:
   // \throws ClassNotFoundException
   // \throws LinkageError
   const JavaTypes::JavaClass &getClass(
-      const Utf8String &Name, const ClassLoader &ILoader);
+      Utils::Symbol Name, const ClassLoader &ILoader);
+  const JavaTypes::JavaClass &getClass(
+      const Utf8String &Name, const ClassLoader &ILoader) {
+    return getClass(Utils::Symbol::intern(Name), ILoader);
+  }
 
   // Create object for the loaded class.
-  // This involves verification. preparation and initialization.
+  // This involves verification. preparation, binding of the native methods
+  // and initialization. If any of these steps fail class is marked as
+  // erroneous and all subsequent requests fail.
   // \throws VerificationError
+  // \throws UnsatisfiedLinkError
+  // \throws NoClassDefFoundError
   Runtime::ClassObject &getClassObject(const JavaTypes::JavaClass &Class);
 
   // Same as previous but uses class name instead of it's object.
   // Additionaly may cause class loading.
+  Runtime::ClassObject &getClassObject(
+      Utils::Symbol Name, const ClassLoader &ILoader) {
+    return getClassObject(getClass(Name, ILoader));
+  }
   Runtime::ClassObject &getClassObject(
       const Utf8String &Name, const ClassLoader &ILoader) {
     return getClassObject(getClass(Name, ILoader));
   }
 
+  // Loads all given classes using the thread pool. Reading and parsing of
+  // the different classes overlap, classes are defined afterwards in the
+  // order of the list, so the result doesn't depend on the scheduling.
+  // Classes which are already loaded are returned as is.
+  // Either all classes are defined or none of them.
+  // \returns Classes in the same order as names.
+  // \throws First error in the order of the list.
+  std::vector<const JavaTypes::JavaClass*> loadClasses(
+      const std::vector<Utf8String> &Names,
+      const ClassLoader &ILoader,
+      Utils::ThreadPool &Pool);
+
+  // Initializes all given classes concurrently using the thread pool.
+  // Dependencies between classes are derived from the constant pool
+  // references of their <clinit> methods and the methods of the same class
+  // they call. Class is initialized only after all of the classes from this
+  // list it depends on. Classes with cyclic dependencies are initialized
+  // sequentially in the order of the list after all others. Dependencies
+  // hidden in the other classes may still make two classes wait for each
+  // other, then one of them proceeds as with a recursive request.
+  // \throws Error of the first failed class in the order of the list, other
+  // classes are still initialized.
+  void initializeClasses(
+      const std::vector<const JavaTypes::JavaClass*> &ToInit,
+      Utils::ThreadPool &Pool);
+
   const ClassLoader *getDefLoader(const JavaTypes::JavaClass &Class) const;
 
-  // Helper method for the class loaders.
+  // When enabled classes initialized after this call are not verified
+  // upfront. Instead each method is verified on it's first invocation as
+  // permitted by JVMS 5.4. Classes found in the verification cache are not
+  // affected.
+  void setLazyVerification(bool Enable) {
+    LazyVerification.store(Enable);
+  }
+
+  // Should be called before each method invocation. Verifies the method if
+  // it wasn't done yet and it's class is verified lazily.
+  // \throws VerificationError
+  void verifyBeforeInvoke(const JavaTypes::JavaMethod &Method) const;
+
+  // Methods of the classes initialized after this call are verified
+  // concurrently using the given pool. Null means that verification happens
+  // on the initializing thread. Pool should outlive this manager.
+  void setVerificationPool(Utils::ThreadPool *Pool) {
+    VerificationPool.store(Pool);
+  }
+
+  // Classes loaded after this call are not verified if the cache says they
+  // were verified before. Newly verified classes are recorded in the cache.
+  // Cache should outlive this manager.
+  void setVerificationCache(VerificationCache *VCache) {
+    VerifyCache.store(VCache);
+  }
+
+  // Load shared library which will be used to look up native methods of the
+  // classes linked after this call.
+  // \throws UnsatisfiedLinkError
+  void loadNativeLibrary(const std::string &Path) {
+    std::lock_guard<std::recursive_mutex> Guard(Lock);
+    Natives.load(Path);
+  }
+
+  // All objects allocated by the code running in this class manager
+  Heap &getHeap() { return ObjectsHeap; }
+
+  // Helper method for the class loaders. Bytes are only used during the call.
   // \throws Various class parsing errors depending on the parsing method
+  JavaTypes::JavaClass &defineClass(
+      const Utf8String &Name, std::string_view Bytes,
+      const ClassLoader &DefLoader);
+
+  // Same as above but reads bytes from the stream first.
   JavaTypes::JavaClass &defineClass(
       const Utf8String &Name, std::istream &Bytes, const ClassLoader &DefLoader);
 
 private:
-  struct ClassMetaInfo {
-    const ClassLoader &DefLoader;
-    std::unique_ptr<JavaTypes::JavaClass> Class;
-    std::unique_ptr<ClassObject> Object;
-    enum {
-      LOADED, INIT_IN_PROGRESS, INITIALIZED
-    } State;
+  using InitLoaderKey = std::pair<Utils::Symbol, const ClassLoader*>;
+  struct InitLoaderKeyHash {
+    std::size_t operator()(const InitLoaderKey &Key) const {
+      return Key.first.hash() * 31 +
+             std::hash<const ClassLoader*>()(Key.second);
+    }
   };
 
 private:
+  // Checks if initialization of the 'Meta' class waits for the 'Thread',
+  // directly or through the other waiting threads. Should be called under
+  // the lock.
+  bool isInitBlockedOn(
+      const ClassMetaInfo &Meta, std::thread::id Thread) const;
+
+  // Parses the class or takes it from the cache. Doesn't need the lock.
+  // \param CacheKey Receives the verification cache key of the class bytes
+  // if the verification cache is used.
+  std::shared_ptr<JavaTypes::JavaClass> parseClass(
+      std::string_view Bytes, const ClassLoader &DefLoader,
+      std::optional<VerificationCache::Key> &CacheKey);
+
+  // Records parsed class as defined by the 'DefLoader'. Should be called
+  // under the lock.
+  // \throws LinkageError if class with the same name is already defined.
+  ClassMetaInfo &recordClass(
+      std::shared_ptr<JavaTypes::JavaClass> Class, const ClassLoader &DefLoader,
+      const std::optional<VerificationCache::Key> &CacheKey);
+
+  // Lock free.
   // \returns null if no information was found
-  const ClassMetaInfo *getMetaInfoForInitLoader(
-      const Utf8String &Name, const ClassLoader &ILoader) const;
+  ClassMetaInfo *getMetaInfoForInitLoader(
+      Utils::Symbol Name, const ClassLoader &ILoader) const;
 
-  // Always succeeds since class must have been loaded
-  const ClassMetaInfo &getMetaInfoForClass(
-      const JavaTypes::JavaClass &Class) const;
-  ClassMetaInfo &getMetaInfoForClass(const JavaTypes::JavaClass &Class);
+  // Lock free. Always succeeds since class must have been loaded.
+  ClassMetaInfo &getMetaInfoForClass(const JavaTypes::JavaClass &Class) const;
 
 private:
-  std::multimap<Utf8String, ClassMetaInfo> Classes;
+  // Metadata for all classes defined by this manager
+  std::vector<std::unique_ptr<ClassMetaInfo>> Classes;
 
-  std::map<std::pair<Utf8String, const ClassLoader*>, const ClassMetaInfo*>
+  // Lookups are lock free, insertions are done under the Lock
+  Utils::ConcurrentHashMap<InitLoaderKey, ClassMetaInfo*, InitLoaderKeyHash>
       ClassesInitLoaders;
+
+  // Metadata of the shared classes which are linked to the other managers
+  Utils::ConcurrentHashMap<const JavaTypes::JavaClass*, ClassMetaInfo*>
+      ForeignClasses;
+
+  const std::shared_ptr<SharedClassCache> Cache;
+
+  std::atomic<Utils::ThreadPool*> VerificationPool{nullptr};
+  std::atomic<VerificationCache*> VerifyCache{nullptr};
+  std::atomic<bool> LazyVerification{false};
+
+  NativeLibraries Natives;
+
+  // Guards all of the above except for the lookups. Recursive since class
+  // loaders call back into 'defineClass' while 'getClass' is in progress.
+  mutable std::recursive_mutex Lock;
+  // Notified each time some class finishes it's initialization
+  std::condition_variable_any InitDone;
+  // Class which each thread waits to be initialized by some other thread.
+  // Guarded by the Lock.
+  std::unordered_map<std::thread::id, const ClassMetaInfo*> InitWaits;
+
+  // Declared last so that objects die before their classes
+  Heap ObjectsHeap;
 };
 
 }
@@ -0,0 +1,295 @@
+///
+/// Class path implementation. Only the parts of the zip format which are
+/// used by the jar files are supported: single disk archives without zip64
+/// extensions and with stored or deflated entries.
+///
+
+#include "ClassPath.h"
+
+#include <zlib.h>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <new>
+
+using namespace Runtime;
+using namespace Utils;
+
+namespace {
+
+constexpr uint32_t EndOfCentralDirSignature = 0x06054b50;
+constexpr uint32_t CentralDirHeaderSignature = 0x02014b50;
+constexpr uint32_t LocalHeaderSignature = 0x04034b50;
+
+constexpr std::size_t EndOfCentralDirSize = 22;
+constexpr std::size_t MaxCommentSize = 0xffff;
+constexpr std::size_t LocalHeaderSize = 30;
+
+constexpr uint16_t MethodStored = 0;
+constexpr uint16_t MethodDeflated = 8;
+
+// Deflate output is at most 1032 times larger than it's input
+constexpr uint64_t MaxDeflateRatio = 1032;
+constexpr uint64_t MaxDeflateOverhead = 1024;
+
+const std::string ClassSuffix = ".class";
+
+// Zip is little endian while our reader is big endian
+uint16_t readLE16(const uint8_t *Data) {
+  return static_cast<uint16_t>(Data[0] | (Data[1] << 8));
+}
+
+uint32_t readLE32(const uint8_t *Data) {
+  return static_cast<uint32_t>(Data[0]) |
+         (static_cast<uint32_t>(Data[1]) << 8) |
+         (static_cast<uint32_t>(Data[2]) << 16) |
+         (static_cast<uint32_t>(Data[3]) << 24);
+}
+
+bool endsWith(const std::string &Str, const std::string &Suffix) {
+  return Str.size() >= Suffix.size() &&
+         Str.compare(Str.size() - Suffix.size(), Suffix.size(), Suffix) == 0;
+}
+
+}
+
+ClassPath::ClassPath(const std::string &Spec) {
+  std::size_t Start = 0;
+  while (Start <= Spec.size()) {
+    auto End = Spec.find(':', Start);
+    if (End == std::string::npos)
+      End = Spec.size();
+
+    if (End != Start)
+      add(Spec.substr(Start, End - Start));
+    Start = End + 1;
+  }
+}
+
+ClassPath::~ClassPath() = default;
+
+void ClassPath::add(const std::string &Path) {
+  struct stat Stat;
+  if (stat(Path.c_str(), &Stat) != 0)
+    throw ClassPathError("Can't find class path entry " + Path);
+
+  if (S_ISDIR(Stat.st_mode))
+    addDirectory(Path);
+  else
+    addArchive(Path);
+}
+
+void ClassPath::addEntry(std::string ClassName, Entry E) {
+  // First entry on the class path wins
+  Index.emplace(std::move(ClassName), std::move(E));
+}
+
+void ClassPath::addDirectory(const std::string &Path) {
+  DirIds Visited;
+  indexDirectory(Path, "", Visited);
+}
+
+void ClassPath::indexDirectory(
+    const std::string &Root, const std::string &Prefix, DirIds &Visited) {
+
+  const std::string DirPath = Prefix.empty() ? Root : Root + "/" + Prefix;
+
+  // Symbolic link cycles would recurse forever
+  struct stat DirStat;
+  if (stat(DirPath.c_str(), &DirStat) != 0)
+    throw ClassPathError("Can't open directory " + DirPath);
+  if (!Visited.emplace(DirStat.st_dev, DirStat.st_ino).second)
+    return;
+
+  DIR *Dir = opendir(DirPath.c_str());
+  if (!Dir)
+    throw ClassPathError("Can't open directory " + DirPath);
+
+  std::vector<std::string> SubDirs;
+  while (const dirent *Ent = readdir(Dir)) {
+    const std::string Name = Ent->d_name;
+    if (Name == "." || Name == "..")
+      continue;
+
+    const std::string RelPath = Prefix.empty() ? Name : Prefix + "/" + Name;
+
+    bool IsDir = Ent->d_type == DT_DIR;
+    if (Ent->d_type == DT_UNKNOWN || Ent->d_type == DT_LNK) {
+      struct stat Stat;
+      IsDir = stat((Root + "/" + RelPath).c_str(), &Stat) == 0 &&
+              S_ISDIR(Stat.st_mode);
+    }
+
+    if (IsDir) {
+      SubDirs.push_back(RelPath);
+    } else if (endsWith(Name, ClassSuffix)) {
+      Entry E;
+      E.Path = Root + "/" + RelPath;
+      addEntry(RelPath.substr(0, RelPath.size() - ClassSuffix.size()),
+               std::move(E));
+    }
+  }
+  closedir(Dir);
+
+  for (const auto &Sub: SubDirs)
+    indexDirectory(Root, Sub, Visited);
+}
+
+void ClassPath::addArchive(const std::string &Path) {
+  std::unique_ptr<MappedFile> File;
+  try {
+    File = std::make_unique<MappedFile>(Path);
+  } catch (ReadError &) {
+    throw ClassPathError("Can't open archive " + Path);
+  }
+
+  const uint8_t *Data = File->data();
+  const std::size_t Size = File->size();
+  if (Size < EndOfCentralDirSize)
+    throw ClassPathError("Archive is too small " + Path);
+
+  // End of central directory record is followed by the variable sized
+  // comment, so search for it backwards.
+  const uint8_t *EndRecord = nullptr;
+  const std::size_t SearchEnd =
+      Size >= EndOfCentralDirSize + MaxCommentSize ?
+      Size - EndOfCentralDirSize - MaxCommentSize : 0;
+  for (std::size_t Pos = Size - EndOfCentralDirSize + 1; Pos-- > SearchEnd;) {
+    if (readLE32(Data + Pos) == EndOfCentralDirSignature) {
+      EndRecord = Data + Pos;
+      break;
+    }
+  }
+  if (!EndRecord)
+    throw ClassPathError("Can't find central directory in " + Path);
+
+  const uint16_t NumEntries = readLE16(EndRecord + 10);
+  const uint32_t DirSize = readLE32(EndRecord + 12);
+  const uint32_t DirOffset = readLE32(EndRecord + 16);
+  if (NumEntries == 0xffff || DirOffset == 0xffffffff)
+    throw ClassPathError("Zip64 archives are not supported " + Path);
+  if (static_cast<std::size_t>(DirOffset) + DirSize > Size)
+    throw ClassPathError("Malformed central directory in " + Path);
+
+  // Walk the central directory, this is the only place which lists all of
+  // the entries.
+  const uint8_t *Cur = Data + DirOffset;
+  const uint8_t *const DirEnd = Cur + DirSize;
+  const std::size_t CentralHeaderSize = 46;
+  for (uint16_t Idx = 0; Idx < NumEntries; ++Idx) {
+    if (static_cast<std::size_t>(DirEnd - Cur) < CentralHeaderSize ||
+        readLE32(Cur) != CentralDirHeaderSignature)
+      throw ClassPathError("Malformed central directory in " + Path);
+
+    const uint16_t NameLength = readLE16(Cur + 28);
+    const uint16_t ExtraLength = readLE16(Cur + 30);
+    const uint16_t CommentLength = readLE16(Cur + 32);
+    const std::size_t HeaderSize =
+        CentralHeaderSize + NameLength + ExtraLength + CommentLength;
+    if (static_cast<std::size_t>(DirEnd - Cur) < HeaderSize)
+      throw ClassPathError("Malformed central directory in " + Path);
+
+    std::string Name(
+        reinterpret_cast<const char*>(Cur + CentralHeaderSize), NameLength);
+    if (endsWith(Name, ClassSuffix)) {
+      Entry E;
+      E.Archive = File.get();
+      E.Method = readLE16(Cur + 10);
+      E.CompressedSize = readLE32(Cur + 20);
+      E.UncompressedSize = readLE32(Cur + 24);
+      E.LocalHeaderOffset = readLE32(Cur + 42);
+      E.Path = Name;
+
+      Name.resize(Name.size() - ClassSuffix.size());
+      addEntry(std::move(Name), std::move(E));
+    }
+
+    Cur += HeaderSize;
+  }
+
+  Archives.push_back(std::move(File));
+}
+
+bool ClassPath::contains(const Utf8String &ClassName) const {
+  return Index.count(ClassName) != 0;
+}
+
+std::optional<std::string> ClassPath::read(const Utf8String &ClassName) const {
+  auto It = Index.find(ClassName);
+  if (It == Index.end())
+    return std::nullopt;
+
+  const Entry &E = It->second;
+  if (E.Archive)
+    return readFromArchive(E);
+
+  try {
+    MappedFile File(E.Path);
+    return std::string(reinterpret_cast<const char*>(File.data()), File.size());
+  } catch (ReadError &) {
+    throw ClassPathError("Can't read class file " + E.Path);
+  }
+}
+
+std::string ClassPath::readFromArchive(const Entry &E) const {
+  const uint8_t *Data = E.Archive->data();
+  const std::size_t Size = E.Archive->size();
+
+  // Local header might have different extra field than the central one
+  const std::size_t HeaderPos = E.LocalHeaderOffset;
+  if (HeaderPos + LocalHeaderSize > Size ||
+      readLE32(Data + HeaderPos) != LocalHeaderSignature)
+    throw ClassPathError("Malformed local header for " + E.Path);
+
+  const std::size_t DataPos = HeaderPos + LocalHeaderSize +
+      readLE16(Data + HeaderPos + 26) + readLE16(Data + HeaderPos + 28);
+  if (DataPos + E.CompressedSize > Size)
+    throw ClassPathError("Truncated archive entry " + E.Path);
+  const uint8_t *Compressed = Data + DataPos;
+
+  if (E.Method == MethodStored) {
+    if (E.CompressedSize != E.UncompressedSize)
+      throw ClassPathError("Malformed stored entry " + E.Path);
+    return std::string(
+        reinterpret_cast<const char*>(Compressed), E.CompressedSize);
+  }
+
+  if (E.Method != MethodDeflated)
+    throw ClassPathError("Unsupported compression method for " + E.Path);
+
+  // Sizes come from the archive, don't trust them with the allocation.
+  // Deflate can't do better than this, anything above is malformed.
+  if (E.UncompressedSize >
+      static_cast<uint64_t>(E.CompressedSize) * MaxDeflateRatio +
+      MaxDeflateOverhead)
+    throw ClassPathError("Malformed archive entry size " + E.Path);
+
+  std::string Ret;
+  try {
+    Ret.resize(E.UncompressedSize);
+  } catch (std::bad_alloc &) {
+    throw ClassPathError("Archive entry is too large " + E.Path);
+  }
+
+  z_stream Stream;
+  std::memset(&Stream, 0, sizeof(Stream));
+  // Negative window bits for the raw deflate data without zlib header
+  if (inflateInit2(&Stream, -MAX_WBITS) != Z_OK)
+    throw ClassPathError("Can't initialize inflater");
+
+  Stream.next_in = const_cast<Bytef*>(Compressed);
+  Stream.avail_in = E.CompressedSize;
+  Stream.next_out = reinterpret_cast<Bytef*>(&Ret[0]);
+  Stream.avail_out = E.UncompressedSize;
+
+  const int Res = inflate(&Stream, Z_FINISH);
+  const auto Produced = Stream.total_out;
+  inflateEnd(&Stream);
+
+  if (Res != Z_STREAM_END || Produced != E.UncompressedSize)
+    throw ClassPathError("Can't inflate archive entry " + E.Path);
+
+  return Ret;
+}
@@ -0,0 +1,93 @@
+///
+/// Class path made of the directories and jar (zip) archives. All entries
+/// are indexed once when they are added, so lookups never touch the file
+/// system unless the class is actually there.
+///
+
+#ifndef ICP_CLASSPATH_H
+#define ICP_CLASSPATH_H
+
+#include "Utils/BinaryFiles.h"
+#include "Utils/Utf8String.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Runtime {
+
+class ClassPathError: public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+class ClassPath final {
+public:
+  ClassPath() = default;
+  ~ClassPath();
+
+  // No copies, index refers to the mapped archives
+  ClassPath(const ClassPath &) = delete;
+  ClassPath &operator=(const ClassPath &) = delete;
+
+  // Parses list of the entries separated by ':'.
+  // \throws ClassPathError If some of the entries can't be opened.
+  explicit ClassPath(const std::string &Spec);
+
+  // Adds directory or archive depending on the entry type. Earlier entries
+  // take precedence over the later ones.
+  // \throws ClassPathError If entry can't be opened or is malformed.
+  void add(const std::string &Path);
+  void addDirectory(const std::string &Path);
+  void addArchive(const std::string &Path);
+
+  // \returns Whether class with the given name ("java/lang/Object") exists.
+  // Doesn't perform any system calls.
+  bool contains(const Utf8String &ClassName) const;
+
+  // Reads the class file. Compressed archive entries are inflated only here.
+  // \returns Class file bytes or nothing if class is not on the class path.
+  // \throws ClassPathError If entry can't be read.
+  std::optional<std::string> read(const Utf8String &ClassName) const;
+
+  std::size_t numClasses() const { return Index.size(); }
+
+private:
+  // Location of the single class file
+  struct Entry {
+    // Null for the plain files
+    const Utils::MappedFile *Archive = nullptr;
+    // File path or entry name inside of the archive
+    std::string Path;
+
+    // Archive only
+    uint16_t Method = 0;
+    uint32_t CompressedSize = 0;
+    uint32_t UncompressedSize = 0;
+    uint32_t LocalHeaderOffset = 0;
+  };
+
+  // Device and inode of the directories which were already indexed. Symbolic
+  // links are followed, so the same directory might be reached twice.
+  using DirIds = std::set<std::pair<uint64_t, uint64_t>>;
+
+  void indexDirectory(
+      const std::string &Root, const std::string &Prefix, DirIds &Visited);
+  void addEntry(std::string ClassName, Entry E);
+
+  std::string readFromArchive(const Entry &E) const;
+
+private:
+  std::vector<std::unique_ptr<Utils::MappedFile>> Archives;
+  // Class name without the ".class" suffix to it's location
+  std::unordered_map<std::string, Entry> Index;
+};
+
+}
+
+#endif //ICP_CLASSPATH_H
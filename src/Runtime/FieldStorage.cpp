@@ -32,10 +32,27 @@ FieldStorage::FieldStorage(const JavaTypes::JavaClass &Class, bool is_static):
   }
 
   Fields.resize(ObjectSize);
+
+  // Static fields with the 'ConstantValue' attribute are initialized during
+  // preparation (jvms 5.4.2), before any class initializer has a chance to
+  // observe them.
+  if (Kind != STATIC)
+    return;
+  std::size_t CurrentOffset = 0;
+  for (const auto &Field: Class.fields()) {
+    if (!shouldManage(Field))
+      continue;
+    if (Field.hasConstantValue())
+      Value::toMemory(
+          Fields.data() + CurrentOffset,
+          Field.getConstantValue().getValue(),
+          Field.getType());
+    CurrentOffset += Field.getSize();
+  }
 }
 
 std::pair<const JavaField*, std::size_t>
-FieldStorage::findFieldAndOffset(const Utf8String &Name) const {
+FieldStorage::findFieldAndOffset(Utils::Symbol Name) const {
   std::size_t CurrentOffset = 0;
   const JavaField *Found = nullptr;
 
@@ -56,7 +73,7 @@ FieldStorage::findFieldAndOffset(const Utf8String &Name) const {
   return {Found, CurrentOffset};
 }
 
-Value FieldStorage::getField(const Utf8String &Name) const {
+Value FieldStorage::getField(Utils::Symbol Name) const {
   std::size_t Offset = 0;
   const JavaField *Field = nullptr;
 
@@ -64,7 +81,7 @@ Value FieldStorage::getField(const Utf8String &Name) const {
   return Value::fromMemory(Field->getType(), Fields.data() + Offset);
 }
 
-void FieldStorage::setField(const Utf8String &Name, const Value &V) {
+void FieldStorage::setField(Utils::Symbol Name, const Value &V) {
   std::size_t Offset = 0;
   const JavaField *Field = nullptr;
 
@@ -10,6 +10,7 @@
 #include "Runtime/Value.h"
 #include "JavaTypes/JavaTypesFwd.h"
 #include "Utils/Utf8String.h"
+#include "Utils/Symbol.h"
 
 namespace Runtime {
 
@@ -20,17 +21,21 @@ public:
   // Creates field storage for the given class.
   // If 'is_static' is true only manages static fields.
   // If 'is_static' is false only manages instance fields.
+  // Static fields with a constant value are initialized to that value, all
+  // others are zero initialized.
   FieldStorage(const JavaTypes::JavaClass &Class, bool is_static);
 
   // \throws UnrecognizedField If no field was found.
-  Value getField(const Utf8String &Name) const;
+  Value getField(Utils::Symbol Name) const;
 
   // \throws UnrecognizedField If no field was found.
-  void setField(const Utf8String &Name, const Value &V);
+  void setField(Utils::Symbol Name, const Value &V);
 
+  // Fields are compared by their symbols, so strings which were never
+  // interned can't match any field.
   // \throws UnrecognizedField If no field was found.
   std::pair<const JavaTypes::JavaField*, std::size_t>
-  findFieldAndOffset(const Utf8String &Name) const;
+  findFieldAndOffset(Utils::Symbol Name) const;
 
 private:
   bool shouldManage(const JavaTypes::JavaField &F) const;
@@ -0,0 +1,48 @@
+///
+/// Owner of all objects allocated by the single VM instance. There is no
+/// garbage collection yet, so objects are freed together with the heap.
+///
+
+#ifndef ICP_HEAP_H
+#define ICP_HEAP_H
+
+#include "Runtime/Objects.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Runtime {
+
+class Heap final {
+public:
+  Heap() = default;
+
+  // No copies
+  Heap(const Heap &) = delete;
+  Heap &operator=(const Heap &) = delete;
+
+  // Takes ownership of the newly created object. Thread safe.
+  template<class T>
+  T *adopt(std::unique_ptr<T> Obj) {
+    static_assert(std::is_base_of_v<Object, T>);
+
+    T *Ret = Obj.get();
+    std::lock_guard<std::mutex> Guard(Lock);
+    Objects.push_back(std::move(Obj));
+    return Ret;
+  }
+
+  std::size_t numObjects() const {
+    std::lock_guard<std::mutex> Guard(Lock);
+    return Objects.size();
+  }
+
+private:
+  mutable std::mutex Lock;
+  std::vector<std::unique_ptr<Object>> Objects;
+};
+
+}
+
+#endif //ICP_HEAP_H
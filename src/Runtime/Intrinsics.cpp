@@ -0,0 +1,204 @@
+///
+/// Implementation of the intrinsic methods. Each of them should follow java
+/// semantics exactly, which is not always the same as the C++ one.
+///
+
+#include "Intrinsics.h"
+
+#include "JavaTypes/Type.h"
+
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+using namespace Runtime;
+using namespace JavaTypes;
+
+namespace {
+
+// Integer Math.abs. Java defines abs(MIN_VALUE) as MIN_VALUE which would be
+// an overflow in C++, so negate in unsigned arithmetic instead.
+template<class T>
+Value absInt(const Value *Args) {
+  using UnsignedT = std::make_unsigned_t<T>;
+
+  const T X = Args[0].getAs<T>();
+  const UnsignedT Res = X < 0 ?
+      static_cast<UnsignedT>(0) - static_cast<UnsignedT>(X) :
+      static_cast<UnsignedT>(X);
+  return Value::create<T>(static_cast<T>(Res));
+}
+
+template<class T>
+Value absFloat(const Value *Args) {
+  return Value::create<T>(std::fabs(Args[0].getAs<T>()));
+}
+
+template<class T>
+Value minInt(const Value *Args) {
+  const T A = Args[0].getAs<T>();
+  const T B = Args[1].getAs<T>();
+  return Value::create<T>(A < B ? A : B);
+}
+
+template<class T>
+Value maxInt(const Value *Args) {
+  const T A = Args[0].getAs<T>();
+  const T B = Args[1].getAs<T>();
+  return Value::create<T>(A > B ? A : B);
+}
+
+// Floating point min and max propagate NaN's and treat negative zero as
+// strictly smaller than positive zero. std::min and std::max do neither.
+template<class T>
+Value minFloat(const Value *Args) {
+  const T A = Args[0].getAs<T>();
+  const T B = Args[1].getAs<T>();
+
+  if (std::isnan(A) || std::isnan(B))
+    return Value::create<T>(std::numeric_limits<T>::quiet_NaN());
+  if (A == B)
+    return Value::create<T>(std::signbit(A) ? A : B);
+  return Value::create<T>(A < B ? A : B);
+}
+
+template<class T>
+Value maxFloat(const Value *Args) {
+  const T A = Args[0].getAs<T>();
+  const T B = Args[1].getAs<T>();
+
+  if (std::isnan(A) || std::isnan(B))
+    return Value::create<T>(std::numeric_limits<T>::quiet_NaN());
+  if (A == B)
+    return Value::create<T>(std::signbit(A) ? B : A);
+  return Value::create<T>(A > B ? A : B);
+}
+
+Value sqrtDouble(const Value *Args) {
+  return Value::create<JavaDouble>(std::sqrt(Args[0].getAs<JavaDouble>()));
+}
+
+// Math.fma requires single rounding, std::fma provides exactly that.
+template<class T>
+Value fmaFloat(const Value *Args) {
+  return Value::create<T>(std::fma(
+      Args[0].getAs<T>(), Args[1].getAs<T>(), Args[2].getAs<T>()));
+}
+
+Value bitCountInt(const Value *Args) {
+  const auto X = static_cast<uint32_t>(Args[0].getAs<JavaInt>());
+  return Value::create<JavaInt>(__builtin_popcount(X));
+}
+
+Value bitCountLong(const Value *Args) {
+  const auto X = static_cast<uint64_t>(Args[0].getAs<JavaLong>());
+  return Value::create<JavaInt>(__builtin_popcountll(X));
+}
+
+// Builtin clz is undefined for zero, java defines it as the type width.
+Value leadingZerosInt(const Value *Args) {
+  const auto X = static_cast<uint32_t>(Args[0].getAs<JavaInt>());
+  return Value::create<JavaInt>(X == 0 ? 32 : __builtin_clz(X));
+}
+
+Value leadingZerosLong(const Value *Args) {
+  const auto X = static_cast<uint64_t>(Args[0].getAs<JavaLong>());
+  return Value::create<JavaInt>(X == 0 ? 64 : __builtin_clzll(X));
+}
+
+Value reverseBytesInt(const Value *Args) {
+  const auto X = static_cast<uint32_t>(Args[0].getAs<JavaInt>());
+  return Value::create<JavaInt>(static_cast<JavaInt>(__builtin_bswap32(X)));
+}
+
+Value reverseBytesLong(const Value *Args) {
+  const auto X = static_cast<uint64_t>(Args[0].getAs<JavaLong>());
+  return Value::create<JavaLong>(static_cast<JavaLong>(__builtin_bswap64(X)));
+}
+
+Value nanoTime(const Value *) {
+  const auto Now = std::chrono::steady_clock::now().time_since_epoch();
+  return Value::create<JavaLong>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Now).count());
+}
+
+// Key is in the form of "<class>.<name>:<descriptor>".
+using IntrinsicTable = std::unordered_map<std::string, Intrinsic>;
+
+std::string makeKey(
+    const Utf8String &ClassName,
+    const Utf8String &Name,
+    const Utf8String &Descriptor) {
+  return ClassName + "." + Name + ":" + Descriptor;
+}
+
+IntrinsicTable createTable() {
+  IntrinsicTable Ret;
+
+  auto Add = [&](
+      const char *ClassName, const char *Name, const char *Descriptor,
+      Intrinsic::FunctionType Fn) {
+    const auto &[RetType, ArgTypes] = Type::parseMethodDescriptor(Descriptor);
+
+    Intrinsic NewIntrinsic;
+    NewIntrinsic.Fn = Fn;
+    assert(ArgTypes.size() <= Intrinsic::MaxArgs);
+    NewIntrinsic.NumArgs = static_cast<uint8_t>(ArgTypes.size());
+    NewIntrinsic.HasResult = RetType != Types::Void;
+
+    bool Inserted =
+        Ret.emplace(makeKey(ClassName, Name, Descriptor), NewIntrinsic).second;
+    (void)Inserted; assert(Inserted); // no duplicates
+  };
+
+  Add("java/lang/Math", "abs", "(I)I", absInt<JavaInt>);
+  Add("java/lang/Math", "abs", "(J)J", absInt<JavaLong>);
+  Add("java/lang/Math", "abs", "(F)F", absFloat<JavaFloat>);
+  Add("java/lang/Math", "abs", "(D)D", absFloat<JavaDouble>);
+
+  Add("java/lang/Math", "min", "(II)I", minInt<JavaInt>);
+  Add("java/lang/Math", "min", "(JJ)J", minInt<JavaLong>);
+  Add("java/lang/Math", "min", "(FF)F", minFloat<JavaFloat>);
+  Add("java/lang/Math", "min", "(DD)D", minFloat<JavaDouble>);
+
+  Add("java/lang/Math", "max", "(II)I", maxInt<JavaInt>);
+  Add("java/lang/Math", "max", "(JJ)J", maxInt<JavaLong>);
+  Add("java/lang/Math", "max", "(FF)F", maxFloat<JavaFloat>);
+  Add("java/lang/Math", "max", "(DD)D", maxFloat<JavaDouble>);
+
+  Add("java/lang/Math", "sqrt", "(D)D", sqrtDouble);
+  Add("java/lang/Math", "fma", "(FFF)F", fmaFloat<JavaFloat>);
+  Add("java/lang/Math", "fma", "(DDD)D", fmaFloat<JavaDouble>);
+
+  Add("java/lang/Integer", "bitCount", "(I)I", bitCountInt);
+  Add("java/lang/Integer", "numberOfLeadingZeros", "(I)I", leadingZerosInt);
+  Add("java/lang/Integer", "reverseBytes", "(I)I", reverseBytesInt);
+
+  Add("java/lang/Long", "bitCount", "(J)I", bitCountLong);
+  Add("java/lang/Long", "numberOfLeadingZeros", "(J)I", leadingZerosLong);
+  Add("java/lang/Long", "reverseBytes", "(J)J", reverseBytesLong);
+
+  Add("java/lang/System", "nanoTime", "()J", nanoTime);
+
+  return Ret;
+}
+
+}
+
+const Intrinsic *Runtime::findIntrinsic(
+    const Utf8String &ClassName,
+    const Utf8String &Name,
+    const Utf8String &Descriptor) {
+
+  // Table is immutable after creation
+  static const IntrinsicTable Table = createTable();
+
+  auto It = Table.find(makeKey(ClassName, Name, Descriptor));
+  if (It == Table.end())
+    return nullptr;
+  return &It->second;
+}
@@ -0,0 +1,41 @@
+///
+/// Table of the java library methods which are implemented directly in C++.
+/// Calls to such methods do not create interpreter frames, instead arguments
+/// are passed straight into the native implementation.
+///
+
+#ifndef ICP_INTRINSICS_H
+#define ICP_INTRINSICS_H
+
+#include "Runtime/Value.h"
+#include "Utils/Utf8String.h"
+
+#include <cstdint>
+
+namespace Runtime {
+
+// Single intrinsic method.
+struct Intrinsic final {
+  // Receives 'NumArgs' arguments in the order of their declaration. Result is
+  // ignored if intrinsic has no return value.
+  using FunctionType = Value (*)(const Value *Args);
+
+  // Allows callers to pass arguments without the heap allocation.
+  static constexpr uint8_t MaxArgs = 4;
+
+  FunctionType Fn = nullptr;
+  uint8_t NumArgs = 0;
+  bool HasResult = false;
+};
+
+// Finds intrinsic implementation for the given method. Intended to be called
+// once per call site during method resolution.
+// \returns Intrinsic or null if method is not an intrinsic.
+const Intrinsic *findIntrinsic(
+    const Utf8String &ClassName,
+    const Utf8String &Name,
+    const Utf8String &Descriptor);
+
+}
+
+#endif //ICP_INTRINSICS_H
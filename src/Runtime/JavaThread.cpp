@@ -0,0 +1,39 @@
+///
+/// Implementation of the java threads.
+///
+
+#include "JavaThread.h"
+
+#include "SlowInterpreter/SlowInterpreter.h"
+
+using namespace Runtime;
+using namespace JavaTypes;
+
+JavaThread::JavaThread(
+    const JavaMethod &Entry,
+    std::vector<Value> Arguments,
+    ClassManager &CM):
+  Native([this, &Entry, Args = std::move(Arguments), &CM]() {
+    // Exceptions can't cross thread boundary, save them until join
+    try {
+      Result = SlowInterpreter::interpret(Entry, Args, CM);
+    } catch (...) {
+      Error = std::current_exception();
+    }
+  }) {
+  ;
+}
+
+JavaThread::~JavaThread() {
+  if (Native.joinable())
+    Native.join();
+}
+
+Value JavaThread::join() {
+  if (Native.joinable())
+    Native.join();
+
+  if (Error)
+    std::rethrow_exception(Error);
+  return Result;
+}
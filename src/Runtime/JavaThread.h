@@ -0,0 +1,56 @@
+///
+/// Java threads. Each java thread is mapped onto it's own native thread and
+/// runs separate interpreter with it's own stack. All threads share single
+/// class manager.
+///
+
+#ifndef ICP_JAVATHREAD_H
+#define ICP_JAVATHREAD_H
+
+#include "JavaTypes/JavaTypesFwd.h"
+#include "Runtime/Value.h"
+
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace Runtime {
+
+class JavaThread final {
+public:
+  // Starts interpreting the given method on a new native thread. This is an
+  // equivalent of the java/lang/Thread.start with the method as an entry
+  // point instead of the Runnable.
+  // Method and class manager should outlive the thread.
+  JavaThread(
+      const JavaTypes::JavaMethod &Entry,
+      std::vector<Value> Arguments,
+      ClassManager &CM);
+
+  // Joins the thread if it wasn't joined yet
+  ~JavaThread();
+
+  // No copies
+  JavaThread(const JavaThread &) = delete;
+  JavaThread &operator=(const JavaThread &) = delete;
+  // No moves, running thread refers to this object
+  JavaThread(JavaThread &&) = delete;
+  JavaThread &operator=(JavaThread &&) = delete;
+
+  // Waits for the thread to finish.
+  // \returns Result of the entry method.
+  // \throws Any exception which escaped the entry method.
+  Value join();
+
+private:
+  Value Result;
+  std::exception_ptr Error;
+
+  // Should be the last so that all other fields are initialized before the
+  // thread starts.
+  std::thread Native;
+};
+
+}
+
+#endif //ICP_JAVATHREAD_H
@@ -0,0 +1,336 @@
+///
+/// Implementation of the thin locks and monitors.
+///
+
+#include "Monitor.h"
+
+#include <cassert>
+#include <climits>
+#include <thread>
+
+#if defined(__linux__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+using namespace Runtime;
+
+namespace {
+
+// Futex wrappers. On platforms without futexes fall back to yielding which is
+// slower but still correct since all callers recheck their condition.
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+void futexWait(std::atomic<uint32_t> &Addr, uint32_t Expected) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&Addr),
+          FUTEX_WAIT_PRIVATE, Expected, nullptr, nullptr, 0);
+#else
+  if (Addr.load(std::memory_order_relaxed) == Expected)
+    std::this_thread::yield();
+#endif
+}
+
+void futexWake(std::atomic<uint32_t> &Addr, int NumThreads) {
+#if defined(__linux__)
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&Addr),
+          FUTEX_WAKE_PRIVATE, NumThreads, nullptr, nullptr, 0);
+#else
+  (void)Addr; (void)NumThreads;
+#endif
+}
+
+// Lock word encoding
+constexpr uintptr_t InflatedBit = 1;
+constexpr uintptr_t RecursionShift = 1;
+constexpr uintptr_t RecursionBits = 7;
+constexpr uintptr_t RecursionUnit = 1u << RecursionShift;
+constexpr uintptr_t MaxThinRecursion = (1u << RecursionBits) - 1;
+constexpr uintptr_t OwnerShift = RecursionShift + RecursionBits;
+
+// Number of attempts to acquire thin lock before inflating it
+constexpr int SpinLimit = 64;
+
+static_assert(alignof(Monitor) > InflatedBit);
+
+bool isInflatedWord(uintptr_t Word) { return Word & InflatedBit; }
+
+Monitor *toMonitor(uintptr_t Word) {
+  assert(isInflatedWord(Word));
+  return reinterpret_cast<Monitor*>(Word & ~InflatedBit);
+}
+
+uintptr_t fromMonitor(const Monitor *M) {
+  return reinterpret_cast<uintptr_t>(M) | InflatedBit;
+}
+
+ThreadId thinOwner(uintptr_t Word) {
+  assert(!isInflatedWord(Word));
+  return Word >> OwnerShift;
+}
+
+uintptr_t thinRecursion(uintptr_t Word) {
+  assert(!isInflatedWord(Word));
+  return (Word >> RecursionShift) & MaxThinRecursion;
+}
+
+uintptr_t makeThin(ThreadId Owner) {
+  return Owner << OwnerShift;
+}
+
+void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#else
+  std::this_thread::yield();
+#endif
+}
+
+// Replaces thin lock held by 'Owner' with the monitor.
+// \returns Monitor if replacement succeeded, null if lock word had changed.
+Monitor *tryInflate(ObjectLock::WordType &Lock, uintptr_t Word) {
+  auto *M = new Monitor(thinOwner(Word), static_cast<uint32_t>(thinRecursion(Word)));
+  if (Lock.compare_exchange_strong(Word, fromMonitor(M),
+      std::memory_order_acq_rel, std::memory_order_relaxed))
+    return M;
+
+  delete M;
+  return nullptr;
+}
+
+// Makes sure that lock is inflated and owned by the current thread.
+// \throws IllegalMonitorStateException
+Monitor &getOwnMonitor(ObjectLock::WordType &Lock) {
+  const auto Self = currentThreadId();
+
+  while (true) {
+    uintptr_t Word = Lock.load(std::memory_order_acquire);
+    if (isInflatedWord(Word)) {
+      if (!toMonitor(Word)->isOwnedBy(Self))
+        throw IllegalMonitorStateException("Current thread is not the owner");
+      return *toMonitor(Word);
+    }
+
+    if (Word == 0 || thinOwner(Word) != Self)
+      throw IllegalMonitorStateException("Current thread is not the owner");
+
+    if (auto *M = tryInflate(Lock, Word))
+      return *M;
+  }
+}
+
+}
+
+ThreadId Runtime::currentThreadId() {
+  static std::atomic<ThreadId> NextId{1};
+  thread_local const ThreadId Id = NextId.fetch_add(1);
+  return Id;
+}
+
+Monitor::Monitor(ThreadId Owner, uint32_t Recursion):
+    State(Owner != 0 ? 1 : 0),
+    Owner(Owner),
+    Recursion(Recursion),
+    NotifySeq(0) {
+  ;
+}
+
+void Monitor::acquire() {
+  // Classic three state futex mutex
+  uint32_t C = 0;
+  if (State.compare_exchange_strong(C, 1, std::memory_order_acquire))
+    return;
+
+  if (C != 2)
+    C = State.exchange(2, std::memory_order_acquire);
+  while (C != 0) {
+    futexWait(State, 2);
+    C = State.exchange(2, std::memory_order_acquire);
+  }
+}
+
+void Monitor::release() {
+  if (State.fetch_sub(1, std::memory_order_release) != 1) {
+    State.store(0, std::memory_order_release);
+    futexWake(State, 1);
+  }
+}
+
+void Monitor::checkOwner() const {
+  if (!isOwnedBy(currentThreadId()))
+    throw IllegalMonitorStateException("Current thread is not the owner");
+}
+
+void Monitor::enter() {
+  const auto Self = currentThreadId();
+  if (isOwnedBy(Self)) {
+    ++Recursion;
+    return;
+  }
+
+  acquire();
+  Owner.store(Self, std::memory_order_relaxed);
+  Recursion = 0;
+}
+
+void Monitor::exit() {
+  checkOwner();
+
+  if (Recursion > 0) {
+    --Recursion;
+    return;
+  }
+
+  Owner.store(0, std::memory_order_relaxed);
+  release();
+}
+
+void Monitor::wait() {
+  checkOwner();
+
+  // Read sequence before releasing the lock, so that notification which
+  // happens right after the release is not lost.
+  const uint32_t Seq = NotifySeq.load(std::memory_order_relaxed);
+  const uint32_t SavedRecursion = Recursion;
+
+  Owner.store(0, std::memory_order_relaxed);
+  release();
+
+  futexWait(NotifySeq, Seq);
+
+  acquire();
+  Owner.store(currentThreadId(), std::memory_order_relaxed);
+  Recursion = SavedRecursion;
+}
+
+void Monitor::notify() {
+  checkOwner();
+  NotifySeq.fetch_add(1, std::memory_order_relaxed);
+  futexWake(NotifySeq, 1);
+}
+
+void Monitor::notifyAll() {
+  checkOwner();
+  NotifySeq.fetch_add(1, std::memory_order_relaxed);
+  futexWake(NotifySeq, INT_MAX);
+}
+
+void ObjectLock::enter(WordType &Lock) {
+  const auto Self = currentThreadId();
+  int Spins = 0;
+
+  uintptr_t Word = Lock.load(std::memory_order_acquire);
+  while (true) {
+    // Fast path: single CAS on the unlocked object
+    if (Word == 0) {
+      if (Lock.compare_exchange_weak(Word, makeThin(Self),
+          std::memory_order_acquire, std::memory_order_acquire))
+        return;
+      continue;
+    }
+
+    if (isInflatedWord(Word)) {
+      toMonitor(Word)->enter();
+      return;
+    }
+
+    // Recursive locking
+    if (thinOwner(Word) == Self) {
+      if (thinRecursion(Word) < MaxThinRecursion) {
+        if (Lock.compare_exchange_weak(Word, Word + RecursionUnit,
+            std::memory_order_acquire, std::memory_order_acquire))
+          return;
+        continue;
+      }
+
+      // Recursion counter overflow
+      if (auto *M = tryInflate(Lock, Word)) {
+        M->enter();
+        return;
+      }
+      Word = Lock.load(std::memory_order_acquire);
+      continue;
+    }
+
+    // Contended. Give owner some time to release the lock and then inflate.
+    if (Spins++ < SpinLimit) {
+      cpuRelax();
+      Word = Lock.load(std::memory_order_acquire);
+      continue;
+    }
+
+    if (auto *M = tryInflate(Lock, Word)) {
+      M->enter();
+      return;
+    }
+    Word = Lock.load(std::memory_order_acquire);
+  }
+}
+
+void ObjectLock::exit(WordType &Lock) {
+  const auto Self = currentThreadId();
+
+  uintptr_t Word = Lock.load(std::memory_order_acquire);
+  while (true) {
+    if (isInflatedWord(Word)) {
+      toMonitor(Word)->exit();
+      return;
+    }
+
+    if (Word == 0 || thinOwner(Word) != Self)
+      throw IllegalMonitorStateException("Current thread is not the owner");
+
+    // CAS is required since other thread might be inflating this lock
+    const uintptr_t NewWord =
+        thinRecursion(Word) > 0 ? Word - RecursionUnit : 0;
+    if (Lock.compare_exchange_weak(Word, NewWord,
+        std::memory_order_release, std::memory_order_acquire))
+      return;
+  }
+}
+
+void ObjectLock::wait(WordType &Lock) {
+  getOwnMonitor(Lock).wait();
+}
+
+void ObjectLock::notify(WordType &Lock) {
+  // Nobody could wait on the thin lock
+  const uintptr_t Word = Lock.load(std::memory_order_acquire);
+  if (!isInflatedWord(Word)) {
+    if (Word == 0 || thinOwner(Word) != currentThreadId())
+      throw IllegalMonitorStateException("Current thread is not the owner");
+    return;
+  }
+
+  toMonitor(Word)->notify();
+}
+
+void ObjectLock::notifyAll(WordType &Lock) {
+  const uintptr_t Word = Lock.load(std::memory_order_acquire);
+  if (!isInflatedWord(Word)) {
+    if (Word == 0 || thinOwner(Word) != currentThreadId())
+      throw IllegalMonitorStateException("Current thread is not the owner");
+    return;
+  }
+
+  toMonitor(Word)->notifyAll();
+}
+
+bool ObjectLock::holdsLock(const WordType &Lock) {
+  const uintptr_t Word = Lock.load(std::memory_order_acquire);
+  if (isInflatedWord(Word))
+    return toMonitor(Word)->isOwnedBy(currentThreadId());
+  return Word != 0 && thinOwner(Word) == currentThreadId();
+}
+
+bool ObjectLock::isInflated(const WordType &Lock) {
+  return isInflatedWord(Lock.load(std::memory_order_acquire));
+}
+
+void ObjectLock::destroy(WordType &Lock) {
+  const uintptr_t Word = Lock.load(std::memory_order_acquire);
+  if (isInflatedWord(Word))
+    delete toMonitor(Word);
+  Lock.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,100 @@
+///
+/// Object locking. Every object has a lock word in it's header which is
+/// enough to represent uncontended and recursive locking by a single thread
+/// (thin lock). Once lock is contended, or wait/notify is required, lock word
+/// is replaced with the pointer to the full monitor (inflated lock).
+///
+/// Lock word layout:
+///   Unlocked: all zeroes
+///   Thin:     [owner thread id | recursion count (7 bits) | 0]
+///   Inflated: [Monitor pointer                            | 1]
+///
+
+#ifndef ICP_MONITOR_H
+#define ICP_MONITOR_H
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Runtime {
+
+class IllegalMonitorStateException: public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+// Small unique identifier of the native thread. Never zero.
+using ThreadId = uintptr_t;
+ThreadId currentThreadId();
+
+// Full monitor with the futex based wait queue. It's never deflated and lives
+// as long as the object which owns it.
+class Monitor final {
+public:
+  // Creates monitor which is already owned by the given thread. This is used
+  // when inflating thin lock which is held by some other thread.
+  // \param Recursion Number of the additional lock entries.
+  Monitor(ThreadId Owner, uint32_t Recursion);
+
+  // No copies
+  Monitor(const Monitor &) = delete;
+  Monitor &operator=(const Monitor &) = delete;
+
+  void enter();
+
+  // \throws IllegalMonitorStateException if not owned by current thread.
+  void exit();
+
+  // Fully releases the monitor and waits for notification. Spurious wakeups
+  // are possible as permitted by the java specification.
+  // \throws IllegalMonitorStateException if not owned by current thread.
+  void wait();
+  void notify();
+  void notifyAll();
+
+  bool isOwnedBy(ThreadId Id) const {
+    return Owner.load(std::memory_order_relaxed) == Id;
+  }
+
+private:
+  void acquire();
+  void release();
+
+  void checkOwner() const;
+
+private:
+  // 0 - unlocked, 1 - locked, 2 - locked and there might be waiters
+  std::atomic<uint32_t> State;
+  std::atomic<ThreadId> Owner;
+  // Only accessed by the owner
+  uint32_t Recursion;
+
+  // Changed on every notification, waiters sleep on this value
+  std::atomic<uint32_t> NotifySeq;
+};
+
+// Operations on the object lock word
+namespace ObjectLock {
+
+using WordType = std::atomic<uintptr_t>;
+
+void enter(WordType &Word);
+
+// \throws IllegalMonitorStateException
+void exit(WordType &Word);
+void wait(WordType &Word);
+void notify(WordType &Word);
+void notifyAll(WordType &Word);
+
+bool holdsLock(const WordType &Word);
+bool isInflated(const WordType &Word);
+
+// Frees the monitor if lock was inflated. Object should not be used after
+// that.
+void destroy(WordType &Word);
+
+}
+
+}
+
+#endif //ICP_MONITOR_H
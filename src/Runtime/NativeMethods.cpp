@@ -0,0 +1,256 @@
+///
+/// Implementation of the native method binding.
+///
+
+#include "NativeMethods.h"
+
+#include "JavaTypes/Type.h"
+
+#include <dlfcn.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+using namespace Runtime;
+using namespace JavaTypes;
+
+// Calling convention trick used below relies on integer and floating point
+// arguments being assigned to the separate register files in the order of
+// their appearance. This holds for the System V x86-64 and AArch64 ABIs.
+#if (defined(__x86_64__) || defined(__aarch64__)) && !defined(_WIN32)
+  #define ICP_NATIVE_CALLS_SUPPORTED 1
+#else
+  #define ICP_NATIVE_CALLS_SUPPORTED 0
+#endif
+
+NativeMethod::Kind NativeMethod::classify(const Type &T) {
+  if (T == Types::Void) return Kind::VOID;
+  if (T == Types::Boolean) return Kind::BOOLEAN;
+  if (T == Types::Byte) return Kind::BYTE;
+  if (T == Types::Char) return Kind::CHAR;
+  if (T == Types::Short) return Kind::SHORT;
+  if (T == Types::Int) return Kind::INT;
+  if (T == Types::Long) return Kind::LONG;
+  if (T == Types::Float) return Kind::FLOAT;
+  if (T == Types::Double) return Kind::DOUBLE;
+
+  assert(Types::isAssignable(T, Types::Reference));
+  return Kind::REFERENCE;
+}
+
+NativeMethod::NativeMethod(void *Fn, const Utf8String &Descriptor):
+    Fn(Fn) {
+  assert(Fn != nullptr);
+
+  if (!ICP_NATIVE_CALLS_SUPPORTED)
+    throw UnsatisfiedLinkError("Native calls are not supported on this platform");
+
+  const auto &[RetType, ArgTypes] = Type::parseMethodDescriptor(Descriptor);
+
+  // Precompute argument classes so that the call itself doesn't need to
+  // look at the descriptor.
+  std::size_t NumInt = 0, NumFp = 0;
+  for (const auto &T: ArgTypes) {
+    ArgKinds.push_back(classify(T));
+
+    if (ArgKinds.back() == Kind::FLOAT || ArgKinds.back() == Kind::DOUBLE)
+      ++NumFp;
+    else
+      ++NumInt;
+  }
+  if (NumInt > MaxIntArgs || NumFp > MaxFpArgs)
+    throw UnsatisfiedLinkError(
+        "Too many arguments for the native method " + Descriptor);
+
+  RetKind = classify(RetType);
+  if (RetKind == Kind::REFERENCE)
+    throw UnsatisfiedLinkError(
+        "Native methods can't return references yet " + Descriptor);
+}
+
+Value NativeMethod::call(const Value *Args) const {
+  // Every call passes all argument registers. Callee ignores the ones it
+  // doesn't need, which is fine since they are caller saved.
+  using IntRetFn = int64_t (*)(
+      int64_t, int64_t, int64_t, int64_t, int64_t, int64_t,
+      double, double, double, double, double, double, double, double);
+  using FpRetFn = double (*)(
+      int64_t, int64_t, int64_t, int64_t, int64_t, int64_t,
+      double, double, double, double, double, double, double, double);
+  static_assert(MaxIntArgs == 6 && MaxFpArgs == 8);
+
+  int64_t I[MaxIntArgs] = {};
+  double F[MaxFpArgs] = {};
+  // References are passed as pointers to these handles. They are alive for
+  // the duration of the call.
+  JavaRef Handles[MaxIntArgs] = {};
+
+  std::size_t NumInt = 0, NumFp = 0;
+  for (std::size_t Idx = 0; Idx < ArgKinds.size(); ++Idx) {
+    const auto &Arg = Args[Idx];
+
+    switch (ArgKinds[Idx]) {
+    case Kind::BOOLEAN:
+    case Kind::BYTE:
+    case Kind::CHAR:
+    case Kind::SHORT:
+    case Kind::INT:
+      I[NumInt++] = Arg.getAs<JavaInt>();
+      break;
+    case Kind::LONG:
+      I[NumInt++] = Arg.getAs<JavaLong>();
+      break;
+    case Kind::REFERENCE:
+      Handles[NumInt] = Arg.getAs<JavaRef>();
+      I[NumInt] = reinterpret_cast<intptr_t>(&Handles[NumInt]);
+      ++NumInt;
+      break;
+    case Kind::FLOAT: {
+      // Float occupies low bits of the floating point register
+      const JavaFloat Val = Arg.getAs<JavaFloat>();
+      std::memcpy(&F[NumFp++], &Val, sizeof(Val));
+      break;
+    }
+    case Kind::DOUBLE:
+      F[NumFp++] = Arg.getAs<JavaDouble>();
+      break;
+    case Kind::VOID:
+      assert(false); // void arguments are not allowed
+    }
+  }
+
+  const auto Addr = reinterpret_cast<uintptr_t>(Fn);
+
+  if (RetKind == Kind::FLOAT || RetKind == Kind::DOUBLE) {
+    const double Res = reinterpret_cast<FpRetFn>(Addr)(
+        I[0], I[1], I[2], I[3], I[4], I[5],
+        F[0], F[1], F[2], F[3], F[4], F[5], F[6], F[7]);
+
+    if (RetKind == Kind::DOUBLE)
+      return Value::create<JavaDouble>(Res);
+
+    JavaFloat FloatRes;
+    std::memcpy(&FloatRes, &Res, sizeof(FloatRes));
+    return Value::create<JavaFloat>(FloatRes);
+  }
+
+  const int64_t Res = reinterpret_cast<IntRetFn>(Addr)(
+      I[0], I[1], I[2], I[3], I[4], I[5],
+      F[0], F[1], F[2], F[3], F[4], F[5], F[6], F[7]);
+
+  // Upper bits of the small return values are unspecified, so truncate
+  // them explicitly.
+  switch (RetKind) {
+  case Kind::VOID: return Value();
+  case Kind::BOOLEAN: return Value::create<JavaBool>(static_cast<uint8_t>(Res) != 0);
+  case Kind::BYTE: return Value::create<JavaByte>(static_cast<JavaByte>(Res));
+  case Kind::CHAR: return Value::create<JavaChar>(static_cast<JavaChar>(Res));
+  case Kind::SHORT: return Value::create<JavaShort>(static_cast<JavaShort>(Res));
+  case Kind::INT: return Value::create<JavaInt>(static_cast<JavaInt>(Res));
+  case Kind::LONG: return Value::create<JavaLong>(Res);
+  default:
+    assert(false); // handled above or rejected in constructor
+  }
+
+  return Value();
+}
+
+NativeLibraries::~NativeLibraries() {
+  for (auto *Handle: Handles)
+    dlclose(Handle);
+}
+
+void NativeLibraries::load(const std::string &Path) {
+  void *Handle = dlopen(Path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!Handle)
+    throw UnsatisfiedLinkError(
+        "Unable to load native library " + Path + ": " + dlerror());
+
+  Handles.push_back(Handle);
+}
+
+void *NativeLibraries::findSymbol(const std::string &Name) const {
+  for (auto *Handle: Handles) {
+    if (void *Sym = dlsym(Handle, Name.c_str()))
+      return Sym;
+  }
+
+  return nullptr;
+}
+
+NativeMethod NativeLibraries::bind(
+    const Utf8String &ClassName,
+    const Utf8String &Name,
+    const Utf8String &Descriptor) const {
+
+  void *Sym = findSymbol(mangle(ClassName, Name, Descriptor, false));
+  if (!Sym)
+    Sym = findSymbol(mangle(ClassName, Name, Descriptor, true));
+  if (!Sym)
+    throw UnsatisfiedLinkError(
+        "Unable to find native method " + ClassName + "." + Name + Descriptor);
+
+  return NativeMethod(Sym, Descriptor);
+}
+
+// Mangles single component of the native method name according to the JNI
+// specification. Input is expected to be modified UTF-8.
+static void mangleComponent(const Utf8String &In, std::string &Out) {
+  for (std::size_t Idx = 0; Idx < In.size(); ++Idx) {
+    const auto C = static_cast<unsigned char>(In[Idx]);
+
+    if ((C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z') ||
+        (C >= '0' && C <= '9')) {
+      Out += static_cast<char>(C);
+    } else if (C == '/') {
+      Out += '_';
+    } else if (C == '_') {
+      Out += "_1";
+    } else if (C == ';') {
+      Out += "_2";
+    } else if (C == '[') {
+      Out += "_3";
+    } else {
+      // Decode two and three byte sequences, modified UTF-8 doesn't have
+      // longer ones.
+      uint32_t CodePoint = C;
+      if ((C & 0xE0) == 0xC0 && Idx + 1 < In.size()) {
+        CodePoint = ((C & 0x1Fu) << 6) | (In[Idx + 1] & 0x3F);
+        Idx += 1;
+      } else if ((C & 0xF0) == 0xE0 && Idx + 2 < In.size()) {
+        CodePoint = ((C & 0x0Fu) << 12) | ((In[Idx + 1] & 0x3F) << 6) |
+                    (In[Idx + 2] & 0x3F);
+        Idx += 2;
+      }
+
+      char Buf[8];
+      std::snprintf(Buf, sizeof(Buf), "_0%04x", CodePoint & 0xFFFF);
+      Out += Buf;
+    }
+  }
+}
+
+std::string NativeLibraries::mangle(
+    const Utf8String &ClassName,
+    const Utf8String &Name,
+    const Utf8String &Descriptor,
+    bool WithArgs) {
+
+  std::string Ret = "Java_";
+  mangleComponent(ClassName, Ret);
+  Ret += '_';
+  mangleComponent(Name, Ret);
+
+  if (WithArgs) {
+    const auto ArgsEnd = Descriptor.find(')');
+    assert(!Descriptor.empty() && Descriptor[0] == '(');
+    assert(ArgsEnd != Utf8String::npos);
+
+    Ret += "__";
+    mangleComponent(Descriptor.substr(1, ArgsEnd - 1), Ret);
+  }
+
+  return Ret;
+}
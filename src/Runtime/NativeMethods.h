@@ -0,0 +1,101 @@
+///
+/// Support for the methods declared with ACC_NATIVE flag. Native methods are
+/// looked up by their JNI style mangled names in the user specified shared
+/// libraries and bound when their class is linked.
+///
+/// Note that this is not a JNI. Native functions receive exactly the java
+/// arguments: primitives are passed as their C counterparts and references
+/// are passed as pointers to the handles (JavaRef*). No JNIEnv or class
+/// arguments are passed.
+///
+
+#ifndef ICP_NATIVEMETHODS_H
+#define ICP_NATIVEMETHODS_H
+
+#include "Runtime/Value.h"
+#include "Utils/Utf8String.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Runtime {
+
+class UnsatisfiedLinkError: public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+// Native function bound to the java method. Knows how to pass arguments of
+// the specific method signature.
+class NativeMethod final {
+public:
+  // Maximal number of arguments of each class. Only signatures which fit
+  // entirely into the argument registers are supported.
+  static constexpr std::size_t MaxIntArgs = 6;
+  static constexpr std::size_t MaxFpArgs = 8;
+
+public:
+  // \throws UnsatisfiedLinkError if signature is not supported.
+  NativeMethod(void *Fn, const Utf8String &Descriptor);
+
+  // Calls native function.
+  // \param Args Arguments in the order of their declaration.
+  // \returns Result of the call. Returns empty value for void methods.
+  Value call(const Value *Args) const;
+
+  std::size_t numArgs() const { return ArgKinds.size(); }
+  bool hasResult() const { return RetKind != Kind::VOID; }
+
+private:
+  enum class Kind: uint8_t {
+    VOID, BOOLEAN, BYTE, CHAR, SHORT, INT, LONG, FLOAT, DOUBLE, REFERENCE
+  };
+
+  static Kind classify(const JavaTypes::Type &T);
+
+private:
+  void *Fn;
+  std::vector<Kind> ArgKinds;
+  Kind RetKind;
+};
+
+// Set of the loaded shared libraries.
+class NativeLibraries final {
+public:
+  NativeLibraries() = default;
+  ~NativeLibraries();
+
+  // No copies
+  NativeLibraries(const NativeLibraries &) = delete;
+  NativeLibraries &operator=(const NativeLibraries &) = delete;
+
+  // \throws UnsatisfiedLinkError if unable to load the library.
+  void load(const std::string &Path);
+
+  // Looks for the symbol in all loaded libraries in order of loading.
+  // \returns Symbol address or null if nothing found.
+  void *findSymbol(const std::string &Name) const;
+
+  // Finds native implementation for the given method. Tries short mangled
+  // name first and then the long one with the argument types.
+  // \throws UnsatisfiedLinkError if nothing was found.
+  NativeMethod bind(
+      const Utf8String &ClassName,
+      const Utf8String &Name,
+      const Utf8String &Descriptor) const;
+
+  // Returns JNI style mangled name, i.e "Java_pkg_Cls_name" or
+  // "Java_pkg_Cls_name__I" if 'WithArgs' is true.
+  static std::string mangle(
+      const Utf8String &ClassName,
+      const Utf8String &Name,
+      const Utf8String &Descriptor,
+      bool WithArgs);
+
+private:
+  std::vector<void*> Handles;
+};
+
+}
+
+#endif //ICP_NATIVEMETHODS_H
@@ -5,14 +5,30 @@
 #include "Objects.h"
 
 #include "JavaTypes/JavaClass.h"
+#include "JavaTypes/JavaMethod.h"
+#include "Runtime/Heap.h"
+
+#include <cassert>
 
 using namespace Runtime;
 using namespace JavaTypes;
 
-const JavaMethod *ClassObject::getMethod(const Utf8String &Name) const {
+Object::~Object() {
+  ObjectLock::destroy(LockWord);
+}
+
+const JavaMethod *ClassObject::getMethod(Utils::Symbol Name) const {
   return getClass().getMethod(Name);
 }
 
-InstanceObject *InstanceObject::create(ClassObject &Class) {
-  return new InstanceObject(Class);
+void ClassObject::bindNative(const JavaMethod &Method, NativeMethod &&Native) {
+  assert(&Method.getOwner() == &getClass()); // can only bind own methods
+  assert(Method.isNative());
+
+  bool Inserted = Natives.emplace(&Method, std::move(Native)).second;
+  (void)Inserted; assert(Inserted); // bind only once
+}
+
+InstanceObject *InstanceObject::create(ClassObject &Class, Heap &H) {
+  return H.adopt(std::unique_ptr<InstanceObject>(new InstanceObject(Class)));
 }
@@ -9,17 +9,39 @@
 #include "JavaTypes/JavaTypesFwd.h"
 #include "Runtime/Value.h"
 #include "Utils/Utf8String.h"
+#include "Utils/Symbol.h"
 #include "Runtime/FieldStorage.h"
+#include "Runtime/NativeMethods.h"
+#include "Runtime/Monitor.h"
+
+#include <unordered_map>
 
 namespace Runtime {
 
+class NullPointerException: public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
 // Base abstract class for any type of the runtime object.
 class Object {
 public:
   class BadAccess: public std::exception { };
 
 public:
-  virtual ~Object() = default;
+  virtual ~Object();
+
+  // Java monitor operations. Uncontended locking doesn't allocate anything.
+  // See Monitor.h for the details.
+  // \throws IllegalMonitorStateException when necessary
+  void monitorEnter() { ObjectLock::enter(LockWord); }
+  void monitorExit() { ObjectLock::exit(LockWord); }
+  void wait() { ObjectLock::wait(LockWord); }
+  void notify() { ObjectLock::notify(LockWord); }
+  void notifyAll() { ObjectLock::notifyAll(LockWord); }
+
+  // \returns True if current thread holds the monitor of this object.
+  bool holdsLock() const { return ObjectLock::holdsLock(LockWord); }
+  bool isLockInflated() const { return ObjectLock::isInflated(LockWord); }
 
   // Type safe accessors. These are more or less transparent applications
   // of the default RTTI and only needed to prevent dynamic_casts from
@@ -50,6 +72,9 @@ public:
 
 protected:
   Object() = default;
+
+private:
+  ObjectLock::WordType LockWord{0};
 };
 
 // Class which represents the loaded java class itself.
@@ -73,43 +98,70 @@ public:
   // \throws UnrecognizedField If no field was found.
   // TODO: This and following similar function should be replaced with the
   // proper resolution step.
-  Value getField(const Utf8String &Name) const {
+  Value getField(Utils::Symbol Name) const {
     return Fields.getField(Name);
   }
+  Value getField(std::string_view Name) const {
+    return Fields.getField(Utils::Symbol::lookup(Name));
+  }
 
   // Set static field or throw an exception if no such field is found.
   // \throws UnrecognizedField If no field was found.
-  void setField(const Utf8String &Name, const Value &V) {
+  void setField(Utils::Symbol Name, const Value &V) {
     return Fields.setField(Name, V);
   }
+  void setField(std::string_view Name, const Value &V) {
+    return Fields.setField(Utils::Symbol::lookup(Name), V);
+  }
 
   const JavaTypes::JavaClass &getClass() const { return Class; }
 
   // Resolve the method
-  const JavaTypes::JavaMethod *getMethod(const Utf8String &Name) const;
+  const JavaTypes::JavaMethod *getMethod(Utils::Symbol Name) const;
+  const JavaTypes::JavaMethod *getMethod(std::string_view Name) const {
+    return getMethod(Utils::Symbol::lookup(Name));
+  }
+
+  // Record native implementation for the method of this class.
+  void bindNative(const JavaTypes::JavaMethod &Method, NativeMethod &&Native);
+
+  // \returns Native implementation of the method or null if it's not bound.
+  const NativeMethod *getNative(const JavaTypes::JavaMethod &Method) const {
+    auto It = Natives.find(&Method);
+    return It == Natives.end() ? nullptr : &It->second;
+  }
 
 private:
   const JavaTypes::JavaClass &Class;
   FieldStorage Fields;
+
+  std::unordered_map<const JavaTypes::JavaMethod*, NativeMethod> Natives;
 };
 
 // Class which represents instance of the java class (ClassObject)
 class InstanceObject final: public Object {
 public:
+  // Allocates new instance in the given heap.
   // TODO: This should return gc managed pointer someday
-  static InstanceObject *create(ClassObject &ClassObj);
+  static InstanceObject *create(ClassObject &ClassObj, Heap &H);
 
   // Get instance field from this class.
   // \throws UnrecognizedField If no field was found.
-  Value getField(const Utf8String &Name) const {
+  Value getField(Utils::Symbol Name) const {
     return Fields.getField(Name);
   }
+  Value getField(std::string_view Name) const {
+    return Fields.getField(Utils::Symbol::lookup(Name));
+  }
 
   // Set instance field or throw an exception if no such field is found.
   // \throws UnrecognizedField If no field was found.
-  void setField(const Utf8String &Name, const Value &V) {
+  void setField(Utils::Symbol Name, const Value &V) {
     Fields.setField(Name, V);
   }
+  void setField(std::string_view Name, const Value &V) {
+    Fields.setField(Utils::Symbol::lookup(Name), V);
+  }
 
   ClassObject &getClassObj() { return ClassObj; }
   const ClassObject &getClassObj() const { return ClassObj; }
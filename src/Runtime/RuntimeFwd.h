@@ -21,6 +21,8 @@ class ClassObject;
 class InstanceObject;
 class ArrayObject;
 
+class Heap;
+
 /// Runtime data types
 ///
 // No direct support of booleans, but we may choose to optimize them later
@@ -50,6 +52,7 @@ template<class T>
 using promote_to_stack_t = typename promote_to_stack<T>::Result;
 
 class ClassManager;
+struct ClassMetaInfo;
 
 }
 
@@ -0,0 +1,42 @@
+///
+/// Shared class cache implementation.
+///
+
+#include "SharedClassCache.h"
+
+#include "JavaTypes/JavaClass.h"
+
+using namespace Runtime;
+using namespace JavaTypes;
+
+SharedClassCache::~SharedClassCache() = default;
+
+std::shared_ptr<JavaClass> SharedClassCache::getOrParse(
+    std::string_view Bytes, const ParserType &Parse) {
+
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto It = Classes.find(Bytes);
+    if (It != Classes.end())
+      return It->second->Class;
+  }
+
+  // Parse without holding the lock. If someone else parsed the same bytes
+  // in the meantime, use theirs.
+  auto New = std::make_unique<Entry>();
+  New->Class = Parse(Bytes);
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  auto It = Classes.find(Bytes);
+  if (It != Classes.end())
+    return It->second->Class;
+
+  New->Bytes = Bytes;
+  const std::string_view Key = New->Bytes;
+  return Classes.emplace(Key, std::move(New)).first->second->Class;
+}
+
+std::size_t SharedClassCache::size() const {
+  std::lock_guard<std::mutex> Guard(Lock);
+  return Classes.size();
+}
@@ -0,0 +1,55 @@
+///
+/// Cache of the parsed classes which is shared between class managers of the
+/// different VM instances. Parsed classes are immutable after construction,
+/// so identical class bytes can be parsed once and used by everyone.
+///
+
+#ifndef ICP_SHAREDCLASSCACHE_H
+#define ICP_SHAREDCLASSCACHE_H
+
+#include "JavaTypes/JavaTypesFwd.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Runtime {
+
+class SharedClassCache final {
+public:
+  using ParserType =
+      std::function<std::unique_ptr<JavaTypes::JavaClass>(std::string_view)>;
+
+  SharedClassCache() = default;
+  ~SharedClassCache();
+
+  // No copies
+  SharedClassCache(const SharedClassCache &) = delete;
+  SharedClassCache &operator=(const SharedClassCache &) = delete;
+
+  // Returns class parsed from the given bytes. Calls 'Parse' only if these
+  // bytes were not seen before. All users of the cache are expected to derive
+  // identical classes from identical bytes. Thread safe.
+  // \throws Whatever 'Parse' throws. Failures are not cached.
+  std::shared_ptr<JavaTypes::JavaClass> getOrParse(
+      std::string_view Bytes, const ParserType &Parse);
+
+  std::size_t size() const;
+
+private:
+  mutable std::mutex Lock;
+  struct Entry {
+    std::string Bytes;
+    std::shared_ptr<JavaTypes::JavaClass> Class;
+  };
+  // Keyed by the class bytes themselves, so there are no false hits. Keys
+  // refer to the bytes owned by the entry, lookups don't copy them.
+  std::unordered_map<std::string_view, std::unique_ptr<Entry>> Classes;
+};
+
+}
+
+#endif //ICP_SHAREDCLASSCACHE_H
@@ -0,0 +1,16 @@
+///
+/// Virtual machine instance implementation.
+///
+
+#include "VM.h"
+
+#include "Runtime/SharedClassCache.h"
+
+using namespace Runtime;
+
+VM::VM(std::shared_ptr<SharedClassCache> Cache):
+  CM(std::move(Cache)) {
+  ;
+}
+
+VM::~VM() = default;
@@ -0,0 +1,49 @@
+///
+/// Single virtual machine instance. Several instances can run in one process
+/// without interfering with each other.
+///
+/// Sharing rules:
+///  * Types are compile time constants and have no global state.
+///  * Parsed classes are immutable and can be shared through the
+///    SharedClassCache. Their runtime information (class objects, static
+///    fields, initialization state) is private to each instance.
+///  * Class loaders, class manager, heap and native libraries belong to
+///    exactly one instance.
+///
+
+#ifndef ICP_VM_H
+#define ICP_VM_H
+
+#include "Runtime/ClassManager.h"
+
+#include <memory>
+
+namespace Runtime {
+
+class VM final {
+public:
+  // \param Cache Optional cache of the parsed classes shared with other VMs.
+  explicit VM(std::shared_ptr<SharedClassCache> Cache = nullptr);
+  ~VM();
+
+  // No copies, class manager refers to the loaders by address
+  VM(const VM &) = delete;
+  VM &operator=(const VM &) = delete;
+
+  ClassManager &getClassManager() { return CM; }
+  Heap &getHeap() { return CM.getHeap(); }
+
+  const ClassLoader &getBootstrapLoader() const { return Bootstrap; }
+  const ClassLoader &getTestLoader() const { return Test; }
+
+private:
+  // Loaders should outlive the class manager
+  const BootstrapLoader Bootstrap;
+  const TestLoader Test;
+
+  ClassManager CM;
+};
+
+}
+
+#endif //ICP_VM_H
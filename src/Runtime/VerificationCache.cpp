@@ -0,0 +1,182 @@
+///
+/// Verification cache implementation.
+///
+/// Layout, all numbers are big endian:
+///   header: magic(4) version(2) verifier version length(2) verifier version,
+///           key count(4)
+///   keys:   sorted keys, 32 bytes each
+///
+
+#include "VerificationCache.h"
+
+#include "Utils/BinaryFiles.h"
+#include "Utils/Blake2b.h"
+#include "Verifier/Verifier.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+using namespace Runtime;
+using namespace Utils;
+
+namespace {
+
+constexpr uint32_t CacheMagic = 0x49435056; // "ICPV"
+constexpr uint16_t CacheVersion = 1;
+
+// Holds exclusive lock on the file until destroyed
+class FileLock final {
+public:
+  explicit FileLock(const std::string &Path) {
+    Fd = open(Path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (Fd < 0)
+      throw VerificationCacheError("Unable to open lock file " + Path);
+
+    if (flock(Fd, LOCK_EX) != 0) {
+      close(Fd);
+      throw VerificationCacheError("Unable to lock " + Path);
+    }
+  }
+  ~FileLock() {
+    // Closing the descriptor releases the lock
+    close(Fd);
+  }
+
+  FileLock(const FileLock &) = delete;
+  FileLock &operator=(const FileLock &) = delete;
+
+private:
+  int Fd = -1;
+};
+
+}
+
+VerificationCache::VerificationCache(std::string Path):
+  Path(std::move(Path)) {
+
+  const auto Stored = readFile(this->Path);
+  Keys.insert(Stored.begin(), Stored.end());
+}
+
+VerificationCache::~VerificationCache() {
+  try {
+    flush();
+  } catch (VerificationCacheError &) {
+    // It's only a cache, next run will verify classes again
+  }
+}
+
+VerificationCache::Key VerificationCache::computeKey(
+    std::string_view ClassBytes) {
+
+  Key Ret;
+  Blake2b Hasher(KeySize);
+  Hasher.update(Verifier::version());
+  // Separates version from the class bytes
+  Hasher.update(std::string_view("", 1));
+  Hasher.update(ClassBytes);
+  Hasher.finish(Ret.data());
+  return Ret;
+}
+
+bool VerificationCache::contains(const Key &K) const {
+  std::lock_guard<std::mutex> Guard(Lock);
+  return Keys.count(K) != 0;
+}
+
+void VerificationCache::insert(const Key &K) {
+  std::lock_guard<std::mutex> Guard(Lock);
+  if (Keys.insert(K).second)
+    Pending.push_back(K);
+}
+
+std::size_t VerificationCache::size() const {
+  std::lock_guard<std::mutex> Guard(Lock);
+  return Keys.size();
+}
+
+std::vector<VerificationCache::Key> VerificationCache::readFile(
+    const std::string &Path) {
+
+  std::unique_ptr<MappedFile> File;
+  try {
+    File = std::make_unique<MappedFile>(Path);
+  } catch (ReadError &) {
+    return {};
+  }
+
+  std::vector<Key> Ret;
+  try {
+    BigEndianReader Input(File->data(), File->size());
+
+    if (Input.readWord() != CacheMagic || Input.readHalf() != CacheVersion)
+      return {};
+
+    const uint16_t VersionLength = Input.readHalf();
+    const std::string_view Version(
+        reinterpret_cast<const char*>(Input.readBytes(VersionLength)),
+        VersionLength);
+    // Entries of the other verifiers are useless, drop them
+    if (Version != Verifier::version())
+      return {};
+
+    const uint32_t NumKeys = Input.readWord();
+    if (Input.remaining() != static_cast<std::size_t>(NumKeys) * KeySize)
+      return {};
+
+    Ret.resize(NumKeys);
+    for (auto &K: Ret)
+      std::memcpy(K.data(), Input.readBytes(KeySize), KeySize);
+  } catch (ReadError &) {
+    return {};
+  }
+
+  return Ret;
+}
+
+void VerificationCache::flush() {
+  std::lock_guard<std::mutex> FlushGuard(FlushLock);
+
+  std::vector<Key> ToWrite;
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    if (Pending.empty())
+      return;
+    ToWrite = Pending;
+  }
+
+  // Other processes might have updated the file since we've read it
+  FileLock FileGuard(Path + ".lock");
+
+  auto Merged = readFile(Path);
+  Merged.insert(Merged.end(), ToWrite.begin(), ToWrite.end());
+  std::sort(Merged.begin(), Merged.end());
+  Merged.erase(std::unique(Merged.begin(), Merged.end()), Merged.end());
+
+  const std::string_view Version = Verifier::version();
+  BigEndianWriter Out;
+  Out.writeWord(CacheMagic);
+  Out.writeHalf(CacheVersion);
+  Out.writeHalf(static_cast<uint16_t>(Version.size()));
+  Out.writeBytes(Version);
+  Out.writeWord(static_cast<uint32_t>(Merged.size()));
+  for (const auto &K: Merged)
+    Out.writeBytes(std::string_view(
+        reinterpret_cast<const char*>(K.data()), KeySize));
+
+  try {
+    replaceFile(Path, Out.str());
+  } catch (WriteError &) {
+    throw VerificationCacheError("Unable to write cache " + Path);
+  }
+
+  // Keys written by the others are useful for us as well. Pending might
+  // have grown in the meantime, only remove what we've written.
+  std::lock_guard<std::mutex> KeysGuard(Lock);
+  Keys.insert(Merged.begin(), Merged.end());
+  Pending.erase(Pending.begin(), Pending.begin() + ToWrite.size());
+}
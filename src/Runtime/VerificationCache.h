@@ -0,0 +1,92 @@
+///
+/// Persistent record of the successfully verified classes. Processes which
+/// are restarted over and over load the same class files, with this cache
+/// only the first of them pays for the verification.
+///
+/// Cache is a single file with the sorted list of keys. Key is a BLAKE2b hash
+/// of the verifier version followed by the class bytes, so results of one
+/// version of the verification rules are never used by another. Failures are not recorded.
+///
+/// Same file may be used by several processes at once. New keys are merged
+/// with the current file contents under the exclusive lock and published by
+/// the atomic rename, so readers never see partially written cache.
+///
+
+#ifndef ICP_VERIFICATIONCACHE_H
+#define ICP_VERIFICATIONCACHE_H
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Runtime {
+
+class VerificationCacheError: public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+class VerificationCache final {
+public:
+  static constexpr std::size_t KeySize = 32;
+  using Key = std::array<uint8_t, KeySize>;
+
+public:
+  // Reads existing entries. Missing, malformed or produced by a different
+  // verifier file is treated as an empty cache.
+  explicit VerificationCache(std::string Path);
+
+  // Flushes new entries, errors are ignored.
+  ~VerificationCache();
+
+  // No copies
+  VerificationCache(const VerificationCache &) = delete;
+  VerificationCache &operator=(const VerificationCache &) = delete;
+
+  static Key computeKey(std::string_view ClassBytes);
+
+  // Both are thread safe.
+  bool contains(const Key &K) const;
+  void insert(const Key &K);
+
+  // Writes new entries into the file together with everything other
+  // processes have written since we've read it. Does nothing if there is
+  // nothing new.
+  // \throws VerificationCacheError If cache can't be written.
+  void flush();
+
+  std::size_t size() const;
+
+private:
+  struct KeyHash {
+    std::size_t operator()(const Key &K) const {
+      // Key is already a good hash
+      std::size_t Res;
+      std::memcpy(&Res, K.data(), sizeof(Res));
+      return Res;
+    }
+  };
+
+  // \returns Keys stored in the file or nothing if it's not usable.
+  static std::vector<Key> readFile(const std::string &Path);
+
+private:
+  const std::string Path;
+
+  // Serializes flushes of this process, file lock takes care of the others
+  std::mutex FlushLock;
+
+  mutable std::mutex Lock;
+  std::unordered_set<Key, KeyHash> Keys;
+  // Inserted but not yet written
+  std::vector<Key> Pending;
+};
+
+}
+
+#endif //ICP_VERIFICATIONCACHE_H
@@ -9,6 +9,7 @@
 #include "JavaTypes/JavaMethod.h"
 #include "Runtime/Value.h"
 #include "Runtime/ClassManager.h"
+#include "Runtime/Intrinsics.h"
 #include "JavaTypes/JavaClass.h"
 #include "JavaTypes/ConstantPool.h"
 #include "JavaTypes/ConstantPoolRecords.h"
@@ -21,6 +22,7 @@
 #include <cstdint>
 #include <ostream>
 #include <iostream>
+#include <unordered_map>
 
 using namespace Bytecode;
 using namespace SlowInterpreter;
@@ -118,6 +120,10 @@ public:
 
   const JavaMethod &method() const { return Method; }
 
+  // Object which monitor was entered on behalf of the synchronized method.
+  Object *syncObject() const { return SyncObject; }
+  void setSyncObject(Object *Obj) { SyncObject = Obj; }
+
   void print(std::ostream &Out = std::cout) {
     Out << "Frame for: " << method().getName() << "\n";
 
@@ -149,6 +155,8 @@ private:
   std::vector<Value> Stack;
 
   JavaMethod::CodeIterator CurInstr;
+
+  Object *SyncObject = nullptr;
 };
 
 // Represents stack of InterpreterFrames.
@@ -156,6 +164,27 @@ private:
 // enforced via asserts since they were already checked by the class verifier.
 class InterpreterStack final {
 public:
+  InterpreterStack() = default;
+
+  // Frames are left here only if an exception unwinds the interpreter.
+  // Monitors of their synchronized methods are released same as on return,
+  // otherwise every other thread would deadlock on them.
+  ~InterpreterStack() {
+    while (!stack().empty()) {
+      if (auto *sync_obj = stack().back().syncObject()) {
+        try {
+          sync_obj->monitorExit();
+        } catch (IllegalMonitorStateException &) {
+          // Already released by the unbalanced monitorexit
+        }
+      }
+      stack().pop_back();
+    }
+  }
+
+  InterpreterStack(const InterpreterStack &) = delete;
+  InterpreterStack &operator=(const InterpreterStack &) = delete;
+
   void enter_function(
       const JavaMethod &Method,
       std::vector<Value> Arguments) {
@@ -218,7 +247,7 @@ public:
       const JavaMethod &Method,
       std::vector<Value> Arguments,
       ClassManager &CM): CM(CM) {
-    stack().enter_function(Method, std::move(Arguments));
+    enterMethod(Method, std::move(Arguments));
   }
 
   // Main interface method.
@@ -239,9 +268,12 @@ public:
   void visit(const aload_val &) override;
   void visit(const astore_val &) override;
   void visit(const invokespecial &) override;
+  void visit(const invokestatic &) override;
   void visit(const iconst_val &) override;
   void visit(const dconst_val &) override;
   void visit(const ireturn &) override;
+  void visit(const lreturn &) override;
+  void visit(const freturn &) override;
   void visit(const dreturn &) override;
   void visit(const java_return &) override;
   void visit(const putstatic &) override;
@@ -263,6 +295,13 @@ public:
   void visit(const dup &) override;
   void visit(const bipush &) override;
 
+  void visit(const ldc &) override;
+  void visit(const ldc_w &) override;
+  void visit(const ldc2_w &) override;
+
+  void visit(const monitorenter &) override;
+  void visit(const monitorexit &) override;
+
 private:
   InterpreterStack &stack() { return Stack; }
   const InterpreterStack &stack() const { return Stack; }
@@ -281,8 +320,20 @@ private:
     return curMethod().getOwner().getConstantPool();
   }
 
+  // Creates new frame for the method. Enters the monitor if method is
+  // synchronized.
+  void enterMethod(const JavaMethod &Method, std::vector<Value> Arguments);
+
   void returnFromFunction();
 
+  // Pops arguments for the method with the given descriptor from the current
+  // frame. Returns them in the order of declaration.
+  std::vector<Value> popArguments(const Utf8String &Descriptor);
+
+  // Returns intrinsic implementation for the call site or null if method
+  // should be called normally. Lookup is done only once for each call site.
+  const Intrinsic *resolveIntrinsic(const ConstantPoolRecords::MethodRef &MRef);
+
   // Schedules bci jump which is performed in the 'runSingleInstr' method.
   void jumpToBciOffset(BciOffsetType Offset) { NextOffset = Offset; }
 
@@ -296,6 +347,10 @@ private:
   std::optional<BciOffsetType> NextOffset;
 
   ClassManager &CM;
+
+  // Call sites which were already checked for being intrinsic.
+  std::unordered_map<const ConstantPoolRecords::MethodRef*, const Intrinsic*>
+      IntrinsicCallSites;
 };
 
 }
@@ -326,12 +381,41 @@ void Interpreter::visit(const dconst_val &Inst) {
   curFrame().push<JavaDouble>(Inst.getVal());
 }
 
+void Interpreter::enterMethod(
+    const JavaMethod &Method, std::vector<Value> Arguments) {
+
+  // Throws VerificationError if class is verified lazily
+  CM.verifyBeforeInvoke(Method);
+
+  // Static methods are synchronized on their class object, instance methods
+  // are synchronized on 'this'.
+  Object *sync_obj = nullptr;
+  if (Method.isSynchronized()) {
+    if (Method.isStatic())
+      sync_obj = &CM.getClassObject(Method.getOwner());
+    else
+      sync_obj = Arguments.at(0).getAs<JavaRef>();
+    assert(sync_obj); // 'this' can't be null
+  }
+
+  // Monitor is recorded in the frame as soon as it's entered, so that it's
+  // released even if we unwind right away.
+  stack().enter_function(Method, std::move(Arguments));
+  if (sync_obj) {
+    sync_obj->monitorEnter();
+    curFrame().setSyncObject(sync_obj);
+  }
+}
+
 void Interpreter::returnFromFunction() {
   // Pop the result value
   std::optional<Value> result = std::nullopt;
   if (!curFrame().empty())
     result = curFrame().pop();
 
+  if (auto *sync_obj = curFrame().syncObject())
+    sync_obj->monitorExit();
+
   // Pop stack frame.
   // It's always non-empty, verifier should have checked this.
   stack().exit_function();
@@ -352,6 +436,14 @@ void Interpreter::visit(const ireturn &) {
   returnFromFunction();
 }
 
+void Interpreter::visit(const lreturn &) {
+  returnFromFunction();
+}
+
+void Interpreter::visit(const freturn &) {
+  returnFromFunction();
+}
+
 void Interpreter::visit(const dreturn &) {
   returnFromFunction();
 }
@@ -381,8 +473,8 @@ void Interpreter::visit(const invokespecial &Inst) {
 
   // Resolve the method (so far only instance init methods)
   // TODO: This should be a proper resolution with proper exceptions
-  assert(m_ref.getName() == "<init>");
-  const auto *method = class_obj.getClass().getMethod("<init>");
+  assert(m_ref.getName() == Utils::Symbols::init());
+  const auto *method = class_obj.getClass().getMethod(Utils::Symbols::init());
   assert(method); // should be present
   assert(!method->isStatic()); // should be
 
@@ -401,7 +493,74 @@ void Interpreter::visit(const invokespecial &Inst) {
   std::reverse(arg_vals.begin(), arg_vals.end());
 
   // Start new function
-  stack().enter_function(*method, std::move(arg_vals));
+  enterMethod(*method, std::move(arg_vals));
+  NextOffset = 0;
+}
+
+std::vector<Value> Interpreter::popArguments(const Utf8String &Descriptor) {
+  const auto NumArgs = Type::parseMethodDescriptor(Descriptor).second.size();
+
+  std::vector<Value> arg_vals(NumArgs);
+  for (std::size_t i = NumArgs; i > 0; --i)
+    arg_vals[i - 1] = curFrame().pop();
+
+  return arg_vals;
+}
+
+const Intrinsic *Interpreter::resolveIntrinsic(
+    const ConstantPoolRecords::MethodRef &MRef) {
+  auto It = IntrinsicCallSites.find(&MRef);
+  if (It == IntrinsicCallSites.end()) {
+    const auto *Res =
+        findIntrinsic(MRef.getClassName(), MRef.getName(), MRef.getDescriptor());
+    It = IntrinsicCallSites.emplace(&MRef, Res).first;
+  }
+
+  return It->second;
+}
+
+void Interpreter::visit(const invokestatic &Inst) {
+  const auto &m_ref = CP().getAs<ConstantPoolRecords::MethodRef>(Inst.getIdx());
+
+  // Intrinsics are executed in place without creating new frame
+  if (const auto *intrinsic = resolveIntrinsic(m_ref)) {
+    Value args[Intrinsic::MaxArgs];
+    for (std::size_t i = intrinsic->NumArgs; i > 0; --i)
+      args[i - 1] = curFrame().pop();
+
+    Value res = intrinsic->Fn(args);
+    if (intrinsic->HasResult)
+      curFrame().push(res);
+    return;
+  }
+
+  // Resolve the class (also load, verify and initialize it if necessary)
+  auto &class_obj = CM.getClassObject(m_ref.getClassName(), curLoader());
+
+  // Resolve the method
+  // TODO: This should be a proper resolution with proper exceptions
+  const auto *method = class_obj.getClass().getMethod(
+      m_ref.getName(), m_ref.getDescriptor());
+  assert(method); // should be present
+  assert(method->isStatic()); // should be
+
+  // Natives receive arguments directly and don't create interpreter frames
+  if (method->isNative()) {
+    const auto *native = class_obj.getNative(*method);
+    assert(native); // natives are bound during class linking
+
+    Value args[NativeMethod::MaxIntArgs + NativeMethod::MaxFpArgs];
+    for (std::size_t i = native->numArgs(); i > 0; --i)
+      args[i - 1] = curFrame().pop();
+
+    Value res = native->call(args);
+    if (native->hasResult())
+      curFrame().push(res);
+    return;
+  }
+
+  // Start new function
+  enterMethod(*method, popArguments(method->getDescriptor()));
   NextOffset = 0;
 }
 
@@ -506,7 +665,7 @@ void Interpreter::visit(const java_new &Inst) {
   auto &class_obj = CM.getClassObject(class_ref.getName(), curLoader());
 
   // Create new instance of this class and push it on the stack
-  JavaRef instance = InstanceObject::create(class_obj);
+  JavaRef instance = InstanceObject::create(class_obj, CM.getHeap());
   curFrame().push<JavaRef>(instance);
 }
 
@@ -518,6 +677,37 @@ void Interpreter::visit(const bipush &Inst) {
   curFrame().push<JavaByte>(Inst.getIdx());
 }
 
+// Constant values are materialized when constant pool is created, so all ldc
+// variants are simple copies.
+void Interpreter::visit(const ldc &Inst) {
+  curFrame().push(
+      CP().getAs<ConstantPoolRecords::NumericConstant>(Inst.getIdx()).getValue());
+}
+
+void Interpreter::visit(const ldc_w &Inst) {
+  curFrame().push(
+      CP().getAs<ConstantPoolRecords::NumericConstant>(Inst.getIdx()).getValue());
+}
+
+void Interpreter::visit(const ldc2_w &Inst) {
+  curFrame().push(
+      CP().getAs<ConstantPoolRecords::NumericConstant>(Inst.getIdx()).getValue());
+}
+
+void Interpreter::visit(const monitorenter &) {
+  auto *obj = curFrame().pop<JavaRef>();
+  if (!obj)
+    throw NullPointerException("monitorenter on null reference");
+  obj->monitorEnter();
+}
+
+void Interpreter::visit(const monitorexit &) {
+  auto *obj = curFrame().pop<JavaRef>();
+  if (!obj)
+    throw NullPointerException("monitorexit on null reference");
+  obj->monitorExit();
+}
+
 
 
 Value SlowInterpreter::interpret(
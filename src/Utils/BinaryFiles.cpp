@@ -2,8 +2,15 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <cstdio>
 #include <istream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 using namespace Utils;
 
 // Converts number from big endian to whatever native endian is.
@@ -14,7 +21,7 @@ static uint64_t bigToNativeEndian(
 
   uint64_t Res = 0;
   for (std::size_t i = 0; i < Length; ++i) {
-    Res |= Input[i] << ((Length - i - 1) * 8);
+    Res |= static_cast<uint64_t>(Input[i]) << ((Length - i - 1) * 8);
   }
   return Res;
 }
@@ -52,3 +59,72 @@ uint64_t Utils::BigEndianReading::readDoubleWord(std::istream& Input) {
   readByteArray(Res, 8, Input);
   return bigToNativeEndian(Res, 8);
 }
+
+MappedFile::MappedFile(const std::string &FileName) {
+  const int Fd = open(FileName.c_str(), O_RDONLY);
+  if (Fd < 0)
+    throw ReadError();
+
+  struct stat Stat;
+  if (fstat(Fd, &Stat) != 0) {
+    close(Fd);
+    throw ReadError();
+  }
+  Size = static_cast<std::size_t>(Stat.st_size);
+
+  // Empty files can't be mapped, leave them with null data
+  if (Size != 0) {
+    void *Addr = mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, Fd, 0);
+    if (Addr == MAP_FAILED) {
+      close(Fd);
+      throw ReadError();
+    }
+    Data = static_cast<const uint8_t*>(Addr);
+  }
+
+  // Mapping stays valid after the descriptor is closed
+  close(Fd);
+}
+
+MappedFile::~MappedFile() {
+  if (Data)
+    munmap(const_cast<uint8_t*>(Data), Size);
+}
+
+void Utils::replaceFile(const std::string &Path, std::string_view Bytes) {
+  const auto TempPath = Path + ".tmp." + std::to_string(getpid());
+
+  const int Fd = open(
+      TempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (Fd < 0)
+    throw WriteError();
+
+  auto Fail = [&]() {
+    close(Fd);
+    unlink(TempPath.c_str());
+    throw WriteError();
+  };
+
+  while (!Bytes.empty()) {
+    const auto Written = write(Fd, Bytes.data(), Bytes.size());
+    if (Written < 0 && errno == EINTR)
+      continue;
+    if (Written <= 0)
+      Fail();
+    Bytes.remove_prefix(static_cast<std::size_t>(Written));
+  }
+
+  // Otherwise rename might reach the disk before the data
+  if (fsync(Fd) != 0)
+    Fail();
+
+  if (close(Fd) != 0) {
+    unlink(TempPath.c_str());
+    throw WriteError();
+  }
+
+  if (std::rename(TempPath.c_str(), Path.c_str()) != 0) {
+    unlink(TempPath.c_str());
+    throw WriteError();
+  }
+}
@@ -5,13 +5,19 @@
 #ifndef ICP_BINARYFILES_H
 #define ICP_BINARYFILES_H
 
+#include <cassert>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 #include <istream>
 #include <iostream>
+#include <string>
+#include <string_view>
 
 namespace Utils {
 
 class ReadError: std::exception {};
+class WriteError: std::exception {};
 
 namespace BigEndianReading {
 
@@ -29,6 +35,136 @@ uint64_t readDoubleWord(std::istream &Input);
 
 }
 
+// Sequential reader of the big endian data from the memory buffer. Doesn't
+// copy or own the buffer. All reads are bounds checked.
+class BigEndianReader final {
+public:
+  BigEndianReader(const uint8_t *Data, std::size_t Size):
+    Cur(Data), End(Data + Size) {
+    ;
+  }
+
+  // Same as the BigEndianReading functions.
+  // \throws ReadError If there is not enough data left.
+  uint8_t readByte() {
+    return *consume(1);
+  }
+  uint16_t readHalf() {
+    uint16_t Res;
+    std::memcpy(&Res, consume(sizeof(Res)), sizeof(Res));
+    return fromBigEndian(Res);
+  }
+  uint32_t readWord() {
+    uint32_t Res;
+    std::memcpy(&Res, consume(sizeof(Res)), sizeof(Res));
+    return fromBigEndian(Res);
+  }
+  uint64_t readDoubleWord() {
+    uint64_t Res;
+    std::memcpy(&Res, consume(sizeof(Res)), sizeof(Res));
+    return fromBigEndian(Res);
+  }
+
+  // Advances over 'Length' bytes without copying them.
+  // \returns Pointer to the first skipped byte.
+  // \throws ReadError If there is not enough data left.
+  const uint8_t *readBytes(std::size_t Length) {
+    return consume(Length);
+  }
+  void skip(std::size_t Length) {
+    (void)consume(Length);
+  }
+
+  std::size_t remaining() const {
+    return static_cast<std::size_t>(End - Cur);
+  }
+
+private:
+  const uint8_t *consume(std::size_t Length) {
+    if (Length > remaining())
+      throw ReadError();
+    const uint8_t *Ret = Cur;
+    Cur += Length;
+    return Ret;
+  }
+
+  template<class T>
+  static T fromBigEndian(T Val) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if constexpr (sizeof(T) == 2)
+      return __builtin_bswap16(Val);
+    else if constexpr (sizeof(T) == 4)
+      return __builtin_bswap32(Val);
+    else
+      return __builtin_bswap64(Val);
+#else
+    return Val;
+#endif
+  }
+
+private:
+  const uint8_t *Cur;
+  const uint8_t *const End;
+};
+
+// Accumulates big endian data in memory. Counterpart of the BigEndianReader.
+class BigEndianWriter final {
+public:
+  void writeByte(uint8_t Val) { write(Val, 1); }
+  void writeHalf(uint16_t Val) { write(Val, 2); }
+  void writeWord(uint32_t Val) { write(Val, 4); }
+  void writeDoubleWord(uint64_t Val) { write(Val, 8); }
+  void writeBytes(std::string_view Bytes) { Out.append(Bytes); }
+
+  // Overwrites already written word at the offset 'Pos'. Useful for the
+  // length prefixes which are known only after the data is written.
+  void patchWord(std::size_t Pos, uint32_t Val) {
+    assert(Pos + 4 <= Out.size());
+    for (std::size_t i = 0; i < 4; ++i)
+      Out[Pos + i] = static_cast<char>((Val >> ((3 - i) * 8)) & 0xff);
+  }
+
+  std::size_t size() const { return Out.size(); }
+  const std::string &str() const { return Out; }
+  std::string take() { return std::move(Out); }
+
+private:
+  void write(uint64_t Val, std::size_t Length) {
+    for (std::size_t i = 0; i < Length; ++i)
+      Out += static_cast<char>((Val >> ((Length - i - 1) * 8)) & 0xff);
+  }
+
+private:
+  std::string Out;
+};
+
+// Read only memory mapping of the whole file.
+class MappedFile final {
+public:
+  // \throws ReadError If file can't be opened or mapped.
+  explicit MappedFile(const std::string &FileName);
+  ~MappedFile();
+
+  // No copies
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const uint8_t *data() const { return Data; }
+  std::size_t size() const { return Size; }
+
+private:
+  const uint8_t *Data = nullptr;
+  std::size_t Size = 0;
+};
+
+// Replaces contents of the file with the given bytes. Bytes are written into
+// the temporary file next to the 'Path', flushed to the disk and then renamed
+// over the 'Path'. Concurrent readers see either old or new file, even the
+// ones which have old file mapped, and crash never leaves partially written
+// file behind.
+// \throws WriteError If file can't be written. Original file is left intact.
+void replaceFile(const std::string &Path, std::string_view Bytes);
+
 template<class T, class _X = std::enable_if_t<std::is_unsigned_v<T>>>
 constexpr bool isUint8(T Val) {
   return Val >= std::numeric_limits<uint8_t>::min() &&
@@ -0,0 +1,268 @@
+///
+/// BLAKE2b implementation. Compression function is written twice: portable
+/// one and the one which keeps rows of the state in the AVX2 registers and
+/// mixes all four columns (or diagonals) at once.
+///
+
+#include "Blake2b.h"
+
+#include <cstring>
+
+#if defined(__x86_64__)
+  #include <immintrin.h>
+  #define ICP_HAS_AVX2_PATH 1
+#else
+  #define ICP_HAS_AVX2_PATH 0
+#endif
+
+using namespace Utils;
+
+namespace {
+
+constexpr uint64_t IV[8] = {
+    0x6a09e667f3bcc908ull, 0xbb67ae8584caa73bull,
+    0x3c6ef372fe94f82bull, 0xa54ff53a5f1d36f1ull,
+    0x510e527fade682d1ull, 0x9b05688c2b3e6c1full,
+    0x1f83d9abfb41bd6bull, 0x5be0cd19137e2179ull};
+
+// Message word permutations, last two rounds reuse the first two
+constexpr uint8_t Sigma[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+    {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+    {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+    {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+    {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}};
+
+constexpr unsigned NumRounds = 12;
+
+// Words are little endian
+uint64_t loadWord(const uint8_t *Ptr) {
+  uint64_t Res;
+  std::memcpy(&Res, Ptr, sizeof(Res));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  Res = __builtin_bswap64(Res);
+#endif
+  return Res;
+}
+
+uint64_t rotr(uint64_t Val, unsigned Amount) {
+  return (Val >> Amount) | (Val << (64 - Amount));
+}
+
+using CompressFn = void (*)(
+    uint64_t *H, const uint8_t *Block, uint64_t T0, uint64_t T1, bool Final);
+
+void compressScalar(
+    uint64_t *H, const uint8_t *Block, uint64_t T0, uint64_t T1, bool Final) {
+
+  uint64_t M[16];
+  for (unsigned Idx = 0; Idx < 16; ++Idx)
+    M[Idx] = loadWord(Block + Idx * 8);
+
+  uint64_t V[16];
+  for (unsigned Idx = 0; Idx < 8; ++Idx) {
+    V[Idx] = H[Idx];
+    V[Idx + 8] = IV[Idx];
+  }
+  V[12] ^= T0;
+  V[13] ^= T1;
+  if (Final)
+    V[14] = ~V[14];
+
+  auto G = [&](unsigned A, unsigned B, unsigned C, unsigned D,
+               uint64_t X, uint64_t Y) {
+    V[A] = V[A] + V[B] + X;
+    V[D] = rotr(V[D] ^ V[A], 32);
+    V[C] = V[C] + V[D];
+    V[B] = rotr(V[B] ^ V[C], 24);
+    V[A] = V[A] + V[B] + Y;
+    V[D] = rotr(V[D] ^ V[A], 16);
+    V[C] = V[C] + V[D];
+    V[B] = rotr(V[B] ^ V[C], 63);
+  };
+
+  for (unsigned Round = 0; Round < NumRounds; ++Round) {
+    const uint8_t *S = Sigma[Round];
+    G(0, 4, 8, 12, M[S[0]], M[S[1]]);
+    G(1, 5, 9, 13, M[S[2]], M[S[3]]);
+    G(2, 6, 10, 14, M[S[4]], M[S[5]]);
+    G(3, 7, 11, 15, M[S[6]], M[S[7]]);
+    G(0, 5, 10, 15, M[S[8]], M[S[9]]);
+    G(1, 6, 11, 12, M[S[10]], M[S[11]]);
+    G(2, 7, 8, 13, M[S[12]], M[S[13]]);
+    G(3, 4, 9, 14, M[S[14]], M[S[15]]);
+  }
+
+  for (unsigned Idx = 0; Idx < 8; ++Idx)
+    H[Idx] ^= V[Idx] ^ V[Idx + 8];
+}
+
+#if ICP_HAS_AVX2_PATH && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+// Lambdas don't inherit target attributes, so helpers are separate functions
+#define ICP_AVX2_HELPER __attribute__((target("avx2"), always_inline)) inline
+
+// Gathers message words S[First], S[First + 2], S[First + 4], S[First + 6]
+ICP_AVX2_HELPER __m256i loadMessage(
+    const long long *M, const uint8_t *S, unsigned First) {
+  return _mm256_setr_epi64x(
+      M[S[First]], M[S[First + 2]], M[S[First + 4]], M[S[First + 6]]);
+}
+
+// G function applied to all four lanes
+ICP_AVX2_HELPER void mixAvx2(
+    __m256i &A, __m256i &B, __m256i &C, __m256i &D, __m256i X, __m256i Y) {
+  const __m256i Rot24 = _mm256_setr_epi8(
+      3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+      3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+  const __m256i Rot16 = _mm256_setr_epi8(
+      2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+      2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+
+  A = _mm256_add_epi64(_mm256_add_epi64(A, B), X);
+  D = _mm256_shuffle_epi32(_mm256_xor_si256(D, A), _MM_SHUFFLE(2, 3, 0, 1));
+  C = _mm256_add_epi64(C, D);
+  B = _mm256_shuffle_epi8(_mm256_xor_si256(B, C), Rot24);
+  A = _mm256_add_epi64(_mm256_add_epi64(A, B), Y);
+  D = _mm256_shuffle_epi8(_mm256_xor_si256(D, A), Rot16);
+  C = _mm256_add_epi64(C, D);
+  B = _mm256_xor_si256(B, C);
+  B = _mm256_or_si256(_mm256_srli_epi64(B, 63), _mm256_add_epi64(B, B));
+}
+
+// Each row of the 4x4 state is one register. Column step mixes all four
+// columns at once, then rows are rotated so that diagonals become columns.
+__attribute__((target("avx2")))
+void compressAvx2(
+    uint64_t *H, const uint8_t *Block, uint64_t T0, uint64_t T1, bool Final) {
+
+  long long M[16];
+  std::memcpy(M, Block, sizeof(M));
+
+  const __m256i H0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(H));
+  const __m256i H1 =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(H + 4));
+
+  __m256i A = H0;
+  __m256i B = H1;
+  __m256i C = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(IV));
+  __m256i D = _mm256_xor_si256(
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(IV + 4)),
+      _mm256_setr_epi64x(
+          static_cast<long long>(T0), static_cast<long long>(T1),
+          Final ? -1ll : 0ll, 0));
+
+  for (unsigned Round = 0; Round < NumRounds; ++Round) {
+    const uint8_t *S = Sigma[Round];
+
+    mixAvx2(A, B, C, D, loadMessage(M, S, 0), loadMessage(M, S, 1));
+
+    B = _mm256_permute4x64_epi64(B, _MM_SHUFFLE(0, 3, 2, 1));
+    C = _mm256_permute4x64_epi64(C, _MM_SHUFFLE(1, 0, 3, 2));
+    D = _mm256_permute4x64_epi64(D, _MM_SHUFFLE(2, 1, 0, 3));
+
+    mixAvx2(A, B, C, D, loadMessage(M, S, 8), loadMessage(M, S, 9));
+
+    B = _mm256_permute4x64_epi64(B, _MM_SHUFFLE(2, 1, 0, 3));
+    C = _mm256_permute4x64_epi64(C, _MM_SHUFFLE(1, 0, 3, 2));
+    D = _mm256_permute4x64_epi64(D, _MM_SHUFFLE(0, 3, 2, 1));
+  }
+
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(H),
+      _mm256_xor_si256(H0, _mm256_xor_si256(A, C)));
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(H + 4),
+      _mm256_xor_si256(H1, _mm256_xor_si256(B, D)));
+}
+
+#undef ICP_AVX2_HELPER
+
+CompressFn selectCompress() {
+  return __builtin_cpu_supports("avx2") ? compressAvx2 : compressScalar;
+}
+
+#else
+
+CompressFn selectCompress() {
+  return compressScalar;
+}
+
+#endif
+
+}
+
+Blake2b::Blake2b(std::size_t DigestSize):
+    DigestSize(DigestSize) {
+  assert(DigestSize >= 1 && DigestSize <= MaxDigestSize);
+
+  std::memcpy(State, IV, sizeof(State));
+  // Parameter block without key, salt and personalization
+  State[0] ^= 0x01010000ull ^ DigestSize;
+}
+
+void Blake2b::compress(
+    const uint8_t *Blocks, std::size_t NumBlocks,
+    std::size_t LastSize, bool IsFinal) {
+
+  // Decide once, cpu doesn't change while we are running
+  static const CompressFn Impl = selectCompress();
+
+  for (std::size_t Idx = 0; Idx < NumBlocks; ++Idx) {
+    const bool IsLast = Idx + 1 == NumBlocks;
+    const uint64_t Increment = IsLast ? LastSize : BlockSize;
+
+    Counter[0] += Increment;
+    if (Counter[0] < Increment)
+      ++Counter[1];
+
+    Impl(State, Blocks + Idx * BlockSize,
+         Counter[0], Counter[1], IsLast && IsFinal);
+  }
+}
+
+void Blake2b::update(const void *Data, std::size_t Size) {
+  assert(!Finished);
+
+  const auto *In = static_cast<const uint8_t*>(Data);
+
+  // Full blocks can be compressed only when we know that more data follows
+  if (BufferSize + Size > BlockSize) {
+    if (BufferSize != 0) {
+      const auto Fill = BlockSize - BufferSize;
+      std::memcpy(Buffer + BufferSize, In, Fill);
+      compress(Buffer, 1, BlockSize, false);
+      BufferSize = 0;
+      In += Fill;
+      Size -= Fill;
+    }
+
+    // Input is hashed in place, only the tail goes into the buffer
+    if (Size > BlockSize) {
+      const auto NumBlocks = (Size - 1) / BlockSize;
+      compress(In, NumBlocks, BlockSize, false);
+      In += NumBlocks * BlockSize;
+      Size -= NumBlocks * BlockSize;
+    }
+  }
+
+  if (Size != 0)
+    std::memcpy(Buffer + BufferSize, In, Size);
+  BufferSize += Size;
+}
+
+void Blake2b::finish(uint8_t *Out) {
+  assert(!Finished);
+  Finished = true;
+
+  std::memset(Buffer + BufferSize, 0, BlockSize - BufferSize);
+  compress(Buffer, 1, BufferSize, true);
+
+  for (std::size_t Idx = 0; Idx < DigestSize; ++Idx)
+    Out[Idx] = static_cast<uint8_t>(State[Idx / 8] >> (8 * (Idx % 8)));
+}
@@ -0,0 +1,67 @@
+///
+/// BLAKE2b hash function as specified by the RFC 7693. Used when we need a
+/// hash which is strong enough to identify content, i.e for the persistent
+/// caches keyed by the class bytes. Keyed hashing is not supported.
+///
+
+#ifndef ICP_BLAKE2B_H
+#define ICP_BLAKE2B_H
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace Utils {
+
+class Blake2b final {
+public:
+  static constexpr std::size_t BlockSize = 128;
+  static constexpr std::size_t MaxDigestSize = 64;
+
+public:
+  // \param DigestSize Size of the result in bytes, from 1 to 64.
+  explicit Blake2b(std::size_t DigestSize = MaxDigestSize);
+
+  void update(const void *Data, std::size_t Size);
+  void update(std::string_view Data) { update(Data.data(), Data.size()); }
+
+  // Writes digest into the 'Out' which should have room for 'DigestSize'
+  // bytes. Hasher can't be updated afterwards.
+  void finish(uint8_t *Out);
+
+  // Hashes whole buffer at once.
+  template<std::size_t N>
+  static std::array<uint8_t, N> hash(std::string_view Data) {
+    static_assert(N >= 1 && N <= MaxDigestSize);
+    std::array<uint8_t, N> Ret;
+    Blake2b Hasher(N);
+    Hasher.update(Data);
+    Hasher.finish(Ret.data());
+    return Ret;
+  }
+
+private:
+  // Compresses 'NumBlocks' full blocks. Counter is advanced by 'LastSize'
+  // for the last of them and by the 'BlockSize' for all others.
+  void compress(
+      const uint8_t *Blocks, std::size_t NumBlocks,
+      std::size_t LastSize, bool IsFinal);
+
+private:
+  uint64_t State[8];
+  // 128 bit counter of the processed bytes
+  uint64_t Counter[2] = {0, 0};
+
+  // Last block is kept in the buffer until we know whether it's the final one
+  uint8_t Buffer[BlockSize];
+  std::size_t BufferSize = 0;
+
+  const std::size_t DigestSize;
+  bool Finished = false;
+};
+
+}
+
+#endif //ICP_BLAKE2B_H
@@ -0,0 +1,136 @@
+///
+/// Insert-only hash map with lock-free lookups. Intended for the tables which
+/// are read on every instruction but are rarely updated, i.e loaded classes.
+///
+/// Open addressing with linear probing. Each slot holds an atomic pointer to
+/// the immutable node, so readers never observe partially constructed entries.
+/// Writers are serialized with the mutex. When table grows, old tables are
+/// kept alive until the map is destroyed since readers might still use them.
+/// Entries can't be removed.
+///
+
+#ifndef ICP_CONCURRENTHASHMAP_H
+#define ICP_CONCURRENTHASHMAP_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Utils {
+
+template<class KeyT, class ValueT,
+         class Hash = std::hash<KeyT>, class Equal = std::equal_to<KeyT>>
+class ConcurrentHashMap final {
+public:
+  explicit ConcurrentHashMap(std::size_t InitialCapacity = 64) {
+    std::size_t Capacity = 8;
+    while (Capacity < InitialCapacity * 2)
+      Capacity *= 2;
+
+    Tables.push_back(std::make_unique<Table>(Capacity));
+    Current.store(Tables.back().get(), std::memory_order_release);
+  }
+
+  // No copies
+  ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+  ConcurrentHashMap &operator=(const ConcurrentHashMap &) = delete;
+
+  // Lock-free lookup. Returned pointer is valid for the lifetime of the map.
+  // \returns Value or null if nothing was found.
+  const ValueT *find(const KeyT &Key) const {
+    const auto KeyHash = Hash()(Key);
+    const Table *T = Current.load(std::memory_order_acquire);
+
+    for (std::size_t Idx = KeyHash & T->Mask;; Idx = (Idx + 1) & T->Mask) {
+      const Node *N = T->Slots[Idx].load(std::memory_order_acquire);
+      if (N == nullptr)
+        return nullptr;
+      if (N->KeyHash == KeyHash && Equal()(N->Key, Key))
+        return &N->Value;
+    }
+  }
+
+  // Inserts new value if key is not present yet.
+  // \returns Pointer to the value associated with the key and flag which is
+  // true if insertion took place.
+  std::pair<const ValueT*, bool> insert(KeyT Key, ValueT Value) {
+    std::lock_guard<std::mutex> Guard(WriteLock);
+
+    if (const auto *Existing = find(Key))
+      return {Existing, false};
+
+    // Keep load factor below one half
+    Table *T = Current.load(std::memory_order_relaxed);
+    if ((Size + 1) * 2 > T->Slots.size())
+      T = grow();
+
+    const auto KeyHash = Hash()(Key);
+    Nodes.push_back(std::make_unique<Node>(
+        Node{KeyHash, std::move(Key), std::move(Value)}));
+    place(*T, Nodes.back().get());
+    ++Size;
+
+    return {&Nodes.back()->Value, true};
+  }
+
+  std::size_t size() const {
+    std::lock_guard<std::mutex> Guard(WriteLock);
+    return Size;
+  }
+
+private:
+  struct Node {
+    const std::size_t KeyHash;
+    const KeyT Key;
+    const ValueT Value;
+  };
+
+  struct Table {
+    explicit Table(std::size_t Capacity):
+        Slots(Capacity), Mask(Capacity - 1) {
+      assert((Capacity & Mask) == 0); // should be power of two
+    }
+
+    std::vector<std::atomic<const Node*>> Slots;
+    const std::size_t Mask;
+  };
+
+  static void place(Table &T, const Node *N) {
+    std::size_t Idx = N->KeyHash & T.Mask;
+    while (T.Slots[Idx].load(std::memory_order_relaxed) != nullptr)
+      Idx = (Idx + 1) & T.Mask;
+    T.Slots[Idx].store(N, std::memory_order_release);
+  }
+
+  // Creates twice larger table and publishes it when it's fully populated.
+  Table *grow() {
+    const auto *Old = Current.load(std::memory_order_relaxed);
+
+    Tables.push_back(std::make_unique<Table>(Old->Slots.size() * 2));
+    Table *New = Tables.back().get();
+    for (const auto &Slot: Old->Slots) {
+      if (const Node *N = Slot.load(std::memory_order_relaxed))
+        place(*New, N);
+    }
+
+    Current.store(New, std::memory_order_release);
+    return New;
+  }
+
+private:
+  std::atomic<Table*> Current;
+
+  // Everything below is guarded by the WriteLock
+  mutable std::mutex WriteLock;
+  std::vector<std::unique_ptr<Table>> Tables;
+  std::vector<std::unique_ptr<Node>> Nodes;
+  std::size_t Size = 0;
+};
+
+}
+
+#endif //ICP_CONCURRENTHASHMAP_H
@@ -0,0 +1,143 @@
+///
+/// Modified UTF-8 validation. Nearly all of the constant pool strings are
+/// ASCII, so the main goal is to get through them as fast as possible and
+/// only fall back to the byte by byte decoding for the rare multibyte
+/// sequences.
+///
+
+#include "ModifiedUtf8.h"
+
+#if defined(__x86_64__)
+  #include <immintrin.h>
+  #define ICP_HAS_SSE2 1
+#else
+  #define ICP_HAS_SSE2 0
+#endif
+
+using namespace Utils;
+
+// Non-zero ASCII byte
+static bool isPlainAscii(uint8_t Byte) {
+  return Byte != 0 && Byte < 0x80;
+}
+
+static std::size_t asciiPrefixScalar(
+    const uint8_t *Data, std::size_t Size, std::size_t Idx) {
+  while (Idx < Size && isPlainAscii(Data[Idx]))
+    ++Idx;
+  return Idx;
+}
+
+#if ICP_HAS_SSE2
+
+// Both functions below look for the first byte which is either zero or has
+// the high bit set. Tail shorter than a vector is handled by the scalar loop.
+
+static std::size_t asciiPrefixSse2(const uint8_t *Data, std::size_t Size) {
+  const __m128i Zero = _mm_setzero_si128();
+
+  std::size_t Idx = 0;
+  for (; Idx + 16 <= Size; Idx += 16) {
+    const __m128i Chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(Data + Idx));
+    const auto Mask = static_cast<unsigned>(
+        _mm_movemask_epi8(Chunk) |
+        _mm_movemask_epi8(_mm_cmpeq_epi8(Chunk, Zero)));
+    if (Mask != 0)
+      return Idx + static_cast<std::size_t>(__builtin_ctz(Mask));
+  }
+
+  return asciiPrefixScalar(Data, Size, Idx);
+}
+
+__attribute__((target("avx2")))
+static std::size_t asciiPrefixAvx2(const uint8_t *Data, std::size_t Size) {
+  const __m256i Zero = _mm256_setzero_si256();
+
+  std::size_t Idx = 0;
+  for (; Idx + 32 <= Size; Idx += 32) {
+    const __m256i Chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Data + Idx));
+    const auto Mask = static_cast<unsigned>(
+        _mm256_movemask_epi8(Chunk) |
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(Chunk, Zero)));
+    if (Mask != 0)
+      return Idx + static_cast<std::size_t>(__builtin_ctz(Mask));
+  }
+
+  return Idx + asciiPrefixSse2(Data + Idx, Size - Idx);
+}
+
+#endif
+
+std::size_t ModifiedUtf8::asciiPrefixLength(
+    const uint8_t *Data, std::size_t Size) {
+#if ICP_HAS_SSE2
+  // Decide once, cpu doesn't change while we are running
+  static const bool HasAvx2 = __builtin_cpu_supports("avx2");
+  return HasAvx2 ? asciiPrefixAvx2(Data, Size) : asciiPrefixSse2(Data, Size);
+#else
+  return asciiPrefixScalar(Data, Size, 0);
+#endif
+}
+
+static bool isContinuation(uint8_t Byte) {
+  return (Byte & 0xC0) == 0x80;
+}
+
+// Checks single character starting at 'Idx' and advances past it.
+// \returns false if character is malformed.
+static bool checkCharacter(
+    const uint8_t *Data, std::size_t Size, std::size_t &Idx) {
+  const uint8_t First = Data[Idx];
+
+  if (isPlainAscii(First)) {
+    Idx += 1;
+    return true;
+  }
+
+  // Two byte form: U+0080-U+07FF and the null character as C0 80
+  if ((First & 0xE0) == 0xC0) {
+    if (Idx + 1 >= Size || !isContinuation(Data[Idx + 1]))
+      return false;
+    if (First < 0xC2 && !(First == 0xC0 && Data[Idx + 1] == 0x80))
+      return false;
+    Idx += 2;
+    return true;
+  }
+
+  // Three byte form: U+0800-U+FFFF. Surrogates are encoded separately so
+  // they are allowed here.
+  if ((First & 0xF0) == 0xE0) {
+    if (Idx + 2 >= Size ||
+        !isContinuation(Data[Idx + 1]) || !isContinuation(Data[Idx + 2]))
+      return false;
+    if (First == 0xE0 && Data[Idx + 1] < 0xA0)
+      return false;
+    Idx += 3;
+    return true;
+  }
+
+  // Zero byte, stray continuation or a four byte form
+  return false;
+}
+
+bool ModifiedUtf8::isValid(const uint8_t *Data, std::size_t Size) {
+  std::size_t Idx = 0;
+  while (true) {
+    Idx += asciiPrefixLength(Data + Idx, Size - Idx);
+    if (Idx == Size)
+      return true;
+    if (!checkCharacter(Data, Size, Idx))
+      return false;
+  }
+}
+
+bool ModifiedUtf8::isValidScalar(const uint8_t *Data, std::size_t Size) {
+  std::size_t Idx = 0;
+  while (Idx < Size) {
+    if (!checkCharacter(Data, Size, Idx))
+      return false;
+  }
+  return true;
+}
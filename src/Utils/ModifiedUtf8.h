@@ -0,0 +1,32 @@
+///
+/// Validation of the modified UTF-8 strings from the class files (jvms 4.4.7).
+/// Strings are kept in their modified UTF-8 form, so validation is the only
+/// thing which needs to look at every byte.
+///
+
+#ifndef ICP_MODIFIEDUTF8_H
+#define ICP_MODIFIEDUTF8_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Utils {
+namespace ModifiedUtf8 {
+
+// Checks that the given bytes form a valid modified UTF-8 string: no zero
+// bytes, no four byte sequences and no overlong encodings except for the
+// two byte null character. Runs of ASCII characters are checked with SIMD
+// instructions when they are available.
+bool isValid(const uint8_t *Data, std::size_t Size);
+
+// Same as isValid but never uses SIMD. Intended for testing.
+bool isValidScalar(const uint8_t *Data, std::size_t Size);
+
+// \returns Length of the longest prefix which consists only of the non-zero
+// ASCII characters.
+std::size_t asciiPrefixLength(const uint8_t *Data, std::size_t Size);
+
+}
+}
+
+#endif //ICP_MODIFIEDUTF8_H
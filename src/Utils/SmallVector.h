@@ -0,0 +1,182 @@
+///
+/// Vector which keeps up to N elements inline and only goes to the heap when
+/// it grows past that. Intended for the short lived per-instruction data in
+/// the hot loops, i.e verifier frames.
+///
+/// Only trivially copyable elements are supported, so elements are moved
+/// around with memcpy and never destroyed. Capacity never shrinks, assigning
+/// a smaller vector reuses the existing storage.
+///
+
+#ifndef ICP_SMALLVECTOR_H
+#define ICP_SMALLVECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <type_traits>
+
+namespace Utils {
+
+template<class T, std::size_t N>
+class SmallVector final {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(N > 0);
+
+public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+public:
+  SmallVector() = default;
+
+  SmallVector(std::initializer_list<T> Init) {
+    append(Init.begin(), Init.end());
+  }
+
+  SmallVector(const SmallVector &Other) {
+    append(Other.begin(), Other.end());
+  }
+
+  SmallVector(SmallVector &&Other) noexcept {
+    *this = std::move(Other);
+  }
+
+  SmallVector &operator=(const SmallVector &Other) {
+    if (this == &Other)
+      return *this;
+    Size = 0;
+    append(Other.begin(), Other.end());
+    return *this;
+  }
+
+  SmallVector &operator=(SmallVector &&Other) noexcept {
+    if (this == &Other)
+      return *this;
+
+    // Steal heap storage, inline one has to be copied
+    if (!Other.isInline()) {
+      freeHeap();
+      Data = Other.Data;
+      Size = Other.Size;
+      Capacity = Other.Capacity;
+      Other.resetToInline();
+      return *this;
+    }
+
+    Size = 0;
+    append(Other.begin(), Other.end());
+    Other.Size = 0;
+    return *this;
+  }
+
+  ~SmallVector() { freeHeap(); }
+
+  std::size_t size() const { return Size; }
+  bool empty() const { return Size == 0; }
+  std::size_t capacity() const { return Capacity; }
+
+  T *data() { return Data; }
+  const T *data() const { return Data; }
+
+  iterator begin() { return Data; }
+  iterator end() { return Data + Size; }
+  const_iterator begin() const { return Data; }
+  const_iterator end() const { return Data + Size; }
+
+  T &operator[](std::size_t Idx) {
+    assert(Idx < Size);
+    return Data[Idx];
+  }
+  const T &operator[](std::size_t Idx) const {
+    assert(Idx < Size);
+    return Data[Idx];
+  }
+
+  T &back() { return (*this)[Size - 1]; }
+  const T &back() const { return (*this)[Size - 1]; }
+
+  void push_back(const T &Val) {
+    if (Size == Capacity) {
+      // 'Val' might point into our own storage
+      const T Copy = Val;
+      grow(Size + 1);
+      Data[Size++] = Copy;
+      return;
+    }
+    Data[Size++] = Val;
+  }
+
+  void pop_back() {
+    assert(Size > 0);
+    --Size;
+  }
+
+  // Appends elements from the range which should not overlap with this vector.
+  void append(const T *Begin, const T *End) {
+    const auto Count = static_cast<std::size_t>(End - Begin);
+    reserve(Size + Count);
+    if (Count != 0)
+      std::memcpy(static_cast<void*>(Data + Size), Begin, Count * sizeof(T));
+    Size += Count;
+  }
+
+  // New elements are initialized with 'Val'.
+  void resize(std::size_t NewSize, const T &Val) {
+    if (NewSize > Size) {
+      const T Copy = Val;
+      reserve(NewSize);
+      std::fill(Data + Size, Data + NewSize, Copy);
+    }
+    Size = NewSize;
+  }
+
+  void reserve(std::size_t NewCapacity) {
+    if (NewCapacity > Capacity)
+      grow(NewCapacity);
+  }
+
+  void clear() { Size = 0; }
+
+  bool isInline() const {
+    return Data == reinterpret_cast<const T*>(Inline);
+  }
+
+private:
+  void grow(std::size_t MinCapacity) {
+    const auto NewCapacity = std::max(MinCapacity, Capacity * 2);
+    T *NewData = static_cast<T*>(::operator new(NewCapacity * sizeof(T)));
+    if (Size != 0)
+      std::memcpy(static_cast<void*>(NewData), Data, Size * sizeof(T));
+
+    freeHeap();
+    Data = NewData;
+    Capacity = NewCapacity;
+  }
+
+  void freeHeap() {
+    if (!isInline())
+      ::operator delete(Data);
+  }
+
+  void resetToInline() {
+    Data = reinterpret_cast<T*>(Inline);
+    Size = 0;
+    Capacity = N;
+  }
+
+private:
+  T *Data = reinterpret_cast<T*>(Inline);
+  std::size_t Size = 0;
+  std::size_t Capacity = N;
+
+  alignas(T) unsigned char Inline[N * sizeof(T)];
+};
+
+}
+
+#endif //ICP_SMALLVECTOR_H
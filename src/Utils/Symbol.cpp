@@ -0,0 +1,82 @@
+///
+/// Process wide symbol table.
+///
+
+#include "Symbol.h"
+
+#include "Utils/ConcurrentHashMap.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace Utils;
+
+namespace Utils {
+
+class SymbolTable final {
+public:
+  static SymbolTable &get() {
+    // Never destroyed, symbols might be used by the static destructors
+    static SymbolTable *Table = new SymbolTable();
+    return *Table;
+  }
+
+  Symbol lookup(std::string_view Str) const {
+    const auto *Res = Symbols.find(Str);
+    return Res ? Symbol(*Res) : Symbol();
+  }
+
+  Symbol intern(std::string_view Str) {
+    if (auto Res = lookup(Str); !Res.isNull())
+      return Res;
+
+    std::lock_guard<std::mutex> Guard(Lock);
+    if (auto Res = lookup(Str); !Res.isNull())
+      return Res; // someone was faster
+
+    Entries.push_back(std::make_unique<Symbol::Entry>(
+        Symbol::Entry{Utf8String(Str), std::hash<std::string_view>()(Str)}));
+    const auto *E = Entries.back().get();
+
+    // Key refers to the entry string which is never moved
+    Symbols.insert(std::string_view(E->Str), E);
+    return Symbol(E);
+  }
+
+  std::size_t size() const {
+    return Symbols.size();
+  }
+
+private:
+  SymbolTable(): Symbols(4096) { ; }
+
+private:
+  std::mutex Lock;
+  std::vector<std::unique_ptr<Symbol::Entry>> Entries;
+  ConcurrentHashMap<std::string_view, const Symbol::Entry*> Symbols;
+};
+
+}
+
+Symbol Symbol::intern(std::string_view Str) {
+  return SymbolTable::get().intern(Str);
+}
+
+Symbol Symbol::lookup(std::string_view Str) {
+  return SymbolTable::get().lookup(Str);
+}
+
+std::size_t Symbol::tableSize() {
+  return SymbolTable::get().size();
+}
+
+Symbol Symbols::init() {
+  static const Symbol Ret = Symbol::intern("<init>");
+  return Ret;
+}
+
+Symbol Symbols::clinit() {
+  static const Symbol Ret = Symbol::intern("<clinit>");
+  return Ret;
+}
@@ -0,0 +1,109 @@
+///
+/// Interned strings. Every distinct name or descriptor is stored exactly once
+/// in the process wide symbol table and is referred to by a Symbol handle.
+/// Symbols are compared by pointer and carry precomputed hash.
+///
+/// Table is append-only and symbols are never freed, so handles stay valid
+/// for the whole lifetime of the process and can be shared between VMs.
+///
+
+#ifndef ICP_SYMBOL_H
+#define ICP_SYMBOL_H
+
+#include "Utils/Utf8String.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
+namespace Utils {
+
+class Symbol final {
+private:
+  struct Entry {
+    const Utf8String Str;
+    const std::size_t Hash;
+  };
+
+public:
+  // Null symbol which doesn't correspond to any string
+  Symbol() = default;
+
+  // Finds or creates symbol for the given string. Thread safe.
+  static Symbol intern(std::string_view Str);
+
+  // Finds existing symbol without creating a new one. Lock free.
+  // \returns Null symbol if string was never interned.
+  static Symbol lookup(std::string_view Str);
+
+  // Total number of the interned strings.
+  static std::size_t tableSize();
+
+  bool isNull() const { return E == nullptr; }
+
+  const Utf8String &str() const { assert(E); return E->Str; }
+  std::size_t hash() const { assert(E); return E->Hash; }
+
+  // Symbols are often used where plain strings were used before
+  operator const Utf8String&() const { return str(); }
+
+  bool operator==(const Symbol &Other) const { return E == Other.E; }
+  bool operator!=(const Symbol &Other) const { return E != Other.E; }
+
+  // Slow comparisons with the arbitrary strings
+  bool operator==(std::string_view Other) const {
+    return E != nullptr && E->Str == Other;
+  }
+  bool operator!=(std::string_view Other) const { return !(*this == Other); }
+  bool operator==(const char *Other) const {
+    return *this == std::string_view(Other);
+  }
+  bool operator!=(const char *Other) const { return !(*this == Other); }
+  bool operator==(const Utf8String &Other) const {
+    return *this == std::string_view(Other);
+  }
+  bool operator!=(const Utf8String &Other) const { return !(*this == Other); }
+
+private:
+  explicit Symbol(const Entry *E): E(E) { ; }
+
+  friend class SymbolTable;
+
+private:
+  const Entry *E = nullptr;
+};
+
+// Names which are looked up by the runtime itself
+namespace Symbols {
+Symbol init();   // "<init>"
+Symbol clinit(); // "<clinit>"
+}
+
+inline std::ostream &operator<<(std::ostream &Out, const Symbol &S) {
+  return Out << S.str();
+}
+
+inline Utf8String operator+(const Symbol &Lhs, const Utf8String &Rhs) {
+  return Lhs.str() + Rhs;
+}
+inline Utf8String operator+(const Utf8String &Lhs, const Symbol &Rhs) {
+  return Lhs + Rhs.str();
+}
+inline Utf8String operator+(const Symbol &Lhs, const char *Rhs) {
+  return Lhs.str() + Rhs;
+}
+inline Utf8String operator+(const char *Lhs, const Symbol &Rhs) {
+  return Lhs + Rhs.str();
+}
+
+}
+
+namespace std {
+template<> struct hash<Utils::Symbol> {
+  std::size_t operator()(const Utils::Symbol &S) const { return S.hash(); }
+};
+}
+
+#endif //ICP_SYMBOL_H
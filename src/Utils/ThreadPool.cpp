@@ -0,0 +1,57 @@
+///
+/// Thread pool implementation.
+///
+
+#include "ThreadPool.h"
+
+#include <cassert>
+
+using namespace Utils;
+
+ThreadPool::ThreadPool(std::size_t NumThreads) {
+  if (NumThreads == 0)
+    NumThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  Workers.reserve(NumThreads);
+  for (std::size_t i = 0; i < NumThreads; ++i)
+    Workers.emplace_back([this]() { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    ShuttingDown = true;
+  }
+  HasWork.notify_all();
+
+  for (auto &W: Workers)
+    W.join();
+}
+
+void ThreadPool::enqueue(std::function<void()> &&Task) {
+  {
+    std::lock_guard<std::mutex> Guard(Lock);
+    assert(!ShuttingDown); // can't submit after destruction started
+    Tasks.push_back(std::move(Task));
+  }
+  HasWork.notify_one();
+}
+
+void ThreadPool::workerLoop() {
+  while (true) {
+    std::function<void()> Task;
+    {
+      std::unique_lock<std::mutex> Guard(Lock);
+      HasWork.wait(Guard, [this]() { return ShuttingDown || !Tasks.empty(); });
+
+      // Drain the queue before exiting
+      if (Tasks.empty())
+        return;
+
+      Task = std::move(Tasks.front());
+      Tasks.pop_front();
+    }
+
+    Task();
+  }
+}
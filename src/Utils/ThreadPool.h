@@ -0,0 +1,68 @@
+///
+/// Fixed size pool of worker threads.
+///
+
+#ifndef ICP_THREADPOOL_H
+#define ICP_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace Utils {
+
+class ThreadPool final {
+public:
+  // Creates pool with the given number of workers. Zero means number of the
+  // hardware threads.
+  explicit ThreadPool(std::size_t NumThreads = 0);
+
+  // Waits for all submitted tasks to finish
+  ~ThreadPool();
+
+  // No copies
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  // No moves
+  ThreadPool(ThreadPool &&) = delete;
+  ThreadPool &operator=(ThreadPool &&) = delete;
+
+  // Schedules task for the execution. Tasks are allowed to submit new tasks.
+  // \returns Future which will receive result or exception of the task.
+  template<class F>
+  std::future<std::invoke_result_t<F>> submit(F &&Task) {
+    using ResT = std::invoke_result_t<F>;
+
+    // std::function requires copyable callable, so keep task on the heap
+    auto Packaged = std::make_shared<std::packaged_task<ResT()>>(
+        std::forward<F>(Task));
+    auto Ret = Packaged->get_future();
+
+    enqueue([Packaged]() { (*Packaged)(); });
+    return Ret;
+  }
+
+  std::size_t numThreads() const { return Workers.size(); }
+
+private:
+  void enqueue(std::function<void()> &&Task);
+  void workerLoop();
+
+private:
+  std::vector<std::thread> Workers;
+
+  std::mutex Lock;
+  std::condition_variable HasWork;
+  std::deque<std::function<void()>> Tasks;
+  bool ShuttingDown = false;
+};
+
+}
+
+#endif //ICP_THREADPOOL_H
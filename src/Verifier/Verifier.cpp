@@ -9,6 +9,13 @@
 
 #include "JavaTypes/JavaClass.h"
 #include "Bytecode/Instructions.h"
+#include "Utils/ThreadPool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
 
 using namespace JavaTypes;
 using namespace Bytecode;
@@ -16,6 +23,12 @@ using namespace Verifier;
 
 namespace {
 
+// Results of the verification are cached across runs under this version.
+// Bump it whenever the set of accepted classes might change. This includes
+// not only this file, but everything verifier depends on: class file parsing,
+// bytecode decoding, types, stack frames and stack map tables.
+constexpr const char *VerifierVersion = "1";
+
 // This visitor is intended to be called on all instructions of the method
 // in order of their appearance. Caller is responsible to supply
 // correct stack frames when necessary.
@@ -32,7 +45,7 @@ public:
 
     // Add 'this' argument type
     if (!(Method.getAccessFlags() & JavaMethod::AccessFlags::ACC_STATIC)) {
-      if (Method.getName() == "<init>")
+      if (Method.getName() == Utils::Symbols::init())
         LocalTypes.insert(LocalTypes.begin(), Types::UninitializedThis);
       else
         LocalTypes.insert(LocalTypes.begin(), Types::Class);
@@ -41,11 +54,13 @@ public:
     if (LocalTypes.size() > Method.getMaxLocals())
       throwErr("Too many locals");
 
-    // Materialize stack map
-    StackMap = Method.getStackMapBuilder().createTable(LocalTypes);
-    StackMapIt = StackMap.begin();
-
+    // Main loop shouldn't allocate, so reserve everything upfront. Stack might
+    // exceed the limit by one type before it's checked.
+    // Stack map frames are replayed as we go, only the current one is kept.
+    StackMap = StackMapCursor(Method.getStackMapBuilder(), LocalTypes);
+    StackMap.reserve(Method.getMaxLocals(), Method.getMaxStack());
     CurrentFrame = StackFrame(LocalTypes, {});
+    CurrentFrame.reserve(Method.getMaxLocals(), Method.getMaxStack() + 2u);
     CurrentFrame.resizeLocals(Method.getMaxLocals());
 
     CurInstr = Method.begin();
@@ -66,9 +81,12 @@ public:
   void visit(const aload_val &Inst) override;
   void visit(const astore_val &Inst) override;
   void visit(const invokespecial &Inst) override;
+  void visit(const invokestatic &Inst) override;
   void visit(const java_return &) override;
   void visit(const iconst_val &) override;
   void visit(const ireturn &) override;
+  void visit(const lreturn &) override;
+  void visit(const freturn &) override;
   void visit(const dreturn &) override;
   void visit(const putstatic &) override;
   void visit(const getstatic &) override;
@@ -84,36 +102,41 @@ public:
   void visit(const java_new &) override;
   void visit(const dup &Inst) override;
   void visit(const bipush &) override;
+  void visit(const ldc &) override;
+  void visit(const ldc_w &) override;
+  void visit(const ldc2_w &) override;
+  void visit(const monitorenter &) override;
+  void visit(const monitorexit &) override;
 
   // Runs before visiting instruction.
   void runPreConditions() {
     // Must have stack map if after goto
     if (afterGoto) {
-      if (StackMapIt == StackMap.end() || StackMapIt.getBci() != getCurBci())
+      if (StackMap.atEnd() || StackMap.getBci() != getCurBci())
         throwErr("Couldn't find stack map after goto");
 
-      CurrentFrame = *StackMapIt;
+      CurrentFrame = StackMap.getFrame();
       CurrentFrame.resizeLocals(Method.getMaxLocals());
 
-      ++StackMapIt;
+      StackMap.advance();
       afterGoto = false;
       return;
     }
 
     // No stack map - nothing to do.
-    if (StackMapIt == StackMap.end())
+    if (StackMap.atEnd())
       return;
 
     // Don't have stack map for the current bci - nothing to do.
-    if (StackMapIt.getBci() != getCurBci())
+    if (StackMap.getBci() != getCurBci())
       return;
 
-    const auto &map_frame = *StackMapIt;
+    const auto &map_frame = StackMap.getFrame();
     if (!CurrentFrame.transformInto(map_frame))
       throwErr("Current frame is unassignable into map frame");
 
     CurrentFrame.resizeLocals(Method.getMaxLocals());
-    ++StackMapIt;
+    StackMap.advance();
   }
 
   // Runs after visit of the instruction.
@@ -155,7 +178,7 @@ private:
   }
 
   // Pops type list from the current frame or throws verification error.
-  void tryPop(const std::vector<Type> &ToPop, std::string_view ErrMsg) {
+  void tryPop(TypeList ToPop, std::string_view ErrMsg) {
     if (!CurrentFrame.popMatchingList(ToPop))
       throwErr(ErrMsg);
   }
@@ -176,7 +199,7 @@ private:
     return CurInstr.getBci();
   }
 
-  void tryTypeTransition(const std::vector<Type> &ToPop, Type ToPush) {
+  void tryTypeTransition(TypeList ToPop, Type ToPush) {
     if (!CurrentFrame.doTypeTransition(ToPop, ToPush))
       throwErr("Incorrect type transition");
   }
@@ -190,8 +213,7 @@ private:
   StackFrame CurrentFrame{{}, {}};
   Type ReturnType = Types::Top;
 
-  StackMapTable StackMap;
-  StackMapTable::const_iterator StackMapIt;
+  StackMapCursor StackMap;
 
   // If tru we need to load new stack frame
   bool afterGoto = false;
@@ -213,14 +235,13 @@ void MethodVerifier::visit(const invokespecial &Inst) {
   if (MRef == nullptr)
     throwErr("Incorrect CP index at invokespecial");
 
-  if (MRef->getName() != "<init>") {
+  if (MRef->getName() != Utils::Symbols::init()) {
     throwErr("Private or super methods is not yet supported");
   }
 
-  std::vector<Type> ArgTypes;
-  Type CallRetType = Types::Void;
-  std::tie(CallRetType, ArgTypes) =
-    Type::parseMethodDescriptor(MRef->getDescriptor());
+  Type::ArgumentTypes ArgTypes;
+  const Type CallRetType =
+      Type::parseMethodDescriptor(MRef->getDescriptor(), ArgTypes);
 
   if (CallRetType != Types::Void)
     throwErr("<init> method should have void return type");
@@ -249,6 +270,35 @@ void MethodVerifier::visit(const invokespecial &Inst) {
   CurrentFrame.substituteStack(UninitializedArg, UninitializedRepl);
 }
 
+void MethodVerifier::visit(const invokestatic &Inst) {
+  const auto *MRef =
+      CP.getAsOrNull<ConstantPoolRecords::MethodRef>(Inst.getIdx());
+  if (MRef == nullptr)
+    throwErr("Incorrect CP index at invokestatic");
+
+  if (MRef->getName() == Utils::Symbols::init() ||
+      MRef->getName() == Utils::Symbols::clinit())
+    throwErr("Can't call initialization methods with invokestatic");
+
+  Type::ArgumentTypes ArgTypes;
+  Type CallRetType = Types::Void;
+  try {
+    CallRetType = Type::parseMethodDescriptor(MRef->getDescriptor(), ArgTypes);
+  } catch (Type::ParsingError &) {
+    throwErr("Unable to parse method descriptor");
+  }
+
+  // Pop method arguments
+  std::reverse(ArgTypes.begin(), ArgTypes.end());
+  std::transform(
+      ArgTypes.begin(), ArgTypes.end(), ArgTypes.begin(), Types::toStackType);
+  tryPop(ArgTypes, "Unable to pop arguments");
+
+  // Push the result
+  if (CallRetType != Types::Void)
+    CurrentFrame.pushList({Types::toStackType(CallRetType)});
+}
+
 void MethodVerifier::visit(const java_return &) {
   if (ReturnType != Types::Void)
     throw VerificationError("Return type should be 'void'");
@@ -273,6 +323,22 @@ void MethodVerifier::visit(const dconst_val &) {
   CurrentFrame.pushList({Types::Double});
 }
 
+void MethodVerifier::visit(const lreturn &) {
+  if (ReturnType != Types::Long)
+    throw VerificationError("Return type should be long");
+
+  tryPop({Types::Long}, "Expected long type to be on the stack");
+  afterGoto = true;
+}
+
+void MethodVerifier::visit(const freturn &) {
+  if (ReturnType != Types::Float)
+    throw VerificationError("Return type should be float");
+
+  tryPop({Types::Float}, "Expected float type to be on the stack");
+  afterGoto = true;
+}
+
 void MethodVerifier::visit(const dreturn &) {
   if (ReturnType != Types::Double)
     throw VerificationError("Return type should be double");
@@ -334,9 +400,9 @@ void MethodVerifier::visit(const getfield &Inst) {
 
 void MethodVerifier::targetIsTypeSafe(Bytecode::BciOffsetType Off) {
   auto target_bci = getCurBci() + Off;
-  auto target_frame = StackMap.findAtBci(target_bci);
+  const auto *target_frame = StackMap.findAtBci(target_bci);
 
-  if (target_frame == StackMap.end())
+  if (target_frame == nullptr)
     throwErr("Unable to find stack map table entry for the target bci");
 
   if (!StackFrame::isAssignable(CurrentFrame, *target_frame))
@@ -366,8 +432,9 @@ void MethodVerifier::visit(const iinc &Inst) {
 void MethodVerifier::visit(const java_goto &Inst) {
   targetIsTypeSafe(Inst.getIdx());
   afterGoto = true;
-  // Reset frame to avoid unfortunate accidents
-  CurrentFrame = StackFrame({}, {});
+  // Reset frame to avoid unfortunate accidents. Storage is kept for the
+  // next frame.
+  CurrentFrame.clear();
 }
 
 void MethodVerifier::visit(const iadd &) {
@@ -412,6 +479,41 @@ void MethodVerifier::visit(const bipush &) {
   CurrentFrame.pushList({Types::Int});
 }
 
+// Helper for the ldc family of instructions. Checks that constant pool index
+// points to the numeric constant of the expected size and returns it's type.
+static Type getConstantType(
+    ConstantPool::IndexType Idx, const ConstantPool &CP, std::size_t Size) {
+  const auto *Const =
+      CP.getAsOrNull<ConstantPoolRecords::NumericConstant>(Idx);
+  if (!Const)
+    throw VerificationError("Constant pool index should point to the constant");
+
+  if (Types::sizeOf(Const->getType()) != Size)
+    throw VerificationError("Constant has unexpected category");
+
+  return Const->getType();
+}
+
+void MethodVerifier::visit(const ldc &Inst) {
+  CurrentFrame.pushList({getConstantType(Inst.getIdx(), CP, 1)});
+}
+
+void MethodVerifier::visit(const ldc_w &Inst) {
+  CurrentFrame.pushList({getConstantType(Inst.getIdx(), CP, 1)});
+}
+
+void MethodVerifier::visit(const ldc2_w &Inst) {
+  CurrentFrame.pushList({getConstantType(Inst.getIdx(), CP, 2)});
+}
+
+void MethodVerifier::visit(const monitorenter &) {
+  tryPop({Types::Reference}, "Expected reference for monitorenter");
+}
+
+void MethodVerifier::visit(const monitorexit &) {
+  tryPop({Types::Reference}, "Expected reference for monitorexit");
+}
+
 
 
 
@@ -428,6 +530,94 @@ void Verifier::verify(const JavaClass &Class) {
   // TODO: Add class level verification
 
   for (const auto &Method: Class.methods()) {
+    // Nothing to verify in the native methods
+    if (Method->isNative())
+      continue;
     verifyMethod(*Method);
   }
 }
+
+namespace {
+
+// Shared between the verifying thread and the pool helpers. Helpers may start
+// after the verification is done, so this is kept alive by them.
+struct ParallelVerification {
+  explicit ParallelVerification(const JavaClass &Class):
+      Class(Class),
+      Errors(Class.methods().size()) {
+    ;
+  }
+
+  // Verifies methods until there is nothing left to take.
+  void run() {
+    const auto NumMethods = Errors.size();
+    while (true) {
+      const auto Idx = NextMethod.fetch_add(1);
+      if (Idx >= NumMethods)
+        return;
+
+      // Methods after the already failed one can't change the result
+      const auto &Method = *Class.methods()[Idx];
+      if (Idx < FirstError.load() && !Method.isNative()) {
+        try {
+          verifyMethod(Method);
+        } catch (...) {
+          Errors[Idx] = std::current_exception();
+          std::size_t Cur = FirstError.load();
+          while (Idx < Cur && !FirstError.compare_exchange_weak(Cur, Idx))
+            ;
+        }
+      }
+
+      std::lock_guard<std::mutex> Guard(Lock);
+      if (++NumDone == NumMethods)
+        AllDone.notify_all();
+    }
+  }
+
+  void waitAll() {
+    std::unique_lock<std::mutex> Guard(Lock);
+    AllDone.wait(Guard, [this]() { return NumDone == Errors.size(); });
+  }
+
+  const JavaClass &Class;
+
+  // Exception for each failed method
+  std::vector<std::exception_ptr> Errors;
+  std::atomic<std::size_t> FirstError{SIZE_MAX};
+  std::atomic<std::size_t> NextMethod{0};
+
+  std::mutex Lock;
+  std::condition_variable AllDone;
+  std::size_t NumDone = 0;
+};
+
+}
+
+void Verifier::verify(const JavaClass &Class, Utils::ThreadPool &Pool) {
+  // TODO: Add class level verification
+
+  const auto NumMethods = Class.methods().size();
+  if (NumMethods <= 1) {
+    verify(Class);
+    return;
+  }
+
+  auto State = std::make_shared<ParallelVerification>(Class);
+
+  // Calling thread does it's share of work, so helpers are only useful while
+  // there are methods left. We don't wait for helpers which never started.
+  const auto NumHelpers = std::min(Pool.numThreads(), NumMethods - 1);
+  for (std::size_t Idx = 0; Idx < NumHelpers; ++Idx)
+    Pool.submit([State]() { State->run(); });
+
+  State->run();
+  State->waitAll();
+
+  if (State->FirstError.load() != SIZE_MAX)
+    std::rethrow_exception(State->Errors[State->FirstError.load()]);
+}
+
+const char *Verifier::version() {
+  return VerifierVersion;
+}
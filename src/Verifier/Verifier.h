@@ -10,6 +10,10 @@
 
 #include <stdexcept>
 
+namespace Utils {
+class ThreadPool;
+}
+
 namespace Verifier {
 
 class VerificationError: public std::runtime_error {
@@ -25,6 +29,18 @@ void verifyMethod(const JavaTypes::JavaMethod &Method);
 // \throws VerificationError In case of any verification errors.
 void verify(const JavaTypes::JavaClass &Class);
 
+// Same as above but methods are verified concurrently using the thread pool.
+// Calling thread takes part in the verification, so it's fine to call this
+// from the pool workers. If several methods fail, error of the first one in
+// the order of the class methods is reported.
+// \throws VerificationError In case of any verification errors.
+void verify(const JavaTypes::JavaClass &Class, Utils::ThreadPool &Pool);
+
+// Version of the verification rules. It's maintained by hand and changes
+// only when verifier semantics change. Verification results which are
+// stored outside of the process are only valid for the same version.
+const char *version();
+
 }
 
 
@@ -152,3 +152,43 @@ TEST_CASE("Lexer error", "[CD]") {
 TEST_CASE("Slashes in strings", "[CD]") {
   REQUIRE_NOTHROW(Lexer("\"java/lang/Object\"\n"));
 }
+
+TEST_CASE("Numeric constants", "[CD]") {
+  Lexer lex("\"-1.5e+3\" = #5");
+
+  REQUIRE(lex.consume() == Token::String("-1.5e+3"));
+  REQUIRE(lex.consume() == Token::Eq);
+  REQUIRE(lex.consume() == Token::Sharp);
+  REQUIRE(lex.consume() == Token::Num("5"));
+  REQUIRE(!lex.hasNext());
+}
+
+TEST_CASE("Keywords are whole words", "[CD]") {
+  Lexer lex("classes class method_1 method\r\n@stackmap");
+
+  REQUIRE(lex.consume() == Token::Id("classes"));
+  REQUIRE(lex.consume() == Token::Keyword("class"));
+  REQUIRE(lex.consume() == Token::Id("method_1"));
+  REQUIRE(lex.consume() == Token::Keyword("method"));
+  REQUIRE(lex.consume() == Token::Dog);
+  REQUIRE(lex.consume() == Token::Keyword("stackmap"));
+  REQUIRE(!lex.hasNext());
+}
+
+TEST_CASE("Lexer owns moved input", "[CD]") {
+  std::string Input = "class \"java/lang/Object\"";
+  Lexer lex(std::move(Input));
+  Input = "overwritten";
+
+  REQUIRE(lex.consume() == Token::Keyword("class"));
+  REQUIRE(lex.consume().getData() == "java/lang/Object");
+}
+
+TEST_CASE("Lexer error line", "[CD]") {
+  try {
+    Lexer("class {\r\n}\r\n  $");
+    FAIL("Expected lexer error");
+  } catch (Lexer::LexerError &E) {
+    REQUIRE(std::string(E.what()) == "Unable to lex the whole string: 3");
+  }
+}
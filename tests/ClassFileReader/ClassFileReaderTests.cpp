@@ -12,13 +12,63 @@
 #include "ClassFileReader/ClassFileReader.h"
 #include "Verifier/Verifier.h"
 
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Throw exception if file not found", "[ClassFileReader]") {
   REQUIRE_THROWS_AS(ClassFileReader::loadClassFromFile("wrong name"),
     ClassFileReader::FileNotFound);
 }
 
+TEST_CASE("Read class from buffer", "[ClassFileReader]") {
+  std::ifstream File("./examples/Simple.class", std::ios_base::binary);
+  std::vector<uint8_t> Bytes(
+      (std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+  REQUIRE(!Bytes.empty());
+
+  auto Class = ClassFileReader::loadClassFromBuffer(Bytes.data(), Bytes.size());
+  // Class should not refer to the buffer
+  Bytes.assign(Bytes.size(), 0);
+  REQUIRE(Class->getClassName() == "Simple");
+  REQUIRE(Class->getMethod("main") != nullptr);
+
+  // Truncated input is a format error, not a crash
+  std::ifstream Again("./examples/Simple.class", std::ios_base::binary);
+  std::vector<uint8_t> Truncated(
+      (std::istreambuf_iterator<char>(Again)), std::istreambuf_iterator<char>());
+  Truncated.resize(Truncated.size() / 2);
+  REQUIRE_THROWS_AS(
+      ClassFileReader::loadClassFromBuffer(Truncated.data(), Truncated.size()),
+      ClassFileReader::FormatError);
+}
+
+TEST_CASE("Method bodies are decoded lazily", "[ClassFileReader]") {
+  auto Class = ClassFileReader::loadClassFromFile("./examples/Loop.class");
+  const auto *Main = Class->getMethod("main");
+  REQUIRE(Main != nullptr);
+  REQUIRE_FALSE(Main->isMaterialized());
+
+  // All threads observe the same decoded body
+  std::vector<std::thread> Threads;
+  std::vector<Bytecode::BciType> Counts(4);
+  for (std::size_t i = 0; i < Counts.size(); ++i)
+    Threads.emplace_back([&, i]() { Counts[i] = Main->numInstructions(); });
+  for (auto &T: Threads)
+    T.join();
+
+  REQUIRE(Main->isMaterialized());
+  REQUIRE(Counts[0] > 0);
+  for (auto Count: Counts)
+    REQUIRE(Count == Counts[0]);
+
+  // Other methods are still untouched
+  for (const auto &Method: Class->methods())
+    REQUIRE((Method.get() == Main || !Method->isMaterialized()));
+}
+
 template<class ResT = Runtime::JavaInt>
 ResT testSingleClass(const std::string &ClassName) {
   Runtime::ClassManager CM;
@@ -0,0 +1,157 @@
+//
+// Tests for the class file writer. Classes are written and then read back
+// using the class file reader.
+//
+
+#include "catch.hpp"
+
+#include "ClassFileWriter/ClassFileWriter.h"
+#include "ClassFileReader/ClassFileReader.h"
+#include "CD/Parser.h"
+#include "JavaTypes/ConstantPoolRecords.h"
+#include "JavaTypes/JavaMethod.h"
+#include "JavaTypes/StackMapTable.h"
+#include "Verifier/Verifier.h"
+#include "Bytecode/Bytecode.h"
+
+#include <cstdio>
+#include <sstream>
+
+using namespace JavaTypes;
+
+namespace {
+
+std::unique_ptr<JavaClass> roundTrip(const JavaClass &Class) {
+  std::istringstream Input(ClassFileWriter::writeClassToBuffer(Class));
+  return ClassFileReader::loadClassFromStream(Input);
+}
+
+bool isVerifiable(const JavaMethod &Method) {
+  try {
+    Verifier::verifyMethod(Method);
+    return true;
+  } catch (const Verifier::VerificationError &) {
+    return false;
+  }
+}
+
+void checkStackMapsEqual(const JavaMethod &Expected, const JavaMethod &Actual) {
+  const auto Locals =
+      std::get<1>(Type::parseMethodDescriptor(Expected.getDescriptor()));
+
+  const auto ExpectedTable =
+      Expected.getStackMapBuilder().createTable(Locals);
+  const auto ActualTable = Actual.getStackMapBuilder().createTable(Locals);
+
+  auto ExpectedIt = ExpectedTable.begin();
+  auto ActualIt = ActualTable.begin();
+  for (; ExpectedIt != ExpectedTable.end(); ++ExpectedIt, ++ActualIt) {
+    REQUIRE(ActualIt != ActualTable.end());
+    REQUIRE(ActualIt.getBci() == ExpectedIt.getBci());
+    REQUIRE(*ActualIt == *ExpectedIt);
+  }
+  REQUIRE(ActualIt == ActualTable.end());
+}
+
+void checkMethodsEqual(const JavaMethod &Expected, const JavaMethod &Actual) {
+  REQUIRE(Actual.getName() == Expected.getName());
+  REQUIRE(Actual.getDescriptor() == Expected.getDescriptor());
+  REQUIRE(Actual.getAccessFlags() == Expected.getAccessFlags());
+  if (Expected.isNative())
+    return;
+
+  REQUIRE(Actual.getMaxStack() == Expected.getMaxStack());
+  REQUIRE(Actual.getMaxLocals() == Expected.getMaxLocals());
+
+  auto ExpectedIt = Expected.begin();
+  auto ActualIt = Actual.begin();
+  for (; ExpectedIt != Expected.end(); ++ExpectedIt, ++ActualIt) {
+    REQUIRE(ActualIt != Actual.end());
+    REQUIRE(ActualIt.getBci() == ExpectedIt.getBci());
+
+    Bytecode::Container ExpectedBytes, ActualBytes;
+    (*ExpectedIt)->encode(ExpectedBytes);
+    (*ActualIt)->encode(ActualBytes);
+    REQUIRE(ActualBytes == ExpectedBytes);
+  }
+  REQUIRE(ActualIt == Actual.end());
+
+  checkStackMapsEqual(Expected, Actual);
+}
+
+void checkClassesEqual(const JavaClass &Expected, const JavaClass &Actual) {
+  REQUIRE(Actual.getClassName() == Expected.getClassName());
+  REQUIRE(Actual.hasSuper() == Expected.hasSuper());
+  if (Expected.hasSuper())
+    REQUIRE(Actual.getSuperClassName() == Expected.getSuperClassName());
+
+  REQUIRE(Actual.fields().size() == Expected.fields().size());
+  for (std::size_t Idx = 0; Idx < Expected.fields().size(); ++Idx) {
+    const auto &ExpectedField = Expected.fields()[Idx];
+    const auto &ActualField = Actual.fields()[Idx];
+
+    REQUIRE(ActualField.getName() == ExpectedField.getName());
+    REQUIRE(ActualField.getDescriptor() == ExpectedField.getDescriptor());
+    REQUIRE(ActualField.getFlags() == ExpectedField.getFlags());
+    REQUIRE(ActualField.hasConstantValue() == ExpectedField.hasConstantValue());
+    if (ExpectedField.hasConstantValue())
+      REQUIRE(ActualField.getConstantValue().getValue() ==
+              ExpectedField.getConstantValue().getValue());
+  }
+
+  REQUIRE(Actual.methods().size() == Expected.methods().size());
+  for (std::size_t Idx = 0; Idx < Expected.methods().size(); ++Idx)
+    checkMethodsEqual(*Expected.methods()[Idx], *Actual.methods()[Idx]);
+}
+
+}
+
+TEST_CASE("Write simple classes", "[ClassFileWriter]") {
+  for (const auto *FileName: {
+      "tests/CD/Simple.cd", "tests/CD/Fields.cd", "tests/CD/FieldRef.cd",
+      "tests/CD/EmptyMethods.cd"}) {
+    INFO(FileName);
+
+    const auto Class = CD::parseFromFile(FileName);
+    const auto Result = roundTrip(*Class);
+    checkClassesEqual(*Class, *Result);
+
+    // Written class is stable
+    REQUIRE(ClassFileWriter::writeClassToBuffer(*Result) ==
+            ClassFileWriter::writeClassToBuffer(*roundTrip(*Result)));
+  }
+}
+
+TEST_CASE("Write classes with stack maps", "[ClassFileWriter]") {
+  for (const auto *FileName: {
+      "goto.cd", "if_icmp.cd", "iinc.cd", "new.cd", "putfield_getfield.cd",
+      "ldc.cd", "dconst_dreturn.cd"}) {
+    INFO(FileName);
+
+    const auto Class = CD::parseFromFile(std::string("tests/Verifier/") + FileName);
+    const auto Result = roundTrip(*Class);
+    checkClassesEqual(*Class, *Result);
+
+    // Verifier should agree on both classes
+    for (std::size_t Idx = 0; Idx < Class->methods().size(); ++Idx) {
+      INFO(Class->methods()[Idx]->getName());
+      REQUIRE(isVerifiable(*Result->methods()[Idx]) ==
+              isVerifiable(*Class->methods()[Idx]));
+    }
+  }
+}
+
+TEST_CASE("Write class into the file", "[ClassFileWriter]") {
+  const auto Class = CD::parseFromFile("tests/CD/Simple.cd");
+  const std::string FileName = "cd2class_test.class";
+
+  ClassFileWriter::writeClassToFile(*Class, FileName);
+  const auto Result = ClassFileReader::loadClassFromFile(FileName);
+  std::remove(FileName.c_str());
+
+  checkClassesEqual(*Class, *Result);
+
+  REQUIRE_THROWS_AS(
+      ClassFileWriter::writeClassToFile(*Class, "no/such/dir/a.class"),
+      ClassFileWriter::WriteError);
+}
@@ -44,8 +44,7 @@ TEST_CASE("Constant pool type safety", "[ConstantPool]") {
   REQUIRE_THROWS(Builder.getCellReference<ConstantPoolRecords::NameAndType>(2));
 
   // Can't save Utf8 into ClassInfo.
-  REQUIRE_THROWS(
-      Builder.set(2, std::make_unique<ConstantPoolRecords::Utf8>("test")));
+  REQUIRE_THROWS(Builder.create<ConstantPoolRecords::Utf8>(2, "test"));
 
   // But can set ClassInfo into ClassInfo.
   REQUIRE_NOTHROW(Builder.create<ConstantPoolRecords::ClassInfo>(
@@ -54,3 +53,32 @@ TEST_CASE("Constant pool type safety", "[ConstantPool]") {
   // And can set Utf8 into Utf8.
   REQUIRE_NOTHROW(Builder.create<ConstantPoolRecords::Utf8>(1, "asdf"));
 }
+
+TEST_CASE("Constant pool tags", "[ConstantPool]") {
+  ConstantPoolBuilder Builder(4);
+  Builder.create<ConstantPoolRecords::Utf8>(1, "test");
+  Builder.create<ConstantPoolRecords::Long>(2, 5);
+  Builder.create<ConstantPoolRecords::Unusable>(3);
+  Builder.create<ConstantPoolRecords::Integer>(4, 7);
+  auto CP = Builder.createConstantPool();
+
+  REQUIRE(CP->getTag(1) == ConstantPoolRecords::Tag::Utf8);
+  REQUIRE(CP->getTag(2) == ConstantPoolRecords::Tag::Long);
+  REQUIRE(CP->getTag(3) == ConstantPoolRecords::Tag::Unusable);
+
+  // Numeric constants share common base.
+  REQUIRE(CP->isA<NumericConstant>(2));
+  REQUIRE(CP->isA<NumericConstant>(4));
+  REQUIRE_FALSE(CP->isA<NumericConstant>(1));
+  REQUIRE_FALSE(CP->isA<NumericConstant>(3));
+  REQUIRE(CP->getAs<NumericConstant>(2).getType() == Types::Long);
+  REQUIRE(CP->getAs<NumericConstant>(4).getValue() ==
+          Runtime::Value::create<Runtime::JavaInt>(7));
+
+  // Out of range indexes are never of any type.
+  REQUIRE_FALSE(CP->isA<Utf8>(0));
+  REQUIRE_FALSE(CP->isA<Utf8>(5));
+
+  for (ConstantPool::IndexType Idx = 1; Idx <= CP->numRecords(); ++Idx)
+    REQUIRE(CP->indexOf(CP->get(Idx)) == Idx);
+}
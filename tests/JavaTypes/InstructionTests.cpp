@@ -7,6 +7,8 @@
 #include "Bytecode/Bytecode.h"
 #include "Bytecode/Instructions.h"
 
+#include <sstream>
+
 using namespace Bytecode;
 
 TEST_CASE("Common instruction interface", "[Bytecode]") {
@@ -15,46 +17,46 @@ TEST_CASE("Common instruction interface", "[Bytecode]") {
        0xb7, 0x00, 0x01, // invokespecial #1
        0xb1 };           // return
   auto It = Bytes.begin();
-  std::unique_ptr<Instruction> Aload = parseInstruction(Bytes, It);
-  std::unique_ptr<Instruction> Invoke = parseInstruction(Bytes, It);
-  std::unique_ptr<Instruction> Ret = parseInstruction(Bytes, It);
+  Instruction Aload = parseInstruction(Bytes, It);
+  Instruction Invoke = parseInstruction(Bytes, It);
+  Instruction Ret = parseInstruction(Bytes, It);
   REQUIRE(It == Bytes.end());
 
   SECTION("isA") {
-    REQUIRE(Aload->isA<aload_0>());
-    REQUIRE(Invoke->isA<invokespecial>());
-    REQUIRE(Ret->isA<java_return>());
+    REQUIRE(Aload.isA<aload_0>());
+    REQUIRE(Invoke.isA<invokespecial>());
+    REQUIRE(Ret.isA<java_return>());
 
-    REQUIRE_FALSE(Aload->isA<invokespecial>());
-    REQUIRE_FALSE(Aload->isA<java_return>());
+    REQUIRE_FALSE(Aload.isA<invokespecial>());
+    REQUIRE_FALSE(Aload.isA<java_return>());
   }
 
   SECTION("getAs") {
-    REQUIRE_NOTHROW(Aload->getAs<aload_0>());
+    REQUIRE_NOTHROW(Aload.getAs<aload_0>());
     REQUIRE_THROWS_AS(
-        Aload->getAs<invokespecial>(),
+        Aload.getAs<invokespecial>(),
         UnexpectedBytecodeOperation);
   }
 
   SECTION("getAsOtNull") {
-    REQUIRE(Aload->getAsOrNull<aload_0>() != nullptr);
-    REQUIRE(Aload->getAsOrNull<invokespecial>() == nullptr);
+    REQUIRE(Aload.getAsOrNull<aload_0>().has_value());
+    REQUIRE_FALSE(Aload.getAsOrNull<invokespecial>().has_value());
   }
 
   SECTION("bci") {
-    REQUIRE(Aload->getLength() == 1);
-    REQUIRE(Invoke->getLength() == 3);
-    REQUIRE(Ret->getLength() == 1);
+    REQUIRE(Aload.getLength() == 1);
+    REQUIRE(Invoke.getLength() == 3);
+    REQUIRE(Ret.getLength() == 1);
   }
 }
 
 TEST_CASE("Plain create", "[Bytecode]") {
   auto Instr = Instruction::create<aload_0>();
-  REQUIRE(Instr->isA<aload_0>());
+  REQUIRE(Instr.isA<aload_0>());
 
   auto Instr2 = Instruction::create<invokespecial>(5);
-  REQUIRE(Instr2->isA<invokespecial>());
-  REQUIRE(Instr2->getAs<invokespecial>().getIdx() == 5);
+  REQUIRE(Instr2.isA<invokespecial>());
+  REQUIRE(Instr2.getAs<invokespecial>().getIdx() == 5);
 }
 
 TEST_CASE("Undefined bytecode", "[Bytecode]") {
@@ -71,18 +73,72 @@ TEST_CASE("Empty bytecode", "[Bytecode]") {
 
 TEST_CASE("Parse from string") {
   auto aload0 = parseFromString("aload_0");
-  REQUIRE(aload0);
-  REQUIRE(aload0->isA<aload_0>());
+  REQUIRE(aload0.isA<aload_0>());
 
   auto aloadInst = parseFromString("aload", 1);
-  REQUIRE(aloadInst);
-  REQUIRE(aloadInst->isA<aload>());
-  REQUIRE(aloadInst->getAs<aload>().getIdx() == 1);
+  REQUIRE(aloadInst.isA<aload>());
+  REQUIRE(aloadInst.getAs<aload>().getIdx() == 1);
 
   auto invoke = parseFromString("invokespecial", 1);
-  REQUIRE(invoke);
-  REQUIRE(invoke->isA<invokespecial>());
-  REQUIRE(invoke->getAs<invokespecial>().getIdx() == 1);
+  REQUIRE(invoke.isA<invokespecial>());
+  REQUIRE(invoke.getAs<invokespecial>().getIdx() == 1);
+
+  auto ret = parseFromString("return");
+  REQUIRE(ret.isA<java_return>());
+
+  REQUIRE_THROWS_AS(parseFromString("no_such_op"), UnknownBytecode);
+  REQUIRE_THROWS_AS(parseFromString(""), UnknownBytecode);
+  REQUIRE_THROWS_AS(parseFromString("aload_"), UnknownBytecode);
+}
+
+TEST_CASE("Opcode metadata", "[Bytecode]") {
+  static_assert(getOpcodeInfo(OpCodes::invokespecial).Length == 3);
+  static_assert(lookupOpcode("goto") == java_goto::OpCode);
+  static_assert(!lookupOpcode("nop").has_value());
+
+  // Every known opcode can be found by it's name
+  for (unsigned Op = 0; Op < OpcodeTable.size(); ++Op) {
+    const auto &Info = getOpcodeInfo(static_cast<uint8_t>(Op));
+    if (!Info.isValid())
+      continue;
+    REQUIRE(lookupOpcode(Info.Name) == Op);
+  }
+
+  REQUIRE(getOpcodeInfo(iload::OpCode).Operand == OperandKind::Local);
+  REQUIRE(getOpcodeInfo(iinc::OpCode).Operand == OperandKind::LocalAndConst);
+  REQUIRE(getOpcodeInfo(iadd::OpCode).Pops == 2);
+  REQUIRE(getOpcodeInfo(iadd::OpCode).Pushes == 1);
+  REQUIRE(getOpcodeInfo(invokestatic::OpCode).Pops == VarStack);
+
+  REQUIRE(getOpcodeInfo(if_icmpeq::OpCode).isBranch());
+  REQUIRE(getOpcodeInfo(if_icmpeq::OpCode).isConditional());
+  REQUIRE_FALSE(getOpcodeInfo(if_icmpeq::OpCode).endsBlock());
+  REQUIRE(getOpcodeInfo(java_goto::OpCode).endsBlock());
+  REQUIRE(getOpcodeInfo(ireturn::OpCode).endsBlock());
+  REQUIRE_FALSE(getOpcodeInfo(iadd::OpCode).isBranch());
+}
+
+TEST_CASE("Instruction operands", "[Bytecode]") {
+  const std::vector<uint8_t> Bytes =
+      {0x84, 0x02, 0xff, // iinc #2 #-1
+       0xa7, 0xff, 0xfd, // goto -3
+       0x10, 0x05 };     // bipush 5
+  auto Insts = parseInstructions(Bytes);
+  REQUIRE(Insts.size() == 3);
+
+  REQUIRE(Insts[0].getAs<iinc>().getIdx() == 2);
+  REQUIRE(Insts[0].getAs<iinc>().getConst() == -1);
+  REQUIRE(Insts[1].getAs<java_goto>().getIdx() == -3);
+  REQUIRE(Insts[2].getAs<bipush>().getIdx() == 5);
+  REQUIRE(Insts[2].getLength() == 2);
+
+  // Instructions created directly are identical to the parsed ones
+  auto Inc = Instruction::create<iinc>(0x02ff);
+  REQUIRE(Inc.getAs<iinc>().getConst() == -1);
+
+  std::ostringstream Out;
+  Insts[0].print(Out);
+  REQUIRE(Out.str() == "iinc #2 #-1\n");
 }
 
 TEST_CASE("iconst value wrapper", "[Bytecode]") {
@@ -90,8 +146,8 @@ TEST_CASE("iconst value wrapper", "[Bytecode]") {
   auto iconst1 = parseFromString("iconst_1");
 
   // Implicit conversions are supported.
-  iconst_val wrapper0 = iconst0->getAs<iconst_0>();
-  iconst_val wrapper1 = iconst1->getAs<iconst_1>();
+  iconst_val wrapper0 = iconst0.getAs<iconst_0>();
+  iconst_val wrapper1 = iconst1.getAs<iconst_1>();
 
   REQUIRE(wrapper0.getVal() == 0);
   REQUIRE(wrapper1.getVal() == 1);
@@ -101,3 +157,40 @@ TEST_CASE("iconst value wrapper", "[Bytecode]") {
 //  iconst_val wrapper = dconst1->getAs<dconst_1>();
 //  (void)wrapper;
 }
+
+TEST_CASE("Decode long methods", "[Bytecode]") {
+  // Mix of one byte runs and wide instructions which cross vector boundaries
+  std::vector<uint8_t> Bytes;
+  for (int Rep = 0; Rep < 50; ++Rep) {
+    for (int Idx = 0; Idx < Rep % 23; ++Idx)
+      Bytes.push_back(iadd::OpCode);
+    Bytes.insert(Bytes.end(), {iinc::OpCode, 0x01, 0x60});
+    Bytes.insert(Bytes.end(), {bipush::OpCode, 0xb7}); // operand is an opcode
+    Bytes.push_back(dup::OpCode);
+    Bytes.insert(Bytes.end(), {invokestatic::OpCode, 0x2a, 0x2a});
+  }
+
+  // Reference result from the one by one parsing
+  std::vector<uint8_t> Expected;
+  for (auto It = Bytes.cbegin(); It != Bytes.cend();)
+    Expected.push_back(parseInstruction(Bytes, It).getOpCode());
+
+  const auto Insts = parseInstructions(Bytes);
+  std::vector<uint8_t> Actual;
+  for (const auto &Inst: Insts)
+    Actual.push_back(Inst.getOpCode());
+  REQUIRE(Actual == Expected);
+
+  SECTION("Unknown opcode in the middle") {
+    std::size_t Offset = 0;
+    for (std::size_t Idx = 0; Idx < Insts.size() / 2; ++Idx)
+      Offset += Insts[Idx].getLength();
+    Bytes[Offset] = 0x00;
+    REQUIRE_THROWS_AS(parseInstructions(Bytes), UnknownBytecode);
+  }
+
+  SECTION("Truncated last instruction") {
+    Bytes.pop_back();
+    REQUIRE_THROWS_AS(parseInstructions(Bytes), BytecodeParsingError);
+  }
+}
@@ -77,6 +77,6 @@ TEST_CASE("Basic bytecode visitor", "[Bytecode][Visitor]") {
 
   TestVisitor V;
   for (const auto &I: Insts) {
-    I->accept(V);
+    I.accept(V);
   }
 }
@@ -192,6 +192,16 @@ TEST_CASE("Parse method descriptor", "[Verifier][StackFrame]") {
     REQUIRE(RetT == Types::Void);
   }
 
+  {
+    // Allocation free version appends to the buffer
+    Type::ArgumentTypes Args;
+    Args.push_back(Types::Top);
+    RetT = Type::parseMethodDescriptor("(J[I)D", Args);
+    REQUIRE(RetT == Types::Double);
+    REQUIRE(std::vector<Type>(Args.begin(), Args.end()) ==
+            std::vector<Type>{Types::Top, Types::Long, Types::Array});
+  }
+
   REQUIRE_THROWS_AS(
       Type::parseMethodDescriptor("wrong descriptor"),
       Type::ParsingError);
@@ -276,3 +286,35 @@ TEST_CASE("Stack frame transformInto", "[Verifier][StackFrame]") {
   REQUIRE(!t10.transformInto(t9));
   REQUIRE(t9.transformInto(t10));
 }
+
+TEST_CASE("Wide frame assignability", "[Verifier][StackFrame]") {
+  // Enough slots to go through the vectorized comparison with a tail
+  const std::vector<Type> Base = {
+      Types::Int, Types::Class, Types::Float, Types::Long, Types::Int,
+      Types::Array, Types::Int, Types::UninitializedOffset(3), Types::Int};
+
+  const StackFrame From(Base, Base);
+  REQUIRE(From == StackFrame(Base, Base));
+  REQUIRE(StackFrame::isAssignable(From, From));
+
+  // Only the last slots differ
+  auto Super = Base;
+  Super.back() = Types::OneWord;
+  Super[5] = Types::Reference;
+  REQUIRE(From != StackFrame(Super, Super));
+  REQUIRE(StackFrame::isAssignable(From, StackFrame(Super, Super)));
+  REQUIRE(!StackFrame::isAssignable(StackFrame(Super, Super), From));
+
+  // Wildcards are equal to any parameter
+  auto Wildcard = Base;
+  Wildcard[7] = Types::UninitializedOffset();
+  REQUIRE(From == StackFrame(Wildcard, Wildcard));
+
+  auto Other = Base;
+  Other[7] = Types::UninitializedOffset(4);
+  REQUIRE(!StackFrame::isAssignable(From, StackFrame(Other, Other)));
+
+  // Missing locals are Top
+  REQUIRE(StackFrame::isAssignable(From, StackFrame({}, Base)));
+  REQUIRE(!StackFrame::isAssignable(StackFrame({}, Base), From));
+}
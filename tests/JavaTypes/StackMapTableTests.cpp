@@ -44,3 +44,116 @@ TEST_CASE("Basic stack map table construction", "[StackMapTable]") {
   REQUIRE(f3 == f2);
   REQUIRE(f4 == StackFrame({Types::Long}, {Types::Double, Types::Int}));
 }
+
+TEST_CASE("Stack map cursor", "[StackMapTable]") {
+  StackMapTableBuilder Builder;
+
+  Builder.addAppend(2, {Types::Int});
+  Builder.addFull(5, {Types::Long}, {Types::Int});
+  Builder.addSame(7);
+  Builder.addAppend(9, {Types::Int});
+
+  const std::vector<Type> LocalTypes{Types::Class};
+  const StackMapTable Table = Builder.createTable(LocalTypes);
+
+  SECTION("Walk in order") {
+    StackMapCursor Cursor(Builder, LocalTypes);
+    for (const auto &Frame: Table) {
+      REQUIRE(!Cursor.atEnd());
+      REQUIRE(Cursor.getFrame() == Frame);
+      Cursor.advance();
+    }
+    REQUIRE(Cursor.atEnd());
+
+    // Frames are still reachable after the walk
+    REQUIRE(*Cursor.findAtBci(2) == *Table.findAtBci(2));
+  }
+
+  SECTION("Random access") {
+    StackMapCursor Cursor(Builder, LocalTypes);
+    Cursor.advance();
+    Cursor.advance();
+    REQUIRE(Cursor.getBci() == 7);
+
+    // Backward, current and forward frames
+    for (Bytecode::BciType Bci: {2u, 5u, 7u, 9u, 2u}) {
+      const auto *Frame = Cursor.findAtBci(Bci);
+      REQUIRE(Frame != nullptr);
+      REQUIRE(*Frame == *Table.findAtBci(Bci));
+    }
+    REQUIRE(*Cursor.findAtBci(9) ==
+            StackFrame({Types::Long, Types::Int}, {}));
+
+    REQUIRE(Cursor.findAtBci(3) == nullptr);
+    REQUIRE(Cursor.findAtBci(10) == nullptr);
+
+    // Lookups don't move the cursor
+    REQUIRE(Cursor.getBci() == 7);
+    REQUIRE(Cursor.getFrame() == StackFrame({Types::Long}, {Types::Int}));
+  }
+
+  SECTION("Empty table") {
+    const StackMapTableBuilder EmptyBuilder;
+    StackMapCursor Cursor(EmptyBuilder, LocalTypes);
+    REQUIRE(Cursor.atEnd());
+    REQUIRE(Cursor.findAtBci(0) == nullptr);
+  }
+}
+
+TEST_CASE("Chop and same locals one stack frames", "[StackMapTable]") {
+  StackMapTableBuilder Builder;
+
+  Builder.addAppend(2, {Types::Int, Types::Double});
+  // Two word local is removed as a single one
+  Builder.addChop(5, 2);
+  Builder.addSameLocalsOneStack(9, Types::Float);
+  Builder.addAppend(12, {Types::Int});
+
+  const auto LocalTypes =
+      std::get<1>(Type::parseMethodDescriptor("(J)V"));
+  StackMapTable Table = Builder.createTable(LocalTypes);
+
+  REQUIRE(*Table.findAtBci(5) == StackFrame({Types::Long}, {}));
+  REQUIRE(*Table.findAtBci(9) == StackFrame({Types::Long}, {Types::Float}));
+  REQUIRE(*Table.findAtBci(12) ==
+          StackFrame({Types::Long, Types::Int}, {}));
+}
+
+TEST_CASE("Stack map cursor backward lookups", "[StackMapTable]") {
+  // Long table without full frames, like the ones produced by javac. It has
+  // more checkpoints than the cursor keeps.
+  StackMapTableBuilder Builder;
+  const std::size_t NumFrames =
+      (StackMapCursor::NumCheckpoints + 2) *
+      StackMapCursor::CheckpointInterval + 7;
+  for (std::size_t Idx = 0; Idx < NumFrames; ++Idx) {
+    const auto Bci = static_cast<Bytecode::BciType>(Idx * 2);
+    switch (Idx % 4) {
+    case 0: Builder.addAppend(Bci, {Types::Int}); break;
+    case 1: Builder.addSameLocalsOneStack(Bci, Types::Float); break;
+    case 2: Builder.addAppend(Bci, {Types::Long}); break;
+    case 3: Builder.addChop(Bci, 1); break;
+    }
+  }
+
+  const auto LocalTypes = std::get<1>(Type::parseMethodDescriptor("(J)V"));
+  const StackMapTable Table = Builder.createTable(LocalTypes);
+
+  // Every frame branches back to some earlier ones, including repeated and
+  // not yet reached targets.
+  StackMapCursor Cursor(Builder, LocalTypes);
+  for (std::size_t Idx = 0; !Cursor.atEnd(); ++Idx, Cursor.advance()) {
+    for (std::size_t TargetIdx: {Idx / 2, Idx / 2, Idx - Idx % 3, Idx + 5}) {
+      const auto Bci = static_cast<Bytecode::BciType>(TargetIdx * 2);
+      const auto *Frame = Cursor.findAtBci(Bci);
+      if (TargetIdx >= NumFrames) {
+        REQUIRE(Frame == nullptr);
+        continue;
+      }
+      REQUIRE(Frame != nullptr);
+      REQUIRE(*Frame == *Table.findAtBci(Bci));
+    }
+    REQUIRE(Cursor.getFrame() ==
+            *Table.findAtBci(static_cast<Bytecode::BciType>(Idx * 2)));
+  }
+}
@@ -7,7 +7,12 @@
 #include "Runtime/ClassManager.h"
 #include "Runtime/Objects.h"
 #include "Verifier/Verifier.h"
+#include "SlowInterpreter/SlowInterpreter.h"
+#include "JavaTypes/JavaMethod.h"
 #include "JavaTypes/JavaClass.h"
+#include "Utils/ThreadPool.h"
+
+#include <fstream>
 
 using namespace Runtime;
 
@@ -78,6 +83,44 @@ TEST_CASE("Class manager verification failure", "[Runtime][ClassManager]") {
   REQUIRE_THROWS_AS(CM.getClassObject(C), Verifier::VerificationError);
 }
 
+TEST_CASE("Class manager lazy verification", "[Runtime][ClassManager]") {
+  ClassManager CM;
+  CM.setLazyVerification(true);
+
+  // Class has both correct and incorrect methods, but it's not verified
+  // during the initialization
+  const auto &C = CM.getClass("tests/Verifier/get_put_static", getTestLoader());
+  REQUIRE_NOTHROW(CM.getClassObject(C));
+
+  const auto *Ok = C.getMethod("ok");
+  const auto *Wrong = C.getMethod("wrong_type");
+  REQUIRE(Ok);
+  REQUIRE(Wrong);
+  REQUIRE(!Ok->isVerified());
+
+  REQUIRE(SlowInterpreter::interpret(*Ok, {}, CM).getAs<JavaInt>() == 0);
+  REQUIRE(Ok->isVerified());
+
+  // Error is reported at the call site each time
+  REQUIRE_THROWS_AS(
+      SlowInterpreter::interpret(*Wrong, {}, CM), Verifier::VerificationError);
+  REQUIRE_THROWS_AS(
+      SlowInterpreter::interpret(*Wrong, {}, CM), Verifier::VerificationError);
+  REQUIRE(!Wrong->isVerified());
+}
+
+TEST_CASE("Class manager eager verification", "[Runtime][ClassManager]") {
+  ClassManager CM;
+
+  // Calls don't need to consult the class once it was verified
+  const auto &C = CM.getClass("examples/Branches", getBootstrapLoader());
+  for (const auto &Method: C.methods())
+    REQUIRE(!Method->isVerified());
+  CM.getClassObject(C);
+  for (const auto &Method: C.methods())
+    REQUIRE(Method->isVerified());
+}
+
 TEST_CASE("Class manager correct preparation", "[Runtime][ClassManager]") {
   ClassManager CM;
   const auto &C = CM.getClass("tests/SlowInterpreter/get_put_static", getTestLoader());
@@ -87,6 +130,18 @@ TEST_CASE("Class manager correct preparation", "[Runtime][ClassManager]") {
   REQUIRE(O.getField("F2").getAs<JavaDouble>() == 0);
 }
 
+TEST_CASE("Class manager preparation of constant fields", "[Runtime][ClassManager]") {
+  ClassManager CM;
+  const auto &C = CM.getClass("tests/SlowInterpreter/ldc", getTestLoader());
+  const auto &O = CM.getClassObject(C);
+
+  REQUIRE(O.getField("I").getAs<JavaInt>() == 42);
+  REQUIRE(O.getField("D").getAs<JavaDouble>() == 1.5);
+  REQUIRE(O.getField("L").getAs<JavaLong>() == -3000000000L);
+  REQUIRE(O.getField("F").getAs<JavaFloat>() == 2.5f);
+  REQUIRE(O.getField("NotFinal").getAs<JavaInt>() == -5);
+}
+
 TEST_CASE("Class manager correct initialization", "[Runtime][ClassManager]") {
   ClassManager CM;
   const auto &C = CM.getClass("examples/Branches", getBootstrapLoader());
@@ -96,3 +151,123 @@ TEST_CASE("Class manager correct initialization", "[Runtime][ClassManager]") {
   REQUIRE(O.getField("b").getAs<JavaInt>() == 2);
   REQUIRE(O.getField("c").getAs<JavaInt>() == 3);
 }
+
+TEST_CASE("Class manager initialization failure", "[Runtime][ClassManager]") {
+  ClassManager CM;
+  const auto &C = CM.getClass("tests/Runtime/init_error", getTestLoader());
+
+  // First attempt reports the original error, class is unusable after that
+  REQUIRE_THROWS_AS(CM.getClassObject(C), IllegalMonitorStateException);
+  REQUIRE_THROWS_AS(CM.getClassObject(C), NoClassDefFoundError);
+}
+
+TEST_CASE("Class manager parallel initialization", "[Runtime][ClassManager]") {
+  ClassManager CM;
+  Utils::ThreadPool Pool(4);
+
+  std::vector<const JavaTypes::JavaClass*> Classes;
+  for (const auto *Name: {
+      "tests/Runtime/init_a", "tests/Runtime/init_b",
+      "tests/Runtime/init_cycle_c", "tests/Runtime/init_cycle_d",
+      "tests/Runtime/threads"})
+    Classes.push_back(&CM.getClass(Name, getTestLoader()));
+
+  CM.initializeClasses(Classes, Pool);
+
+  // Dependency is initialized first
+  REQUIRE(CM.getClassObject(*Classes[0]).getField("Y").getAs<JavaInt>() == 42);
+  REQUIRE(CM.getClassObject(*Classes[1]).getField("X").getAs<JavaInt>() == 41);
+
+  // Cycle is initialized in the list order: C starts first and observes D
+  // already initialized by the recursive request.
+  REQUIRE(CM.getClassObject(*Classes[2]).getField("X").getAs<JavaInt>() == 2);
+  REQUIRE(CM.getClassObject(*Classes[3]).getField("X").getAs<JavaInt>() == 1);
+
+  REQUIRE(CM.getClassObject(*Classes[4]).getField("Inits").getAs<JavaInt>() == 1);
+
+  // Errors are reported after all classes are processed
+  ClassManager CM1;
+  const auto &Bad = CM1.getClass("tests/Runtime/init_error", getTestLoader());
+  const auto &Good = CM1.getClass("tests/Runtime/init_b", getTestLoader());
+  REQUIRE_THROWS_AS(
+      CM1.initializeClasses({&Bad, &Good}, Pool), IllegalMonitorStateException);
+  REQUIRE(CM1.getClassObject(Good).getField("X").getAs<JavaInt>() == 41);
+
+  // Error of the first class in the list is reported independent of the
+  // scheduling
+  for (int Iter = 0; Iter < 10; ++Iter) {
+    ClassManager CM2;
+    const auto &Unverifiable =
+        CM2.getClass("tests/Verifier/to_many_locals", getTestLoader());
+    const auto &Failing =
+        CM2.getClass("tests/Runtime/init_error", getTestLoader());
+    REQUIRE_THROWS_AS(
+        CM2.initializeClasses({&Failing, &Unverifiable}, Pool),
+        IllegalMonitorStateException);
+
+    ClassManager CM3;
+    const auto &Unverifiable3 =
+        CM3.getClass("tests/Verifier/to_many_locals", getTestLoader());
+    const auto &Failing3 =
+        CM3.getClass("tests/Runtime/init_error", getTestLoader());
+    REQUIRE_THROWS_AS(
+        CM3.initializeClasses({&Unverifiable3, &Failing3}, Pool),
+        Verifier::VerificationError);
+  }
+}
+
+TEST_CASE("Class manager parallel initialization of hidden cycles",
+          "[Runtime][ClassManager]") {
+  Utils::ThreadPool Pool(4);
+
+  // Classes depend on each other through a class outside of the list, so
+  // they are initialized concurrently and end up waiting for each other.
+  // One of them proceeds as if it was a recursive request.
+  for (int Iter = 0; Iter < 5; ++Iter) {
+    ClassManager CM;
+    const auto &E = CM.getClass("tests/Runtime/init_wait_e", getTestLoader());
+    const auto &F = CM.getClass("tests/Runtime/init_wait_f", getTestLoader());
+    CM.initializeClasses({&E, &F}, Pool);
+
+    const auto EX = CM.getClassObject(E).getField("X").getAs<JavaInt>();
+    const auto FX = CM.getClassObject(F).getField("X").getAs<JavaInt>();
+    REQUIRE(((EX == 1 && FX == 2) || (EX == 2 && FX == 1)));
+  }
+}
+
+TEST_CASE("Class manager parallel loading", "[Runtime][ClassManager]") {
+  ClassManager CM;
+  Utils::ThreadPool Pool(4);
+
+  // Already loaded classes are reused
+  const auto &Threads = CM.getClass("tests/Runtime/threads", getTestLoader());
+
+  const std::vector<Utf8String> Names = {
+      "tests/Runtime/init_a", "tests/Runtime/init_b",
+      "tests/Runtime/threads", "tests/Runtime/init_a",
+      "tests/Runtime/init_cycle_c"};
+  const auto Classes = CM.loadClasses(Names, getTestLoader(), Pool);
+
+  // Results are in the order of the names
+  REQUIRE(Classes.size() == Names.size());
+  REQUIRE(Classes[0]->getClassName() == "tests/Runtime/InitA");
+  REQUIRE(Classes[1]->getClassName() == "tests/Runtime/InitB");
+  REQUIRE(Classes[2] == &Threads);
+  REQUIRE(Classes[3] == Classes[0]);
+  REQUIRE(Classes[4]->getClassName() == "tests/Runtime/CycleC");
+
+  // Loaded classes are visible by both names
+  REQUIRE(&CM.getClass("tests/Runtime/init_b", getTestLoader()) == Classes[1]);
+  REQUIRE(&CM.getClass("tests/Runtime/InitB", getTestLoader()) == Classes[1]);
+  REQUIRE(CM.getClassObject(*Classes[1]).getField("X").getAs<JavaInt>() == 41);
+
+  // Nothing is defined if any of the classes fails
+  ClassManager CM1;
+  REQUIRE_THROWS_AS(
+      CM1.loadClasses(
+          {"tests/Runtime/init_b", "tests/Runtime/missing"},
+          getTestLoader(), Pool),
+      ClassNotFoundException);
+  std::ifstream Bytes("tests/Runtime/init_b.cd");
+  REQUIRE_NOTHROW(CM1.defineClass("tests/Runtime/init_b", Bytes, getTestLoader()));
+}
@@ -0,0 +1,114 @@
+///
+/// Tests for the class path
+///
+
+#include "catch.hpp"
+
+#include "Utils/TestUtils.h"
+#include "Runtime/ClassPath.h"
+#include "Runtime/ClassManager.h"
+#include "JavaTypes/JavaClass.h"
+#include "SlowInterpreter/SlowInterpreter.h"
+#include "Utils/BinaryFiles.h"
+
+#include <fstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Runtime;
+
+static std::string readWholeFile(const std::string &Name) {
+  Utils::MappedFile File(Name);
+  return std::string(reinterpret_cast<const char*>(File.data()), File.size());
+}
+
+TEST_CASE("Class path directories", "[Runtime][ClassPath]") {
+  ClassPath CP;
+  CP.addDirectory("examples");
+
+  REQUIRE(CP.numClasses() == 5);
+  REQUIRE(CP.contains("Simple"));
+  REQUIRE_FALSE(CP.contains("Simple.java"));
+  REQUIRE_FALSE(CP.read("java/lang/Missing"));
+
+  REQUIRE(*CP.read("Loop") == readWholeFile("examples/Loop.class"));
+
+  // Nested directories are indexed with their package names
+  ClassPath Nested;
+  Nested.addDirectory(".");
+  REQUIRE(Nested.contains("examples/Simple"));
+
+  REQUIRE_THROWS_AS(CP.addDirectory("wrong dir"), ClassPathError);
+}
+
+TEST_CASE("Class path directory cycles", "[Runtime][ClassPath]") {
+  TestUtils::TempDir Dir;
+  const std::string &Root = Dir.path();
+
+  // Root/pkg/Simple.class and Root/pkg/loop -> Root
+  const std::string Pkg = Root + "/pkg";
+  REQUIRE(mkdir(Pkg.c_str(), 0755) == 0);
+  {
+    std::ofstream Out(Pkg + "/Simple.class", std::ios_base::binary);
+    Out << readWholeFile("examples/Simple.class");
+  }
+  REQUIRE(symlink(Root.c_str(), (Pkg + "/loop").c_str()) == 0);
+
+  ClassPath CP;
+  CP.addDirectory(Root);
+  REQUIRE(CP.numClasses() == 1);
+  REQUIRE(CP.contains("pkg/Simple"));
+}
+
+TEST_CASE("Class path archives", "[Runtime][ClassPath]") {
+  ClassPath CP("tests/Runtime/classpath.jar");
+
+  // Manifest is not a class
+  REQUIRE(CP.numClasses() == 2);
+
+  // Deflated and stored entries
+  REQUIRE(*CP.read("Simple") == readWholeFile("examples/Simple.class"));
+  REQUIRE(*CP.read("Loop") == readWholeFile("examples/Loop.class"));
+  REQUIRE_FALSE(CP.read("Fields"));
+
+  REQUIRE_THROWS_AS(ClassPath("examples/Simple.java"), ClassPathError);
+  REQUIRE_THROWS_AS(ClassPath("missing.jar"), ClassPathError);
+
+  // Uncompressed size from the central directory is not trusted. Last
+  // occurrence of the name is in the central directory header, which starts
+  // 46 bytes before it.
+  auto Bytes = readWholeFile("tests/Runtime/classpath.jar");
+  const auto Header = Bytes.rfind("Simple.class") - 46;
+  for (std::size_t Idx = 0; Idx < 4; ++Idx)
+    Bytes[Header + 24 + Idx] = '\xf0';
+
+  TestUtils::TempDir Dir;
+  const std::string Malformed = Dir.path("malformed.jar");
+  {
+    std::ofstream Out(Malformed, std::ios_base::binary);
+    Out << Bytes;
+  }
+  ClassPath BadCP(Malformed);
+  REQUIRE_THROWS_AS(BadCP.read("Simple"), ClassPathError);
+}
+
+TEST_CASE("Class path order", "[Runtime][ClassPath]") {
+  // First entry wins, empty entries are ignored
+  ClassPath CP("tests/Runtime/classpath.jar::examples");
+  REQUIRE(CP.numClasses() == 5);
+  REQUIRE(*CP.read("Fields") == readWholeFile("examples/Fields.class"));
+}
+
+TEST_CASE("Class path loader", "[Runtime][ClassPath]") {
+  ClassPathLoader Loader("tests/Runtime/classpath.jar");
+  ClassManager CM;
+
+  const auto &Obj = CM.getClassObject("Loop", Loader);
+  const auto Ret =
+      SlowInterpreter::interpret(*Obj.getMethod("main"), {}, CM);
+  REQUIRE(Ret.getAs<JavaInt>() == 6);
+
+  REQUIRE_THROWS_AS(CM.getClass("Fields", Loader), ClassNotFoundException);
+}
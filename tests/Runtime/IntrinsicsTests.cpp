@@ -0,0 +1,109 @@
+///
+/// Tests for the intrinsic methods table
+///
+
+#include "catch.hpp"
+
+#include "Runtime/Intrinsics.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace Runtime;
+
+// Helper which finds intrinsic and calls it with the given arguments.
+static Value callIntrinsic(
+    const char *ClassName, const char *Name, const char *Descriptor,
+    std::vector<Value> Args) {
+  const auto *I = findIntrinsic(ClassName, Name, Descriptor);
+  REQUIRE(I != nullptr);
+  REQUIRE(I->NumArgs == Args.size());
+  return I->Fn(Args.data());
+}
+
+TEST_CASE("Intrinsics lookup", "[Runtime][Intrinsics]") {
+  REQUIRE(findIntrinsic("java/lang/Math", "abs", "(I)I"));
+  REQUIRE(findIntrinsic("java/lang/System", "nanoTime", "()J")->HasResult);
+
+  // Descriptor should match exactly
+  REQUIRE(!findIntrinsic("java/lang/Math", "abs", "(S)S"));
+  REQUIRE(!findIntrinsic("java/lang/Math", "sin", "(D)D"));
+  REQUIRE(!findIntrinsic("java/lang/StrictMath", "abs", "(I)I"));
+}
+
+TEST_CASE("Integer intrinsics", "[Runtime][Intrinsics]") {
+  const auto IntMin = std::numeric_limits<JavaInt>::min();
+  const auto LongMin = std::numeric_limits<JavaLong>::min();
+
+  REQUIRE(callIntrinsic("java/lang/Math", "abs", "(I)I",
+      {Value::create<JavaInt>(-5)}).getAs<JavaInt>() == 5);
+  REQUIRE(callIntrinsic("java/lang/Math", "abs", "(I)I",
+      {Value::create<JavaInt>(IntMin)}).getAs<JavaInt>() == IntMin);
+  REQUIRE(callIntrinsic("java/lang/Math", "abs", "(J)J",
+      {Value::create<JavaLong>(LongMin)}).getAs<JavaLong>() == LongMin);
+
+  REQUIRE(callIntrinsic("java/lang/Math", "min", "(JJ)J",
+      {Value::create<JavaLong>(-1), Value::create<JavaLong>(1)})
+          .getAs<JavaLong>() == -1);
+  REQUIRE(callIntrinsic("java/lang/Math", "max", "(II)I",
+      {Value::create<JavaInt>(-1), Value::create<JavaInt>(1)})
+          .getAs<JavaInt>() == 1);
+
+  REQUIRE(callIntrinsic("java/lang/Integer", "bitCount", "(I)I",
+      {Value::create<JavaInt>(-1)}).getAs<JavaInt>() == 32);
+  REQUIRE(callIntrinsic("java/lang/Long", "bitCount", "(J)I",
+      {Value::create<JavaLong>(-1)}).getAs<JavaInt>() == 64);
+
+  REQUIRE(callIntrinsic("java/lang/Integer", "numberOfLeadingZeros", "(I)I",
+      {Value::create<JavaInt>(1)}).getAs<JavaInt>() == 31);
+  REQUIRE(callIntrinsic("java/lang/Integer", "numberOfLeadingZeros", "(I)I",
+      {Value::create<JavaInt>(0)}).getAs<JavaInt>() == 32);
+  REQUIRE(callIntrinsic("java/lang/Long", "numberOfLeadingZeros", "(J)I",
+      {Value::create<JavaLong>(0)}).getAs<JavaInt>() == 64);
+  REQUIRE(callIntrinsic("java/lang/Long", "numberOfLeadingZeros", "(J)I",
+      {Value::create<JavaLong>(-1)}).getAs<JavaInt>() == 0);
+
+  REQUIRE(callIntrinsic("java/lang/Integer", "reverseBytes", "(I)I",
+      {Value::create<JavaInt>(0x01020304)}).getAs<JavaInt>() == 0x04030201);
+  REQUIRE(callIntrinsic("java/lang/Long", "reverseBytes", "(J)J",
+      {Value::create<JavaLong>(0xFF)}).getAs<JavaLong>() == LongMin >> 7);
+}
+
+TEST_CASE("Floating point intrinsics", "[Runtime][Intrinsics]") {
+  const auto NaN = std::numeric_limits<JavaDouble>::quiet_NaN();
+
+  REQUIRE(callIntrinsic("java/lang/Math", "abs", "(F)F",
+      {Value::create<JavaFloat>(-1.5f)}).getAs<JavaFloat>() == 1.5f);
+  REQUIRE(!std::signbit(callIntrinsic("java/lang/Math", "abs", "(D)D",
+      {Value::create<JavaDouble>(-0.0)}).getAs<JavaDouble>()));
+
+  // NaN propagates through min and max
+  REQUIRE(std::isnan(callIntrinsic("java/lang/Math", "min", "(DD)D",
+      {Value::create<JavaDouble>(1.0), Value::create<JavaDouble>(NaN)})
+          .getAs<JavaDouble>()));
+  REQUIRE(std::isnan(callIntrinsic("java/lang/Math", "max", "(DD)D",
+      {Value::create<JavaDouble>(NaN), Value::create<JavaDouble>(1.0)})
+          .getAs<JavaDouble>()));
+
+  // Negative zero is smaller than positive zero
+  REQUIRE(std::signbit(callIntrinsic("java/lang/Math", "min", "(DD)D",
+      {Value::create<JavaDouble>(0.0), Value::create<JavaDouble>(-0.0)})
+          .getAs<JavaDouble>()));
+  REQUIRE(!std::signbit(callIntrinsic("java/lang/Math", "max", "(FF)F",
+      {Value::create<JavaFloat>(-0.0f), Value::create<JavaFloat>(0.0f)})
+          .getAs<JavaFloat>()));
+
+  REQUIRE(callIntrinsic("java/lang/Math", "sqrt", "(D)D",
+      {Value::create<JavaDouble>(16.0)}).getAs<JavaDouble>() == 4.0);
+  REQUIRE(callIntrinsic("java/lang/Math", "fma", "(DDD)D",
+      {Value::create<JavaDouble>(2.0), Value::create<JavaDouble>(3.0),
+       Value::create<JavaDouble>(1.0)}).getAs<JavaDouble>() == 7.0);
+}
+
+TEST_CASE("System intrinsics", "[Runtime][Intrinsics]") {
+  const auto T1 =
+      callIntrinsic("java/lang/System", "nanoTime", "()J", {}).getAs<JavaLong>();
+  const auto T2 =
+      callIntrinsic("java/lang/System", "nanoTime", "()J", {}).getAs<JavaLong>();
+  REQUIRE(T1 <= T2);
+}
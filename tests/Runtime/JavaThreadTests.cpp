@@ -0,0 +1,47 @@
+///
+/// Tests for the java threads
+///
+
+#include "catch.hpp"
+
+#include "Runtime/JavaThread.h"
+#include "Runtime/ClassManager.h"
+#include "JavaTypes/JavaClass.h"
+#include "JavaTypes/JavaMethod.h"
+
+#include <memory>
+#include <vector>
+
+using namespace Runtime;
+
+TEST_CASE("Java threads", "[Runtime][JavaThread]") {
+  ClassManager CM;
+  const auto &Class = CM.getClass("tests/Runtime/threads", getTestLoader());
+  const auto *Run = Class.getMethod("run");
+  REQUIRE(Run != nullptr);
+
+  const int NumThreads = 8;
+  const int NumIters = 500;
+
+  // All threads race to initialize the class
+  std::vector<std::unique_ptr<JavaThread>> Threads;
+  for (int i = 0; i < NumThreads; ++i) {
+    Threads.push_back(std::make_unique<JavaThread>(
+        *Run, std::vector<Value>{Value::create<JavaInt>(NumIters)}, CM));
+  }
+  for (auto &T: Threads)
+    T->join();
+
+  const auto &Obj = CM.getClassObject(Class);
+  REQUIRE(Obj.getField("Inits").getAs<JavaInt>() == 1);
+  REQUIRE(Obj.getField("Counter").getAs<JavaInt>() == NumThreads * NumIters);
+}
+
+TEST_CASE("Java thread exceptions", "[Runtime][JavaThread]") {
+  ClassManager CM;
+  const auto &Class = CM.getClass("tests/Runtime/init_error", getTestLoader());
+
+  // Exception is rethrown on join
+  JavaThread T(*Class.getMethod("<clinit>"), {}, CM);
+  REQUIRE_THROWS_AS(T.join(), IllegalMonitorStateException);
+}
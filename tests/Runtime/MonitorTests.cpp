@@ -0,0 +1,101 @@
+///
+/// Tests for the object locking
+///
+
+#include "catch.hpp"
+
+#include "Runtime/Objects.h"
+
+#include <thread>
+#include <vector>
+
+using namespace Runtime;
+
+namespace {
+// Objects can't be created directly, this is the simplest one.
+class TestObject final: public Object { };
+}
+
+TEST_CASE("Thin locks", "[Runtime][Monitor]") {
+  TestObject Obj;
+  REQUIRE(!Obj.holdsLock());
+  REQUIRE_THROWS_AS(Obj.monitorExit(), IllegalMonitorStateException);
+  REQUIRE_THROWS_AS(Obj.notify(), IllegalMonitorStateException);
+
+  Obj.monitorEnter();
+  REQUIRE(Obj.holdsLock());
+
+  // Recursion doesn't inflate the lock
+  Obj.monitorEnter();
+  Obj.monitorEnter();
+  Obj.notifyAll();
+  Obj.monitorExit();
+  Obj.monitorExit();
+  REQUIRE(Obj.holdsLock());
+  REQUIRE(!Obj.isLockInflated());
+
+  Obj.monitorExit();
+  REQUIRE(!Obj.holdsLock());
+  REQUIRE(!Obj.isLockInflated());
+
+  // Deep recursion overflows the lock word
+  for (int i = 0; i < 1000; ++i)
+    Obj.monitorEnter();
+  REQUIRE(Obj.isLockInflated());
+  for (int i = 0; i < 1000; ++i)
+    Obj.monitorExit();
+  REQUIRE(!Obj.holdsLock());
+  REQUIRE_THROWS_AS(Obj.monitorExit(), IllegalMonitorStateException);
+}
+
+TEST_CASE("Contended locks", "[Runtime][Monitor]") {
+  TestObject Obj;
+
+  const int NumThreads = 4;
+  const int NumIters = 20000;
+  int Counter = 0;
+
+  std::vector<std::thread> Threads;
+  for (int t = 0; t < NumThreads; ++t) {
+    Threads.emplace_back([&]() {
+      for (int i = 0; i < NumIters; ++i) {
+        Obj.monitorEnter();
+        Obj.monitorEnter();
+        ++Counter;
+        Obj.monitorExit();
+        Obj.monitorExit();
+      }
+    });
+  }
+  for (auto &T: Threads)
+    T.join();
+
+  REQUIRE(Counter == NumThreads * NumIters);
+  REQUIRE(!Obj.holdsLock());
+}
+
+TEST_CASE("Wait and notify", "[Runtime][Monitor]") {
+  TestObject Obj;
+  bool Ready = false;
+  bool Done = false;
+
+  std::thread Consumer([&]() {
+    Obj.monitorEnter();
+    while (!Ready)
+      Obj.wait();
+    Done = true;
+    Obj.notifyAll();
+    Obj.monitorExit();
+  });
+
+  Obj.monitorEnter();
+  REQUIRE_THROWS_AS(TestObject().wait(), IllegalMonitorStateException);
+  Ready = true;
+  Obj.notify();
+  while (!Done)
+    Obj.wait();
+  Obj.monitorExit();
+
+  Consumer.join();
+  REQUIRE(Obj.isLockInflated());
+}
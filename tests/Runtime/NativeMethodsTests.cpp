@@ -0,0 +1,86 @@
+///
+/// Tests for the native method binding
+///
+
+#include "catch.hpp"
+
+#include "Runtime/NativeMethods.h"
+#include "Runtime/ClassManager.h"
+#include "JavaTypes/JavaClass.h"
+#include "JavaTypes/JavaMethod.h"
+
+using namespace Runtime;
+
+TEST_CASE("Native method name mangling", "[Runtime][NativeMethods]") {
+  REQUIRE(NativeLibraries::mangle("Native", "add", "(II)I", false) ==
+          "Java_Native_add");
+  REQUIRE(NativeLibraries::mangle("Native", "add", "(II)I", true) ==
+          "Java_Native_add__II");
+  REQUIRE(NativeLibraries::mangle("java/lang/Object", "hash_code", "()I", false) ==
+          "Java_java_lang_Object_hash_1code");
+  REQUIRE(NativeLibraries::mangle(
+      "p/Cls", "f", "([Ljava/lang/String;J)V", true) ==
+          "Java_p_Cls_f___3Ljava_lang_String_2J");
+  // Two byte modified UTF-8 sequence for U+00E9
+  REQUIRE(NativeLibraries::mangle("Caf\xC3\xA9", "f", "()V", false) ==
+          "Java_Caf_000e9_f");
+}
+
+TEST_CASE("Native method calls", "[Runtime][NativeMethods]") {
+  NativeLibraries Libs;
+  Libs.load(ICP_TEST_NATIVES_PATH);
+
+  SECTION("Primitives") {
+    auto Add = Libs.bind("Native", "add", "(II)I");
+    REQUIRE(Add.numArgs() == 2);
+    REQUIRE(Add.hasResult());
+    Value AddArgs[] = {Value::create<JavaInt>(-7), Value::create<JavaInt>(3)};
+    REQUIRE(Add.call(AddArgs).getAs<JavaInt>() == -4);
+
+    auto Mix = Libs.bind("Native", "mix", "(IDJF)D");
+    Value MixArgs[] = {
+        Value::create<JavaInt>(1), Value::create<JavaDouble>(0.5),
+        Value::create<JavaLong>(1LL << 40), Value::create<JavaFloat>(0.25f)};
+    REQUIRE(Mix.call(MixArgs).getAs<JavaDouble>() ==
+            1.75 + static_cast<double>(1LL << 40));
+  }
+
+  SECTION("Long name") {
+    auto Scale = Libs.bind("Native", "scale", "(F)F");
+    Value Args[] = {Value::create<JavaFloat>(1.5f)};
+    REQUIRE(Scale.call(Args).getAs<JavaFloat>() == 3.0f);
+  }
+
+  SECTION("References") {
+    auto IsNull = Libs.bind("Native", "isNull", "(Ljava/lang/Object;)Z");
+    Value NullArgs[] = {Value::create<JavaRef>(nullptr)};
+    REQUIRE(IsNull.call(NullArgs).getAs<JavaBool>() == 1);
+  }
+
+  SECTION("Errors") {
+    REQUIRE_THROWS_AS(
+        Libs.bind("Native", "absent", "()V"), UnsatisfiedLinkError);
+    REQUIRE_THROWS_AS(
+        Libs.bind("Native", "add", "()Ljava/lang/Object;"),
+        UnsatisfiedLinkError);
+    REQUIRE_THROWS_AS(
+        Libs.bind("Native", "add", "(IIIIIII)I"), UnsatisfiedLinkError);
+    REQUIRE_THROWS_AS(Libs.load("no_such_library.so"), UnsatisfiedLinkError);
+  }
+}
+
+TEST_CASE("Native methods linking", "[Runtime][NativeMethods]") {
+  ClassManager CM;
+  CM.loadNativeLibrary(ICP_TEST_NATIVES_PATH);
+
+  auto &Obj = CM.getClassObject(
+      "tests/SlowInterpreter/native", getTestLoader());
+  const auto *UnderScore = Obj.getMethod("under_score");
+  REQUIRE(UnderScore != nullptr);
+  REQUIRE(Obj.getNative(*UnderScore)->call(nullptr).getAs<JavaInt>() == 42);
+
+  // Missing symbols are reported during linking
+  REQUIRE_THROWS_AS(
+      CM.getClassObject("tests/SlowInterpreter/native_missing", getTestLoader()),
+      UnsatisfiedLinkError);
+}
@@ -0,0 +1,33 @@
+///
+/// Native methods used by the native method binding tests. Built as a
+/// separate shared library which is loaded at runtime.
+///
+
+#include <cstdint>
+
+extern "C" {
+
+int32_t Java_Native_add(int32_t A, int32_t B) {
+  return A + B;
+}
+
+// Integer and floating point arguments are interleaved
+double Java_Native_mix(int32_t A, double B, int64_t C, float D) {
+  return A + B + static_cast<double>(C) + D;
+}
+
+// Only long name is available
+float Java_Native_scale__F(float X) {
+  return X * 2.0f;
+}
+
+int32_t Java_Native_under_1score() {
+  return 42;
+}
+
+// References are passed as handles
+uint8_t Java_Native_isNull(void **Ref) {
+  return *Ref == nullptr;
+}
+
+}
@@ -0,0 +1,107 @@
+///
+/// Tests for the isolated VM instances
+///
+
+#include "catch.hpp"
+
+#include "Runtime/VM.h"
+#include "Runtime/SharedClassCache.h"
+#include "Runtime/JavaThread.h"
+#include "Runtime/Objects.h"
+#include "JavaTypes/JavaClass.h"
+#include "JavaTypes/JavaMethod.h"
+#include "SlowInterpreter/SlowInterpreter.h"
+
+#include <memory>
+#include <vector>
+
+using namespace Runtime;
+
+TEST_CASE("Shared classes", "[Runtime][VM]") {
+  auto Cache = std::make_shared<SharedClassCache>();
+
+  auto First = std::make_unique<VM>(Cache);
+  VM Second(Cache);
+
+  const auto &Class1 = First->getClassManager().getClass(
+      "tests/Runtime/threads", First->getTestLoader());
+  const auto &Class2 = Second.getClassManager().getClass(
+      "tests/Runtime/threads", Second.getTestLoader());
+
+  // Parsed once, but initialized separately
+  REQUIRE(&Class1 == &Class2);
+  REQUIRE(Cache->size() == 1);
+
+  auto &Obj1 = First->getClassManager().getClassObject(Class1);
+  auto &Obj2 = Second.getClassManager().getClassObject(Class2);
+  REQUIRE(&Obj1 != &Obj2);
+  REQUIRE(Obj1.getField("Inits").getAs<JavaInt>() == 1);
+  REQUIRE(Obj2.getField("Inits").getAs<JavaInt>() == 1);
+
+  // Statics are not shared
+  SlowInterpreter::interpret(
+      *Class1.getMethod("run"), {Value::create<JavaInt>(10)},
+      First->getClassManager());
+  SlowInterpreter::interpret(
+      *Class2.getMethod("run"), {Value::create<JavaInt>(3)},
+      Second.getClassManager());
+  REQUIRE(Obj1.getField("Counter").getAs<JavaInt>() == 10);
+  REQUIRE(Obj2.getField("Counter").getAs<JavaInt>() == 3);
+
+  // Class outlives the VM which linked it first
+  First.reset();
+  SlowInterpreter::interpret(
+      *Class2.getMethod("run"), {Value::create<JavaInt>(2)},
+      Second.getClassManager());
+  REQUIRE(Obj2.getField("Counter").getAs<JavaInt>() == 5);
+
+  // New VM is able to pick up the same class again
+  VM Third(Cache);
+  const auto &Class3 = Third.getClassManager().getClass(
+      "tests/Runtime/threads", Third.getTestLoader());
+  REQUIRE(&Class3 == &Class2);
+  REQUIRE(Third.getClassManager().getClassObject(Class3)
+              .getField("Counter").getAs<JavaInt>() == 0);
+}
+
+TEST_CASE("Separate heaps", "[Runtime][VM]") {
+  VM First, Second;
+
+  const auto &Class = First.getClassManager().getClass(
+      "tests/SlowInterpreter/new", First.getTestLoader());
+  SlowInterpreter::interpret(
+      *Class.getMethod("test1"), {}, First.getClassManager());
+  SlowInterpreter::interpret(
+      *Class.getMethod("test1"), {}, First.getClassManager());
+
+  REQUIRE(First.getHeap().numObjects() == 2);
+  REQUIRE(Second.getHeap().numObjects() == 0);
+}
+
+TEST_CASE("Concurrent VMs", "[Runtime][VM]") {
+  auto Cache = std::make_shared<SharedClassCache>();
+  const int NumVMs = 4;
+  const int NumIters = 200;
+
+  std::vector<std::unique_ptr<VM>> VMs;
+  std::vector<std::unique_ptr<JavaThread>> Threads;
+  for (int i = 0; i < NumVMs; ++i) {
+    VMs.push_back(std::make_unique<VM>(Cache));
+    auto &CM = VMs.back()->getClassManager();
+    const auto &Class =
+        CM.getClass("tests/Runtime/threads", VMs.back()->getTestLoader());
+    Threads.push_back(std::make_unique<JavaThread>(
+        *Class.getMethod("run"),
+        std::vector<Value>{Value::create<JavaInt>(NumIters)}, CM));
+  }
+  for (auto &T: Threads)
+    T->join();
+
+  REQUIRE(Cache->size() == 1);
+  for (auto &Instance: VMs) {
+    auto &CM = Instance->getClassManager();
+    const auto &Obj = CM.getClassObject(
+        CM.getClass("tests/Runtime/threads", Instance->getTestLoader()));
+    REQUIRE(Obj.getField("Counter").getAs<JavaInt>() == NumIters);
+  }
+}
@@ -0,0 +1,127 @@
+///
+/// Tests for the persistent verification cache
+///
+
+#include "catch.hpp"
+
+#include "Utils/TestUtils.h"
+
+#include "Runtime/VerificationCache.h"
+#include "Runtime/ClassManager.h"
+#include "Verifier/Verifier.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace Runtime;
+
+TEST_CASE("Verification cache persistence", "[Runtime][VerificationCache]") {
+  TestUtils::TempDir Dir;
+  const auto Path = Dir.path("cache");
+
+  const auto K1 = VerificationCache::computeKey("first class");
+  const auto K2 = VerificationCache::computeKey("second class");
+  REQUIRE(K1 != K2);
+  REQUIRE(K1 == VerificationCache::computeKey("first class"));
+
+  {
+    // Empty file is the same as no cache
+    std::ofstream(Path).close();
+    VerificationCache Cache(Path);
+    REQUIRE(Cache.size() == 0);
+    REQUIRE(!Cache.contains(K1));
+
+    Cache.insert(K1);
+    REQUIRE(Cache.contains(K1));
+    Cache.flush();
+  }
+
+  {
+    VerificationCache Cache(Path);
+    REQUIRE(Cache.contains(K1));
+    REQUIRE(!Cache.contains(K2));
+    Cache.insert(K2);
+    // Flushed by the destructor
+  }
+
+  VerificationCache Cache(Path);
+  REQUIRE(Cache.size() == 2);
+  REQUIRE(Cache.contains(K2));
+}
+
+TEST_CASE("Verification cache merges concurrent writers",
+          "[Runtime][VerificationCache]") {
+  TestUtils::TempDir Dir;
+  const auto Path = Dir.path("cache");
+
+  const auto K1 = VerificationCache::computeKey("first class");
+  const auto K2 = VerificationCache::computeKey("second class");
+
+  // Both caches read the file before any of them wrote to it
+  VerificationCache A(Path), B(Path);
+  A.insert(K1);
+  B.insert(K2);
+  A.flush();
+  B.flush();
+
+  // Writer sees what others have written
+  REQUIRE(B.contains(K1));
+  REQUIRE(VerificationCache(Path).size() == 2);
+}
+
+TEST_CASE("Verification cache ignores malformed files",
+          "[Runtime][VerificationCache]") {
+  TestUtils::TempDir Dir;
+  const auto Path = Dir.path("cache");
+  {
+    std::ofstream Out(Path, std::ios_base::binary | std::ios_base::trunc);
+    Out << "garbage";
+  }
+
+  VerificationCache Cache(Path);
+  REQUIRE(Cache.size() == 0);
+
+  // Malformed file is replaced
+  Cache.insert(VerificationCache::computeKey("class"));
+  Cache.flush();
+  REQUIRE(VerificationCache(Path).size() == 1);
+}
+
+TEST_CASE("Class manager uses verification cache",
+          "[Runtime][VerificationCache]") {
+  TestUtils::TempDir Dir;
+  const auto Path = Dir.path("cache");
+
+  {
+    VerificationCache Cache(Path);
+    ClassManager CM;
+    CM.setVerificationCache(&Cache);
+
+    CM.getClassObject("tests/SlowInterpreter/get_put_static", getTestLoader());
+    REQUIRE(Cache.size() == 1);
+
+    // Failures are not recorded
+    const auto &Bad = CM.getClass("tests/Verifier/to_many_locals", getTestLoader());
+    REQUIRE_THROWS_AS(CM.getClassObject(Bad), Verifier::VerificationError);
+    REQUIRE(Cache.size() == 1);
+  }
+
+  // Verification is skipped only for the classes from the cache. Class
+  // which would fail verification is accepted if it's bytes are recorded.
+  std::ifstream Input("tests/Verifier/to_many_locals.cd", std::ios_base::binary);
+  const std::string Bytes(
+      (std::istreambuf_iterator<char>(Input)), std::istreambuf_iterator<char>());
+  REQUIRE(!Bytes.empty());
+  {
+    VerificationCache Cache(Path);
+    Cache.insert(VerificationCache::computeKey(Bytes));
+  }
+
+  VerificationCache Cache(Path);
+  REQUIRE(Cache.size() == 2);
+  ClassManager CM;
+  CM.setVerificationCache(&Cache);
+  REQUIRE_NOTHROW(CM.getClassObject(
+      "tests/Verifier/to_many_locals", getTestLoader()));
+}
@@ -9,8 +9,12 @@
 #include "Runtime/Value.h"
 #include "Runtime/ClassManager.h"
 #include "CD/Parser.h"
+#include "Bytecode/Instructions.h"
 
 #include <iostream>
+#include <cmath>
+#include <limits>
+#include <thread>
 
 using namespace JavaTypes;
 using namespace SlowInterpreter;
@@ -148,3 +152,83 @@ TEST_CASE("interpret getputfield", "[SlowInterpreter][getputfield]") {
   REQUIRE(runAutoTest<Runtime::JavaInt>("getfield_putfield",
       {Value::create<JavaInt>(-5), Value::create<JavaInt>(5)}, 1));
 }
+
+TEST_CASE("interpret ldc", "[SlowInterpreter][ldc]") {
+  ClassManager CM;
+  const auto &Class = CM.getClass("tests/SlowInterpreter/ldc", getTestLoader());
+
+  REQUIRE(testWithMethod<JavaInt>(Class, "test1", {}, CM) == 42);
+  REQUIRE(testWithMethod<JavaDouble>(Class, "test2", {}, CM) == 1.5);
+  REQUIRE(testWithMethod<JavaInt>(Class, "test3", {}, CM) == 42);
+  REQUIRE(testWithMethod<JavaDouble>(Class, "test4", {}, CM) == 1.5);
+  REQUIRE(testWithMethod<JavaInt>(Class, "test5", {}, CM) == -5);
+  REQUIRE(testWithMethod<JavaInt>(Class, "test6", {}, CM) == -4);
+
+  // Static final constants are folded into the direct constant loads
+  const auto FirstInstr = [&](const char *Name) -> const Bytecode::Instruction& {
+    return **Class.getMethod(Name)->begin();
+  };
+  REQUIRE(FirstInstr("test3").isA<Bytecode::ldc_w>());
+  REQUIRE(FirstInstr("test4").isA<Bytecode::ldc2_w>());
+  REQUIRE(FirstInstr("test6").isA<Bytecode::getstatic>());
+}
+
+TEST_CASE("interpret invokestatic", "[SlowInterpreter][invokestatic]") {
+  ClassManager CM;
+  const auto &Class =
+      CM.getClass("tests/SlowInterpreter/invokestatic", getTestLoader());
+
+  REQUIRE(testWithMethod<JavaInt>(Class, "test1", {}, CM) == 20);
+  REQUIRE(testWithMethod<JavaInt>(Class, "test2", {}, CM) ==
+          std::numeric_limits<JavaInt>::min());
+  REQUIRE(testWithMethod<JavaInt>(Class, "test3", {}, CM) == 8);
+  REQUIRE(testWithMethod<JavaLong>(Class, "test4", {}, CM) ==
+          (static_cast<JavaLong>(1) << 56));
+  REQUIRE(testWithMethod<JavaDouble>(Class, "test5", {}, CM) == std::sqrt(2.0));
+
+  const auto min_res = testWithMethod<JavaFloat>(Class, "test6", {}, CM);
+  REQUIRE(min_res == 0.0f);
+  REQUIRE(std::signbit(min_res));
+
+  REQUIRE(testWithMethod<JavaInt>(Class, "test7", {}, CM) == 32);
+}
+
+TEST_CASE("interpret native", "[SlowInterpreter][native]") {
+  ClassManager CM;
+  CM.loadNativeLibrary(ICP_TEST_NATIVES_PATH);
+  const auto &Class =
+      CM.getClass("tests/SlowInterpreter/native", getTestLoader());
+
+  REQUIRE(testWithMethod<JavaInt>(Class, "test1", {}, CM) == 5);
+  REQUIRE(testWithMethod<JavaDouble>(Class, "test2", {}, CM) == 103.75);
+  REQUIRE(testWithMethod<JavaFloat>(Class, "test3", {}, CM) == 0.5f);
+}
+
+TEST_CASE("interpret synchronized", "[SlowInterpreter][synchronized]") {
+  ClassManager CM;
+  const auto &Class =
+      CM.getClass("tests/SlowInterpreter/synchronized", getTestLoader());
+
+  REQUIRE(testWithMethod<JavaInt>(Class, "test1", {}, CM) == 2);
+  REQUIRE(testWithMethod<JavaInt>(Class, "test2", {}, CM) == 1);
+
+  // All monitors should be released without inflation
+  const auto &Obj = CM.getClassObject(Class);
+  REQUIRE(!Obj.holdsLock());
+  REQUIRE(!Obj.isLockInflated());
+
+  // Monitor is released when exception leaves the synchronized method
+  REQUIRE_THROWS_AS(
+      testWithMethod<JavaInt>(Class, "test3", {}, CM), ClassNotFoundException);
+  REQUIRE(!Obj.holdsLock());
+
+  bool Locked = false;
+  std::thread Other([&]() {
+    auto &Lock = const_cast<ClassObject &>(Obj);
+    Lock.monitorEnter();
+    Locked = true;
+    Lock.monitorExit();
+  });
+  Other.join();
+  REQUIRE(Locked);
+}
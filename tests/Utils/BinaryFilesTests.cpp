@@ -0,0 +1,108 @@
+///
+/// Tests for the binary file utilities
+///
+
+#include "catch.hpp"
+
+#include "Utils/TestUtils.h"
+#include "Utils/BinaryFiles.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace Utils;
+
+TEST_CASE("Big endian reader", "[Utils][BinaryFiles]") {
+  const uint8_t Data[] = {
+      0xCA, 0xFE, 0xBA, 0xBE,
+      0x00, 0x34,
+      0x7f,
+      0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+      0xAA};
+
+  BigEndianReader Reader(Data, sizeof(Data));
+  REQUIRE(Reader.readWord() == 0xCAFEBABE);
+  REQUIRE(Reader.readHalf() == 0x34);
+  REQUIRE(Reader.readByte() == 0x7f);
+  REQUIRE(Reader.readDoubleWord() == 0x0102030405060708ull);
+  REQUIRE(Reader.remaining() == 1);
+
+  // Reads past the end throw and don't advance
+  REQUIRE_THROWS_AS(Reader.readHalf(), ReadError);
+  REQUIRE_THROWS_AS(Reader.readBytes(2), ReadError);
+  REQUIRE(Reader.remaining() == 1);
+
+  REQUIRE(*Reader.readBytes(1) == 0xAA);
+  REQUIRE(Reader.remaining() == 0);
+  REQUIRE_THROWS_AS(Reader.readByte(), ReadError);
+}
+
+TEST_CASE("Big endian reader matches stream reading", "[Utils][BinaryFiles]") {
+  const uint8_t Data[] = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0};
+  std::istringstream Stream(
+      std::string(reinterpret_cast<const char*>(Data), sizeof(Data)));
+
+  BigEndianReader Reader(Data, sizeof(Data));
+  REQUIRE(Reader.readHalf() == BigEndianReading::readHalf(Stream));
+  REQUIRE(Reader.readByte() == BigEndianReading::readByte(Stream));
+  Reader.skip(1);
+  (void)BigEndianReading::readByte(Stream);
+  REQUIRE(Reader.readWord() == BigEndianReading::readWord(Stream));
+}
+
+TEST_CASE("Big endian writer", "[Utils][BinaryFiles]") {
+  BigEndianWriter Writer;
+  Writer.writeWord(0xCAFEBABE);
+  Writer.writeHalf(0x34);
+  const auto Pos = Writer.size();
+  Writer.writeWord(0);
+  Writer.writeByte(0x7f);
+  Writer.writeDoubleWord(0x0102030405060708ull);
+  Writer.writeBytes("ab");
+  Writer.patchWord(Pos, 0x11223344);
+
+  const auto Bytes = Writer.take();
+  REQUIRE(Bytes.size() == 21);
+
+  BigEndianReader Reader(
+      reinterpret_cast<const uint8_t*>(Bytes.data()), Bytes.size());
+  REQUIRE(Reader.readWord() == 0xCAFEBABE);
+  REQUIRE(Reader.readHalf() == 0x34);
+  REQUIRE(Reader.readWord() == 0x11223344);
+  REQUIRE(Reader.readByte() == 0x7f);
+  REQUIRE(Reader.readDoubleWord() == 0x0102030405060708ull);
+  REQUIRE(Reader.readByte() == 'a');
+  REQUIRE(Reader.readByte() == 'b');
+  REQUIRE(Reader.remaining() == 0);
+}
+
+TEST_CASE("Mapped file", "[Utils][BinaryFiles]") {
+  REQUIRE_THROWS_AS(MappedFile("wrong name"), ReadError);
+
+  MappedFile File("examples/Simple.class");
+  REQUIRE(File.size() > 4);
+
+  BigEndianReader Reader(File.data(), File.size());
+  REQUIRE(Reader.readWord() == 0xCAFEBABE);
+}
+
+TEST_CASE("Replace file", "[Utils][BinaryFiles]") {
+  TestUtils::TempDir Dir;
+  const std::string Path = Dir.path("replace.bin");
+
+  replaceFile(Path, "first");
+  {
+    // Mapping of the old file stays intact
+    MappedFile Old(Path);
+    replaceFile(Path, "second");
+
+    REQUIRE(std::string_view(
+        reinterpret_cast<const char*>(Old.data()), Old.size()) == "first");
+  }
+
+  MappedFile New(Path);
+  REQUIRE(std::string_view(
+      reinterpret_cast<const char*>(New.data()), New.size()) == "second");
+
+  REQUIRE_THROWS_AS(replaceFile("no/such/dir/file", "data"), WriteError);
+}
@@ -0,0 +1,66 @@
+///
+/// Tests for the BLAKE2b hash
+///
+
+#include "catch.hpp"
+
+#include "Utils/Blake2b.h"
+
+#include <string>
+
+using namespace Utils;
+
+namespace {
+
+template<std::size_t N>
+std::string toHex(const std::array<uint8_t, N> &Digest) {
+  static const char Digits[] = "0123456789abcdef";
+  std::string Ret;
+  for (auto Byte: Digest) {
+    Ret += Digits[Byte >> 4];
+    Ret += Digits[Byte & 0xf];
+  }
+  return Ret;
+}
+
+std::string generateData(std::size_t Size) {
+  std::string Ret(Size, '\0');
+  for (std::size_t Idx = 0; Idx < Size; ++Idx)
+    Ret[Idx] = static_cast<char>(Idx % 251);
+  return Ret;
+}
+
+}
+
+TEST_CASE("Blake2b reference values", "[Utils][Blake2b]") {
+  REQUIRE(toHex(Blake2b::hash<64>("")) ==
+          "786a02f742015903c6c6fd852552d272912f4740e15847618a86e217f71f5419"
+          "d25e1031afee585313896444934eb04b903a685b1448b755d56f701afe9be2ce");
+  REQUIRE(toHex(Blake2b::hash<64>("abc")) ==
+          "ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d1"
+          "7d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923");
+  REQUIRE(toHex(Blake2b::hash<32>("abc")) ==
+          "bddd813c634239723171ef3fee98579b94964e3bb1cb3e427262c8c068d52319");
+
+  // Exactly one block and several blocks with the tail
+  REQUIRE(toHex(Blake2b::hash<32>(std::string(128, '\0'))) ==
+          "378d0caaaa3855f1b38693c1d6ef004fd118691c95c959d4efa950d6d6fcf7c1");
+  REQUIRE(toHex(Blake2b::hash<32>(generateData(1000))) ==
+          "b372d0608f720c8c3dd41e9c8eecb10143b41abe520b616607e754bf79c08331");
+}
+
+TEST_CASE("Blake2b incremental updates", "[Utils][Blake2b]") {
+  const auto Data = generateData(1000);
+  const auto Expected = Blake2b::hash<32>(Data);
+
+  // Split points around the block boundaries
+  for (std::size_t Chunk: {1u, 7u, 127u, 128u, 129u, 256u, 999u}) {
+    Blake2b Hasher(32);
+    for (std::size_t Pos = 0; Pos < Data.size(); Pos += Chunk)
+      Hasher.update(std::string_view(Data).substr(Pos, Chunk));
+
+    std::array<uint8_t, 32> Digest;
+    Hasher.finish(Digest.data());
+    REQUIRE(Digest == Expected);
+  }
+}
@@ -0,0 +1,66 @@
+///
+/// Tests for the concurrent hash map
+///
+
+#include "catch.hpp"
+
+#include "Utils/ConcurrentHashMap.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Utils;
+
+TEST_CASE("Concurrent hash map basic", "[Utils][ConcurrentHashMap]") {
+  ConcurrentHashMap<std::string, int> Map(2);
+
+  REQUIRE(Map.find("a") == nullptr);
+  REQUIRE(Map.insert("a", 1).second);
+  REQUIRE(*Map.find("a") == 1);
+
+  // No overwrites
+  auto [Val, Inserted] = Map.insert("a", 2);
+  REQUIRE(!Inserted);
+  REQUIRE(*Val == 1);
+
+  // Pointers are stable across growth
+  const int *A = Map.find("a");
+  for (int i = 0; i < 1000; ++i)
+    Map.insert(std::to_string(i), i);
+  REQUIRE(Map.size() == 1001);
+  REQUIRE(Map.find("a") == A);
+
+  int NumFound = 0;
+  for (int i = 0; i < 1000; ++i)
+    NumFound += *Map.find(std::to_string(i)) == i;
+  REQUIRE(NumFound == 1000);
+  REQUIRE(Map.find("1000") == nullptr);
+}
+
+TEST_CASE("Concurrent hash map readers", "[Utils][ConcurrentHashMap]") {
+  ConcurrentHashMap<int, int> Map(1);
+  const int NumKeys = 20000;
+
+  // Readers should always see either nothing or the complete value
+  std::vector<std::thread> Readers;
+  bool Failed[4] = {};
+  for (int t = 0; t < 4; ++t) {
+    Readers.emplace_back([&, t]() {
+      for (int i = 0; i < NumKeys; ++i) {
+        const int *V = Map.find(i);
+        if (V && *V != i * 2)
+          Failed[t] = true;
+      }
+    });
+  }
+
+  for (int i = 0; i < NumKeys; ++i)
+    Map.insert(i, i * 2);
+  for (auto &R: Readers)
+    R.join();
+
+  for (bool F: Failed)
+    REQUIRE(!F);
+  REQUIRE(*Map.find(NumKeys - 1) == (NumKeys - 1) * 2);
+}
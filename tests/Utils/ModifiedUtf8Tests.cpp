@@ -0,0 +1,66 @@
+///
+/// Tests for the modified UTF-8 validation
+///
+
+#include "catch.hpp"
+
+#include "Utils/ModifiedUtf8.h"
+
+#include <string>
+#include <vector>
+
+using namespace Utils;
+
+static bool checkBoth(const std::vector<uint8_t> &Bytes) {
+  const bool Fast = ModifiedUtf8::isValid(Bytes.data(), Bytes.size());
+  const bool Slow = ModifiedUtf8::isValidScalar(Bytes.data(), Bytes.size());
+  REQUIRE(Fast == Slow);
+  return Fast;
+}
+
+static std::vector<uint8_t> bytes(const std::string &Str) {
+  return std::vector<uint8_t>(Str.begin(), Str.end());
+}
+
+TEST_CASE("Modified UTF-8 ASCII", "[Utils][ModifiedUtf8]") {
+  REQUIRE(checkBoth({}));
+  REQUIRE(checkBoth(bytes("java/lang/Object")));
+  REQUIRE(checkBoth(bytes("(Ljava/lang/String;IJ)Ljava/lang/Object;")));
+
+  // Zero byte is never allowed, check every position relative to the vectors
+  for (std::size_t Pos = 0; Pos < 70; ++Pos) {
+    auto Str = bytes(std::string(70, 'a'));
+    REQUIRE(ModifiedUtf8::asciiPrefixLength(Str.data(), Str.size()) == 70);
+
+    Str[Pos] = 0;
+    REQUIRE(ModifiedUtf8::asciiPrefixLength(Str.data(), Str.size()) == Pos);
+    REQUIRE_FALSE(checkBoth(Str));
+  }
+}
+
+TEST_CASE("Modified UTF-8 multibyte", "[Utils][ModifiedUtf8]") {
+  // Null character and regular two and three byte characters
+  REQUIRE(checkBoth({'a', 0xC0, 0x80, 'b'}));
+  REQUIRE(checkBoth({0xC3, 0xA9}));
+  REQUIRE(checkBoth({0xE2, 0x82, 0xAC}));
+  // Surrogate pair is encoded as two three byte sequences
+  REQUIRE(checkBoth({0xED, 0xA0, 0xBD, 0xED, 0xB8, 0x80}));
+
+  // Long ASCII runs around the multibyte characters
+  auto Mixed = bytes(std::string(40, 'x') + "\xC3\xA9" + std::string(40, 'y'));
+  REQUIRE(checkBoth(Mixed));
+  Mixed[41] = 'z'; // broken continuation
+  REQUIRE_FALSE(checkBoth(Mixed));
+
+  // Overlong forms
+  REQUIRE_FALSE(checkBoth({0xC1, 0xBF}));
+  REQUIRE_FALSE(checkBoth({0xC0, 0x81}));
+  REQUIRE_FALSE(checkBoth({0xE0, 0x80, 0x80}));
+  // Four byte forms and stray bytes
+  REQUIRE_FALSE(checkBoth({0xF0, 0x9F, 0x98, 0x80}));
+  REQUIRE_FALSE(checkBoth({0xFF}));
+  REQUIRE_FALSE(checkBoth({0x80}));
+  // Truncated sequences
+  REQUIRE_FALSE(checkBoth({'a', 0xC3}));
+  REQUIRE_FALSE(checkBoth({0xE2, 0x82}));
+}
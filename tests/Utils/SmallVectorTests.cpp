@@ -0,0 +1,60 @@
+///
+/// Tests for the small vector
+///
+
+#include "catch.hpp"
+
+#include "Utils/SmallVector.h"
+
+#include <vector>
+
+using namespace Utils;
+
+TEST_CASE("Small vector growth", "[Utils][SmallVector]") {
+  SmallVector<int, 4> Vec{1, 2, 3};
+  REQUIRE(Vec.size() == 3);
+  REQUIRE(Vec.isInline());
+
+  Vec.push_back(4);
+  REQUIRE(Vec.isInline());
+
+  // Elements survive moving to the heap
+  Vec.push_back(Vec[0]);
+  REQUIRE(!Vec.isInline());
+  REQUIRE(std::vector<int>(Vec.begin(), Vec.end()) ==
+          std::vector<int>{1, 2, 3, 4, 1});
+
+  Vec.resize(7, 9);
+  REQUIRE(Vec.back() == 9);
+  Vec.pop_back();
+  REQUIRE(Vec.size() == 6);
+
+  // Capacity is kept after clear
+  const auto Capacity = Vec.capacity();
+  Vec.clear();
+  REQUIRE(Vec.empty());
+  REQUIRE(Vec.capacity() == Capacity);
+}
+
+TEST_CASE("Small vector copies", "[Utils][SmallVector]") {
+  SmallVector<int, 2> Small{1};
+  SmallVector<int, 2> Large{1, 2, 3, 4};
+
+  // Assignment reuses the existing storage
+  SmallVector<int, 2> Dst;
+  Dst.reserve(8);
+  Dst = Large;
+  REQUIRE(Dst.capacity() == 8);
+  REQUIRE(std::vector<int>(Dst.begin(), Dst.end()) ==
+          std::vector<int>{1, 2, 3, 4});
+
+  // Heap storage is taken over by the move, inline is copied
+  SmallVector<int, 2> Moved(std::move(Large));
+  REQUIRE(Moved.size() == 4);
+  REQUIRE(!Moved.isInline());
+  REQUIRE(Large.empty());
+
+  Moved = std::move(Small);
+  REQUIRE(Moved.size() == 1);
+  REQUIRE(Moved[0] == 1);
+}
@@ -0,0 +1,73 @@
+///
+/// Tests for the symbol table
+///
+
+#include "catch.hpp"
+
+#include "Utils/Symbol.h"
+#include "Runtime/ClassManager.h"
+#include "JavaTypes/JavaClass.h"
+
+#include <thread>
+#include <vector>
+
+using namespace Utils;
+
+TEST_CASE("Symbol interning", "[Utils][Symbol]") {
+  const auto A = Symbol::intern("tests/Utils/SymbolA");
+  const auto B = Symbol::intern(std::string("tests/Utils/") + "SymbolA");
+  const auto C = Symbol::intern("tests/Utils/SymbolC");
+
+  REQUIRE(A == B);
+  REQUIRE(&A.str() == &B.str());
+  REQUIRE(A.hash() == B.hash());
+  REQUIRE(A != C);
+
+  // Comparisons with plain strings
+  REQUIRE(A == "tests/Utils/SymbolA");
+  REQUIRE(A != "tests/Utils/SymbolC");
+  REQUIRE(A + ".class" == "tests/Utils/SymbolA.class");
+
+  // Lookups don't create new symbols
+  const auto Size = Symbol::tableSize();
+  REQUIRE(Symbol::lookup("tests/Utils/never interned").isNull());
+  REQUIRE(Symbol::tableSize() == Size);
+  REQUIRE(Symbol::lookup("tests/Utils/SymbolA") == A);
+
+  REQUIRE(Symbols::init() == "<init>");
+  REQUIRE(Symbols::clinit() == Symbol::intern("<clinit>"));
+}
+
+TEST_CASE("Concurrent symbol interning", "[Utils][Symbol]") {
+  const int NumThreads = 4;
+  const int NumSymbols = 500;
+
+  std::vector<std::vector<Symbol>> Results(NumThreads);
+  std::vector<std::thread> Threads;
+  for (int T = 0; T < NumThreads; ++T) {
+    Threads.emplace_back([&, T]() {
+      for (int i = 0; i < NumSymbols; ++i)
+        Results[T].push_back(
+            Symbol::intern("tests/Utils/concurrent" + std::to_string(i)));
+    });
+  }
+  for (auto &T: Threads)
+    T.join();
+
+  for (int T = 1; T < NumThreads; ++T)
+    REQUIRE(Results[T] == Results[0]);
+}
+
+TEST_CASE("Names are shared between classes", "[Utils][Symbol]") {
+  Runtime::ClassManager CM;
+  const auto &A = CM.getClass("tests/Runtime/init_a", Runtime::getTestLoader());
+  const auto &B = CM.getClass("tests/Runtime/init_b", Runtime::getTestLoader());
+
+  // Both classes refer to the same interned super class name
+  REQUIRE(A.getSuperClassName() == B.getSuperClassName());
+  REQUIRE(&A.getSuperClassName().str() == &B.getSuperClassName().str());
+
+  const auto *Clinit = A.getMethod(Symbols::clinit());
+  REQUIRE(Clinit != nullptr);
+  REQUIRE(Clinit == A.getMethod("<clinit>"));
+}
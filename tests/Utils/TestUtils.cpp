@@ -5,6 +5,11 @@
 
 #include "TestUtils.h"
 
+#include <cstdio>
+#include <cstdlib>
+
+#include <ftw.h>
+
 using namespace TestUtils;
 using namespace JavaTypes;
 
@@ -18,76 +23,68 @@ static std::vector<uint8_t> trivialBytecodePlain() {
 static std::unique_ptr<ConstantPool> createConstantPool() {
   ConstantPoolBuilder Builder(27);
 
-  Builder.set(1, std::make_unique<ConstantPoolRecords::Utf8>("trivial_method"));
-  Builder.set(2, std::make_unique<ConstantPoolRecords::Utf8>("()I"));
-  Builder.set(3, std::make_unique<ConstantPoolRecords::Utf8>("trivial_class"));
-  Builder.set(4, std::make_unique<ConstantPoolRecords::ClassInfo>(
-      Builder.getCellReference<ConstantPoolRecords::Utf8>(3)));
+  Builder.create<ConstantPoolRecords::Utf8>(1, "trivial_method");
+  Builder.create<ConstantPoolRecords::Utf8>(2, "()I");
+  Builder.create<ConstantPoolRecords::Utf8>(3, "trivial_class");
+  Builder.create<ConstantPoolRecords::ClassInfo>(4,
+      Builder.getCellReference<ConstantPoolRecords::Utf8>(3));
 
 
-  Builder.set(5, std::make_unique<ConstantPoolRecords::Utf8>("()V"));
-  Builder.set(6, std::make_unique<ConstantPoolRecords::Utf8>("()J"));
+  Builder.create<ConstantPoolRecords::Utf8>(5, "()V");
+  Builder.create<ConstantPoolRecords::Utf8>(6, "()J");
 
-  Builder.set(7, std::make_unique<ConstantPoolRecords::Utf8>("([Ljava/lang/String;)V"));
-  Builder.set(8, std::make_unique<ConstantPoolRecords::Utf8>("(Ljava/lang/Object;)V"));
-  Builder.set(9, std::make_unique<ConstantPoolRecords::Utf8>("(I)V"));
+  Builder.create<ConstantPoolRecords::Utf8>(7, "([Ljava/lang/String;)V");
+  Builder.create<ConstantPoolRecords::Utf8>(8, "(Ljava/lang/Object;)V");
+  Builder.create<ConstantPoolRecords::Utf8>(9, "(I)V");
 
-  Builder.set(10, std::make_unique<ConstantPoolRecords::Utf8>("java/lang/Object"));
-  Builder.set(12, std::make_unique<ConstantPoolRecords::ClassInfo>(
-      Builder.getCellReference<ConstantPoolRecords::Utf8>(10)));
+  Builder.create<ConstantPoolRecords::Utf8>(10, "java/lang/Object");
+  Builder.create<ConstantPoolRecords::ClassInfo>(12,
+      Builder.getCellReference<ConstantPoolRecords::Utf8>(10));
 
   // NameAndType "<init>":()V
-  Builder.set(11, std::make_unique<ConstantPoolRecords::Utf8>("<init>"));
-  Builder.set(13, std::make_unique<ConstantPoolRecords::NameAndType>(
+  Builder.create<ConstantPoolRecords::Utf8>(11, "<init>");
+  Builder.create<ConstantPoolRecords::NameAndType>(13,
       Builder.getCellReference<ConstantPoolRecords::Utf8>(11),
-      Builder.getCellReference<ConstantPoolRecords::Utf8>(5)));
+      Builder.getCellReference<ConstantPoolRecords::Utf8>(5));
   // MethodRef java/lang/Object."<init>":()V
-  Builder.set(14, std::make_unique<ConstantPoolRecords::MethodRef>(
+  Builder.create<ConstantPoolRecords::MethodRef>(14,
       Builder.getCellReference<ConstantPoolRecords::ClassInfo>(12),
-      Builder.getCellReference<ConstantPoolRecords::NameAndType>(13)));
+      Builder.getCellReference<ConstantPoolRecords::NameAndType>(13));
 
   // NameAndType <init>:(Ljava/lang/Object;I)V
-  Builder.set(15,
-      std::make_unique<ConstantPoolRecords::Utf8>("(Ljava/lang/String;I)V"));
-  Builder.set(16, std::make_unique<ConstantPoolRecords::NameAndType>(
+  Builder.create<ConstantPoolRecords::Utf8>(15, "(Ljava/lang/String;I)V");
+  Builder.create<ConstantPoolRecords::NameAndType>(16,
       Builder.getCellReference<ConstantPoolRecords::Utf8>(11),
-      Builder.getCellReference<ConstantPoolRecords::Utf8>(15)));
+      Builder.getCellReference<ConstantPoolRecords::Utf8>(15));
   // MethodRef java/lang/Object.<init>:(Ljava/lang/Object;I)V
-  Builder.set(17, std::make_unique<ConstantPoolRecords::MethodRef>(
+  Builder.create<ConstantPoolRecords::MethodRef>(17,
       Builder.getCellReference<ConstantPoolRecords::ClassInfo>(12),
-      Builder.getCellReference<ConstantPoolRecords::NameAndType>(16)));
+      Builder.getCellReference<ConstantPoolRecords::NameAndType>(16));
 
   // NameAndType <init>:(Ljava/lang/Object;)V
-  Builder.set(18, std::make_unique<ConstantPoolRecords::NameAndType>(
+  Builder.create<ConstantPoolRecords::NameAndType>(18,
       Builder.getCellReference<ConstantPoolRecords::Utf8>(11),
-      Builder.getCellReference<ConstantPoolRecords::Utf8>(8)));
+      Builder.getCellReference<ConstantPoolRecords::Utf8>(8));
 
   // NameAndType <init>:()I
-  Builder.set(19, std::make_unique<ConstantPoolRecords::NameAndType>(
+  Builder.create<ConstantPoolRecords::NameAndType>(19,
       Builder.getCellReference<ConstantPoolRecords::Utf8>(11),
-      Builder.getCellReference<ConstantPoolRecords::Utf8>(2)));
+      Builder.getCellReference<ConstantPoolRecords::Utf8>(2));
   // MethodRef java/lang/Object.<init>:()I
-  Builder.set(20, std::make_unique<ConstantPoolRecords::MethodRef>(
+  Builder.create<ConstantPoolRecords::MethodRef>(20,
       Builder.getCellReference<ConstantPoolRecords::ClassInfo>(12),
-      Builder.getCellReference<ConstantPoolRecords::NameAndType>(19)));
+      Builder.getCellReference<ConstantPoolRecords::NameAndType>(19));
 
-  Builder.set(21, std::make_unique<ConstantPoolRecords::Utf8>(
-      "I"));
-  Builder.set(22, std::make_unique<ConstantPoolRecords::Utf8>(
-      "F1"));
+  Builder.create<ConstantPoolRecords::Utf8>(21, "I");
+  Builder.create<ConstantPoolRecords::Utf8>(22, "F1");
 
-  Builder.set(23, std::make_unique<ConstantPoolRecords::Utf8>(
-      "D"));
-  Builder.set(24, std::make_unique<ConstantPoolRecords::Utf8>(
-      "F2"));
+  Builder.create<ConstantPoolRecords::Utf8>(23, "D");
+  Builder.create<ConstantPoolRecords::Utf8>(24, "F2");
 
-  Builder.set(25, std::make_unique<ConstantPoolRecords::Utf8>(
-      "LFields;"));
-  Builder.set(26, std::make_unique<ConstantPoolRecords::Utf8>(
-      "Ref"));
+  Builder.create<ConstantPoolRecords::Utf8>(25, "LFields;");
+  Builder.create<ConstantPoolRecords::Utf8>(26, "Ref");
 
-  Builder.set(27, std::make_unique<ConstantPoolRecords::Utf8>(
-      "LFields"));
+  Builder.create<ConstantPoolRecords::Utf8>(27, "LFields");
 
   return Builder.createConstantPool();
 }
@@ -152,3 +149,18 @@ std::unique_ptr<JavaTypes::JavaClass> TestUtils::createClass(
   return std::make_unique<JavaClass>(std::move(Params));
 
 }
+
+TestUtils::TempDir::TempDir() {
+  char Template[] = "/tmp/icp_test_XXXXXX";
+  REQUIRE(mkdtemp(Template) != nullptr);
+  Path = Template;
+}
+
+TestUtils::TempDir::~TempDir() {
+  // Children are visited first, symlinks are removed and not followed
+  nftw(Path.c_str(),
+       [](const char *Name, const struct stat *, int, struct FTW *) {
+         return std::remove(Name);
+       },
+       16, FTW_DEPTH | FTW_PHYS);
+}
@@ -17,9 +17,31 @@
 #include "JavaTypes/ConstantPool.h"
 
 #include <iostream>
+#include <string>
 
 namespace TestUtils {
 
+/// Unique temporary directory which is removed together with everything
+/// inside of it at the end of the scope.
+class TempDir final {
+public:
+  TempDir();
+  ~TempDir();
+
+  TempDir(const TempDir &) = delete;
+  TempDir &operator=(const TempDir &) = delete;
+
+  const std::string &path() const { return Path; }
+
+  /// \returns Path of the entry 'Name' inside of this directory.
+  std::string path(const std::string &Name) const {
+    return Path + "/" + Name;
+  }
+
+private:
+  std::string Path;
+};
+
 /// Matcher for the exceptions with description
 class ExEquals : public Catch::MatcherBase<std::runtime_error> {
   const char *Target;
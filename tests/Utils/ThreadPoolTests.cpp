@@ -0,0 +1,39 @@
+///
+/// Tests for the thread pool
+///
+
+#include "catch.hpp"
+
+#include "Utils/ThreadPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace Utils;
+
+TEST_CASE("Thread pool", "[Utils][ThreadPool]") {
+  ThreadPool Pool(3);
+  REQUIRE(Pool.numThreads() == 3);
+
+  std::vector<std::future<int>> Results;
+  for (int i = 0; i < 100; ++i)
+    Results.push_back(Pool.submit([i]() { return i * i; }));
+  for (int i = 0; i < 100; ++i)
+    REQUIRE(Results[i].get() == i * i);
+
+  // Exceptions are delivered through the future
+  auto Failed = Pool.submit([]() -> int { throw std::runtime_error("fail"); });
+  REQUIRE_THROWS_AS(Failed.get(), std::runtime_error);
+
+  // Tasks can submit other tasks
+  std::atomic<int> Counter{0};
+  auto Outer = Pool.submit([&]() {
+    ++Counter;
+    return Pool.submit([&]() { ++Counter; });
+  });
+  Outer.get().get();
+  REQUIRE(Counter == 2);
+
+  REQUIRE(ThreadPool().numThreads() >= 1);
+}
@@ -10,6 +10,7 @@
 #include "JavaTypes/ConstantPool.h"
 #include "CD/Parser.h"
 #include "Bytecode/Instructions.h"
+#include "Utils/ThreadPool.h"
 
 using Catch::Matchers::Equals;
 
@@ -420,3 +421,31 @@ TEST_CASE("verifier new", "[Verifier][new]") {
 TEST_CASE("verifier getputfield", "[Verifier][getputfield]") {
   runAutoTest("putfield_getfield.cd");
 }
+
+TEST_CASE("verifier ldc", "[Verifier][ldc]") {
+  runAutoTest("ldc.cd");
+}
+
+TEST_CASE("verifier invokestatic", "[Verifier][invokestatic]") {
+  runAutoTest("invokestatic.cd");
+}
+
+TEST_CASE("Parallel class verification", "[Verifier][parallel]") {
+  Utils::ThreadPool Pool(4);
+
+  SECTION("Valid class") {
+    auto C = CD::parseFromFile("tests/SlowInterpreter/invokestatic.cd");
+    REQUIRE_NOTHROW(Verifier::verify(*C, Pool));
+  }
+
+  SECTION("Error of the first method is reported") {
+    // Several methods fail, result should not depend on the scheduling
+    for (int Iter = 0; Iter < 20; ++Iter) {
+      auto C = CD::parseFromFile("tests/Verifier/get_put_static.cd");
+      REQUIRE_THROWS_MATCHES(
+          Verifier::verify(*C, Pool),
+          VerificationError,
+          ExEquals("Incompatible type in put static instruction"));
+    }
+  }
+}
@@ -0,0 +1,44 @@
+///
+/// Assembles CD file into the class file.
+///
+/// Usage: ICP_cd2class input.cd [output.class]
+/// By default output is written next to the input with the '.class'
+/// extension.
+///
+
+#include "CD/Parser.h"
+#include "ClassFileWriter/ClassFileWriter.h"
+#include "JavaTypes/JavaClass.h"
+
+#include <exception>
+#include <iostream>
+#include <string>
+
+int main(int argc, char *argv[]) {
+  if (argc != 2 && argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " input.cd [output.class]\n";
+    return 1;
+  }
+
+  const std::string Input = argv[1];
+  std::string Output;
+  if (argc == 3) {
+    Output = argv[2];
+  } else {
+    const auto Dot = Input.rfind('.');
+    const auto Slash = Input.rfind('/');
+    const bool HasExt =
+        Dot != std::string::npos && (Slash == std::string::npos || Dot > Slash);
+    Output = (HasExt ? Input.substr(0, Dot) : Input) + ".class";
+  }
+
+  try {
+    const auto Class = CD::parseFromFile(Input);
+    ClassFileWriter::writeClassToFile(*Class, Output);
+  } catch (const std::exception &E) {
+    std::cerr << Input << ": " << E.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}